@@ -178,6 +178,21 @@ if(NOT MSVC)
     CXXFLAGS ${AVX2_CXXFLAGS}
   )
 
+  # Check for AVX-512 intrinsics.
+  set(AVX512_CXXFLAGS -mavx -mavx2 -mavx512f)
+  check_cxx_source_compiles_with_flags("
+    #include <immintrin.h>
+
+    int main()
+    {
+      __m512i l = _mm512_set1_epi32(0);
+      l = _mm512_ternarylogic_epi32(l, l, l, 0x96);
+      return _mm512_cvtsi512_si32(_mm512_ror_epi32(l, 7));
+    }
+    " HAVE_AVX512
+    CXXFLAGS ${AVX512_CXXFLAGS}
+  )
+
   # Check for x86 SHA-NI intrinsics.
   set(X86_SHANI_CXXFLAGS -msse4 -msha)
   check_cxx_source_compiles_with_flags("
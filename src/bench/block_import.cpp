@@ -0,0 +1,55 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/chaintype.h>
+#include <validation.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+static constexpr size_t BATCH_BLOCKS{16};
+
+/*
+ * Feed a batch of serialized blocks to validation. The blocks do not connect
+ * to the chain of the test setup, so validation rejects them after checking
+ * them with CheckBlock(), which is where the bulk of the time goes, as it
+ * would for blocks that do connect.
+ */
+static void ProcessBlocksOneByOne(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN)};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+
+    bench.unit("block").batch(BATCH_BLOCKS).run([&] {
+        for (size_t i{0}; i < BATCH_BLOCKS; ++i) {
+            auto block{std::make_shared<CBlock>()};
+            SpanReader{benchmark::data::block413567} >> TX_WITH_WITNESS(*block);
+            chainman.ProcessNewBlock(block, /*force_processing=*/true, /*min_pow_checked=*/true, /*new_block=*/nullptr);
+        }
+    });
+}
+
+static void ProcessBlocksBatched(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN)};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    const std::vector<std::span<const std::byte>> raw_blocks(BATCH_BLOCKS, std::span{benchmark::data::block413567});
+
+    std::vector<bool> new_blocks;
+    bench.unit("block").batch(BATCH_BLOCKS).run([&] {
+        node::ProcessRawBlocks(chainman, raw_blocks, /*num_workers=*/4, new_blocks);
+    });
+}
+
+BENCHMARK(ProcessBlocksOneByOne);
+BENCHMARK(ProcessBlocksBatched);
@@ -9,10 +9,16 @@
 #include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
+#include <random.h>
 #include <script/signingprovider.h>
+#include <sync.h>
 #include <test/util/transaction_utils.h>
+#include <uint256.h>
 
+#include <algorithm>
 #include <cassert>
+#include <span>
+#include <thread>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -55,3 +61,63 @@ static void CCoinsCaching(benchmark::Bench& bench)
 }
 
 BENCHMARK(CCoinsCaching);
+
+/*
+ * Readers on all cores looking up cached coins in batches (as REST getutxos
+ * does), either in a CCoinsViewCache guarded by a single lock, as the tip
+ * cache is by cs_main, or through a CCoinsViewSharded.
+ */
+static void CCoinsCachingConcurrentReaders(benchmark::Bench& bench, bool sharded)
+{
+    constexpr size_t NUM_COINS{10'000};
+    constexpr size_t LOOKUPS_PER_READER{10'000};
+    constexpr size_t BATCH_SIZE{15};
+    const size_t num_readers{std::max(1U, std::thread::hardware_concurrency())};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    CCoinsView coins_dummy;
+    CCoinsViewCache base{&coins_dummy};
+    std::vector<COutPoint> outpoints;
+    for (size_t i{0}; i < NUM_COINS; ++i) {
+        outpoints.emplace_back(Txid::FromUint256(rng.rand256()), 0);
+        base.AddCoin(outpoints.back(), Coin{CTxOut{COIN, CScript{} << OP_TRUE}, 1, false}, /*possible_overwrite=*/false);
+    }
+    base.SetBestBlock(uint256::ONE);
+
+    Mutex mutex;
+    CCoinsViewCache locked_cache{&base};
+    CCoinsViewSharded shared{&base};
+    CoinsViewPublishingCache tip{shared};
+    shared.RequestActivation();
+    tip.Flush();
+    std::vector<std::optional<Coin>> coins;
+    for (const auto& outpoint : outpoints) assert(locked_cache.GetCoin(outpoint));
+    assert(shared.GetCoins(outpoints, coins));
+
+    bench.batch(num_readers * LOOKUPS_PER_READER).unit("lookup").run([&] {
+        std::vector<std::thread> readers;
+        for (size_t r{0}; r < num_readers; ++r) {
+            readers.emplace_back([&, r] {
+                std::vector<std::optional<Coin>> found;
+                for (size_t i{0}; i < LOOKUPS_PER_READER; i += BATCH_SIZE) {
+                    const std::span batch{outpoints.begin() + (r * LOOKUPS_PER_READER + i) % (NUM_COINS - BATCH_SIZE), BATCH_SIZE};
+                    if (sharded) {
+                        assert(shared.GetCoins(batch, found));
+                    } else {
+                        LOCK(mutex);
+                        found.clear();
+                        for (const auto& outpoint : batch) found.push_back(locked_cache.GetCoin(outpoint));
+                    }
+                    assert(found.back());
+                }
+            });
+        }
+        for (auto& reader : readers) reader.join();
+    });
+}
+
+static void CCoinsCachingConcurrentLocked(benchmark::Bench& bench) { CCoinsCachingConcurrentReaders(bench, /*sharded=*/false); }
+static void CCoinsCachingConcurrentSharded(benchmark::Bench& bench) { CCoinsCachingConcurrentReaders(bench, /*sharded=*/true); }
+
+BENCHMARK(CCoinsCachingConcurrentLocked);
+BENCHMARK(CCoinsCachingConcurrentSharded);
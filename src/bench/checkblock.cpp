@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <bench/memory_usage.h>
 #include <bench/data/block413567.raw.h>
 #include <chainparams.h>
 #include <common/args.h>
@@ -48,7 +49,8 @@ static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
     ArgsManager bench_args;
     const auto chainParams = CreateChainParams(bench_args, ChainType::MAIN);
 
-    bench.unit("block").run([&] {
+    bench.unit("block");
+    benchmark::RunWithMemoryUsage(bench, [&] {
         CBlock block; // Note that CBlock caches its checked state, so we need to recreate it here
         stream >> TX_WITH_WITNESS(block);
         bool rewound = stream.Rewind(benchmark::data::block413567.size());
@@ -60,5 +62,23 @@ static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
     });
 }
 
+static void CheckBlockTest(benchmark::Bench& bench)
+{
+    ArgsManager bench_args;
+    const auto chainParams = CreateChainParams(bench_args, ChainType::MAIN);
+
+    CBlock block;
+    SpanReader{benchmark::data::block413567} >> TX_WITH_WITNESS(block);
+
+    bench.unit("block");
+    benchmark::RunWithMemoryUsage(bench, [&] {
+        block.fChecked = false; // CBlock caches its checked state
+        BlockValidationState validationState;
+        bool checked = CheckBlock(block, validationState, chainParams->GetConsensus());
+        assert(checked);
+    });
+}
+
 BENCHMARK(DeserializeBlockTest);
 BENCHMARK(DeserializeAndCheckBlockTest);
+BENCHMARK(CheckBlockTest);
@@ -4,9 +4,13 @@
 
 #include <addresstype.h>
 #include <bench/bench.h>
+#include <bench/memory_usage.h>
+#include <coins.h>
+#include <consensus/amount.h>
 #include <interfaces/chain.h>
 #include <kernel/cs_main.h>
 #include <script/interpreter.h>
+#include <script/script.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
@@ -92,7 +96,8 @@ std::pair<std::vector<CKey>, std::vector<CTxOut>> CreateKeysAndOutputs(const CKe
 void BenchmarkConnectBlock(benchmark::Bench& bench, std::vector<CKey>& keys, std::vector<CTxOut>& outputs, TestChain100Setup& test_setup)
 {
     const auto& test_block{CreateTestBlock(test_setup, keys, outputs)};
-    bench.unit("block").run([&] {
+    bench.unit("block");
+    benchmark::RunWithMemoryUsage(bench, [&] {
         LOCK(cs_main);
         auto& chainman{test_setup.m_node.chainman};
         auto& chainstate{chainman->ActiveChainstate()};
@@ -126,6 +131,73 @@ static void ConnectBlockAllEcdsa(benchmark::Bench& bench)
     BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
 }
 
+/*
+ * Creates a test block whose inputs all spend outputs of an earlier block, with
+ * the coins flushed to the database so every lookup misses the coins cache:
+ * - A funding transaction creates num_inputs anyone-can-spend outputs
+ * - Each test block transaction spends inputs_per_tx of them (no signatures)
+ */
+CBlock CreateColdCacheTestBlock(TestChain100Setup& test_setup, int num_inputs, int inputs_per_tx)
+{
+    Chainstate& chainstate{test_setup.m_node.chainman->ActiveChainstate()};
+    const CScript anyone_can_spend{CScript() << OP_TRUE};
+
+    auto& coinbase_to_spend{test_setup.m_coinbase_txns[0]};
+    const std::vector<CTxOut> funding_outputs(num_inputs, CTxOut{COIN / 100, anyone_can_spend});
+    const auto [funding_tx, _]{test_setup.CreateValidTransaction(
+        {coinbase_to_spend},
+        {COutPoint(coinbase_to_spend->GetHash(), 0)},
+        chainstate.m_chain.Height() + 1, {test_setup.coinbaseKey}, funding_outputs, {}, {})};
+    test_setup.CreateAndProcessBlock({funding_tx}, anyone_can_spend, &chainstate);
+    WITH_LOCK(cs_main, chainstate.ForceFlushStateToDisk(/*wipe_cache=*/true));
+
+    std::vector<CMutableTransaction> txs;
+    txs.reserve(num_inputs / inputs_per_tx);
+    for (int i{0}; i + inputs_per_tx <= num_inputs; i += inputs_per_tx) {
+        CMutableTransaction tx;
+        for (int j{i}; j < i + inputs_per_tx; ++j) {
+            tx.vin.emplace_back(COutPoint(funding_tx.GetHash(), j));
+        }
+        tx.vout.emplace_back(inputs_per_tx * (COIN / 100), anyone_can_spend);
+        txs.push_back(std::move(tx));
+    }
+    return test_setup.CreateBlock(txs, anyone_can_spend, chainstate);
+}
+
+/*
+ * Connects a block with thousands of inputs against a cold coins cache. The
+ * connect view is a CoinsViewOverlay, so the tip cache stays cold across runs.
+ */
+void BenchmarkConnectBlockColdCache(benchmark::Bench& bench, bool fetch_inputs)
+{
+    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto test_block{CreateColdCacheTestBlock(*test_setup, /*num_inputs=*/4000, /*inputs_per_tx=*/4)};
+    bench.unit("block");
+    benchmark::RunWithMemoryUsage(bench, [&] {
+        LOCK(cs_main);
+        auto& chainman{test_setup->m_node.chainman};
+        auto& chainstate{chainman->ActiveChainstate()};
+        BlockValidationState test_block_state;
+        auto* pindex{chainman->m_blockman.AddToBlockIndex(test_block, chainman->m_best_header)}; // Doing this here doesn't impact the benchmark
+        CoinsViewOverlay view{&chainstate.CoinsTip()};
+
+        if (fetch_inputs) chainman->GetInputFetcher().FetchInputs(view, chainstate.CoinsTip(), test_block);
+        assert(chainstate.ConnectBlock(test_block, test_block_state, pindex, view));
+    });
+}
+
+static void ConnectBlockColdCache(benchmark::Bench& bench)
+{
+    BenchmarkConnectBlockColdCache(bench, /*fetch_inputs=*/false);
+}
+
+static void ConnectBlockColdCacheFetchInputs(benchmark::Bench& bench)
+{
+    BenchmarkConnectBlockColdCache(bench, /*fetch_inputs=*/true);
+}
+
 BENCHMARK(ConnectBlockAllSchnorr);
 BENCHMARK(ConnectBlockMixedEcdsaSchnorr);
 BENCHMARK(ConnectBlockAllEcdsa);
+BENCHMARK(ConnectBlockColdCache);
+BENCHMARK(ConnectBlockColdCacheFetchInputs);
@@ -17,6 +17,7 @@
 #include <uint256.h>
 
 #include <cstdint>
+#include <numeric>
 #include <vector>
 
 /* Number of bytes to hash per iteration */
@@ -181,6 +182,45 @@ static void SHA256D64_1024_SHANI(benchmark::Bench& bench)
     SHA256AutoDetect();
 }
 
+static void SHA256D64_1024_AVX512(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", __func__, SHA256AutoDetect(sha256_implementation::USE_SSE4_AND_AVX512)));
+    std::vector<uint8_t> in(64 * 1024, 0);
+    bench.batch(in.size()).unit("byte").run([&] {
+        SHA256D64(in.data(), in.data(), 1024);
+    });
+    SHA256AutoDetect();
+}
+
+/*
+ * Double-SHA256 of 1024 messages with the sizes of typical transactions, as
+ * done for the txids of a block when it is deserialized.
+ */
+static void SHA256DMultiCommon(benchmark::Bench& bench, sha256_implementation::UseImplementation use_implementation, const char* name)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", name, SHA256AutoDetect(use_implementation)));
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<size_t> lengths(1024);
+    for (size_t& length : lengths) length = 150 + rng.randrange(400);
+    std::vector<uint8_t> in(std::accumulate(lengths.begin(), lengths.end(), size_t{0}), 0);
+    std::vector<const unsigned char*> inputs;
+    for (size_t offset{0}; const size_t length : lengths) {
+        inputs.push_back(in.data() + offset);
+        offset += length;
+    }
+    std::vector<uint8_t> out(32 * lengths.size());
+    bench.batch(in.size()).unit("byte").run([&] {
+        SHA256DMulti(out.data(), inputs.data(), lengths.data(), lengths.size());
+    });
+    SHA256AutoDetect();
+}
+
+static void SHA256DMulti_1024_STANDARD(benchmark::Bench& bench) { SHA256DMultiCommon(bench, sha256_implementation::STANDARD, __func__); }
+static void SHA256DMulti_1024_SSE4(benchmark::Bench& bench) { SHA256DMultiCommon(bench, sha256_implementation::USE_SSE4, __func__); }
+static void SHA256DMulti_1024_AVX2(benchmark::Bench& bench) { SHA256DMultiCommon(bench, sha256_implementation::USE_SSE4_AND_AVX2, __func__); }
+static void SHA256DMulti_1024_SHANI(benchmark::Bench& bench) { SHA256DMultiCommon(bench, sha256_implementation::USE_SSE4_AND_SHANI, __func__); }
+static void SHA256DMulti_1024_AVX512(benchmark::Bench& bench) { SHA256DMultiCommon(bench, sha256_implementation::USE_SSE4_AND_AVX512, __func__); }
+
 static void SHA512(benchmark::Bench& bench)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -278,6 +318,12 @@ BENCHMARK(SHA256D64_1024_STANDARD);
 BENCHMARK(SHA256D64_1024_SSE4);
 BENCHMARK(SHA256D64_1024_AVX2);
 BENCHMARK(SHA256D64_1024_SHANI);
+BENCHMARK(SHA256D64_1024_AVX512);
+BENCHMARK(SHA256DMulti_1024_STANDARD);
+BENCHMARK(SHA256DMulti_1024_SSE4);
+BENCHMARK(SHA256DMulti_1024_AVX2);
+BENCHMARK(SHA256DMulti_1024_SHANI);
+BENCHMARK(SHA256DMulti_1024_AVX512);
 
 BENCHMARK(MuHash);
 BENCHMARK(MuHashMul);
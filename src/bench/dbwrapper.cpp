@@ -0,0 +1,101 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#include <bench/bench.h>
+#include <coins.h>
+#include <consensus/amount.h>
+#include <dbwrapper.h>
+#include <flatfile.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <util/fs.h>
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+//! Number of entries written to each database.
+constexpr uint32_t DB_ENTRIES{100'000};
+
+enum class KeyDistribution {
+    //! Outpoints of random txids, the few outputs of a transaction next to each other (like the chainstate)
+    COINS,
+    //! One random txid per entry, with a small disk position (like the txindex)
+    TXINDEX,
+};
+
+std::pair<uint8_t, COutPoint> CoinKey(const Txid& txid, uint32_t n) { return {uint8_t{'C'}, COutPoint{txid, n}}; }
+std::pair<uint8_t, Txid> TxKey(const Txid& txid) { return {uint8_t{'t'}, txid}; }
+} // namespace
+
+/**
+ * Look up entries of a database larger than its cache, to compare the effect
+ * of the DBOptions on the key distributions of the chainstate and txindex.
+ * When missing is true, the keys looked up are not in the database, which is
+ * what the bloom filters are for.
+ */
+static void DBWrapperLookup(benchmark::Bench& bench, KeyDistribution keys, const DBOptions& options, bool missing)
+{
+    const auto test_setup{MakeNoLogFileContext<>()};
+    const fs::path path{test_setup->m_args.GetDataDirBase() / "dbwrapper_bench"};
+    constexpr size_t CACHE_SIZE{1 << 20};
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    std::vector<Txid> txids;
+    {
+        CDBWrapper dbw{{.path = path, .cache_bytes = CACHE_SIZE, .wipe_data = true, .options = options}};
+        CDBBatch batch{dbw};
+        for (uint32_t i = 0; i < DB_ENTRIES;) {
+            const Txid& txid{txids.emplace_back(Txid::FromUint256(rng.rand256()))};
+            if (keys == KeyDistribution::COINS) {
+                const uint32_t outputs{1 + rng.randrange<uint32_t>(4)};
+                for (uint32_t n = 0; n < outputs; ++n, ++i) {
+                    const CScript script{CScript() << OP_0 << rng.randbytes(20)};
+                    batch.Write(CoinKey(txid, n), Coin{CTxOut{rng.randrange<CAmount>(COIN), script}, int(rng.randrange(900'000)), /*fCoinBaseIn=*/false});
+                }
+            } else {
+                batch.Write(TxKey(txid), std::pair{FlatFilePos{int(rng.randrange(5'000)), rng.randrange<uint32_t>(128 << 20)}, rng.randrange<uint32_t>(4 << 20)});
+                ++i;
+            }
+            if (batch.ApproximateSize() > CACHE_SIZE) {
+                dbw.WriteBatch(batch);
+                batch.Clear();
+            }
+        }
+        dbw.WriteBatch(batch);
+    }
+    // Reopen the database so that the lookups read its tables rather than the write buffer.
+    CDBWrapper dbw{{.path = path, .cache_bytes = CACHE_SIZE, .options = options}};
+
+    bench.run([&] {
+        const Txid txid{missing ? Txid::FromUint256(rng.rand256()) : txids[rng.randrange(txids.size())]};
+        bool found;
+        if (keys == KeyDistribution::COINS) {
+            Coin coin;
+            found = dbw.Read(CoinKey(txid, 0), coin);
+        } else {
+            std::pair<FlatFilePos, uint32_t> pos;
+            found = dbw.Read(TxKey(txid), pos);
+        }
+        assert(found != missing);
+    });
+}
+
+static void DBWrapperCoinsLookup(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::COINS, {}, /*missing=*/false); }
+static void DBWrapperCoinsLookupMissing(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::COINS, {}, /*missing=*/true); }
+static void DBWrapperCoinsLookupMissingNoBloom(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::COINS, {.bloom_bits = 0}, /*missing=*/true); }
+static void DBWrapperCoinsLookupBlock16KiB(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::COINS, {.block_size = 16 << 10}, /*missing=*/false); }
+static void DBWrapperTxIndexLookup(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::TXINDEX, {}, /*missing=*/false); }
+static void DBWrapperTxIndexLookupBlock16KiB(benchmark::Bench& bench) { DBWrapperLookup(bench, KeyDistribution::TXINDEX, {.block_size = 16 << 10}, /*missing=*/false); }
+
+BENCHMARK(DBWrapperCoinsLookup);
+BENCHMARK(DBWrapperCoinsLookupMissing);
+BENCHMARK(DBWrapperCoinsLookupMissingNoBloom);
+BENCHMARK(DBWrapperCoinsLookupBlock16KiB);
+BENCHMARK(DBWrapperTxIndexLookup);
+BENCHMARK(DBWrapperTxIndexLookupBlock16KiB);
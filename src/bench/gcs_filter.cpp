@@ -86,8 +86,46 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+
+static void GCSFilterMatchAnyRange(benchmark::Bench& bench)
+{
+    // Scan the filters of a range of blocks of a few thousand elements each,
+    // like scanblocks does, for a wallet with a thousand scripts.
+    constexpr int NUM_BLOCKS{100};
+    constexpr int ELEMENTS_PER_BLOCK{5000};
+    constexpr int NUM_QUERIES{1000};
+
+    std::vector<GCSFilter> filters;
+    for (int block = 0; block < NUM_BLOCKS; ++block) {
+        GCSFilter::ElementSet elements;
+        for (int i = 0; i < ELEMENTS_PER_BLOCK; ++i) {
+            GCSFilter::Element element(32);
+            element[0] = static_cast<unsigned char>(i);
+            element[1] = static_cast<unsigned char>(i >> 8);
+            element[2] = static_cast<unsigned char>(block);
+            elements.insert(std::move(element));
+        }
+        filters.emplace_back(GCSFilter::Params{static_cast<uint64_t>(block), 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+    }
+
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        GCSFilter::Element element(32);
+        element[0] = static_cast<unsigned char>(i);
+        element[1] = static_cast<unsigned char>(i >> 8);
+        element[31] = 1;
+        queries.insert(std::move(element));
+    }
+
+    bench.batch(NUM_BLOCKS).unit("block").run([&] {
+        for (const GCSFilter& filter : filters) {
+            filter.MatchAny(queries);
+        }
+    });
+}
 BENCHMARK(GCSBlockFilterGetHash);
 BENCHMARK(GCSFilterConstruct);
 BENCHMARK(GCSFilterDecode);
 BENCHMARK(GCSFilterDecodeSkipCheck);
 BENCHMARK(GCSFilterMatch);
+BENCHMARK(GCSFilterMatchAnyRange);
@@ -0,0 +1,116 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <common/args.h>
+#include <compat/compat.h>
+#include <httpserver.h>
+#include <netaddress.h>
+#include <netbase.h>
+#include <rpc/protocol.h>
+#include <test/util/setup_common.h>
+#include <util/signalinterrupt.h>
+#include <util/sock.h>
+#include <util/threadinterrupt.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/** Read n responses with a Content-Length header from sock. */
+void ReadResponses(const Sock& sock, size_t n)
+{
+    std::string buffer;
+    while (n > 0) {
+        const size_t header_end{buffer.find("\r\n\r\n")};
+        if (header_end != std::string::npos) {
+            const size_t length_pos{buffer.find("Content-Length: ")};
+            assert(length_pos < header_end);
+            const size_t response_size{header_end + 4 + std::stoul(buffer.substr(length_pos + 16))};
+            if (buffer.size() >= response_size) {
+                buffer.erase(0, response_size);
+                --n;
+                continue;
+            }
+        }
+        Sock::Event occurred;
+        assert(sock.Wait(10s, Sock::RECV, &occurred) && occurred);
+        char buf[64 * 1024];
+        const ssize_t received{sock.Recv(buf, sizeof(buf), 0)};
+        assert(received > 0);
+        buffer.append(buf, received);
+    }
+}
+
+} // namespace
+
+/*
+ * Throughput of the HTTP server: a client on a single persistent connection
+ * sends a batch of pipelined requests and waits for all replies. The handler
+ * replies with a freshly allocated buffer, like the REST block endpoint does
+ * with the result of ReadRawBlock.
+ */
+static void HTTPServerRequests(benchmark::Bench& bench, std::string_view backend, size_t reply_size, size_t pipeline_depth)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    gArgs.ForceSetArg("-rpcserverbackend", std::string{backend});
+    gArgs.ForceSetArg("-rpcport", "0");
+    util::SignalInterrupt interrupt;
+    assert(InitHTTPServer(interrupt));
+    RegisterHTTPHandler("/bench", true, [reply_size](HTTPRequest* req, const std::string&) {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, std::vector<std::byte>(reply_size));
+        return true;
+    });
+    StartHTTPServer();
+
+    std::optional<CService> server_addr;
+    for (const auto& addr : GetHTTPBindAddresses()) {
+        if (addr.IsIPv4()) server_addr = addr;
+    }
+    assert(server_addr);
+    struct sockaddr_storage sockaddr;
+    socklen_t len = sizeof(sockaddr);
+    assert(server_addr->GetSockAddr(reinterpret_cast<struct sockaddr*>(&sockaddr), &len));
+    auto sock{CreateSock(AF_INET, SOCK_STREAM, IPPROTO_TCP)};
+    assert(sock);
+    if (sock->Connect(reinterpret_cast<struct sockaddr*>(&sockaddr), len) != 0) {
+        Sock::Event occurred;
+        assert(sock->Wait(10s, Sock::SEND, &occurred) && occurred == Sock::SEND);
+    }
+
+    std::string requests;
+    for (size_t i{0}; i < pipeline_depth; ++i) requests += "GET /bench HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    CThreadInterrupt sock_interrupt;
+
+    bench.batch(pipeline_depth).unit("request").run([&] {
+        sock->SendComplete(std::span{requests}, 10s, sock_interrupt);
+        ReadResponses(*sock, pipeline_depth);
+    });
+
+    sock.reset();
+    InterruptHTTPServer();
+    StopHTTPServer();
+    UnregisterHTTPHandler("/bench", true);
+}
+
+static void HTTPServerLibevent(benchmark::Bench& bench) { HTTPServerRequests(bench, "libevent", /*reply_size=*/100, /*pipeline_depth=*/16); }
+static void HTTPServerNative(benchmark::Bench& bench) { HTTPServerRequests(bench, "native", /*reply_size=*/100, /*pipeline_depth=*/16); }
+static void HTTPServerLibeventBlock(benchmark::Bench& bench) { HTTPServerRequests(bench, "libevent", /*reply_size=*/1 << 20, /*pipeline_depth=*/4); }
+static void HTTPServerNativeBlock(benchmark::Bench& bench) { HTTPServerRequests(bench, "native", /*reply_size=*/1 << 20, /*pipeline_depth=*/4); }
+
+BENCHMARK(HTTPServerLibevent);
+BENCHMARK(HTTPServerNative);
+BENCHMARK(HTTPServerLibeventBlock);
+BENCHMARK(HTTPServerNativeBlock);
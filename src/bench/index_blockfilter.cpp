@@ -28,7 +28,7 @@
 using namespace util::hex_literals;
 
 // Very simple block filter index sync benchmark, only using coinbase outputs.
-static void BlockFilterIndexSync(benchmark::Bench& bench)
+static void BlockFilterIndexSync(benchmark::Bench& bench, int sync_threads)
 {
     const auto test_setup = MakeNoLogFileContext<TestChain100Setup>();
 
@@ -48,7 +48,7 @@ static void BlockFilterIndexSync(benchmark::Bench& bench)
                                       /*n_cache_size=*/0, /*f_memory=*/false, /*f_wipe=*/true);
         assert(filter_index.Init());
         assert(!filter_index.BlockUntilSyncedToCurrentChain());
-        filter_index.Sync();
+        filter_index.Sync(sync_threads);
 
         IndexSummary summary = filter_index.GetSummary();
         assert(summary.synced);
@@ -59,4 +59,8 @@ static void BlockFilterIndexSync(benchmark::Bench& bench)
     });
 }
 
-BENCHMARK(BlockFilterIndexSync);
+static void BlockFilterIndexSyncSingleThread(benchmark::Bench& bench) { BlockFilterIndexSync(bench, /*sync_threads=*/0); }
+static void BlockFilterIndexSyncPipelined(benchmark::Bench& bench) { BlockFilterIndexSync(bench, DEFAULT_INDEX_SYNC_THREADS); }
+
+BENCHMARK(BlockFilterIndexSyncSingleThread);
+BENCHMARK(BlockFilterIndexSyncPipelined);
@@ -0,0 +1,113 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/memory_usage.h>
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <ostream>
+
+#ifdef WIN32
+#include <malloc.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+namespace {
+std::atomic<uint64_t> g_allocation_count{0};
+
+void* Allocate(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr{std::malloc(size ? size : 1)}) return ptr;
+    throw std::bad_alloc{};
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t align)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const auto alignment{static_cast<std::size_t>(align)};
+    // The size passed to aligned_alloc must be a non-zero multiple of the alignment.
+    const std::size_t aligned_size{(std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment};
+#ifdef WIN32
+    void* ptr{_aligned_malloc(aligned_size, alignment)};
+#else
+    void* ptr{std::aligned_alloc(alignment, aligned_size)};
+#endif
+    if (ptr) return ptr;
+    throw std::bad_alloc{};
+}
+
+void FreeAligned(void* ptr) noexcept
+{
+#ifdef WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+} // namespace
+
+// Replacing the global operator new and delete is opt-in, as it affects every
+// benchmark. The array and nothrow forms of operator new and delete call these.
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return AllocateAligned(size, align); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { FreeAligned(ptr); }
+#endif // BENCH_COUNT_ALLOCATIONS
+
+namespace benchmark {
+
+std::optional<uint64_t> AllocationCount()
+{
+#ifdef BENCH_COUNT_ALLOCATIONS
+    return g_allocation_count.load(std::memory_order_relaxed);
+#else
+    return std::nullopt;
+#endif
+}
+
+int64_t PeakRSSKiB()
+{
+#ifndef WIN32
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // in bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+void RunWithMemoryUsage(Bench& bench, const std::function<void()>& fn)
+{
+    const int64_t peak_rss_before{PeakRSSKiB()};
+    bench.run(fn);
+    const int64_t peak_rss_growth{PeakRSSKiB() - peak_rss_before};
+
+    std::ostream* out{bench.output()};
+    if (!out) return;
+    if (const auto allocations_before{AllocationCount()}) {
+        fn();
+        const uint64_t allocations{*AllocationCount() - *allocations_before};
+        *out << strprintf("%s: %u heap allocations per %s, peak RSS grew by %d KiB\n",
+                          bench.name(), allocations, bench.unit(), peak_rss_growth);
+    } else {
+        *out << strprintf("%s: peak RSS grew by %d KiB\n", bench.name(), peak_rss_growth);
+    }
+}
+
+} // namespace benchmark
@@ -0,0 +1,33 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_MEMORY_USAGE_H
+#define BITCOIN_BENCH_MEMORY_USAGE_H
+
+#include <bench/bench.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace benchmark {
+
+//! The number of allocations made through operator new by this process so far,
+//! or nullopt unless bench_bitcoin was configured with -DBENCH_COUNT_ALLOCATIONS=ON.
+std::optional<uint64_t> AllocationCount();
+
+//! The peak resident set size of this process in KiB, or 0 where it is not known.
+int64_t PeakRSSKiB();
+
+/**
+ * Run a benchmark and print how much the peak resident set size grew while it
+ * ran, which shows memory held on to by the allocator across iterations. If
+ * allocations are counted, also run its body once more and print the number
+ * of heap allocations it makes.
+ */
+void RunWithMemoryUsage(Bench& bench, const std::function<void()>& fn);
+
+} // namespace benchmark
+
+#endif // BITCOIN_BENCH_MEMORY_USAGE_H
@@ -4,7 +4,9 @@
 
 #include <bench/bench.h>
 #include <consensus/merkle.h>
+#include <crypto/sha256.h>
 #include <random.h>
+#include <tinyformat.h>
 #include <uint256.h>
 
 #include <cassert>
@@ -36,4 +38,31 @@ static void MerkleRoot(benchmark::Bench& bench)
     }
 }
 
+/** Merkle root of a block's worth of leaves, hashed with a specific SHA256D64 width. */
+static void MerkleRootCommon(benchmark::Bench& bench, sha256_implementation::UseImplementation use_implementation, const char* name)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", name, SHA256AutoDetect(use_implementation)));
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<uint256> hashes(4096);
+    for (auto& item : hashes) {
+        item = rng.rand256();
+    }
+    bench.batch(hashes.size()).unit("leaf").run([&] {
+        const uint256 root{ComputeMerkleRoot(hashes)};
+        ankerl::nanobench::doNotOptimizeAway(root);
+    });
+    SHA256AutoDetect();
+}
+
+static void MerkleRoot_STANDARD(benchmark::Bench& bench) { MerkleRootCommon(bench, sha256_implementation::STANDARD, __func__); }
+static void MerkleRoot_SSE4(benchmark::Bench& bench) { MerkleRootCommon(bench, sha256_implementation::USE_SSE4, __func__); }
+static void MerkleRoot_AVX2(benchmark::Bench& bench) { MerkleRootCommon(bench, sha256_implementation::USE_SSE4_AND_AVX2, __func__); }
+static void MerkleRoot_SHANI(benchmark::Bench& bench) { MerkleRootCommon(bench, sha256_implementation::USE_SSE4_AND_SHANI, __func__); }
+static void MerkleRoot_AVX512(benchmark::Bench& bench) { MerkleRootCommon(bench, sha256_implementation::USE_SSE4_AND_AVX512, __func__); }
+
 BENCHMARK(MerkleRoot);
+BENCHMARK(MerkleRoot_STANDARD);
+BENCHMARK(MerkleRoot_SSE4);
+BENCHMARK(MerkleRoot_AVX2);
+BENCHMARK(MerkleRoot_SHANI);
+BENCHMARK(MerkleRoot_AVX512);
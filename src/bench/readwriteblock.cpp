@@ -4,14 +4,19 @@
 
 #include <bench/bench.h>
 #include <bench/data/block413567.raw.h>
+#include <chainparams.h>
+#include <dbwrapper.h>
 #include <flatfile.h>
 #include <node/blockstorage.h>
+#include <node/kernel_notifications.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <util/check.h>
 #include <validation.h>
 
 #include <cassert>
@@ -62,6 +67,64 @@ static void ReadRawBlockBench(benchmark::Bench& bench)
     });
 }
 
+//! Read a block from a finalized block file, through a memory mapping if use_mmap is set
+static void ReadRawBlockFinalized(benchmark::Bench& bench, bool use_mmap)
+{
+    const auto testing_setup{MakeNoLogFileContext<BasicTestingSetup>(ChainType::MAIN)};
+    auto& node{testing_setup->m_node};
+    node::KernelNotifications notifications{Assert(node.shutdown_request), node.exit_status, *Assert(node.warnings)};
+    const node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .use_mmap = use_mmap,
+        .fast_prune = true,
+        .blocks_dir = testing_setup->m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = testing_setup->m_args.GetDataDirNet() / "blocks" / "index",
+            .cache_bytes = 0,
+            .memory_only = true,
+        },
+    };
+    node::BlockManager blockman{*Assert(node.shutdown_signal), blockman_opts};
+    const CBlock block{CreateTestBlock()};
+    // With fast_prune, every block of this size goes into a new block file,
+    // which finalizes the previous one.
+    const auto pos{blockman.WriteBlock(block, 413'567)};
+    assert(blockman.WriteBlock(block, 413'568).nFile != pos.nFile);
+    bench.run([&] {
+        const auto res{blockman.ReadRawBlock(pos)};
+        assert(res);
+    });
+}
+
+static void ReadRawBlockFinalizedBench(benchmark::Bench& bench) { ReadRawBlockFinalized(bench, /*use_mmap=*/false); }
+static void ReadRawBlockMappedBench(benchmark::Bench& bench) { ReadRawBlockFinalized(bench, /*use_mmap=*/true); }
+
+//! What reading a block costs on top of ReadRawBlock when it is parsed in
+//! place, compared to DeserializeBlockTest, which also hashes every transaction.
+static void ParseBlockViewBench(benchmark::Bench& bench)
+{
+    bench.unit("block").run([&] {
+        const BlockView view{benchmark::data::block413567};
+        ankerl::nanobench::doNotOptimizeAway(view.TxCount());
+    });
+}
+
+//! Parsing the block in place and hashing every transaction, which is what
+//! the txindex does for every block.
+static void ParseBlockViewTxidsBench(benchmark::Bench& bench)
+{
+    bench.unit("block").run([&] {
+        const BlockView view{benchmark::data::block413567};
+        const auto txids{view.ComputeTxids()};
+        assert(txids.size() == view.TxCount());
+    });
+}
+
 BENCHMARK(WriteBlockBench);
 BENCHMARK(ReadBlockBench);
 BENCHMARK(ReadRawBlockBench);
+BENCHMARK(ReadRawBlockFinalizedBench);
+BENCHMARK(ReadRawBlockMappedBench);
+BENCHMARK(ParseBlockViewBench);
+BENCHMARK(ParseBlockViewTxidsBench);
@@ -9,6 +9,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/json_writer.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -19,6 +20,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace {
@@ -86,3 +88,30 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite);
+
+//! Serialize a block to JSON text, either through a full UniValue tree or streamed
+static void BlockToJsonString(benchmark::Bench& bench, TxVerbosity verbosity, bool stream)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    bench.run([&] {
+        std::string str;
+        if (stream) {
+            JSONWriter writer{str};
+            blockToJSON(writer, data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, verbosity, pow_limit);
+        } else {
+            str = blockToJSON(data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, verbosity, pow_limit).write();
+        }
+        ankerl::nanobench::doNotOptimizeAway(str);
+    });
+}
+
+static void BlockToJsonStringVerbosity2(benchmark::Bench& bench) { BlockToJsonString(bench, TxVerbosity::SHOW_DETAILS, /*stream=*/false); }
+static void BlockToJsonStringVerbosity3(benchmark::Bench& bench) { BlockToJsonString(bench, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, /*stream=*/false); }
+static void BlockToJsonStreamVerbosity2(benchmark::Bench& bench) { BlockToJsonString(bench, TxVerbosity::SHOW_DETAILS, /*stream=*/true); }
+static void BlockToJsonStreamVerbosity3(benchmark::Bench& bench) { BlockToJsonString(bench, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, /*stream=*/true); }
+
+BENCHMARK(BlockToJsonStringVerbosity2);
+BENCHMARK(BlockToJsonStringVerbosity3);
+BENCHMARK(BlockToJsonStreamVerbosity2);
+BENCHMARK(BlockToJsonStreamVerbosity3);
@@ -6,6 +6,7 @@
 #include <consensus/amount.h>
 #include <kernel/cs_main.h>
 #include <primitives/transaction.h>
+#include <rpc/json_writer.h>
 #include <rpc/mempool.h>
 #include <script/script.h>
 #include <sync.h>
@@ -16,6 +17,7 @@
 #include <util/check.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 
@@ -25,12 +27,8 @@ static void AddTx(const CTransactionRef& tx, const CAmount& fee, CTxMemPool& poo
     TryAddToMempool(pool, CTxMemPoolEntry(tx, fee, /*time=*/0, /*entry_height=*/1, /*entry_sequence=*/0, /*spends_coinbase=*/false, /*sigops_cost=*/4, lp));
 }
 
-static void RpcMempool(benchmark::Bench& bench)
+static void PopulateMempool(CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
-    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
-    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
-    LOCK2(cs_main, pool.cs);
-
     for (int i = 0; i < 1000; ++i) {
         CMutableTransaction tx = CMutableTransaction();
         tx.vin.resize(1);
@@ -42,10 +40,43 @@ static void RpcMempool(benchmark::Bench& bench)
         const CTransactionRef tx_r{MakeTransactionRef(tx)};
         AddTx(tx_r, /*fee=*/i, pool);
     }
+}
+
+static void RpcMempool(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    PopulateMempool(pool);
 
     bench.run([&] {
         (void)MempoolToJSON(pool, /*verbose=*/true);
     });
 }
 
+//! Serialize the verbose mempool to JSON text, either through a full UniValue tree or streamed
+static void RpcMempoolString(benchmark::Bench& bench, bool stream)
+{
+    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    PopulateMempool(pool);
+
+    bench.run([&] {
+        std::string str;
+        if (stream) {
+            JSONWriter writer{str};
+            MempoolToJSON(writer, pool);
+        } else {
+            str = MempoolToJSON(pool, /*verbose=*/true).write();
+        }
+        ankerl::nanobench::doNotOptimizeAway(str);
+    });
+}
+
+static void RpcMempoolWrite(benchmark::Bench& bench) { RpcMempoolString(bench, /*stream=*/false); }
+static void RpcMempoolStream(benchmark::Bench& bench) { RpcMempoolString(bench, /*stream=*/true); }
+
 BENCHMARK(RpcMempool);
+BENCHMARK(RpcMempoolWrite);
+BENCHMARK(RpcMempoolStream);
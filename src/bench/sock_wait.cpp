@@ -0,0 +1,74 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/fs_helpers.h>
+#include <util/sock.h>
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Only poll(2) and epoll(7) can wait on this many sockets; select(2) is limited to FD_SETSIZE.
+#ifdef USE_POLL
+
+using namespace std::chrono_literals;
+
+/*
+ * Simulates the socket handler loop of a node with many idle peers: wait for
+ * events on num_idle connected sockets that never become ready, plus one that
+ * always has data to read.
+ */
+static void SockWaitCommon(benchmark::Bench& bench, int num_idle, bool use_epoll)
+{
+    assert(RaiseFileDescriptorLimit(2 * (num_idle + 1) + 64) >= 2 * (num_idle + 1) + 64);
+
+    std::vector<std::shared_ptr<const Sock>> socks;
+    Sock::EventsPerSock events_per_sock;
+    for (int i{0}; i <= num_idle; ++i) {
+        int s[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, s) == 0);
+        socks.push_back(std::make_shared<const Sock>(s[0]));
+        socks.push_back(std::make_shared<const Sock>(s[1]));
+        events_per_sock.emplace(socks[socks.size() - 2], Sock::Events{Sock::RECV});
+    }
+    assert(socks.back()->Send("a", 1, 0) == 1);
+    const auto& ready_sock{socks[socks.size() - 2]};
+
+    auto epoll{use_epoll ? SockEpoll::Create() : nullptr};
+    assert(!use_epoll || epoll);
+    if (epoll) {
+        for (const auto& [sock, events] : events_per_sock) {
+            assert(epoll->Add(sock, events.requested));
+        }
+    }
+
+    Sock::EventsPerSock ready;
+    bench.run([&] {
+        if (epoll) {
+            assert(epoll->Wait(0ms, ready) && ready.size() == 1 && ready.at(ready_sock).occurred == Sock::RECV);
+        } else {
+            assert(events_per_sock.begin()->first->WaitMany(0ms, events_per_sock));
+            assert(events_per_sock.at(ready_sock).occurred == Sock::RECV);
+        }
+    });
+}
+
+static void SockWaitPoll100Idle(benchmark::Bench& bench) { SockWaitCommon(bench, 100, /*use_epoll=*/false); }
+static void SockWaitPoll1000Idle(benchmark::Bench& bench) { SockWaitCommon(bench, 1000, /*use_epoll=*/false); }
+
+BENCHMARK(SockWaitPoll100Idle);
+BENCHMARK(SockWaitPoll1000Idle);
+
+#ifdef USE_EPOLL
+static void SockWaitEpoll100Idle(benchmark::Bench& bench) { SockWaitCommon(bench, 100, /*use_epoll=*/true); }
+static void SockWaitEpoll1000Idle(benchmark::Bench& bench) { SockWaitCommon(bench, 1000, /*use_epoll=*/true); }
+
+BENCHMARK(SockWaitEpoll100Idle);
+BENCHMARK(SockWaitEpoll1000Idle);
+#endif /* USE_EPOLL */
+
+#endif /* USE_POLL */
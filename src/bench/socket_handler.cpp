@@ -0,0 +1,94 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <net.h>
+#include <net_permissions.h>
+#include <netaddress.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+#include <util/fs_helpers.h>
+#include <util/sock.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Only poll(2) and epoll(7) can wait on this many sockets; select(2) is limited to FD_SETSIZE.
+#ifdef USE_POLL
+
+using namespace std::chrono_literals;
+
+/*
+ * One iteration of the socket handler thread of a node with many idle inbound
+ * peers and one peer that sends a ping every iteration. Unlike the SockWait
+ * benchmarks, this includes the per-node work around waiting for the sockets.
+ */
+static void SocketHandlerCommon(benchmark::Bench& bench, int num_idle, bool use_epoll)
+{
+    assert(RaiseFileDescriptorLimit(2 * (num_idle + 1) + 64) >= 2 * (num_idle + 1) + 64);
+
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    auto& connman{static_cast<ConnmanTestMsg&>(*testing_setup->m_node.connman)};
+    CConnman::Options options;
+    options.m_msgproc = testing_setup->m_node.peerman.get();
+    options.m_max_automatic_connections = num_idle + 64;
+    options.m_use_epoll = use_epoll;
+    connman.Init(options);
+    connman.SetPeerConnectTimeout(24h);
+
+    // Keep the remote ends open, so that the sockets of the idle peers never become ready.
+    std::vector<std::unique_ptr<Sock>> remote_socks;
+    for (int i{0}; i <= num_idle; ++i) {
+        int s[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, s) == 0);
+        remote_socks.push_back(std::make_unique<Sock>(s[1]));
+        const CAddress addr{CService{CNetAddr{in_addr{htonl(0x0a000000 + i)}}, 8333}, NODE_NONE};
+        connman.CreateNodeFromAcceptedSocketPublic(std::make_unique<Sock>(s[0]), NetPermissionFlags::NoBan, CAddress{}, addr);
+    }
+    const std::vector<CNode*> nodes{connman.TestNodes()};
+    assert(nodes.size() == size_t(num_idle) + 1);
+    CNode& active_node{*nodes.back()};
+    const Sock& active_sock{*remote_socks.back()};
+
+    // The wire encoding of a ping from the active peer.
+    V1Transport transport{/*node_id=*/0};
+    CSerializedNetMsg ping{NetMsg::Make(NetMsgType::PING, uint64_t{0})};
+    assert(transport.SetMessageToSend(ping));
+    std::vector<uint8_t> ping_bytes;
+    while (true) {
+        const auto& [to_send, _more, _msg_type] = transport.GetBytesToSend(/*have_next_message=*/false);
+        if (to_send.empty()) break;
+        ping_bytes.insert(ping_bytes.end(), to_send.begin(), to_send.end());
+        transport.MarkBytesSent(to_send.size());
+    }
+
+    bench.run([&] {
+        assert(active_sock.Send(ping_bytes.data(), ping_bytes.size(), 0) == ssize_t(ping_bytes.size()));
+        connman.SocketHandlerPublic();
+        // Drop the ping, like the message handler thread would after processing it.
+        assert(active_node.PollMessage());
+    });
+}
+
+static void SocketHandlerPoll100Idle(benchmark::Bench& bench) { SocketHandlerCommon(bench, 100, /*use_epoll=*/false); }
+static void SocketHandlerPoll1000Idle(benchmark::Bench& bench) { SocketHandlerCommon(bench, 1000, /*use_epoll=*/false); }
+
+BENCHMARK(SocketHandlerPoll100Idle);
+BENCHMARK(SocketHandlerPoll1000Idle);
+
+#ifdef USE_EPOLL
+static void SocketHandlerEpoll100Idle(benchmark::Bench& bench) { SocketHandlerCommon(bench, 100, /*use_epoll=*/true); }
+static void SocketHandlerEpoll1000Idle(benchmark::Bench& bench) { SocketHandlerCommon(bench, 1000, /*use_epoll=*/true); }
+
+BENCHMARK(SocketHandlerEpoll100Idle);
+BENCHMARK(SocketHandlerEpoll1000Idle);
+#endif /* USE_EPOLL */
+
+#endif /* USE_POLL */
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
 #include <mutex>
 #include <set>
 #include <string_view>
@@ -109,24 +110,22 @@ bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
     uint64_t N = ReadCompactSize(stream);
     assert(N == m_N);
 
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{std::span{m_encoded}.last(stream.size())};
 
+    const uint64_t* const hashes_end{element_hashes + size};
     uint64_t value = 0;
-    size_t hashes_index = 0;
     for (uint32_t i = 0; i < m_N; ++i) {
-        uint64_t delta = GolombRiceDecode(bitreader, m_params.m_P);
+        uint64_t delta = reader.Decode(m_params.m_P);
         value += delta;
 
-        while (true) {
-            if (hashes_index == size) {
-                return false;
-            } else if (element_hashes[hashes_index] == value) {
-                return true;
-            } else if (element_hashes[hashes_index] > value) {
-                break;
-            }
-
-            hashes_index++;
+        // Skip the queries below the value. There can be many more queries
+        // than filter elements, so search for the next one rather than
+        // stepping through them.
+        element_hashes = std::lower_bound(element_hashes, hashes_end, value);
+        if (element_hashes == hashes_end) {
+            return false;
+        } else if (*element_hashes == value) {
+            return true;
         }
     }
 
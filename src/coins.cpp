@@ -6,10 +6,19 @@
 
 #include <consensus/consensus.h>
 #include <random.h>
+#include <span.h>
+#include <streams.h>
 #include <uint256.h>
 #include <util/log.h>
 #include <util/trace.h>
 
+#include <algorithm>
+#include <functional>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
 TRACEPOINT_SEMAPHORE(utxocache, add);
 TRACEPOINT_SEMAPHORE(utxocache, spent);
 TRACEPOINT_SEMAPHORE(utxocache, uncache);
@@ -77,6 +86,7 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
             return cacheCoins.end();
         }
     }
+    ret->second.Touch(m_access_clock);
     return ret;
 }
 
@@ -117,6 +127,7 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
         Assume(TrySub(cachedCoinsUsage, it->second.coin.DynamicMemoryUsage()));
     }
     it->second.coin = std::move(coin);
+    it->second.Touch(m_access_clock);
     CCoinsCacheEntry::SetDirty(*it, m_sentinel);
     ++m_dirty_count;
     if (fresh) CCoinsCacheEntry::SetFresh(*it, m_sentinel);
@@ -133,12 +144,295 @@ void CCoinsViewCache::EmplaceCoinInternalDANGER(COutPoint&& outpoint, Coin&& coi
     const auto mem_usage{coin.DynamicMemoryUsage()};
     auto [it, inserted] = cacheCoins.try_emplace(std::move(outpoint), std::move(coin));
     if (inserted) {
+        it->second.Touch(m_access_clock);
         CCoinsCacheEntry::SetDirty(*it, m_sentinel);
         ++m_dirty_count;
         cachedCoinsUsage += mem_usage;
     }
 }
 
+void CoinsViewOverlay::WarmCoin(const COutPoint& outpoint, Coin&& coin)
+{
+    Assume(!coin.IsSpent());
+    const auto mem_usage{coin.DynamicMemoryUsage()};
+    if (auto [it, inserted]{cacheCoins.try_emplace(outpoint, std::move(coin))}; inserted) {
+        it->second.Touch(m_access_clock);
+        cachedCoinsUsage += mem_usage;
+    }
+}
+
+CCoinsViewSharded::CCoinsViewSharded(CCoinsView* view, size_t max_cached_coins)
+    : CCoinsViewBacked(view), m_max_cached_per_shard{std::max<size_t>(max_cached_coins / SHARD_COUNT, 1)} {}
+
+std::optional<Coin> CCoinsViewSharded::FetchCoin(const COutPoint& outpoint, bool cache) const
+{
+    Shard& shard{GetShard(outpoint)};
+    uint64_t epoch;
+    {
+        LOCK(shard.mutex);
+        if (auto it{shard.coins.find(outpoint)}; it != shard.coins.end()) {
+            return it->second.coin.IsSpent() ? std::nullopt : std::optional{it->second.coin};
+        }
+        epoch = shard.epoch;
+    }
+    auto coin{base->PeekCoin(outpoint)};
+    if (cache) {
+        LOCK(shard.mutex);
+        // Entries were published or flushed while the base view was read, so
+        // the coin may already be outdated.
+        if (shard.epoch != epoch) return coin;
+        if (shard.cached_count >= m_max_cached_per_shard) {
+            std::erase_if(shard.coins, [](const auto& entry) { return !entry.second.pending; });
+            shard.cached_count = 0;
+        }
+        if (shard.coins.try_emplace(outpoint, Entry{coin.value_or(Coin{}), /*pending=*/false}).second) {
+            ++shard.cached_count;
+        }
+    }
+    return coin;
+}
+
+std::optional<Coin> CCoinsViewSharded::GetCoin(const COutPoint& outpoint) const
+{
+    if (!m_active) return base->GetCoin(outpoint);
+    return FetchCoin(outpoint, /*cache=*/false);
+}
+
+std::optional<Coin> CCoinsViewSharded::PeekCoin(const COutPoint& outpoint) const
+{
+    if (!m_active) return base->PeekCoin(outpoint);
+    return FetchCoin(outpoint, /*cache=*/false);
+}
+
+bool CCoinsViewSharded::HaveCoin(const COutPoint& outpoint) const
+{
+    if (!m_active) return base->HaveCoin(outpoint);
+    return FetchCoin(outpoint, /*cache=*/false).has_value();
+}
+
+void CCoinsViewSharded::MarkPending(const CoinsViewCacheCursor& cursor)
+{
+    for (auto it{cursor.Begin()}; it != cursor.End(); it = it->second.Next()) {
+        if (!it->second.IsDirty()) continue;
+        Shard& shard{GetShard(it->first)};
+        LOCK(shard.mutex);
+        auto [entry, inserted]{shard.coins.try_emplace(it->first, Entry{it->second.coin, /*pending=*/true})};
+        if (!inserted) {
+            if (!entry->second.pending) --shard.cached_count;
+            entry->second = Entry{it->second.coin, /*pending=*/true};
+        }
+        ++shard.epoch;
+    }
+}
+
+void CCoinsViewSharded::Publish(const CoinsViewCacheCursor& cursor, const uint256& hashBlock)
+{
+    if (!m_active) return;
+    ++m_sequence;
+    MarkPending(cursor);
+    WITH_LOCK(m_best_block_mutex, m_best_block = hashBlock);
+    ++m_sequence;
+}
+
+void CCoinsViewSharded::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock)
+{
+    const bool activate{!m_active && m_activation_requested};
+    if (!m_active && !activate) return base->BatchWrite(cursor, hashBlock);
+
+    // Changes that were made to the tip cache directly rather than published
+    // become visible here, and all of them stay visible while the base view is
+    // being written.
+    if (m_active) {
+        ++m_sequence;
+        MarkPending(cursor);
+        ++m_sequence;
+    }
+    base->BatchWrite(cursor, hashBlock);
+    for (Shard& shard : m_shards) {
+        LOCK(shard.mutex);
+        std::erase_if(shard.coins, [](const auto& entry) { return entry.second.pending; });
+        ++shard.epoch;
+    }
+    if (activate) {
+        WITH_LOCK(m_best_block_mutex, m_best_block = hashBlock);
+        m_activation_requested = false;
+        m_active = true;
+    }
+}
+
+void CCoinsViewSharded::Deactivate()
+{
+    std::unique_lock<std::shared_mutex> lock(m_readers_mutex);
+    m_active = false;
+    m_activation_requested = false;
+    for (Shard& shard : m_shards) {
+        LOCK(shard.mutex);
+        shard.coins.clear();
+        shard.cached_count = 0;
+        ++shard.epoch;
+    }
+}
+
+std::optional<uint256> CCoinsViewSharded::GetCoins(std::span<const COutPoint> outpoints, std::vector<std::optional<Coin>>& coins) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_readers_mutex);
+    if (!m_active) return std::nullopt;
+    while (true) {
+        const uint64_t sequence{m_sequence};
+        if (sequence % 2) {
+            std::this_thread::yield();
+            continue;
+        }
+        coins.clear();
+        coins.reserve(outpoints.size());
+        for (const COutPoint& outpoint : outpoints) {
+            coins.push_back(FetchCoin(outpoint, /*cache=*/true));
+        }
+        const uint256 best_block{WITH_LOCK(m_best_block_mutex, return m_best_block)};
+        if (m_sequence == sequence) return best_block;
+    }
+}
+
+namespace {
+/** Minimal stream that appends what is serialized to a container. */
+template <typename Container>
+class AppendWriter
+{
+    Container& m_data;
+
+public:
+    explicit AppendWriter(Container& data LIFETIMEBOUND) : m_data{data} {}
+
+    void write(std::span<const std::byte> src)
+    {
+        m_data.insert(m_data.end(), UCharCast(src.data()), UCharCast(src.data() + src.size()));
+    }
+
+    template <typename T>
+    AppendWriter& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+};
+} // namespace
+
+size_t CCoinsViewCompressedCache::Generation::DynamicMemoryUsage() const
+{
+    // The single bucket of a map that never held any coins is not allocated.
+    if (coins.bucket_count() <= 1) return 0;
+    return memusage::DynamicUsage(coins) + extra_usage;
+}
+
+void CCoinsViewCompressedCache::Generation::Add(const COutPoint& outpoint, CompressedCoin&& coin)
+{
+    extra_usage += memusage::DynamicUsage(coin);
+    if (auto [it, inserted]{coins.try_emplace(outpoint, std::move(coin))}; !inserted) {
+        Assume(TrySub(extra_usage, memusage::DynamicUsage(it->second)));
+        it->second = std::move(coin);
+    }
+}
+
+std::optional<CCoinsViewCompressedCache::CompressedCoin> CCoinsViewCompressedCache::Generation::Remove(const COutPoint& outpoint)
+{
+    auto it{coins.find(outpoint)};
+    if (it == coins.end()) return std::nullopt;
+    Assume(TrySub(extra_usage, memusage::DynamicUsage(it->second)));
+    auto coin{std::move(it->second)};
+    coins.erase(it);
+    return coin;
+}
+
+std::optional<Coin> CCoinsViewCompressedCache::FetchCoin(const COutPoint& outpoint) const
+{
+    std::optional<CompressedCoin> compressed;
+    {
+        LOCK(m_mutex);
+        if (auto it{m_current->coins.find(outpoint)}; it != m_current->coins.end()) {
+            compressed = it->second;
+        } else if ((compressed = m_previous->Remove(outpoint))) {
+            m_current->Add(outpoint, CompressedCoin{*compressed});
+        }
+    }
+    if (!compressed) return std::nullopt;
+    Coin coin;
+    SpanReader{MakeByteSpan(*compressed)} >> coin;
+    return coin;
+}
+
+std::optional<Coin> CCoinsViewCompressedCache::GetCoin(const COutPoint& outpoint) const
+{
+    if (auto coin{FetchCoin(outpoint)}) return coin;
+    return base->GetCoin(outpoint);
+}
+
+std::optional<Coin> CCoinsViewCompressedCache::PeekCoin(const COutPoint& outpoint) const
+{
+    if (auto coin{FetchCoin(outpoint)}) return coin;
+    return base->PeekCoin(outpoint);
+}
+
+bool CCoinsViewCompressedCache::HaveCoin(const COutPoint& outpoint) const
+{
+    return FetchCoin(outpoint).has_value() || base->HaveCoin(outpoint);
+}
+
+void CCoinsViewCompressedCache::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock)
+{
+    {
+        LOCK(m_mutex);
+        if (!m_current->coins.empty() || !m_previous->coins.empty()) {
+            for (auto it{cursor.Begin()}; it != cursor.End(); it = it->second.Next()) {
+                if (!it->second.IsDirty()) continue;
+                m_current->Remove(it->first);
+                m_previous->Remove(it->first);
+            }
+        }
+    }
+    base->BatchWrite(cursor, hashBlock);
+}
+
+bool CCoinsViewCompressedCache::Insert(const COutPoint& outpoint, const Coin& coin)
+{
+    Assume(!coin.IsSpent());
+    if (WITH_LOCK(m_mutex, return m_max_usage) == 0) return false;
+    CompressedCoin compressed;
+    AppendWriter{compressed} << coin;
+    LOCK(m_mutex);
+    if (m_current->DynamicMemoryUsage() >= m_max_usage / 2) return false;
+    m_previous->Remove(outpoint);
+    m_current->Add(outpoint, std::move(compressed));
+    return true;
+}
+
+void CCoinsViewCompressedCache::Age()
+{
+    LOCK(m_mutex);
+    m_previous = std::exchange(m_current, std::make_unique<Generation>());
+}
+
+void CCoinsViewCompressedCache::SetMaxUsage(size_t max_usage)
+{
+    LOCK(m_mutex);
+    if (max_usage < m_max_usage) {
+        m_current = std::make_unique<Generation>();
+        m_previous = std::make_unique<Generation>();
+    }
+    m_max_usage = max_usage;
+}
+
+size_t CCoinsViewCompressedCache::GetCacheSize() const
+{
+    LOCK(m_mutex);
+    return m_current->coins.size() + m_previous->coins.size();
+}
+
+size_t CCoinsViewCompressedCache::DynamicMemoryUsage() const
+{
+    LOCK(m_mutex);
+    return m_current->DynamicMemoryUsage() + m_previous->DynamicMemoryUsage();
+}
+
 void AddCoins(CCoinsViewCache& cache, const CTransaction &tx, int nHeight, bool check_for_overwrite) {
     bool fCoinbase = tx.IsCoinBase();
     const Txid& txid = tx.GetHash();
@@ -203,6 +497,7 @@ uint256 CCoinsViewCache::GetBestBlock() const {
 
 void CCoinsViewCache::SetBestBlock(const uint256 &hashBlockIn) {
     hashBlock = hashBlockIn;
+    ++m_access_clock;
 }
 
 void CCoinsViewCache::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlockIn)
@@ -220,6 +515,7 @@ void CCoinsViewCache::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& ha
                 // Move the data up and mark it as dirty.
                 CCoinsCacheEntry& entry{itUs->second};
                 assert(entry.coin.DynamicMemoryUsage() == 0);
+                entry.Touch(m_access_clock);
                 if (cursor.WillErase(*it)) {
                     // Since this entry will be erased,
                     // we can move the coin into us instead of copying it
@@ -262,6 +558,7 @@ void CCoinsViewCache::BatchWrite(CoinsViewCacheCursor& cursor, const uint256& ha
                     itUs->second.coin = it->second.coin;
                 }
                 cachedCoinsUsage += itUs->second.coin.DynamicMemoryUsage();
+                itUs->second.Touch(m_access_clock);
                 if (!itUs->second.IsDirty()) {
                     CCoinsCacheEntry::SetDirty(*itUs, m_sentinel);
                     ++m_dirty_count;
@@ -348,6 +645,75 @@ void CCoinsViewCache::ReallocateCache()
     ::new (&cacheCoins) CCoinsMap{0, SaltedOutpointHasher{/*deterministic=*/m_deterministic}, CCoinsMap::key_equal{}, &m_cache_coins_memory_resource};
 }
 
+//! Number of blocks since their last access up to which CCoinsViewCache::Trim() tells coins apart.
+static constexpr size_t TRIM_AGE_BUCKETS{1024};
+
+bool CCoinsViewCache::Trim(size_t max_usage, const std::function<bool(const COutPoint&, const Coin&)>& evicted)
+{
+    // Evicting a modified coin would lose the modification.
+    if (m_dirty_count > 0) return false;
+    if (DynamicMemoryUsage() <= max_usage) return true;
+
+    // What an entry takes in the map besides the memory of its coin, on average.
+    const size_t entry_usage{memusage::DynamicUsage(cacheCoins) / std::max<size_t>(cacheCoins.size(), 1)};
+    // Rather than sorting the entries by their last access, bucket them by the number
+    // of blocks since then, which takes linear time. Entries that were last accessed
+    // TRIM_AGE_BUCKETS - 1 or more blocks ago share the last bucket.
+    const auto age_bucket{[&](const CCoinsCacheEntry& entry) -> size_t {
+        return std::min<uint32_t>(m_access_clock - entry.LastAccess(), TRIM_AGE_BUCKETS - 1);
+    }};
+    std::vector<size_t> bucket_usage(TRIM_AGE_BUCKETS);
+    for (const auto& [_, entry] : cacheCoins) {
+        bucket_usage[age_bucket(entry)] += entry_usage + entry.coin.DynamicMemoryUsage();
+    }
+
+    // Keep the most recent buckets that fit entirely, and what fits of the next one.
+    size_t cutoff{0};
+    size_t usage{0};
+    while (cutoff < TRIM_AGE_BUCKETS && usage + bucket_usage[cutoff] <= max_usage) {
+        usage += bucket_usage[cutoff++];
+    }
+    size_t cutoff_budget{max_usage - usage};
+
+    std::vector<std::tuple<COutPoint, Coin, uint32_t>> keep;
+    std::vector<CoinsCachePair*> evict;
+    // Number of evicted entries in each bucket, to order them without sorting.
+    std::vector<size_t> evict_count(evicted ? TRIM_AGE_BUCKETS : 0);
+    for (auto& entry : cacheCoins) {
+        const size_t bucket{age_bucket(entry.second)};
+        const size_t entry_total{entry_usage + entry.second.coin.DynamicMemoryUsage()};
+        if (bucket < cutoff || (bucket == cutoff && entry_total <= cutoff_budget)) {
+            if (bucket == cutoff) cutoff_budget -= entry_total;
+            keep.emplace_back(entry.first, std::move(entry.second.coin), entry.second.LastAccess());
+        } else if (evicted) {
+            evict.push_back(&entry);
+            ++evict_count[bucket];
+        }
+    }
+
+    if (evicted) {
+        // Counting sort of the evicted entries, most recently accessed first.
+        std::vector<size_t> next(TRIM_AGE_BUCKETS);
+        for (size_t bucket{1}; bucket < TRIM_AGE_BUCKETS; ++bucket) {
+            next[bucket] = next[bucket - 1] + evict_count[bucket - 1];
+        }
+        std::vector<CoinsCachePair*> ordered(evict.size());
+        for (CoinsCachePair* entry : evict) ordered[next[age_bucket(entry->second)]++] = entry;
+        for (size_t i{0}; i < ordered.size() && evicted(ordered[i]->first, ordered[i]->second.coin); ++i) {}
+    }
+
+    evict = {};
+    cacheCoins.clear();
+    ReallocateCache();
+    cachedCoinsUsage = 0;
+    cacheCoins.reserve(keep.size());
+    for (auto& [outpoint, coin, last_access] : keep) {
+        cachedCoinsUsage += coin.DynamicMemoryUsage();
+        cacheCoins.try_emplace(outpoint, std::move(coin)).first->second.Touch(last_access);
+    }
+    return true;
+}
+
 void CCoinsViewCache::SanityCheck() const
 {
     size_t recomputed_usage = 0;
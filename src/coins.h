@@ -10,19 +10,28 @@
 #include <compressor.h>
 #include <core_memusage.h>
 #include <memusage.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <support/allocators/pool.h>
+#include <sync.h>
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
 #include <util/hasher.h>
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 
 #include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -122,6 +131,9 @@ private:
     CoinsCachePair* m_prev{nullptr};
     CoinsCachePair* m_next{nullptr};
     uint8_t m_flags{0};
+    //! When the entry was last accessed, in blocks of the cache's clock (see CCoinsViewCache::Trim).
+    //! Fits into the padding after m_flags, so it does not make entries larger.
+    uint32_t m_last_access{0};
 
     //! Adding a flag requires a reference to the sentinel of the flagged pair linked list.
     static void AddFlags(uint8_t flags, CoinsCachePair& pair, CoinsCachePair& sentinel) noexcept
@@ -183,6 +195,9 @@ public:
     bool IsDirty() const noexcept { return m_flags & DIRTY; }
     bool IsFresh() const noexcept { return m_flags & FRESH; }
 
+    uint32_t LastAccess() const noexcept { return m_last_access; }
+    void Touch(uint32_t clock) noexcept { m_last_access = clock; }
+
     //! Only call Next when this entry is DIRTY, FRESH, or both
     CoinsCachePair* Next() const noexcept
     {
@@ -384,6 +399,9 @@ protected:
     mutable size_t cachedCoinsUsage{0};
     /* Running count of dirty Coin cache entries. */
     mutable size_t m_dirty_count{0};
+    /* Advanced whenever the best block is set, and recorded in the entries that are fetched or
+     * modified. PeekCoin() does not record it, as it may be called concurrently. */
+    uint32_t m_access_clock{0};
 
     /**
      * Discard all modifications made to this cache without flushing to the base view.
@@ -496,6 +514,22 @@ public:
     //! See: https://stackoverflow.com/questions/42114044/how-to-release-unordered-map-memory
     void ReallocateCache();
 
+    /**
+     * Evict the least recently accessed coins until the cache takes at most
+     * max_usage bytes, rather than emptying it like Flush() does. Coins are
+     * aged by the number of blocks since they were last accessed, so the ones
+     * that were created or looked up recently, which are the most likely to be
+     * spent soon, stay in the cache. The map is rebuilt from the coins that are
+     * kept, which releases the memory of the others like ReallocateCache().
+     * Takes time linear in the size of the cache.
+     *
+     * @param[in] evicted  Called with the evicted coins, most recently accessed
+     *                     first, until it returns false.
+     * @return false, without evicting anything, if there are modified coins.
+     *         Call this when there are none, e.g. right after Sync().
+     */
+    [[nodiscard]] bool Trim(size_t max_usage, const std::function<bool(const COutPoint&, const Coin&)>& evicted = {});
+
     //! Run an internal sanity check on the cache data structure. */
     void SanityCheck() const;
 
@@ -545,6 +579,187 @@ private:
 
 public:
     using CCoinsViewCache::CCoinsViewCache;
+
+    /**
+     * Insert a coin that was looked up in the base view as a clean entry, so a
+     * later access does not have to fetch it again. Has no effect if the
+     * outpoint is already cached.
+     *
+     * @sa InputFetcher::FetchInputs()
+     */
+    void WarmCoin(const COutPoint& outpoint, Coin&& coin);
+};
+
+/**
+ * Thread-safe view of the UTXO set at the chain tip, for lookups that should
+ * not have to hold cs_main (e.g. from RPC and REST).
+ *
+ * It is layered between the tip cache and the coins database. Coins are kept
+ * in a number of shards, each protected by its own lock:
+ * - changes written into the tip cache are published with Publish(), and
+ *   are kept until the tip cache has flushed them to the base view;
+ * - coins read from the base view by GetCoins() are cached, up to a limit.
+ *
+ * The tip cache is only published once the view is activated, which happens
+ * on the first BatchWrite() after RequestActivation(), when the base view
+ * matches the tip cache. Until then, lookups are passed to the base view.
+ *
+ * The base view must support concurrent reads, and all changes to the tip
+ * cache must either be written into it with BatchWrite() (and published), or
+ * be flushed before readers may observe them.
+ */
+class CCoinsViewSharded final : public CCoinsViewBacked
+{
+public:
+    static constexpr size_t SHARD_COUNT{32};
+    static constexpr size_t DEFAULT_MAX_CACHED_COINS{1 << 16};
+
+    explicit CCoinsViewSharded(CCoinsView* view, size_t max_cached_coins = DEFAULT_MAX_CACHED_COINS);
+
+    std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::optional<Coin> PeekCoin(const COutPoint& outpoint) const override;
+    bool HaveCoin(const COutPoint& outpoint) const override;
+    void BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override;
+
+    //! Start publishing the tip cache from the next BatchWrite() on.
+    void RequestActivation() { m_activation_requested = true; }
+    bool IsActive() const { return m_active; }
+    //! Stop publishing the tip cache and wait for running lookups to finish,
+    //! e.g. before the base view is reopened.
+    void Deactivate();
+
+    //! Make the changes that are about to be written into the tip cache
+    //! visible to readers. Only call from the thread that writes the tip cache.
+    void Publish(const CoinsViewCacheCursor& cursor, const uint256& hashBlock);
+
+    /**
+     * Look up coins without holding cs_main. The results all correspond to
+     * the same tip, whose block hash is returned. Coins read from the base view
+     * are cached.
+     *
+     * @returns std::nullopt if the view is not active, in which case the
+     *          caller has to look the coins up in the tip cache instead.
+     */
+    std::optional<uint256> GetCoins(std::span<const COutPoint> outpoints, std::vector<std::optional<Coin>>& coins) const;
+
+private:
+    struct Entry {
+        //! Spent if the outpoint is known not to be in the UTXO set
+        Coin coin;
+        //! Whether this entry was published and not flushed to the base view yet
+        bool pending;
+    };
+
+    struct Shard {
+        Mutex mutex;
+        std::unordered_map<COutPoint, Entry, SaltedOutpointHasher> coins GUARDED_BY(mutex);
+        size_t cached_count GUARDED_BY(mutex){0};
+        //! Incremented whenever entries are published or flushed, so that a
+        //! coin read from the base view concurrently is not cached
+        uint64_t epoch GUARDED_BY(mutex){0};
+    };
+
+    const size_t m_max_cached_per_shard;
+    const SaltedOutpointHasher m_shard_hasher{};
+    mutable std::array<Shard, SHARD_COUNT> m_shards;
+
+    std::atomic_bool m_active{false};
+    std::atomic_bool m_activation_requested{false};
+    //! Odd while changes are being published, so that GetCoins() can detect
+    //! lookups that raced with them and retry
+    std::atomic<uint64_t> m_sequence{0};
+    //! Held shared by GetCoins() while it may access the base view
+    mutable std::shared_mutex m_readers_mutex;
+    mutable Mutex m_best_block_mutex;
+    uint256 m_best_block GUARDED_BY(m_best_block_mutex);
+
+    Shard& GetShard(const COutPoint& outpoint) const { return m_shards[m_shard_hasher(outpoint) % SHARD_COUNT]; }
+    std::optional<Coin> FetchCoin(const COutPoint& outpoint, bool cache) const;
+    void MarkPending(const CoinsViewCacheCursor& cursor);
+};
+
+/**
+ * Tip cache that publishes the changes written into it to the
+ * CCoinsViewSharded it is layered on.
+ */
+class CoinsViewPublishingCache final : public CCoinsViewCache
+{
+private:
+    CCoinsViewSharded& m_shared;
+
+public:
+    explicit CoinsViewPublishingCache(CCoinsViewSharded& base LIFETIMEBOUND)
+        : CCoinsViewCache{&base}, m_shared{base} {}
+
+    void BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override
+    {
+        m_shared.Publish(cursor, hashBlock);
+        CCoinsViewCache::BatchWrite(cursor, hashBlock);
+    }
+};
+
+/**
+ * Second level of the coins cache, layered below the tip cache. It keeps
+ * unmodified coins that were evicted from the tip cache (see
+ * CCoinsViewCache::Trim()) in their compressed database serialization, which
+ * takes a fraction of the memory of an entry of the tip cache, so that coins
+ * spent soon after a flush do not all have to be read from disk again.
+ *
+ * Changes written through it are passed on to the base view and drop the
+ * coins they touch, so it only ever returns coins as they are in the base
+ * view. Coins age out in two generations: coins are inserted into the newer
+ * one until it takes half the memory, and Age() drops the older one to make
+ * room. A coin that is looked up is moved back to the newer one.
+ *
+ * Lookups may run concurrently, e.g. from CCoinsViewSharded.
+ */
+class CCoinsViewCompressedCache final : public CCoinsViewBacked
+{
+public:
+    explicit CCoinsViewCompressedCache(CCoinsView* view) : CCoinsViewBacked(view) {}
+
+    std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::optional<Coin> PeekCoin(const COutPoint& outpoint) const override;
+    bool HaveCoin(const COutPoint& outpoint) const override;
+    void BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override;
+
+    //! Keep a coin that is unspent and unmodified in the base view.
+    //! Returns false, without keeping it, if the cache is disabled or the newer generation is full.
+    bool Insert(const COutPoint& outpoint, const Coin& coin);
+
+    //! Drop the older generation and start a new one for the coins inserted from now on.
+    void Age();
+
+    //! Set the memory the cache may take. Zero disables it. Shrinking it empties the cache.
+    void SetMaxUsage(size_t max_usage);
+
+    //! Size of the cache (in number of transaction outputs)
+    size_t GetCacheSize() const;
+
+    //! Calculate the size of the cache (in bytes)
+    size_t DynamicMemoryUsage() const;
+
+private:
+    //! Most coins compress to fewer bytes than this, and are stored without another allocation.
+    using CompressedCoin = prevector<40, unsigned char>;
+
+    struct Generation {
+        std::unordered_map<COutPoint, CompressedCoin, SaltedOutpointHasher> coins;
+        //! Memory of the coins that did not fit into a CompressedCoin
+        size_t extra_usage{0};
+
+        size_t DynamicMemoryUsage() const;
+        void Add(const COutPoint& outpoint, CompressedCoin&& coin);
+        std::optional<CompressedCoin> Remove(const COutPoint& outpoint);
+    };
+
+    mutable Mutex m_mutex;
+    std::unique_ptr<Generation> m_current GUARDED_BY(m_mutex){std::make_unique<Generation>()};
+    std::unique_ptr<Generation> m_previous GUARDED_BY(m_mutex){std::make_unique<Generation>()};
+    size_t m_max_usage GUARDED_BY(m_mutex){0};
+
+    //! Look the coin up in this cache only
+    std::optional<Coin> FetchCoin(const COutPoint& outpoint) const;
 };
 
 //! Utility function to add all of a transaction's outputs to a cache.
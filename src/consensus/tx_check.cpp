@@ -8,6 +8,11 @@
 #include <primitives/transaction.h>
 #include <consensus/validation.h>
 
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <set>
+
 bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
 {
     // Basic checks that don't depend on any context
@@ -38,7 +43,12 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
     // of a tx as spent, it does not check if the tx has duplicate inputs.
     // Failure to run this check will result in either a crash or an inflation bug, depending on the implementation of
     // the underlying coins database.
-    std::set<COutPoint> vInOutPoints;
+    // The set is built in an arena that starts out on the stack, so that
+    // checking a typical transaction does not allocate on the heap, and
+    // larger ones only grow it a chunk at a time. It is released at once.
+    std::array<std::byte, 4096> arena_buffer;
+    std::pmr::monotonic_buffer_resource arena{arena_buffer.data(), arena_buffer.size()};
+    std::pmr::set<COutPoint> vInOutPoints{&arena};
     for (const auto& txin : tx.vin) {
         if (!vInOutPoints.insert(txin.prevout).second)
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-inputs-duplicate");
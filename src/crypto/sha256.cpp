@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #include <compat/cpuid.h> // IWYU pragma: keep
@@ -32,11 +33,19 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
+void TransformMulti_4way(uint32_t* const* s, const unsigned char* const* chunks);
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
+void TransformMulti_8way(uint32_t* const* s, const unsigned char* const* chunks);
+}
+
+namespace sha256d64_avx512
+{
+void Transform_16way(unsigned char* out, const unsigned char* in);
+void TransformMulti_16way(uint32_t* const* s, const unsigned char* const* chunks);
 }
 
 namespace sha256d64_x86_shani
@@ -437,6 +446,8 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+/** Perform one transform on each of a number of independent states, each with its own 64-byte chunk. */
+typedef void (*TransformMultiType)(uint32_t* const*, const unsigned char* const*);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -482,6 +493,96 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformD64Type TransformD64_16way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
+TransformMultiType TransformMulti_16way = nullptr;
+
+/** The largest number of lanes of any TransformMultiType. */
+constexpr size_t MAX_MULTI_LANES{16};
+
+/**
+ * Double-SHA256 messages of any length with a multi-way transform.
+ *
+ * Each lane works through the blocks of one message, then through the single
+ * block of its second hash, and then moves on to the next message that has
+ * not been started yet. Lanes only idle once all messages have been started.
+ */
+void SHA256DLanes(TransformMultiType transform, size_t lanes, unsigned char* out, const unsigned char* const* in, const size_t* lens, size_t count)
+{
+    struct Lane {
+        uint32_t state[8];
+        //! The padded final block(s) of the message, or the block of the second hash.
+        unsigned char tail[128];
+        size_t msg;
+        size_t block;
+        size_t full_blocks;
+        size_t total_blocks;
+        bool second;
+        bool active{false};
+    };
+    static const unsigned char idle_chunk[64]{};
+    uint32_t idle_state[8]{};
+    Lane lane_data[MAX_MULTI_LANES];
+    uint32_t* states[MAX_MULTI_LANES];
+    const unsigned char* chunks[MAX_MULTI_LANES];
+    size_t next_msg{0};
+    size_t active{0};
+
+    const auto start{[&](Lane& lane) {
+        lane.active = next_msg < count;
+        if (!lane.active) return;
+        ++active;
+        lane.msg = next_msg++;
+        const size_t len{lens[lane.msg]};
+        const size_t rem{len % 64};
+        lane.full_blocks = len / 64;
+        const size_t tail_blocks{rem < 56 ? size_t{1} : size_t{2}};
+        std::memset(lane.tail, 0, tail_blocks * 64);
+        if (rem) std::memcpy(lane.tail, in[lane.msg] + lane.full_blocks * 64, rem);
+        lane.tail[rem] = 0x80;
+        WriteBE64(lane.tail + tail_blocks * 64 - 8, uint64_t(len) << 3);
+        lane.total_blocks = lane.full_blocks + tail_blocks;
+        lane.block = 0;
+        lane.second = false;
+        sha256::Initialize(lane.state);
+    }};
+
+    for (size_t i = 0; i < lanes; ++i) start(lane_data[i]);
+    while (active) {
+        for (size_t i = 0; i < lanes; ++i) {
+            Lane& lane{lane_data[i]};
+            if (!lane.active) {
+                states[i] = idle_state;
+                chunks[i] = idle_chunk;
+            } else {
+                states[i] = lane.state;
+                chunks[i] = lane.block < lane.full_blocks ? in[lane.msg] + lane.block * 64 : lane.tail + (lane.block - lane.full_blocks) * 64;
+            }
+        }
+        transform(states, chunks);
+        for (size_t i = 0; i < lanes; ++i) {
+            Lane& lane{lane_data[i]};
+            if (!lane.active || ++lane.block < lane.total_blocks) continue;
+            if (!lane.second) {
+                // Hash the 32-byte result again, in a single block.
+                std::memset(lane.tail, 0, 64);
+                for (int j = 0; j < 8; ++j) WriteBE32(lane.tail + 4 * j, lane.state[j]);
+                lane.tail[32] = 0x80;
+                lane.tail[62] = 0x01;
+                lane.full_blocks = 0;
+                lane.total_blocks = 1;
+                lane.block = 0;
+                lane.second = true;
+                sha256::Initialize(lane.state);
+            } else {
+                for (int j = 0; j < 8; ++j) WriteBE32(out + 32 * lane.msg + 4 * j, lane.state[j]);
+                --active;
+                start(lane);
+            }
+        }
+    }
+}
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -565,6 +666,35 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformD64_16way, if available, on the 8 messages twice.
+    if (TransformD64_16way) {
+        unsigned char in[1024];
+        std::copy(data + 1, data + 513, in);
+        std::copy(data + 1, data + 513, in + 512);
+        unsigned char out[512];
+        TransformD64_16way(out, in);
+        if (!std::equal(out, out + 256, result_d64)) return false;
+        if (!std::equal(out + 256, out + 512, result_d64)) return false;
+    }
+
+    // Test the multi-way transforms, if available, with lane i continuing
+    // from the state after i % 8 transforms.
+    for (const auto& [transform, lanes] : {std::pair{TransformMulti_4way, 4}, std::pair{TransformMulti_8way, 8}, std::pair{TransformMulti_16way, 16}}) {
+        if (!transform) continue;
+        uint32_t states[MAX_MULTI_LANES][8];
+        uint32_t* state_ptrs[MAX_MULTI_LANES];
+        const unsigned char* chunks[MAX_MULTI_LANES];
+        for (int i = 0; i < lanes; ++i) {
+            std::copy(result[i % 8], result[i % 8] + 8, states[i]);
+            state_ptrs[i] = states[i];
+            chunks[i] = data + 1 + 64 * (i % 8);
+        }
+        transform(state_ptrs, chunks);
+        for (int i = 0; i < lanes; ++i) {
+            if (!std::equal(states[i], states[i] + 8, result[i % 8 + 1])) return false;
+        }
+    }
+
     return true;
 }
 
@@ -577,6 +707,14 @@ bool AVXEnabled()
     __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
     return (a & 6) == 6;
 }
+
+/** Whether the operating system saves the opmask and upper ZMM registers. */
+bool AVX512Enabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 0xe6) == 0xe6;
+}
 #endif
 #endif // DISABLE_OPTIMIZED_SHA256
 } // namespace
@@ -590,6 +728,10 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     TransformD64_2way = nullptr;
     TransformD64_4way = nullptr;
     TransformD64_8way = nullptr;
+    TransformD64_16way = nullptr;
+    TransformMulti_4way = nullptr;
+    TransformMulti_8way = nullptr;
+    TransformMulti_16way = nullptr;
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #if defined(HAVE_GETCPUID)
@@ -597,6 +739,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     bool have_xsave = false;
     bool have_avx = false;
     [[maybe_unused]] bool have_avx2 = false;
+    [[maybe_unused]] bool have_avx512 = false;
     [[maybe_unused]] bool have_x86_shani = false;
     [[maybe_unused]] bool enabled_avx = false;
 
@@ -618,6 +761,9 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
         if (use_implementation & sha256_implementation::USE_SHANI) {
             have_x86_shani = (ebx >> 29) & 1;
         }
+        if (use_implementation & sha256_implementation::USE_AVX512) {
+            have_avx512 = (ebx >> 16) & 1;
+        }
     }
 
 #if defined(ENABLE_SSE41) && defined(ENABLE_X86_SHANI)
@@ -639,6 +785,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #endif
 #if defined(ENABLE_SSE41)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256d64_sse41::TransformMulti_4way;
         ret += ";sse41(4way)";
 #endif
     }
@@ -646,9 +793,20 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(ENABLE_AVX2)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256d64_avx2::TransformMulti_8way;
         ret += ";avx2(8way)";
     }
 #endif
+
+#if defined(ENABLE_AVX512)
+    // Unlike AVX2, this is used alongside SHA-NI: 16 lanes at a time outrun
+    // its 2-way transform on the many 64-byte messages of merkle roots.
+    if (have_avx512 && have_avx && enabled_avx && AVX512Enabled()) {
+        TransformD64_16way = sha256d64_avx512::Transform_16way;
+        TransformMulti_16way = sha256d64_avx512::TransformMulti_16way;
+        ret += ";avx512(16way)";
+    }
+#endif
 #endif // defined(HAVE_GETCPUID)
 
 #if defined(ENABLE_ARM_SHANI)
@@ -748,6 +906,14 @@ CSHA256& CSHA256::Reset()
 
 void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
 {
+    if (TransformD64_16way) {
+        while (blocks >= 16) {
+            TransformD64_16way(out, in);
+            out += 512;
+            in += 1024;
+            blocks -= 16;
+        }
+    }
     if (TransformD64_8way) {
         while (blocks >= 8) {
             TransformD64_8way(out, in);
@@ -779,3 +945,21 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+void SHA256DMulti(unsigned char* out, const unsigned char* const* in, const size_t* lens, size_t count)
+{
+    // Only use a multi-way transform when most of its lanes will be busy.
+    if (TransformMulti_16way && count >= 8) {
+        SHA256DLanes(TransformMulti_16way, 16, out, in, lens, count);
+    } else if (TransformMulti_8way && count >= 4) {
+        SHA256DLanes(TransformMulti_8way, 8, out, in, lens, count);
+    } else if (TransformMulti_4way && count >= 2) {
+        SHA256DLanes(TransformMulti_4way, 4, out, in, lens, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char buf[CSHA256::OUTPUT_SIZE];
+            CSHA256().Write(in[i], lens[i]).Finalize(buf);
+            CSHA256().Write(buf, sizeof(buf)).Finalize(out + 32 * i);
+        }
+    }
+}
@@ -32,9 +32,11 @@ enum UseImplementation : uint8_t {
     USE_SSE4 = 1 << 0,
     USE_AVX2 = 1 << 1,
     USE_SHANI = 1 << 2,
+    USE_AVX512 = 1 << 3,
     USE_SSE4_AND_AVX2 = USE_SSE4 | USE_AVX2,
     USE_SSE4_AND_SHANI = USE_SSE4 | USE_SHANI,
-    USE_ALL = USE_SSE4 | USE_AVX2 | USE_SHANI,
+    USE_SSE4_AND_AVX512 = USE_SSE4 | USE_AVX512,
+    USE_ALL = USE_SSE4 | USE_AVX2 | USE_SHANI | USE_AVX512,
 };
 }
 
@@ -50,4 +52,13 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute multiple double-SHA256's of messages of any length, several at a
+ *  time where the CPU supports it.
+ *  output:  pointer to a count*32 byte output buffer
+ *  inputs:  pointers to the count messages
+ *  lengths: the lengths in bytes of the count messages
+ *  count:   the number of hashes to compute.
+ */
+void SHA256DMulti(unsigned char* output, const unsigned char* const* inputs, const size_t* lengths, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -19,20 +19,29 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/log.h>
 #include <util/obfuscation.h>
 #include <util/strencodings.h>
+#include <util/string.h>
+#include <util/thread.h>
+#include <util/time.h>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <optional>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 static auto CharCast(const std::byte* data) { return reinterpret_cast<const char*>(data); }
 
@@ -136,12 +145,14 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
     options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    // up to two write buffers may be held in memory simultaneously
+    options.write_buffer_size = db_options.write_buffer_size.value_or(nCacheSize / 4);
+    if (db_options.bloom_bits > 0) options.filter_policy = leveldb::NewBloomFilterPolicy(db_options.bloom_bits);
+    options.block_size = db_options.block_size;
     options.compression = leveldb::kNoCompression;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
@@ -149,7 +160,7 @@ static leveldb::Options GetOptions(size_t nCacheSize)
         // on corruption in later versions.
         options.paranoid_checks = true;
     }
-    options.max_file_size = std::max(options.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    options.max_file_size = db_options.max_file_size;
     SetMaxOpenFiles(&options);
     return options;
 }
@@ -214,6 +225,174 @@ struct LevelDBContext {
     leveldb::DB* pdb;
 };
 
+using namespace std::chrono_literals;
+
+//! Key ranges larger than this are split by their next key byte before they are compacted.
+static constexpr uint64_t DB_COMPACTION_RANGE_SIZE{DBWRAPPER_MAX_FILE_SIZE};
+//! Length of the key prefixes at which ranges are no longer split.
+static constexpr size_t DB_COMPACTION_MAX_PREFIX{4};
+//! How long the database must not have been written to before a range is compacted.
+static constexpr auto DB_COMPACTION_IDLE_TIME{10s};
+//! A compaction pass starts by itself once this fraction of the database has been written since the last one.
+static constexpr uint64_t DB_COMPACTION_AUTO_DIVISOR{4};
+
+//! The first key after all the keys that start with prefix, if any.
+static std::optional<std::string> PrefixEnd(std::string prefix)
+{
+    while (!prefix.empty() && uint8_t(prefix.back()) == 0xff) prefix.pop_back();
+    if (prefix.empty()) return std::nullopt;
+    prefix.back() = char(uint8_t(prefix.back()) + 1);
+    return prefix;
+}
+
+/**
+ * Compacts a database in the background, one key range of about
+ * DB_COMPACTION_RANGE_SIZE at a time, so that the work is spread out when the
+ * database is idle instead of being left to the compactions LevelDB runs as
+ * the database is written. A range is only compacted when the database has not
+ * been written to for DB_COMPACTION_IDLE_TIME and compaction is not deferred,
+ * and the next one waits for as long as its size takes at the configured rate.
+ */
+class DBCompactor
+{
+private:
+    leveldb::DB& m_db;
+    const std::string m_name;
+    //! Bytes of table data compacted per second
+    const uint64_t m_rate;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop GUARDED_BY(m_mutex){false};
+    bool m_requested GUARDED_BY(m_mutex){false};
+    //! Time of the last write since the database was opened, if any
+    SteadyClock::time_point m_last_write GUARDED_BY(m_mutex){};
+    //! Bytes written since the last pass started, and how many start the next one
+    uint64_t m_written GUARDED_BY(m_mutex){0};
+    uint64_t m_auto_pass_bytes GUARDED_BY(m_mutex);
+    DBCompactionProgress m_progress GUARDED_BY(m_mutex){.enabled = true};
+    std::thread m_thread;
+
+    uint64_t ApproximateSize(const std::string& begin, const std::optional<std::string>& end) const
+    {
+        // Without an end, estimate up to a key past any key in the database.
+        const std::string limit{end.value_or(begin + std::string(DBWRAPPER_PREALLOC_KEY_SIZE, '\xff'))};
+        const leveldb::Range range(begin, limit);
+        uint64_t size{0};
+        m_db.GetApproximateSizes(&range, 1, &size);
+        return size;
+    }
+
+    static uint64_t AutoPassBytes(uint64_t db_size) { return std::max(db_size / DB_COMPACTION_AUTO_DIVISOR, DB_COMPACTION_RANGE_SIZE); }
+
+    //! Wait until a range can be compacted. Returns false if the compactor is stopped.
+    bool WaitForIdle() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        while (!m_stop) {
+            const auto idle_at{m_last_write + DB_COMPACTION_IDLE_TIME};
+            if (m_progress.deferred) {
+                m_cv.wait(lock);
+            } else if (SteadyClock::now() < idle_at) {
+                m_cv.wait_until(lock, idle_at);
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Compact the keys that start with prefix. Returns false if the compactor is stopped.
+    bool CompactPrefix(const std::string& prefix) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        const std::optional<std::string> end{PrefixEnd(prefix)};
+        const uint64_t size{ApproximateSize(prefix, end)};
+        if (size == 0) return true;
+        if (size > DB_COMPACTION_RANGE_SIZE && prefix.size() < DB_COMPACTION_MAX_PREFIX) {
+            for (int next{0}; next <= 0xff; ++next) {
+                if (!CompactPrefix(prefix + char(next))) return false;
+            }
+            return true;
+        }
+
+        if (!WaitForIdle()) return false;
+        const leveldb::Slice begin_key{prefix};
+        const leveldb::Slice end_key{end.value_or("")};
+        const auto start{SteadyClock::now()};
+        m_db.CompactRange(&begin_key, end ? &end_key : nullptr);
+
+        WAIT_LOCK(m_mutex, lock);
+        m_progress.compacted_bytes += size;
+        m_progress.compaction_time += std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start);
+        // Wait for the time the rate allows for the range before moving on to the next one.
+        const auto next_start{start + std::chrono::microseconds{size * 1'000'000 / m_rate}};
+        return !m_cv.wait_until(lock, next_start, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop; });
+    }
+
+    void ThreadCompact() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_requested || m_written >= m_auto_pass_bytes; });
+                if (m_stop) return;
+                m_requested = false;
+                m_written = 0;
+                m_progress.running = true;
+                m_progress.pass_bytes = ApproximateSize({}, std::nullopt);
+                m_progress.compacted_bytes = 0;
+                LogDebug(BCLog::LEVELDB, "Starting background compaction of %s (%.1f MiB)", m_name, m_progress.pass_bytes / 1024.0 / 1024);
+            }
+            if (!CompactPrefix({})) return;
+            LOCK(m_mutex);
+            m_progress.running = false;
+            ++m_progress.passes;
+            m_auto_pass_bytes = AutoPassBytes(m_progress.pass_bytes);
+            LogDebug(BCLog::LEVELDB, "Finished background compaction of %s", m_name);
+        }
+    }
+
+public:
+    DBCompactor(leveldb::DB& db, std::string name, uint64_t rate)
+        : m_db{db}, m_name{std::move(name)}, m_rate{rate}, m_auto_pass_bytes{AutoPassBytes(ApproximateSize({}, std::nullopt))}
+    {
+        m_thread = std::thread(&util::TraceThread, "dbcompact", [this] { ThreadCompact(); });
+    }
+
+    ~DBCompactor()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    void Request() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_requested = !m_progress.running);
+        m_cv.notify_all();
+    }
+
+    void SetDeferred(bool deferred) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            LOCK(m_mutex);
+            if (m_progress.deferred == deferred) return;
+            m_progress.deferred = deferred;
+        }
+        m_cv.notify_all();
+    }
+
+    void NotifyWrite(size_t bytes) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_last_write = SteadyClock::now();
+        m_written += bytes;
+        if (m_written >= m_auto_pass_bytes) m_cv.notify_all();
+    }
+
+    DBCompactionProgress GetProgress() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) { return WITH_LOCK(m_mutex, return m_progress); }
+};
+
 CDBWrapper::CDBWrapper(const DBParams& params)
     : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}
 {
@@ -222,7 +401,7 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    DBContext().options = GetOptions(params.cache_bytes, params.options);
     DBContext().options.create_if_missing = true;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -259,10 +438,15 @@ CDBWrapper::CDBWrapper(const DBParams& params)
         LogInfo("Wrote new obfuscation key for %s: %s", fs::PathToString(params.path), m_obfuscation.HexKey());
     }
     LogInfo("Using obfuscation key for %s: %s", fs::PathToString(params.path), m_obfuscation.HexKey());
+
+    if (params.options.compaction_rate > 0) {
+        m_compactor = std::make_unique<DBCompactor>(*DBContext().pdb, m_name, params.options.compaction_rate);
+    }
 }
 
 CDBWrapper::~CDBWrapper()
 {
+    m_compactor.reset();
     delete DBContext().pdb;
     DBContext().pdb = nullptr;
     delete DBContext().options.filter_policy;
@@ -282,6 +466,7 @@ void CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     if (log_memory) {
         mem_before = DynamicMemoryUsage() / 1024.0 / 1024;
     }
+    if (m_compactor) m_compactor->NotifyWrite(batch.ApproximateSize());
     leveldb::Status status = DBContext().pdb->Write(fSync ? DBContext().syncoptions : DBContext().writeoptions, &batch.m_impl_batch->batch);
     HandleError(status);
     if (log_memory) {
@@ -302,6 +487,50 @@ size_t CDBWrapper::DynamicMemoryUsage() const
     return parsed.value();
 }
 
+std::vector<DBLevelStats> CDBWrapper::GetLevelStats() const
+{
+    std::string stats;
+    if (!DBContext().pdb->GetProperty("leveldb.stats", &stats)) {
+        LogDebug(BCLog::LEVELDB, "Failed to get stats property\n");
+        return {};
+    }
+    // The stats are a table with a row of six numbers per level, after a header.
+    std::vector<DBLevelStats> levels;
+    for (const std::string& line : util::SplitString(stats, '\n')) {
+        std::vector<std::string> fields;
+        for (std::string& field : util::SplitString(line, ' ')) {
+            if (!field.empty()) fields.push_back(std::move(field));
+        }
+        if (fields.size() != 6) continue;
+        const auto level{ToIntegral<int>(fields[0])};
+        const auto files{ToIntegral<int64_t>(fields[1])};
+        const auto size{ToIntegral<int64_t>(fields[2])};
+        const auto time{ToIntegral<int64_t>(fields[3])};
+        const auto read{ToIntegral<int64_t>(fields[4])};
+        const auto written{ToIntegral<int64_t>(fields[5])};
+        if (!level || !files || !size || !time || !read || !written) continue;
+        levels.push_back({*level, *files, *size, *time, *read, *written});
+    }
+    return levels;
+}
+
+bool CDBWrapper::RequestCompaction()
+{
+    if (!m_compactor) return false;
+    m_compactor->Request();
+    return true;
+}
+
+void CDBWrapper::SetCompactionDeferred(bool deferred)
+{
+    if (m_compactor) m_compactor->SetDeferred(deferred);
+}
+
+DBCompactionProgress CDBWrapper::GetCompactionProgress() const
+{
+    return m_compactor ? m_compactor->GetProgress() : DBCompactionProgress{};
+}
+
 std::optional<std::string> CDBWrapper::ReadImpl(std::span<const std::byte> key) const
 {
     leveldb::Slice slKey(CharCast(key.data()), key.size());
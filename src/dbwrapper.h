@@ -12,21 +12,67 @@
 #include <util/check.h>
 #include <util/fs.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 static const size_t DBWRAPPER_MAX_FILE_SIZE = 32 << 20; // 32 MiB
+static const int DBWRAPPER_BLOOM_BITS = 10;
+static const size_t DBWRAPPER_BLOCK_SIZE = 4 << 10; // 4 KiB
 
 //! User-controlled performance and debug options.
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Bits per key of the bloom filter of each table, or 0 for no filter.
+    int bloom_bits = DBWRAPPER_BLOOM_BITS;
+    //! Approximate size of the uncompressed data packed per table block.
+    size_t block_size = DBWRAPPER_BLOCK_SIZE;
+    //! Size of the memtable. If unset, a quarter of the cache size.
+    std::optional<size_t> write_buffer_size{};
+    //! Size at which table files are split.
+    size_t max_file_size = DBWRAPPER_MAX_FILE_SIZE;
+    //! If nonzero, compact the database in the background, a small key range
+    //! at a time, at about this many bytes of table data per second.
+    size_t compaction_rate = 0;
+};
+
+//! Statistics of one level of a database, as reported by LevelDB.
+struct DBLevelStats {
+    int level;
+    int64_t files;
+    //! Size of the tables of the level, in MiB
+    int64_t size_mib;
+    //! Time spent on compactions into the level, in seconds
+    int64_t compaction_secs;
+    //! Data read and written by compactions into the level, in MiB
+    int64_t read_mib;
+    int64_t written_mib;
+};
+
+//! State of the background compaction of a database (see DBOptions::compaction_rate).
+struct DBCompactionProgress {
+    bool enabled{false};
+    //! Whether compaction is held off by the owner of the database
+    bool deferred{false};
+    //! Whether a compaction pass is in progress
+    bool running{false};
+    //! Number of compaction passes completed
+    int64_t passes{0};
+    //! Estimated size of the database when the current or last pass started
+    uint64_t pass_bytes{0};
+    //! Estimated size of the key ranges compacted so far by the current or last pass
+    uint64_t compacted_bytes{0};
+    //! Time spent compacting by all passes
+    std::chrono::microseconds compaction_time{0};
 };
 
 //! Application-specific storage settings.
@@ -174,6 +220,7 @@ public:
 };
 
 struct LevelDBContext;
+class DBCompactor;
 
 class CDBWrapper
 {
@@ -185,6 +232,9 @@ private:
     //! the name of this database
     std::string m_name;
 
+    //! background compaction, if enabled
+    std::unique_ptr<DBCompactor> m_compactor;
+
     //! optional XOR-obfuscation of the database
     Obfuscation m_obfuscation;
 
@@ -253,6 +303,23 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    //! Statistics of the levels of the database that have tables or compaction activity.
+    std::vector<DBLevelStats> GetLevelStats() const;
+
+    /**
+     * Start a pass of background compaction over the whole database, if it
+     * is enabled. The pass runs once the database has not been written to
+     * for a while and compaction is not deferred.
+     *
+     * @return  false if background compaction is disabled
+     */
+    bool RequestCompaction();
+
+    //! Hold off background compaction, e.g. while the database is written in bursts.
+    void SetCompactionDeferred(bool deferred);
+
+    DBCompactionProgress GetCompactionProgress() const;
+
     CDBIterator* NewIterator();
 
     /**
@@ -0,0 +1,71 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <headerchecker.h>
+
+#include <crypto/sha256.h>
+#include <pow.h>
+#include <streams.h>
+
+#include <algorithm>
+#include <utility>
+
+/** Below this many headers, handing them to the worker threads costs more than it saves. */
+static constexpr size_t MIN_PARALLEL_HEADERS{16};
+/** The number of headers each worker thread hashes together. */
+static constexpr size_t HEADERS_PER_JOB{32};
+
+CheckedHeader CheckHeader(const CBlockHeader& header, const Consensus::Params& params)
+{
+    const uint256 hash{header.GetHash()};
+    return {hash, CheckProofOfWork(hash, header.nBits, params)};
+}
+
+void CheckHeaders(std::span<const CBlockHeader> headers, const Consensus::Params& params, std::span<CheckedHeader> results)
+{
+    std::vector<unsigned char> ser;
+    std::vector<size_t> offsets{0};
+    for (const CBlockHeader& header : headers) {
+        VectorWriter{ser, ser.size(), header};
+        offsets.push_back(ser.size());
+    }
+    std::vector<const unsigned char*> inputs(headers.size());
+    std::vector<size_t> lengths(headers.size());
+    for (size_t i{0}; i < headers.size(); ++i) {
+        inputs[i] = ser.data() + offsets[i];
+        lengths[i] = offsets[i + 1] - offsets[i];
+    }
+    std::vector<unsigned char> hashes(headers.size() * uint256::size());
+    SHA256DMulti(hashes.data(), inputs.data(), lengths.data(), headers.size());
+
+    for (size_t i{0}; i < headers.size(); ++i) {
+        const uint256 hash{std::span{hashes}.subspan(i * uint256::size(), uint256::size())};
+        results[i] = {hash, CheckProofOfWork(hash, headers[i].nBits, params)};
+    }
+}
+
+HeaderChecker::HeaderChecker(unsigned int batch_size, int worker_threads_num)
+    : m_queue{batch_size, worker_threads_num, "headercheck"}
+{
+}
+
+std::vector<CheckedHeader> HeaderChecker::CheckHeaders(std::span<const CBlockHeader> headers, const Consensus::Params& params)
+{
+    std::vector<CheckedHeader> results(headers.size());
+    if (!m_queue.HasThreads() || headers.size() < MIN_PARALLEL_HEADERS) {
+        ::CheckHeaders(headers, params, results);
+        return results;
+    }
+
+    std::vector<CheckJob> jobs;
+    for (size_t i{0}; i < headers.size(); i += HEADERS_PER_JOB) {
+        const size_t count{std::min(HEADERS_PER_JOB, headers.size() - i)};
+        jobs.emplace_back(headers.subspan(i, count), params, std::span{results}.subspan(i, count));
+    }
+
+    CCheckQueueControl<CheckJob> control{m_queue};
+    control.Add(std::move(jobs));
+    control.Complete();
+    return results;
+}
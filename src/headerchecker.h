@@ -0,0 +1,85 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_HEADERCHECKER_H
+#define BITCOIN_HEADERCHECKER_H
+
+#include <attributes.h>
+#include <checkqueue.h>
+#include <primitives/block.h>
+#include <uint256.h>
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Consensus {
+struct Params;
+} // namespace Consensus
+
+/** Maximum number of threads that check headers. A full headers message is only
+ *  a few hundred kilobytes of hashing, and headers arrive from one peer at a time
+ *  during the initial headers sync. */
+static constexpr int MAX_HEADER_CHECK_THREADS{2};
+
+/** The hash of a block header and whether it satisfies the proof of work it claims. */
+struct CheckedHeader {
+    uint256 hash;
+    bool pow_valid{false};
+};
+
+/** Hash a block header and check its proof of work. */
+CheckedHeader CheckHeader(const CBlockHeader& header, const Consensus::Params& params);
+
+/** Same as CheckHeader() for a number of headers, which are hashed together with SHA256DMulti(). */
+void CheckHeaders(std::span<const CBlockHeader> headers, const Consensus::Params& params, std::span<CheckedHeader> results);
+
+/**
+ * Hashes a batch of block headers, and checks their proof of work, before they
+ * are accepted into the block index.
+ *
+ * These are the only checks on a header that do not depend on the block index,
+ * and for a full headers message they are most of the work of accepting it.
+ * Doing them on a small pool of worker threads of its own, without holding
+ * cs_main, leaves only the contextual checks and the block index insertion to
+ * be done under the lock.
+ */
+class HeaderChecker
+{
+private:
+    /** Check a run of consecutive headers and store the results. */
+    class CheckJob
+    {
+    private:
+        std::span<const CBlockHeader> m_headers;
+        const Consensus::Params* m_params;
+        std::span<CheckedHeader> m_results;
+
+    public:
+        CheckJob(std::span<const CBlockHeader> headers LIFETIMEBOUND, const Consensus::Params& params LIFETIMEBOUND, std::span<CheckedHeader> results LIFETIMEBOUND)
+            : m_headers{headers}, m_params{&params}, m_results{results} {}
+
+        //! Never fails; an invalid header is rejected when it is accepted.
+        std::optional<bool> operator()()
+        {
+            ::CheckHeaders(m_headers, *m_params, m_results);
+            return std::nullopt;
+        }
+    };
+
+    CCheckQueue<CheckJob> m_queue;
+
+public:
+    explicit HeaderChecker(unsigned int batch_size, int worker_threads_num);
+
+    /**
+     * Hash and check the proof of work of all headers, on the worker threads
+     * if there are any and the batch is large enough to be worth it.
+     *
+     * @returns the result for each header, in the same order.
+     */
+    std::vector<CheckedHeader> CheckHeaders(std::span<const CBlockHeader> headers, const Consensus::Params& params);
+};
+
+#endif // BITCOIN_HEADERCHECKER_H
@@ -15,6 +15,7 @@
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/vector.h>
 #include <walletinitinterface.h>
 
 #include <algorithm>
@@ -142,6 +143,9 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         jreq.URI = req->GetURI();
 
         UniValue reply;
+        // Large results of single requests may be streamed into this buffer
+        // instead of being returned in reply
+        std::string result_json;
         bool user_has_whitelist = g_rpc_whitelist.contains(jreq.authUser);
         if (!user_has_whitelist && g_rpc_whitelist_default) {
             LogWarning("RPC User %s not allowed to call any methods", jreq.authUser);
@@ -162,6 +166,7 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             // 2.0 behavior is to catch exceptions and return HTTP success with
             // RPC errors, as long as there is not an actual HTTP server error.
             const bool catch_errors{jreq.m_json_version == JSONRPCVersion::V2};
+            jreq.m_result_buffer = &result_json;
             reply = JSONRPCExec(jreq, catch_errors);
 
             if (jreq.IsNotification()) {
@@ -226,7 +231,14 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, reply.write() + "\n");
+        if (!result_json.empty()) {
+            // Send the streamed result as it is, between the parts of the reply around it
+            auto [prefix, suffix]{JSONRPCReplyEnvelope(jreq.id, jreq.m_json_version)};
+            suffix += '\n';
+            req->WriteReply(HTTP_OK, Vector(std::move(prefix), std::move(result_json), std::move(suffix)));
+        } else {
+            req->WriteReply(HTTP_OK, Vector(reply.write() + "\n"));
+        }
     } catch (UniValue& e) {
         JSONErrorReply(req, std::move(e), jreq);
         return false;
@@ -339,8 +351,6 @@ bool StartHTTPRPC(const std::any& context)
     if (g_wallet_init_interface.HasWalletSupport()) {
         RegisterHTTPHandler("/wallet/", false, handle_rpc);
     }
-    struct event_base* eventBase = EventBase();
-    assert(eventBase);
     return true;
 }
 
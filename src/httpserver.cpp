@@ -15,21 +15,31 @@
 #include <sync.h>
 #include <util/check.h>
 #include <util/signalinterrupt.h>
+#include <util/sock.h>
 #include <util/strencodings.h>
+#include <util/string.h>
+#include <util/thread.h>
 #include <util/threadnames.h>
 #include <util/threadpool.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <span>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
 #include <sys/types.h>
@@ -46,6 +56,8 @@
 #include <support/events.h>
 
 using common::InvalidPortErrMsg;
+using util::SplitString;
+using util::TrimStringView;
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
@@ -185,34 +197,9 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     assert(false);
 }
 
-/** HTTP request callback */
-static void http_request_cb(struct evhttp_request* req, void* arg)
+/** Hand a request to the handler registered for its path, on a worker thread */
+static void DispatchHTTPRequest(std::shared_ptr<HTTPRequest> hreq)
 {
-    evhttp_connection* conn{evhttp_request_get_connection(req)};
-    // Track active requests
-    {
-        g_requests.AddRequest(req);
-        evhttp_request_set_on_complete_cb(req, [](struct evhttp_request* req, void*) {
-            g_requests.RemoveRequest(req);
-        }, nullptr);
-        evhttp_connection_set_closecb(conn, [](evhttp_connection* conn, void* arg) {
-            g_requests.RemoveConnection(conn);
-        }, nullptr);
-    }
-
-    // Disable reading to work around a libevent bug, fixed in 2.1.9
-    // See https://github.com/libevent/libevent/commit/5ff8eb26371c4dc56f384b2de35bea2d87814779
-    // and https://github.com/bitcoin/bitcoin/pull/11593.
-    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
-        if (conn) {
-            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-            if (bev) {
-                bufferevent_disable(bev, EV_READ);
-            }
-        }
-    }
-    auto hreq{std::make_shared<HTTPRequest>(req, *static_cast<const util::SignalInterrupt*>(arg))};
-
     // Early address-based allow check
     if (!ClientAllowed(hreq->GetPeer())) {
         LogDebug(BCLog::HTTP, "HTTP request from %s rejected: Client network is not allowed RPC access\n",
@@ -288,6 +275,35 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
     }
 }
 
+/** HTTP request callback */
+static void http_request_cb(struct evhttp_request* req, void* arg)
+{
+    evhttp_connection* conn{evhttp_request_get_connection(req)};
+    // Track active requests
+    {
+        g_requests.AddRequest(req);
+        evhttp_request_set_on_complete_cb(req, [](struct evhttp_request* req, void*) {
+            g_requests.RemoveRequest(req);
+        }, nullptr);
+        evhttp_connection_set_closecb(conn, [](evhttp_connection* conn, void* arg) {
+            g_requests.RemoveConnection(conn);
+        }, nullptr);
+    }
+
+    // Disable reading to work around a libevent bug, fixed in 2.1.9
+    // See https://github.com/libevent/libevent/commit/5ff8eb26371c4dc56f384b2de35bea2d87814779
+    // and https://github.com/bitcoin/bitcoin/pull/11593.
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_disable(bev, EV_READ);
+            }
+        }
+    }
+    DispatchHTTPRequest(std::make_shared<HTTPRequest>(req, *static_cast<const util::SignalInterrupt*>(arg)));
+}
+
 /** Callback to reject HTTP requests after shutdown. */
 static void http_reject_request_cb(struct evhttp_request* req, void*)
 {
@@ -305,8 +321,663 @@ static void ThreadHTTP(struct event_base* base)
     LogDebug(BCLog::HTTP, "Exited http event loop\n");
 }
 
-/** Bind HTTP server to specified addresses */
-static bool HTTPBindAddresses(struct evhttp* http)
+namespace http_bitcoin {
+
+//! Maximum time the socket handler thread waits for socket events
+static constexpr std::chrono::milliseconds SOCKET_WAIT_TIMEOUT{50};
+//! Number of bytes read from a connection in one call
+static constexpr size_t RECV_CHUNK_SIZE{64 * 1024};
+//! Stop dispatching pipelined requests while this many response bytes are waiting to be sent
+static constexpr size_t MAX_SEND_QUEUE_SIZE{1 << 20};
+//! Reply bodies up to this size are copied behind the header, larger ones are queued as they are
+static constexpr size_t MAX_COALESCED_BODY_SIZE{16 * 1024};
+//! Maximum body size of a request without credentials, which the handlers reject or do not read
+static constexpr size_t MAX_UNAUTHENTICATED_BODY_SIZE{64 * 1024};
+
+static std::span<const std::byte> AsBytes(const SendBuffer& buffer)
+{
+    return std::visit([](const auto& data) { return std::as_bytes(std::span{data}); }, buffer);
+}
+
+static size_t BodySize(const std::vector<SendBuffer>& body)
+{
+    size_t size{0};
+    for (const auto& chunk : body) size += AsBytes(chunk).size();
+    return size;
+}
+
+/** Whether a comma-separated header value contains the given (case-insensitive) token */
+static bool HasHeaderToken(std::string_view value, std::string_view token)
+{
+    for (const auto& part : SplitString(value, ',')) {
+        if (ToLower(TrimStringView(part)) == token) return true;
+    }
+    return false;
+}
+
+std::optional<std::string> HTTPRequestMessage::FindHeader(std::string_view name) const
+{
+    const std::string lower_name{ToLower(name)};
+    for (const auto& [key, value] : headers) {
+        if (ToLower(key) == lower_name) return value;
+    }
+    return std::nullopt;
+}
+
+bool HTTPRequestMessage::KeepAlive() const
+{
+    const auto connection{FindHeader("Connection")};
+    if (version_minor == 0) return connection && HasHeaderToken(*connection, "keep-alive");
+    return !connection || !HasHeaderToken(*connection, "close");
+}
+
+static ParseResult ParseRequestFrom(std::span<const std::byte> buffer, HTTPRequestMessage& msg, size_t& consumed,
+                                    size_t max_headers_size, size_t max_body_size, ParseState& state)
+{
+    const std::string_view data{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+    size_t pos{state.pos};
+    // Return the next line without its terminator. Bare LF terminators are accepted, like libevent does.
+    const auto next_line{[&]() -> std::optional<std::string_view> {
+        const size_t eol{data.find('\n', pos)};
+        if (eol == std::string_view::npos) return std::nullopt;
+        std::string_view line{data.substr(pos, eol - pos)};
+        if (line.ends_with('\r')) line.remove_suffix(1);
+        pos = eol + 1;
+        return line;
+    }};
+
+    if (!state.head) {
+        // The request line and headers are bounded by max_headers_size, so
+        // they are parsed again from the start until they are complete.
+        HTTPRequestMessage req;
+        bool have_request_line{false};
+        while (true) {
+            const auto line{next_line()};
+            if (!line) return data.size() > max_headers_size ? ParseResult::INVALID : ParseResult::INCOMPLETE;
+            if (pos > max_headers_size) return ParseResult::INVALID;
+            if (!have_request_line) {
+                // Empty lines preceding the request line are ignored (RFC 9112 section 2.2)
+                if (line->empty()) continue;
+                const auto parts{SplitString(*line, ' ')};
+                if (parts.size() != 3 || parts[0].empty() || parts[1].empty()) return ParseResult::INVALID;
+                if (parts[2] == "HTTP/1.1") {
+                    req.version_minor = 1;
+                } else if (parts[2] == "HTTP/1.0") {
+                    req.version_minor = 0;
+                } else {
+                    return ParseResult::INVALID;
+                }
+                req.method = parts[0];
+                req.target = parts[1];
+                have_request_line = true;
+            } else if (line->empty()) {
+                break;
+            } else {
+                // Obsolete line folding is rejected (RFC 9112 section 5.2)
+                const size_t colon{line->find(':')};
+                if (line->front() == ' ' || line->front() == '\t' || colon == std::string_view::npos || colon == 0) {
+                    return ParseResult::INVALID;
+                }
+                const std::string_view name{line->substr(0, colon)};
+                if (name.find_first_of(" \t") != std::string_view::npos) return ParseResult::INVALID;
+                req.headers.emplace_back(name, TrimStringView(line->substr(colon + 1), " \t"));
+            }
+        }
+
+        const auto transfer_encoding{req.FindHeader("Transfer-Encoding")};
+        const auto content_length{req.FindHeader("Content-Length")};
+        if (transfer_encoding) {
+            // Only a single chunked coding is supported, and a Content-Length
+            // alongside it is rejected to avoid request smuggling.
+            if (ToLower(TrimStringView(*transfer_encoding)) != "chunked") return ParseResult::UNSUPPORTED;
+            if (content_length) return ParseResult::INVALID;
+            state.chunked = true;
+        } else if (content_length) {
+            const auto length{ToIntegral<uint64_t>(*content_length)};
+            if (!length) return ParseResult::INVALID;
+            if (*length > max_body_size) return ParseResult::TOO_LARGE;
+            state.content_length = *length;
+        }
+        state.head = std::move(req);
+        state.pos = pos;
+    }
+
+    HTTPRequestMessage& req{*state.head};
+    if (state.chunked) {
+        // The raw size of the request is bounded, including any chunk framing.
+        const size_t max_request_size{max_headers_size + max_body_size};
+        // A line that is still incomplete, starting at pos, is searched again
+        // once more data has arrived, so its length is bounded like that of
+        // the headers.
+        const auto incomplete{[&] {
+            if (data.size() > max_request_size) return ParseResult::TOO_LARGE;
+            if (data.size() - pos > max_headers_size) return ParseResult::INVALID;
+            return ParseResult::INCOMPLETE;
+        }};
+        while (!state.in_trailer) {
+            const auto line{next_line()};
+            if (!line) return incomplete();
+            // Chunk extensions are ignored
+            const auto chunk_size{ToIntegral<uint64_t>(TrimStringView(line->substr(0, line->find(';')), " \t"), 16)};
+            if (!chunk_size) return ParseResult::INVALID;
+            if (*chunk_size == 0) {
+                state.in_trailer = true;
+                state.pos = pos;
+                break;
+            }
+            if (*chunk_size > max_body_size - req.body.size()) return ParseResult::TOO_LARGE;
+            if (data.size() - pos < *chunk_size) {
+                return data.size() > max_request_size ? ParseResult::TOO_LARGE : ParseResult::INCOMPLETE;
+            }
+            const std::string_view chunk{data.substr(pos, *chunk_size)};
+            pos += *chunk_size;
+            const auto terminator{next_line()};
+            if (!terminator) return incomplete();
+            if (!terminator->empty()) return ParseResult::INVALID;
+            req.body.append(chunk);
+            state.pos = pos;
+        }
+        // Trailer fields are ignored
+        while (true) {
+            const auto line{next_line()};
+            if (!line) return incomplete();
+            if (line->empty()) break;
+            state.pos = pos;
+        }
+    } else {
+        if (data.size() - pos < state.content_length) return ParseResult::INCOMPLETE;
+        req.body = data.substr(pos, state.content_length);
+        pos += state.content_length;
+    }
+
+    msg = std::move(req);
+    consumed = pos;
+    return ParseResult::COMPLETE;
+}
+
+ParseResult ParseRequest(std::span<const std::byte> buffer, HTTPRequestMessage& msg, size_t& consumed,
+                         size_t max_headers_size, size_t max_body_size, ParseState& state)
+{
+    const auto result{ParseRequestFrom(buffer, msg, consumed, max_headers_size, max_body_size, state)};
+    if (result != ParseResult::INCOMPLETE) state = {};
+    return result;
+}
+
+ParseResult ParseRequest(std::span<const std::byte> buffer, HTTPRequestMessage& msg, size_t& consumed,
+                         size_t max_headers_size, size_t max_body_size)
+{
+    ParseState state;
+    return ParseRequest(buffer, msg, consumed, max_headers_size, max_body_size, state);
+}
+
+/** Reason phrase for the status codes used by the RPC and REST servers */
+static std::string_view HTTPReasonPhrase(int status)
+{
+    switch (status) {
+    case HTTP_OK: return "OK";
+    case HTTP_NO_CONTENT: return "No Content";
+    case HTTP_BAD_REQUEST: return "Bad Request";
+    case HTTP_UNAUTHORIZED: return "Unauthorized";
+    case HTTP_FORBIDDEN: return "Forbidden";
+    case HTTP_NOT_FOUND: return "Not Found";
+    case HTTP_BAD_METHOD: return "Method Not Allowed";
+    case HTTP_PAYLOAD_TOO_LARGE: return "Payload Too Large";
+    case HTTP_INTERNAL_SERVER_ERROR: return "Internal Server Error";
+    case HTTP_NOT_IMPLEMENTED: return "Not Implemented";
+    case HTTP_SERVICE_UNAVAILABLE: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+std::vector<std::byte> FormatResponseHeader(int version_minor, int status,
+                                            const std::vector<std::pair<std::string, std::string>>& headers,
+                                            size_t content_length, bool keep_alive)
+{
+    std::string header{strprintf("HTTP/1.%d %d %s\r\n", version_minor, status, HTTPReasonPhrase(status))};
+    for (const auto& [name, value] : headers) {
+        // The Connection header is derived from keep_alive
+        if (ToLower(name) == "connection") continue;
+        header += strprintf("%s: %s\r\n", name, value);
+    }
+    header += strprintf("Content-Length: %u\r\n", content_length);
+    if (!keep_alive) {
+        header += "Connection: close\r\n";
+    } else if (version_minor == 0) {
+        header += "Connection: keep-alive\r\n";
+    }
+    header += "\r\n";
+    const auto bytes{std::as_bytes(std::span{header})};
+    return {bytes.begin(), bytes.end()};
+}
+
+class HTTPServer;
+
+/** Client connection of the native HTTP server.
+ *
+ * Requests on a connection are handled one at a time: pipelined requests stay
+ * in the receive buffer until the reply to the previous request has been
+ * queued, so replies are always sent in request order.
+ */
+class HTTPConnection
+{
+public:
+    HTTPConnection(HTTPServer& server, std::unique_ptr<Sock>&& sock, const CService& peer)
+        : m_server{server}, m_sock{std::move(sock)}, m_peer{peer} {}
+
+    HTTPServer& m_server;
+    const std::shared_ptr<const Sock> m_sock;
+    const CService m_peer;
+
+    Mutex m_mutex;
+    //! Received data that has not been parsed into a request yet
+    std::vector<std::byte> m_recv_buffer GUARDED_BY(m_mutex);
+    //! How much of the request at the start of m_recv_buffer has been parsed
+    ParseState m_parse_state GUARDED_BY(m_mutex);
+    //! Serialized replies, of which the first one may have been sent partially
+    std::deque<SendBuffer> m_send_queue GUARDED_BY(m_mutex);
+    size_t m_send_offset GUARDED_BY(m_mutex){0};
+    size_t m_send_queue_size GUARDED_BY(m_mutex){0};
+    //! Whether a request is being handled by a worker thread
+    bool m_request_in_flight GUARDED_BY(m_mutex){false};
+    //! Close the connection once the send queue is empty
+    bool m_close_after_send GUARDED_BY(m_mutex){false};
+    //! Set when the socket handler thread dropped the connection, replies are discarded
+    bool m_disconnected GUARDED_BY(m_mutex){false};
+    SteadyClock::time_point m_last_active GUARDED_BY(m_mutex){SteadyClock::now()};
+
+    void QueueSend(SendBuffer&& data) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        const size_t size{AsBytes(data).size()};
+        if (size == 0) return;
+        m_send_queue_size += size;
+        m_send_queue.push_back(std::move(data));
+    }
+
+    /** Send queued data until the socket would block. Return false if the connection failed. */
+    bool SendQueued() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        while (!m_send_queue.empty()) {
+            const auto data{AsBytes(m_send_queue.front())};
+            const ssize_t sent{m_sock->Send(data.data() + m_send_offset, data.size() - m_send_offset, MSG_NOSIGNAL | MSG_DONTWAIT)};
+            if (sent <= 0) {
+                const int err{WSAGetLastError()};
+                return sent == 0 || err == WSAEWOULDBLOCK || err == WSAEMSGSIZE || err == WSAEINTR || err == WSAEINPROGRESS;
+            }
+            m_last_active = SteadyClock::now();
+            m_send_offset += sent;
+            m_send_queue_size -= sent;
+            if (m_send_offset == data.size()) {
+                m_send_queue.pop_front();
+                m_send_offset = 0;
+            }
+        }
+        return true;
+    }
+};
+
+/** HTTP/1.1 server on plain sockets, serving the same handlers as the libevent backend.
+ *
+ * A single socket handler thread accepts connections, reads and parses
+ * requests and sends replies. Request handlers run on g_threadpool_http.
+ * Reply bodies are queued as they are, without copying them into a
+ * separate output buffer.
+ */
+class HTTPServer
+{
+public:
+    HTTPServer(const util::SignalInterrupt& interrupt, std::chrono::seconds timeout)
+        : m_interrupt{interrupt}, m_timeout{timeout}, m_sock_epoll{SockEpoll::Create()}
+    {
+#ifndef WIN32
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0) {
+            m_wake_recv = std::make_shared<const Sock>(fds[0]);
+            m_wake_send = std::make_unique<Sock>(fds[1]);
+            if (!m_wake_recv->SetNonBlocking() || !m_wake_send->SetNonBlocking() ||
+                (m_sock_epoll && !m_sock_epoll->Add(m_wake_recv, Sock::RECV))) {
+                m_wake_recv.reset();
+                m_wake_send.reset();
+            }
+        }
+#endif
+    }
+
+    ~HTTPServer() { Stop(); }
+
+    bool Bind(const CService& addr)
+    {
+        struct sockaddr_storage sockaddr;
+        socklen_t len = sizeof(sockaddr);
+        if (!addr.GetSockAddr(reinterpret_cast<struct sockaddr*>(&sockaddr), &len)) {
+            LogWarning("Bind address family for %s not supported", addr.ToStringAddrPort());
+            return false;
+        }
+        std::unique_ptr<Sock> sock{CreateSock(addr.GetSAFamily(), SOCK_STREAM, IPPROTO_TCP)};
+        if (!sock) {
+            LogWarning("Couldn't open socket for HTTP server: %s", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+        int one{1};
+        if (sock->SetSockOpt(SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == SOCKET_ERROR) {
+            LogInfo("Unable to set SO_REUSEADDR on RPC server socket, continuing anyway");
+        }
+#ifdef IPV6_V6ONLY
+        if (addr.IsIPv6() && sock->SetSockOpt(IPPROTO_IPV6, IPV6_V6ONLY, &one, sizeof(one)) == SOCKET_ERROR) {
+            LogInfo("Unable to set IPV6_V6ONLY on RPC server socket, continuing anyway");
+        }
+#endif
+        if (sock->Bind(reinterpret_cast<struct sockaddr*>(&sockaddr), len) == SOCKET_ERROR ||
+            sock->Listen(SOMAXCONN) == SOCKET_ERROR) {
+            LogWarning("Unable to listen on %s: %s", addr.ToStringAddrPort(), NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+        std::shared_ptr<const Sock> listen_sock{std::move(sock)};
+        if (m_sock_epoll && !m_sock_epoll->Add(listen_sock, Sock::RECV)) {
+            LogWarning("Unable to register the socket for %s with epoll", addr.ToStringAddrPort());
+            return false;
+        }
+        m_listen_socks.push_back(std::move(listen_sock));
+        return true;
+    }
+
+    bool HasListeners() const { return !m_listen_socks.empty(); }
+
+    std::vector<CService> GetBindAddresses() const
+    {
+        std::vector<CService> addrs;
+        for (const auto& sock : m_listen_socks) addrs.push_back(GetBindAddress(*sock));
+        return addrs;
+    }
+
+    void Start()
+    {
+        m_thread = std::thread(&util::TraceThread, "http", [this] { ThreadSocketHandler(); });
+    }
+
+    /** Reject new requests, replies to requests in flight are still sent. */
+    void Interrupt() { m_reject_requests = true; }
+
+    /** Send the remaining replies and close all connections. Call after the worker threads have stopped. */
+    void Stop()
+    {
+        m_reject_requests = true;
+        m_stop = true;
+        Wake();
+        if (m_thread.joinable()) m_thread.join();
+        m_listen_socks.clear();
+    }
+
+    /**
+     * Queue the reply to the request in flight on a connection, called from a worker thread.
+     *
+     * The reply is sent right away as far as the socket buffer allows, and the
+     * next pipelined request is dispatched from the calling thread. Only what
+     * remains is left to the socket handler thread.
+     */
+    void QueueReply(std::shared_ptr<HTTPConnection> conn, std::vector<std::byte>&& header, std::vector<SendBuffer>&& body, bool keep_alive)
+        EXCLUSIVE_LOCKS_REQUIRED(!conn->m_mutex)
+    {
+        // Replies written without a worker thread, by the socket handler
+        // thread or while dispatching on this thread, must not dispatch the
+        // next request, as that would recurse.
+        static thread_local bool dispatching{false};
+        const bool may_dispatch{!dispatching && std::this_thread::get_id() != m_thread.get_id()};
+
+        std::optional<HTTPRequestMessage> request;
+        bool wake{true};
+        {
+            LOCK(conn->m_mutex);
+            if (conn->m_disconnected) return;
+            // Small bodies are sent in the same segment as the header
+            if (BodySize(body) <= MAX_COALESCED_BODY_SIZE) {
+                for (const auto& chunk : body) {
+                    const auto data{AsBytes(chunk)};
+                    header.insert(header.end(), data.begin(), data.end());
+                }
+                body.clear();
+            }
+            conn->QueueSend(std::move(header));
+            for (auto& chunk : body) conn->QueueSend(std::move(chunk));
+            conn->m_request_in_flight = false;
+            if (!keep_alive) conn->m_close_after_send = true;
+            if (conn->SendQueued()) {
+                if (may_dispatch) request = NextRequest(*conn);
+                wake = conn->m_send_queue_size > 0 || conn->m_close_after_send || (!request && !conn->m_recv_buffer.empty());
+            }
+        }
+        if (wake) Wake();
+        if (request) {
+            dispatching = true;
+            DispatchHTTPRequest(std::make_shared<HTTPRequest>(std::move(conn), std::move(*request), m_interrupt));
+            dispatching = false;
+        }
+    }
+
+    /** Wake up the socket handler thread, e.g. because a reply was queued. */
+    void Wake() const
+    {
+        // Without a wake-up socket, the socket handler thread picks up changes
+        // within SOCKET_WAIT_TIMEOUT.
+        if (m_wake_send) {
+            const char byte{0};
+            (void)m_wake_send->Send(&byte, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+        }
+    }
+
+private:
+    const util::SignalInterrupt& m_interrupt;
+    const std::chrono::seconds m_timeout;
+    const std::unique_ptr<SockEpoll> m_sock_epoll;
+    std::shared_ptr<const Sock> m_wake_recv;
+    std::unique_ptr<Sock> m_wake_send;
+    std::vector<std::shared_ptr<const Sock>> m_listen_socks;
+    //! Only accessed by the socket handler thread
+    std::vector<std::shared_ptr<HTTPConnection>> m_connections;
+    std::atomic_bool m_reject_requests{false};
+    std::atomic_bool m_stop{false};
+    std::thread m_thread;
+
+    void AcceptConnection(const Sock& listen_sock)
+    {
+        struct sockaddr_storage sockaddr;
+        socklen_t len = sizeof(sockaddr);
+        auto sock{listen_sock.Accept(reinterpret_cast<struct sockaddr*>(&sockaddr), &len)};
+        if (!sock) {
+            const int err{WSAGetLastError()};
+            if (err != WSAEWOULDBLOCK) LogDebug(BCLog::HTTP, "HTTP accept failed: %s\n", NetworkErrorString(err));
+            return;
+        }
+        CService peer;
+        if (!peer.SetSockAddr(reinterpret_cast<const struct sockaddr*>(&sockaddr), len)) {
+            LogDebug(BCLog::HTTP, "Unknown socket family of HTTP client\n");
+        }
+        if (!sock->SetNonBlocking()) return;
+        int one{1};
+        (void)sock->SetSockOpt(IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        auto conn{std::make_shared<HTTPConnection>(*this, std::move(sock), MaybeFlipIPv6toCJDNS(peer))};
+        if (m_sock_epoll && !m_sock_epoll->Add(conn->m_sock, Sock::RECV)) return;
+        m_connections.push_back(std::move(conn));
+    }
+
+    /**
+     * Receive data, send queued replies and parse the next request of a connection.
+     *
+     * @param[out] request  Set if a request should be dispatched to the handlers.
+     * @returns false if the connection should be closed.
+     */
+    bool ServiceConnection(HTTPConnection& conn, Sock::Event occurred, SteadyClock::time_point now,
+                           std::optional<HTTPRequestMessage>& request) EXCLUSIVE_LOCKS_REQUIRED(!conn.m_mutex)
+    {
+        LOCK(conn.m_mutex);
+        if (occurred & (Sock::RECV | Sock::ERR)) {
+            while (true) {
+                const size_t size{conn.m_recv_buffer.size()};
+                conn.m_recv_buffer.resize(size + RECV_CHUNK_SIZE);
+                const ssize_t received{conn.m_sock->Recv(conn.m_recv_buffer.data() + size, RECV_CHUNK_SIZE, MSG_DONTWAIT)};
+                conn.m_recv_buffer.resize(size + static_cast<size_t>(std::max<ssize_t>(received, 0)));
+                if (received == 0) return false;
+                if (received < 0) {
+                    const int err{WSAGetLastError()};
+                    if (err != WSAEWOULDBLOCK && err != WSAEMSGSIZE && err != WSAEINTR && err != WSAEINPROGRESS) return false;
+                    break;
+                }
+                conn.m_last_active = now;
+                if (static_cast<size_t>(received) < RECV_CHUNK_SIZE || !WantsRecv(conn)) break;
+            }
+        }
+        if ((occurred & Sock::SEND) && !conn.SendQueued()) return false;
+
+        request = NextRequest(conn);
+        if (!conn.SendQueued()) return false;
+
+        if (conn.m_request_in_flight && !m_stop) return true;
+        if (now - conn.m_last_active > m_timeout) return false;
+        return conn.m_send_queue_size > 0 || !(conn.m_close_after_send || m_stop);
+    }
+
+    /**
+     * Parse the next buffered request of a connection, unless a request is
+     * already in flight. Invalid requests are answered right away.
+     *
+     * @returns the request to dispatch to the handlers, if any.
+     */
+    std::optional<HTTPRequestMessage> NextRequest(HTTPConnection& conn) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex)
+    {
+        if (conn.m_request_in_flight || conn.m_close_after_send || conn.m_recv_buffer.empty() ||
+            conn.m_send_queue_size >= MAX_SEND_QUEUE_SIZE) {
+            return std::nullopt;
+        }
+        HTTPRequestMessage msg;
+        size_t consumed{0};
+        auto result{ParseRequest(conn.m_recv_buffer, msg, consumed, MAX_HEADERS_SIZE, MAX_SIZE, conn.m_parse_state)};
+        // Only buffer large bodies for clients that send credentials. They are
+        // checked by the handler, once the whole request has been received.
+        if (result == ParseResult::INCOMPLETE) {
+            const auto& head{conn.m_parse_state.head};
+            if (!head || head->FindHeader("authorization") ||
+                (conn.m_parse_state.content_length <= MAX_UNAUTHENTICATED_BODY_SIZE &&
+                 conn.m_recv_buffer.size() <= MAX_HEADERS_SIZE + MAX_UNAUTHENTICATED_BODY_SIZE)) {
+                return std::nullopt;
+            }
+            conn.m_parse_state = {};
+            result = ParseResult::TOO_LARGE;
+        } else if (result == ParseResult::COMPLETE && msg.body.size() > MAX_UNAUTHENTICATED_BODY_SIZE && !msg.FindHeader("authorization")) {
+            result = ParseResult::TOO_LARGE;
+        }
+        if (result != ParseResult::COMPLETE) {
+            const int status{result == ParseResult::TOO_LARGE   ? HTTP_PAYLOAD_TOO_LARGE :
+                             result == ParseResult::UNSUPPORTED ? HTTP_NOT_IMPLEMENTED :
+                                                                  HTTP_BAD_REQUEST};
+            LogDebug(BCLog::HTTP, "Invalid HTTP request from %s\n", conn.m_peer.ToStringAddrPort());
+            conn.QueueSend(FormatResponseHeader(/*version_minor=*/1, status, {}, 0, /*keep_alive=*/false));
+            conn.m_recv_buffer.clear();
+            conn.m_close_after_send = true;
+            return std::nullopt;
+        }
+        conn.m_recv_buffer.erase(conn.m_recv_buffer.begin(), conn.m_recv_buffer.begin() + consumed);
+        if (m_reject_requests) {
+            LogDebug(BCLog::HTTP, "Rejecting request while shutting down\n");
+            conn.QueueSend(FormatResponseHeader(msg.version_minor, HTTP_SERVICE_UNAVAILABLE, {}, 0, /*keep_alive=*/false));
+            conn.m_close_after_send = true;
+            return std::nullopt;
+        }
+        conn.m_request_in_flight = true;
+        return msg;
+    }
+
+    /** Whether to read from a connection. Pipelined requests are only buffered up to a limit. */
+    static bool WantsRecv(const HTTPConnection& conn) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex)
+    {
+        if (conn.m_close_after_send) return false;
+        if (conn.m_request_in_flight || conn.m_send_queue_size >= MAX_SEND_QUEUE_SIZE) {
+            return conn.m_recv_buffer.size() < MAX_HEADERS_SIZE;
+        }
+        return true;
+    }
+
+    /** Events to wait for on a connection's socket, 0 if none. */
+    static Sock::Event RequestedEvents(const HTTPConnection& conn) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex)
+    {
+        Sock::Event requested{0};
+        if (WantsRecv(conn)) requested |= Sock::RECV;
+        if (conn.m_send_queue_size > 0) requested |= Sock::SEND;
+        return requested;
+    }
+
+    void ThreadSocketHandler()
+    {
+        while (!m_stop || !m_connections.empty()) {
+            Sock::EventsPerSock events_per_sock;
+            bool have_events;
+            if (m_sock_epoll) {
+                // The sockets are registered already, only pass on what changed.
+                if (m_stop) {
+                    for (const auto& sock : m_listen_socks) m_sock_epoll->Modify(*sock, 0);
+                }
+                for (const auto& conn : m_connections) {
+                    LOCK(conn->m_mutex);
+                    m_sock_epoll->Modify(*conn->m_sock, RequestedEvents(*conn));
+                }
+                have_events = m_sock_epoll->Wait(SOCKET_WAIT_TIMEOUT, events_per_sock);
+            } else {
+                if (!m_stop) {
+                    for (const auto& sock : m_listen_socks) events_per_sock.emplace(sock, Sock::Events{Sock::RECV});
+                }
+                if (m_wake_recv) events_per_sock.emplace(m_wake_recv, Sock::Events{Sock::RECV});
+                for (const auto& conn : m_connections) {
+                    LOCK(conn->m_mutex);
+                    const Sock::Event requested{RequestedEvents(*conn)};
+                    if (requested != 0) events_per_sock.emplace(conn->m_sock, Sock::Events{requested});
+                }
+                have_events = !events_per_sock.empty() &&
+                              events_per_sock.begin()->first->WaitMany(SOCKET_WAIT_TIMEOUT, events_per_sock);
+            }
+            if (!have_events) {
+                for (auto& [sock, events] : events_per_sock) events.occurred = 0;
+                if (events_per_sock.empty()) std::this_thread::sleep_for(SOCKET_WAIT_TIMEOUT);
+            }
+            const auto now{SteadyClock::now()};
+            const auto occurred{[&](const std::shared_ptr<const Sock>& sock) {
+                const auto it{events_per_sock.find(sock)};
+                return it != events_per_sock.end() ? it->second.occurred : Sock::Event{0};
+            }};
+
+            if (m_wake_recv && occurred(m_wake_recv)) {
+                std::array<char, 64> buf;
+                while (m_wake_recv->Recv(buf.data(), buf.size(), MSG_DONTWAIT) > 0) {}
+            }
+            for (const auto& sock : m_listen_socks) {
+                if (occurred(sock) & Sock::RECV) AcceptConnection(*sock);
+            }
+
+            std::vector<std::pair<std::shared_ptr<HTTPConnection>, HTTPRequestMessage>> requests;
+            std::erase_if(m_connections, [&](const std::shared_ptr<HTTPConnection>& conn) {
+                std::optional<HTTPRequestMessage> request;
+                if (ServiceConnection(*conn, occurred(conn->m_sock), now, request)) {
+                    if (request) requests.emplace_back(conn, std::move(*request));
+                    return false;
+                }
+                if (m_sock_epoll) m_sock_epoll->Remove(*conn->m_sock);
+                LOCK(conn->m_mutex);
+                conn->m_disconnected = true;
+                return true;
+            });
+
+            for (auto& [conn, msg] : requests) {
+                DispatchHTTPRequest(std::make_shared<HTTPRequest>(conn, std::move(msg), m_interrupt));
+            }
+        }
+        if (m_sock_epoll) m_sock_epoll->Clear();
+    }
+};
+
+} // namespace http_bitcoin
+
+//! Native HTTP server, used instead of libevent with -rpcserverbackend=native
+static std::unique_ptr<http_bitcoin::HTTPServer> g_http_server;
+
+/** Determine the addresses to bind the HTTP server to */
+static std::optional<std::vector<std::pair<std::string, uint16_t>>> GetHTTPBindEndpoints()
 {
     uint16_t http_port{static_cast<uint16_t>(gArgs.GetIntArg("-rpcport", BaseParams().RPCPort()))};
     std::vector<std::pair<std::string, uint16_t>> endpoints;
@@ -331,11 +1002,20 @@ static bool HTTPBindAddresses(struct evhttp* http)
             std::string host;
             if (!SplitHostPort(strRPCBind, port, host)) {
                 LogError("%s\n", InvalidPortErrMsg("-rpcbind", strRPCBind).original);
-                return false;
+                return std::nullopt;
             }
             endpoints.emplace_back(host, port);
         }
     }
+    return endpoints;
+}
+
+/** Bind HTTP server to specified addresses */
+static bool HTTPBindAddresses(struct evhttp* http)
+{
+    auto bind_endpoints{GetHTTPBindEndpoints()};
+    if (!bind_endpoints) return false;
+    auto& endpoints{*bind_endpoints};
 
     // Bind addresses
     for (std::vector<std::pair<std::string, uint16_t> >::iterator i = endpoints.begin(); i != endpoints.end(); ++i) {
@@ -360,6 +1040,26 @@ static bool HTTPBindAddresses(struct evhttp* http)
     return !boundSockets.empty();
 }
 
+/** Bind the native HTTP server to the specified addresses */
+static bool HTTPBindAddresses(http_bitcoin::HTTPServer& server)
+{
+    const auto endpoints{GetHTTPBindEndpoints()};
+    if (!endpoints) return false;
+
+    for (const auto& [host, port] : *endpoints) {
+        LogInfo("Binding RPC on address %s port %i", host, port);
+        const std::optional<CService> addr{Lookup(host.empty() ? "0.0.0.0" : host, port, /*fAllowLookup=*/true)};
+        if (addr && server.Bind(*addr)) {
+            if (host.empty() || addr->IsBindAny()) {
+                LogWarning("The RPC server is not safe to expose to untrusted networks such as the public internet");
+            }
+        } else {
+            LogWarning("Binding RPC on address %s port %i failed.", host, port);
+        }
+    }
+    return server.HasListeners();
+}
+
 /** libevent event log callback */
 static void libevent_log_cb(int severity, const char *msg)
 {
@@ -384,6 +1084,24 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     if (!InitHTTPAllowList())
         return false;
 
+    const std::string backend{gArgs.GetArg("-rpcserverbackend", std::string{DEFAULT_HTTP_SERVER_BACKEND})};
+    if (backend == "native") {
+        auto server{std::make_unique<http_bitcoin::HTTPServer>(interrupt, std::chrono::seconds{gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT)})};
+        if (!HTTPBindAddresses(*server)) {
+            LogError("Unable to bind any endpoint for RPC server");
+            return false;
+        }
+        LogDebug(BCLog::HTTP, "Initialized native HTTP server\n");
+        g_max_queue_depth = std::max(gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1);
+        LogDebug(BCLog::HTTP, "set work queue of depth %d", g_max_queue_depth);
+        g_http_server = std::move(server);
+        return true;
+    }
+    if (backend != "libevent") {
+        LogError("Unknown -rpcserverbackend '%s' (available: libevent, native)", backend);
+        return false;
+    }
+
     // Redirect libevent's logging to our own log
     event_set_log_callback(&libevent_log_cb);
     // Update libevent's log handling.
@@ -440,6 +1158,10 @@ void StartHTTPServer()
     int rpcThreads = std::max(gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1);
     LogInfo("Starting HTTP server with %d worker threads", rpcThreads);
     g_threadpool_http.Start(rpcThreads);
+    if (g_http_server) {
+        g_http_server->Start();
+        return;
+    }
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 }
 
@@ -450,6 +1172,7 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
+    if (g_http_server) g_http_server->Interrupt();
     // Interrupt pool after disabling requests
     g_threadpool_http.Interrupt();
 }
@@ -461,6 +1184,12 @@ void StopHTTPServer()
     LogDebug(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
     g_threadpool_http.Stop();
 
+    if (g_http_server) {
+        // All replies have been queued by now, send them and close the connections.
+        g_http_server->Stop();
+        g_http_server.reset();
+    }
+
     // Unlisten sockets, these are what make the event loop running, which means
     // that after this and all connections are closed the event loop will quit.
     for (evhttp_bound_socket *socket : boundSockets) {
@@ -496,6 +1225,22 @@ struct event_base* EventBase()
     return eventBase;
 }
 
+std::vector<CService> GetHTTPBindAddresses()
+{
+    if (g_http_server) return g_http_server->GetBindAddresses();
+
+    std::vector<CService> addrs;
+    for (evhttp_bound_socket* socket : boundSockets) {
+        struct sockaddr_storage sockaddr;
+        socklen_t len = sizeof(sockaddr);
+        if (getsockname(evhttp_bound_socket_get_fd(socket), reinterpret_cast<struct sockaddr*>(&sockaddr), &len) == 0) {
+            CService addr;
+            if (addr.SetSockAddr(reinterpret_cast<const struct sockaddr*>(&sockaddr), len)) addrs.push_back(addr);
+        }
+    }
+    return addrs;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
 {
     // Static handler: simply call inner handler
@@ -527,6 +1272,11 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrup
 {
 }
 
+HTTPRequest::HTTPRequest(std::shared_ptr<http_bitcoin::HTTPConnection> conn, http_bitcoin::HTTPRequestMessage&& msg, const util::SignalInterrupt& interrupt)
+    : m_conn(std::move(conn)), m_msg(std::move(msg)), m_interrupt(interrupt), replySent(false)
+{
+}
+
 HTTPRequest::~HTTPRequest()
 {
     if (!replySent) {
@@ -539,6 +1289,11 @@ HTTPRequest::~HTTPRequest()
 
 std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr) const
 {
+    if (m_conn) {
+        auto val{m_msg.FindHeader(hdr)};
+        if (val) return std::make_pair(true, std::move(*val));
+        return std::make_pair(false, "");
+    }
     const struct evkeyvalq* headers = evhttp_request_get_input_headers(req);
     assert(headers);
     const char* val = evhttp_find_header(headers, hdr.c_str());
@@ -550,6 +1305,7 @@ std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr) cons
 
 std::string HTTPRequest::ReadBody()
 {
+    if (m_conn) return std::exchange(m_msg.body, {});
     struct evbuffer* buf = evhttp_request_get_input_buffer(req);
     if (!buf)
         return "";
@@ -570,26 +1326,96 @@ std::string HTTPRequest::ReadBody()
 
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
+    if (m_conn) {
+        m_reply_headers.emplace_back(hdr, value);
+        return;
+    }
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
     assert(headers);
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Let a libevent output buffer reference data instead of copying it. The data is freed once libevent has sent it. */
+template <typename T>
+static void AddReference(struct evbuffer* evb, T&& data)
+{
+    auto* owned{new T(std::move(data))};
+    if (owned->empty() || evbuffer_add_reference(evb, owned->data(), owned->size(), [](const void*, size_t, void* arg) {
+            delete static_cast<T*>(arg);
+        }, owned) != 0) {
+        evbuffer_add(evb, owned->data(), owned->size());
+        delete owned;
+    }
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
+{
+    assert(!replySent && (req || m_conn));
+    if (m_conn) {
+        std::vector<http_bitcoin::SendBuffer> body;
+        body.emplace_back(std::vector<std::byte>{reply.begin(), reply.end()});
+        WriteNativeReply(nStatus, std::move(body));
+        return;
+    }
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, reply.data(), reply.size());
+    SendEventReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::vector<std::byte>&& reply)
+{
+    assert(!replySent && (req || m_conn));
+    if (m_conn) {
+        std::vector<http_bitcoin::SendBuffer> body;
+        body.emplace_back(std::move(reply));
+        WriteNativeReply(nStatus, std::move(body));
+        return;
+    }
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    AddReference(evb, std::move(reply));
+    SendEventReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::vector<std::string>&& chunks)
+{
+    assert(!replySent && (req || m_conn));
+    if (m_conn) {
+        WriteNativeReply(nStatus, {std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end())});
+        return;
+    }
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    for (auto& chunk : chunks) AddReference(evb, std::move(chunk));
+    SendEventReply(nStatus);
+}
+
+void HTTPRequest::WriteNativeReply(int nStatus, std::vector<http_bitcoin::SendBuffer>&& body)
+{
+    bool keep_alive{m_msg.KeepAlive() && !m_interrupt};
+    for (const auto& [name, value] : m_reply_headers) {
+        if (ToLower(name) == "connection" && ToLower(value) == "close") keep_alive = false;
+    }
+    auto header{http_bitcoin::FormatResponseHeader(m_msg.version_minor, nStatus, m_reply_headers, http_bitcoin::BodySize(body), keep_alive)};
+    // The reply to a HEAD request has the headers of the full reply, but no body
+    if (m_msg.method == "HEAD") body.clear();
+    replySent = true;
+    auto& server{m_conn->m_server};
+    server.QueueReply(std::move(m_conn), std::move(header), std::move(body), keep_alive);
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
  * this cannot be done from worker threads.
  */
-void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
+void HTTPRequest::SendEventReply(int nStatus)
 {
-    assert(!replySent && req);
     if (m_interrupt) {
         WriteHeader("Connection", "close");
     }
     // Send event to main http thread to send reply message
-    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
-    assert(evb);
-    evbuffer_add(evb, reply.data(), reply.size());
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
@@ -612,6 +1438,7 @@ void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
 
 CService HTTPRequest::GetPeer() const
 {
+    if (m_conn) return m_conn->m_peer;
     evhttp_connection* con = evhttp_request_get_connection(req);
     CService peer;
     if (con) {
@@ -632,11 +1459,19 @@ CService HTTPRequest::GetPeer() const
 
 std::string HTTPRequest::GetURI() const
 {
+    if (m_conn) return m_msg.target;
     return evhttp_request_get_uri(req);
 }
 
 HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
 {
+    if (m_conn) {
+        if (m_msg.method == "GET") return GET;
+        if (m_msg.method == "POST") return POST;
+        if (m_msg.method == "HEAD") return HEAD;
+        if (m_msg.method == "PUT") return PUT;
+        return UNKNOWN;
+    }
     switch (evhttp_request_get_command(req)) {
     case EVHTTP_REQ_GET:
         return GET;
@@ -653,6 +1488,7 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
 
 std::optional<std::string> HTTPRequest::GetQueryParameter(const std::string& key) const
 {
+    if (m_conn) return GetQueryParameterFromUri(m_msg.target.c_str(), key);
     const char* uri{evhttp_request_get_uri(req)};
 
     return GetQueryParameterFromUri(uri, key);
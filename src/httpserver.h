@@ -5,10 +5,16 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace util {
 class SignalInterrupt;
@@ -27,11 +33,83 @@ static const int DEFAULT_HTTP_WORKQUEUE=64;
 
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/** The default value for `-rpcserverbackend`. */
+static constexpr std::string_view DEFAULT_HTTP_SERVER_BACKEND{"libevent"};
+
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
 
+namespace http_bitcoin {
+class HTTPConnection;
+
+/** Part of a serialized response, owned by the connection until it has been sent. */
+using SendBuffer = std::variant<std::vector<std::byte>, std::string>;
+
+/** HTTP/1.x request as parsed by the native HTTP server. */
+struct HTTPRequestMessage
+{
+    std::string method;
+    std::string target;
+    //! Minor version of the HTTP/1.x protocol used by the client
+    int version_minor{1};
+    std::vector<std::pair<std::string, std::string>> headers;
+    //! Request body, with any chunked transfer coding removed
+    std::string body;
+
+    /** Return the value of the first header with the given (case-insensitive) name. */
+    std::optional<std::string> FindHeader(std::string_view name) const;
+    /** Whether the connection should persist after the response to this request. */
+    bool KeepAlive() const;
+};
+
+enum class ParseResult {
+    INCOMPLETE,  //!< More data is needed
+    COMPLETE,    //!< A complete request was parsed
+    INVALID,     //!< Malformed request, or request line and headers exceed the size limit
+    TOO_LARGE,   //!< Request body exceeds the size limit
+    UNSUPPORTED, //!< Unsupported transfer coding
+};
+
+/** What has been parsed of a request that was only received in part. */
+struct ParseState
+{
+    //! The request line and headers, once the empty line ending them has been parsed
+    std::optional<HTTPRequestMessage> head;
+    //! Whether the body uses the chunked transfer coding
+    bool chunked{false};
+    //! Whether all chunks have been parsed, and only the trailer section is left
+    bool in_trailer{false};
+    //! Length of the body if it is not chunked
+    size_t content_length{0};
+    //! Position in the buffer up to which the request has been parsed. Chunks
+    //! before it have been appended to head->body already.
+    size_t pos{0};
+};
+
+/**
+ * Parse a single HTTP/1.x request from the start of buffer.
+ *
+ * Requests may be pipelined, so the buffer can hold more data than the
+ * request; on COMPLETE, consumed is set to the number of bytes that belong
+ * to the parsed request.
+ *
+ * On INCOMPLETE, state records how far the request has been parsed, so that
+ * the next call with the same buffer, extended by newly received data, only
+ * parses the new data. State is reset on any other result.
+ */
+ParseResult ParseRequest(std::span<const std::byte> buffer, HTTPRequestMessage& msg, size_t& consumed,
+                         size_t max_headers_size, size_t max_body_size, ParseState& state);
+ParseResult ParseRequest(std::span<const std::byte> buffer, HTTPRequestMessage& msg, size_t& consumed,
+                         size_t max_headers_size, size_t max_body_size);
+
+/** Serialize the status line and headers of a response with a body of content_length bytes. */
+std::vector<std::byte> FormatResponseHeader(int version_minor, int status,
+                                            const std::vector<std::pair<std::string, std::string>>& headers,
+                                            size_t content_length, bool keep_alive);
+} // namespace http_bitcoin
+
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
  */
@@ -61,21 +139,34 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
+ * Returns nullptr if the native HTTP server backend is used.
  */
 struct event_base* EventBase();
 
+/** Return the addresses the HTTP server is listening on. */
+std::vector<CService> GetHTTPBindAddresses();
+
 /** In-flight HTTP request.
- * Thin C++ wrapper around evhttp_request.
+ * Thin C++ wrapper around evhttp_request, or around a request received by
+ * the native HTTP server.
  */
 class HTTPRequest
 {
 private:
-    struct evhttp_request* req;
+    struct evhttp_request* req{nullptr};
+    //! Connection a native request was received on, nullptr for libevent requests
+    std::shared_ptr<http_bitcoin::HTTPConnection> m_conn;
+    http_bitcoin::HTTPRequestMessage m_msg;
+    std::vector<std::pair<std::string, std::string>> m_reply_headers;
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
 
+    void SendEventReply(int nStatus);
+    void WriteNativeReply(int nStatus, std::vector<http_bitcoin::SendBuffer>&& body);
+
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
+    HTTPRequest(std::shared_ptr<http_bitcoin::HTTPConnection> conn, http_bitcoin::HTTPRequestMessage&& msg, const util::SignalInterrupt& interrupt);
     ~HTTPRequest();
 
     enum RequestMethod {
@@ -143,6 +234,10 @@ public:
         WriteReply(nStatus, std::as_bytes(std::span{reply}));
     }
     void WriteReply(int nStatus, std::span<const std::byte> reply);
+    /** Write HTTP reply, taking ownership of the body so it can be sent without copying it. */
+    void WriteReply(int nStatus, std::vector<std::byte>&& reply);
+    /** Write HTTP reply whose body is the concatenation of chunks, taking ownership of them so they can be sent without copying them. */
+    void WriteReply(int nStatus, std::vector<std::string>&& chunks);
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
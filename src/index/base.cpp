@@ -7,6 +7,7 @@
 #include <chain.h>
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <flatfile.h>
 #include <interfaces/chain.h>
 #include <interfaces/types.h>
 #include <kernel/types.h>
@@ -16,6 +17,7 @@
 #include <node/database_args.h>
 #include <node/interface_ui.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <sync.h>
 #include <tinyformat.h>
 #include <uint256.h>
@@ -25,14 +27,20 @@
 #include <util/string.h>
 #include <util/thread.h>
 #include <util/threadinterrupt.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <cassert>
 #include <compare>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <span>
@@ -48,6 +56,8 @@ constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+//! How many blocks per sync thread are read and prepared ahead of the block being appended
+constexpr size_t SYNC_BLOCKS_AHEAD_PER_THREAD{4};
 
 template <typename... Args>
 void BaseIndex::FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args)
@@ -65,6 +75,16 @@ CBlockLocator GetLocator(interfaces::Chain& chain, const uint256& block_hash)
     return locator;
 }
 
+/** Name of an index database in the database options: the directory under "indexes" that holds it. */
+static std::string IndexDBName(const fs::path& path)
+{
+    std::string name{fs::PathToString(path.filename())};
+    for (auto it{path.begin()}; it != path.end(); ++it) {
+        if (fs::PathToString(*it) == "indexes" && std::next(it) != path.end()) name = fs::PathToString(*std::next(it));
+    }
+    return name;
+}
+
 BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate) :
     CDBWrapper{DBParams{
         .path = path,
@@ -72,7 +92,12 @@ BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool
         .memory_only = f_memory,
         .wipe_data = f_wipe,
         .obfuscate = f_obfuscate,
-        .options = [] { DBOptions options; node::ReadDatabaseArgs(gArgs, options); return options; }()}}
+        .options = [&] {
+            DBOptions options;
+            // no error can happen, already checked in AppInitParameterInteraction
+            Assert(node::ReadDatabaseArgs(gArgs, options, IndexDBName(path)));
+            return options;
+        }()}}
 {}
 
 CBlockLocator BaseIndex::DB::ReadBestBlock() const
@@ -165,28 +190,73 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain&
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
-bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+struct BaseIndex::BlockData {
+    CBlock block;
+    //! The serialized block and a view of it, for indexes that use block views.
+    std::vector<std::byte> raw;
+    std::optional<BlockView> view;
+    CBlockUndo undo;
+};
+
+util::Expected<void, std::string> BaseIndex::PrepareBlock(const CBlockIndex* pindex, const CBlock* block_data, BlockData& data)
 {
     interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
 
-    CBlock block;
-    if (!block_data) { // disk lookup if block data wasn't provided
-        if (!m_chainstate->m_blockman.ReadBlock(block, *pindex)) {
-            FatalErrorf("Failed to read block %s from disk",
-                        pindex->GetBlockHash().ToString());
-            return false;
+    if (!block_data && UsesBlockView()) { // parse the block in place
+        const FlatFilePos block_pos{WITH_LOCK(cs_main, return pindex->GetBlockPos())};
+        auto raw{m_chainstate->m_blockman.ReadRawBlock(block_pos)};
+        if (!raw) {
+            return util::Unexpected{strprintf("Failed to read block %s from disk",
+                                              pindex->GetBlockHash().ToString())};
+        }
+        data.raw = std::move(*raw);
+        try {
+            data.view.emplace(data.raw);
+        } catch (const std::exception& e) {
+            return util::Unexpected{strprintf("Failed to parse block %s from disk: %s",
+                                              pindex->GetBlockHash().ToString(), e.what())};
+        }
+        if (data.view->GetHash() != pindex->GetBlockHash()) {
+            return util::Unexpected{strprintf("Block read from disk at %s is not %s",
+                                              block_pos.ToString(), pindex->GetBlockHash().ToString())};
         }
-        block_info.data = &block;
+        block_info.view = &*data.view;
+    } else if (!block_data) { // disk lookup if block data wasn't provided
+        if (!m_chainstate->m_blockman.ReadBlock(data.block, *pindex)) {
+            return util::Unexpected{strprintf("Failed to read block %s from disk",
+                                              pindex->GetBlockHash().ToString())};
+        }
+        block_info.data = &data.block;
     }
 
-    CBlockUndo block_undo;
     if (CustomOptions().connect_undo_data) {
-        if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            FatalErrorf("Failed to read undo block data %s from disk",
-                        pindex->GetBlockHash().ToString());
-            return false;
+        if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(data.undo, *pindex)) {
+            return util::Unexpected{strprintf("Failed to read undo block data %s from disk",
+                                              pindex->GetBlockHash().ToString())};
         }
-        block_info.undo_data = &block_undo;
+        block_info.undo_data = &data.undo;
+    }
+
+    if (!CustomPrepare(block_info)) {
+        return util::Unexpected{strprintf("Failed to prepare block %s for index",
+                                          pindex->GetBlockHash().ToString())};
+    }
+
+    return {};
+}
+
+bool BaseIndex::AppendBlock(const CBlockIndex* pindex, const CBlock* block_data, const BlockData& data)
+{
+    interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
+    if (!block_data) {
+        if (data.view) {
+            block_info.view = &*data.view;
+        } else {
+            block_info.data = &data.block;
+        }
+    }
+    if (CustomOptions().connect_undo_data) {
+        block_info.undo_data = &data.undo;
     }
 
     if (!CustomAppend(block_info)) {
@@ -198,16 +268,46 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
     return true;
 }
 
-void BaseIndex::Sync()
+bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+{
+    BlockData data;
+    if (auto res{PrepareBlock(pindex, block_data, data)}; !res) {
+        FatalErrorf("%s", res.error());
+        return false;
+    }
+    return AppendBlock(pindex, block_data, data);
+}
+
+void BaseIndex::Sync(int sync_threads)
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
+        /** A block whose data is being read and prepared on the sync thread pool. */
+        struct PendingBlock {
+            const CBlockIndex* pindex;
+            BlockData data;
+            std::future<util::Expected<void, std::string>> prepared;
+        };
+        // Blocks following pindex on the active chain, in chain order. The
+        // pool tasks hold references to these, which a deque does not
+        // invalidate when adding or removing elements at its ends. It is
+        // declared before the pool so that it outlives any running task.
+        std::deque<PendingBlock> pending;
+        ThreadPool pool{GetName()};
+        if (sync_threads > 0) pool.Start(sync_threads);
+        const auto discard_pending{[&] {
+            for (auto& pending_block : pending) pending_block.prepared.wait();
+            pending.clear();
+            CustomDiscardPrepared();
+        }};
+
         auto last_log_time{NodeClock::now()};
         auto last_locator_write_time{last_log_time};
         while (true) {
             if (m_interrupt) {
                 LogInfo("%s: m_interrupt set; exiting ThreadSync", GetName());
 
+                discard_pending();
                 SetBestBlockIndex(pindex);
                 // No need to handle errors in Commit. If it fails, the error will be already be
                 // logged. The best way to recover is to continue, as index cannot be corrupted by
@@ -216,6 +316,30 @@ void BaseIndex::Sync()
                 return;
             }
 
+            if (sync_threads > 0) {
+                // Keep the pool busy reading and preparing the blocks that
+                // follow the last pending one, up to the chain tip. Blocks
+                // after a fork are only scheduled once the index has been
+                // rewound to it below.
+                LOCK(cs_main);
+                const CBlockIndex* pindex_last{pending.empty() ? pindex : pending.back().pindex};
+                while (pending.size() < sync_threads * SYNC_BLOCKS_AHEAD_PER_THREAD) {
+                    const CBlockIndex* pindex_ahead{NextSyncBlock(pindex_last, m_chainstate->m_chain)};
+                    if (!pindex_ahead || pindex_ahead->pprev != pindex_last) break;
+                    auto& pending_block{pending.emplace_back(pindex_ahead)};
+                    auto task{pool.Submit([this, &pending_block]() -> util::Expected<void, std::string> {
+                        if (m_interrupt) return util::Unexpected{"interrupted"};
+                        return PrepareBlock(pending_block.pindex, /*block_data=*/nullptr, pending_block.data);
+                    })};
+                    if (!task) {
+                        pending.pop_back();
+                        break;
+                    }
+                    pending_block.prepared = std::move(*task);
+                    pindex_last = pindex_ahead;
+                }
+            }
+
             const CBlockIndex* pindex_next = WITH_LOCK(cs_main, return NextSyncBlock(pindex, m_chainstate->m_chain));
             // If pindex_next is null, it means pindex is the chain tip, so
             // commit data indexed so far.
@@ -236,14 +360,35 @@ void BaseIndex::Sync()
                     break;
                 }
             }
+            // Blocks read ahead are no longer on the active chain if it
+            // reorged in the meantime.
+            if (!pending.empty() && pending.front().pindex != pindex_next) {
+                discard_pending();
+            }
             if (pindex_next->pprev != pindex && !Rewind(pindex, pindex_next->pprev)) {
                 FatalErrorf("Failed to rewind %s to a previous chain tip", GetName());
                 return;
             }
-            pindex = pindex_next;
-
 
-            if (!ProcessBlock(pindex)) return; // error logged internally
+            if (pending.empty()) {
+                if (!ProcessBlock(pindex_next)) return; // error logged internally
+            } else {
+                PendingBlock& pending_block{pending.front()};
+                if (auto res{pending_block.prepared.get()}; !res) {
+                    // The task may have been skipped because m_interrupt was
+                    // set after the check above. Its future has been
+                    // consumed, so it must not be waited on again.
+                    if (m_interrupt) {
+                        pending.pop_front();
+                        continue;
+                    }
+                    FatalErrorf("%s", res.error());
+                    return;
+                }
+                if (!AppendBlock(pindex_next, /*block_data=*/nullptr, pending_block.data)) return; // error logged internally
+                pending.pop_front();
+            }
+            pindex = pindex_next;
 
             auto current_time{NodeClock::now()};
             if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
@@ -450,11 +595,11 @@ void BaseIndex::Interrupt()
     m_interrupt();
 }
 
-bool BaseIndex::StartBackgroundSync()
+bool BaseIndex::StartBackgroundSync(int sync_threads)
 {
     if (!m_init) throw std::logic_error("Error: Cannot start a non-initialized index");
 
-    m_thread_sync = std::thread(&util::TraceThread, GetName(), [this] { Sync(); });
+    m_thread_sync = std::thread(&util::TraceThread, GetName(), [this, sync_threads] { Sync(sync_threads); });
     return true;
 }
 
@@ -12,6 +12,7 @@
 #include <threadsafety.h>
 #include <uint256.h>
 #include <util/fs.h>
+#include <util/expected.h>
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
@@ -27,6 +28,12 @@ class CBlockIndex;
 class Chainstate;
 
 struct CBlockLocator;
+
+/** Default number of threads reading and preparing blocks ahead of an index during its initial sync */
+static constexpr int DEFAULT_INDEX_SYNC_THREADS{4};
+/** Maximum number of threads reading and preparing blocks ahead of an index during its initial sync */
+static constexpr int MAX_INDEX_SYNC_THREADS{16};
+
 struct IndexSummary {
     std::string name;
     bool synced{false};
@@ -108,6 +115,17 @@ private:
 
     bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
 
+    /// The data of a block that PrepareBlock read from disk.
+    struct BlockData;
+
+    /// Read the data of a block that the index needs from disk (the block
+    /// itself only if block_data is not provided) and call CustomPrepare. This
+    /// is safe to call for several blocks concurrently.
+    util::Expected<void, std::string> PrepareBlock(const CBlockIndex* pindex, const CBlock* block_data, BlockData& data);
+
+    /// Call CustomAppend for a block that PrepareBlock was called for.
+    bool AppendBlock(const CBlockIndex* pindex, const CBlock* block_data, const BlockData& data);
+
     virtual bool AllowPrune() const = 0;
 
     template <typename... Args>
@@ -125,9 +143,27 @@ protected:
     /// Initialize internal state from the database and block index.
     [[nodiscard]] virtual bool CustomInit(const std::optional<interfaces::BlockRef>& block) { return true; }
 
-    /// Write update index entries for a newly connected block.
+    /// Do the part of indexing a newly connected block that does not depend on
+    /// any other block having been appended to the index. This is called
+    /// before CustomAppend for every block. During the initial sync it may be
+    /// called out of order and concurrently for several blocks, and it may be
+    /// called for blocks that are then never appended if the chain reorgs or
+    /// the sync is interrupted.
+    [[nodiscard]] virtual bool CustomPrepare(const interfaces::BlockInfo& block) { return true; }
+
+    /// Discard any state that CustomPrepare kept for blocks that were not
+    /// appended, because the chain reorged or the sync was interrupted.
+    virtual void CustomDiscardPrepared() {}
+
+    /// Write update index entries for a newly connected block. This is called
+    /// for blocks in chain order.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Whether the index can work with a BlockView of blocks read from disk
+    /// instead of a deserialized CBlock. If so, CustomPrepare and CustomAppend
+    /// are passed BlockInfo::view rather than BlockInfo::data for such blocks.
+    virtual bool UsesBlockView() const { return false; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -165,14 +201,18 @@ public:
     [[nodiscard]] bool Init();
 
     /// Starts the initial sync process on a background thread.
-    [[nodiscard]] bool StartBackgroundSync();
+    [[nodiscard]] bool StartBackgroundSync(int sync_threads = DEFAULT_INDEX_SYNC_THREADS);
 
     /// Sync the index with the block index starting from the current best block.
     /// Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
     /// flag is set and the BlockConnected ValidationInterface callback takes
     /// over and the sync thread exits.
-    void Sync();
+    ///
+    /// Blocks are read from disk and passed to CustomPrepare ahead of the sync
+    /// thread on a pool of sync_threads threads, while CustomAppend and
+    /// commits happen on the sync thread in chain order.
+    void Sync(int sync_threads = DEFAULT_INDEX_SYNC_THREADS);
 
     /// Stops the instance from staying in sync with blockchain updates.
     void Stop();
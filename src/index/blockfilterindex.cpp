@@ -248,9 +248,32 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool BlockFilterIndex::CustomPrepare(const interfaces::BlockInfo& block)
 {
     BlockFilter filter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    LOCK(m_prepared_filters_mutex);
+    m_prepared_filters.insert_or_assign(block.height, std::move(filter));
+    return true;
+}
+
+void BlockFilterIndex::CustomDiscardPrepared()
+{
+    LOCK(m_prepared_filters_mutex);
+    m_prepared_filters.clear();
+}
+
+bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    std::optional<BlockFilter> prepared;
+    {
+        LOCK(m_prepared_filters_mutex);
+        auto node{m_prepared_filters.extract(block.height)};
+        if (node && node.mapped().GetBlockHash() == block.hash) prepared = std::move(node.mapped());
+        // Filters prepared for lower heights belong to blocks that were not
+        // appended because of a reorg.
+        m_prepared_filters.erase(m_prepared_filters.begin(), m_prepared_filters.lower_bound(block.height));
+    }
+    const BlockFilter filter{prepared ? std::move(*prepared) : BlockFilter(m_filter_type, *Assert(block.data), *Assert(block.undo_data))};
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
     if (res) m_last_header = header; // update last header
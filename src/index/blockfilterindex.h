@@ -6,6 +6,7 @@
 #define BITCOIN_INDEX_BLOCKFILTERINDEX_H
 
 #include <attributes.h>
+#include <blockfilter.h>
 #include <flatfile.h>
 #include <index/base.h>
 #include <interfaces/chain.h>
@@ -16,14 +17,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <unordered_map>
 #include <vector>
 
-class BlockFilter;
 class CBlockIndex;
-enum class BlockFilterType : uint8_t;
 
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
 
@@ -56,6 +56,10 @@ private:
     // Last computed header to avoid disk reads on every new block.
     uint256 m_last_header{};
 
+    Mutex m_prepared_filters_mutex;
+    /** Filters computed by CustomPrepare that have not been appended yet, by block height. */
+    std::map<int, BlockFilter> m_prepared_filters GUARDED_BY(m_prepared_filters_mutex);
+
     bool AllowPrune() const override { return true; }
 
     bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header);
@@ -67,7 +71,11 @@ protected:
 
     bool CustomCommit(CDBBatch& batch) override;
 
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    bool CustomPrepare(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex);
+
+    void CustomDiscardPrepared() override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex);
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex);
 
     bool CustomRemove(const interfaces::BlockInfo& block) override;
 
@@ -0,0 +1,250 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/scriptindex.h>
+
+#include <chain.h>
+#include <common/args.h>
+#include <compressor.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <kernel/cs_main.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <undo.h>
+#include <util/check.h>
+#include <util/fs.h>
+#include <util/strencodings.h>
+#include <validation.h>
+
+#include <array>
+#include <ios>
+#include <utility>
+
+/* The database has two kinds of entries.
+ * History entries are keyed by [DB_SCRIPT_HISTORY, sha256(scriptPubKey), height, tx index, io], with the
+ * numbers big-endian so that the entries of a script are sorted in chain order. The io of an output is its
+ * index, and the io of an input is its index with SPEND_FLAG set. The value is the txid and the amount, and
+ * for an input also the outpoint it spends.
+ * Spent entries are keyed by [DB_SPENT_OUTPOINT, outpoint] and hold the txid and height of the spending
+ * transaction, so that the outputs in a history can tell whether and where they were spent.
+ */
+
+constexpr uint8_t DB_SCRIPT_HISTORY{'h'};
+constexpr uint8_t DB_SPENT_OUTPOINT{'p'};
+
+std::unique_ptr<ScriptIndex> g_scriptindex;
+
+namespace {
+struct HistoryKey {
+    uint256 script_hash;
+    ScriptHistoryPosition pos;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_SCRIPT_HISTORY);
+        s << script_hash;
+        ser_writedata32be(s, pos.height);
+        ser_writedata32be(s, pos.tx_index);
+        ser_writedata32be(s, pos.io);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        if (ser_readdata8(s) != DB_SCRIPT_HISTORY) {
+            throw std::ios_base::failure("Invalid format for script index DB history key");
+        }
+        s >> script_hash;
+        pos.height = ser_readdata32be(s);
+        pos.tx_index = ser_readdata32be(s);
+        pos.io = ser_readdata32be(s);
+    }
+};
+
+struct OutputValue {
+    Txid txid;
+    CAmount amount{0};
+
+    SERIALIZE_METHODS(OutputValue, obj) { READWRITE(obj.txid, Using<AmountCompression>(obj.amount)); }
+};
+
+struct SpendValue {
+    Txid txid;
+    CAmount amount{0};
+    COutPoint prevout;
+
+    SERIALIZE_METHODS(SpendValue, obj) { READWRITE(obj.txid, Using<AmountCompression>(obj.amount), obj.prevout); }
+};
+
+struct SpentKey {
+    COutPoint outpoint;
+
+    SERIALIZE_METHODS(SpentKey, obj)
+    {
+        uint8_t prefix{DB_SPENT_OUTPOINT};
+        READWRITE(prefix);
+        if (prefix != DB_SPENT_OUTPOINT) {
+            throw std::ios_base::failure("Invalid format for script index DB spent key");
+        }
+        READWRITE(obj.outpoint);
+    }
+};
+
+uint256 ScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+} // namespace
+
+std::string ScriptHistoryPosition::ToHex() const
+{
+    std::array<unsigned char, 12> data;
+    WriteBE32(data.data(), height);
+    WriteBE32(data.data() + 4, tx_index);
+    WriteBE32(data.data() + 8, io);
+    return HexStr(data);
+}
+
+std::optional<ScriptHistoryPosition> ScriptHistoryPosition::FromHex(std::string_view hex)
+{
+    const auto data{TryParseHex<unsigned char>(hex)};
+    if (!data || data->size() != 12) return std::nullopt;
+    ScriptHistoryPosition pos;
+    pos.height = ReadBE32(data->data());
+    pos.tx_index = ReadBE32(data->data() + 4);
+    pos.io = ReadBE32(data->data() + 8);
+    if (pos.height < 0) return std::nullopt;
+    return pos;
+}
+
+ScriptIndex::ScriptIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "scriptindex"), m_db{std::make_unique<DB>(gArgs.GetDataDirNet() / "indexes" / "scriptindex" / "db", n_cache_size, f_memory, f_wipe)}
+{}
+
+interfaces::Chain::NotifyOptions ScriptIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    // The undo data has the scripts and amounts of the spent outputs.
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+void ScriptIndex::WriteBlock(const interfaces::BlockInfo& block, bool erase)
+{
+    CDBBatch batch(*m_db);
+    for (size_t i = 0; i < block.data->vtx.size(); ++i) {
+        const CTransaction& tx{*block.data->vtx[i]};
+        const Txid& txid{tx.GetHash()};
+        for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+            const CTxOut& out{tx.vout[j]};
+            // Outputs that can never be spent don't belong to anyone's history.
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            const HistoryKey key{ScriptHash(out.scriptPubKey), {block.height, uint32_t(i), j}};
+            if (erase) {
+                batch.Erase(key);
+            } else {
+                batch.Write(key, OutputValue{txid, out.nValue});
+            }
+        }
+
+        // The coinbase tx has no undo data since no former output is spent
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{Assert(block.undo_data)->vtxundo.at(i - 1)};
+        for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+            const COutPoint& prevout{tx.vin[j].prevout};
+            const Coin& coin{tx_undo.vprevout.at(j)};
+            const HistoryKey key{ScriptHash(coin.out.scriptPubKey), {block.height, uint32_t(i), j | ScriptHistoryPosition::SPEND_FLAG}};
+            if (erase) {
+                batch.Erase(key);
+                batch.Erase(SpentKey{prevout});
+            } else {
+                batch.Write(key, SpendValue{txid, coin.out.nValue, prevout});
+                batch.Write(SpentKey{prevout}, std::pair{txid, block.height});
+            }
+        }
+    }
+    m_db->WriteBatch(batch);
+}
+
+bool ScriptIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    WriteBlock(block, /*erase=*/false);
+    return true;
+}
+
+bool ScriptIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    WriteBlock(block, /*erase=*/true);
+    return true;
+}
+
+util::Expected<std::vector<ScriptHistoryEntry>, std::string> ScriptIndex::FindHistory(const CScript& script, const ScriptHistoryPosition& start,
+                                                                                       size_t max_entries, std::optional<ScriptHistoryPosition>& next) const
+{
+    next.reset();
+
+    // The entries of disconnected blocks, e.g. after invalidateblock, are only
+    // erased when the index is rewound, once a block of the other branch is
+    // connected. Leave out everything above the fork point of the active chain.
+    const uint256 best_block_hash{GetSummary().best_block_hash};
+    int max_height{-1};
+    {
+        LOCK(::cs_main);
+        if (const CBlockIndex* best_block{m_chainstate->m_blockman.LookupBlockIndex(best_block_hash)}) {
+            if (const CBlockIndex* fork{m_chainstate->m_chain.FindFork(best_block)}) max_height = fork->nHeight;
+        }
+    }
+
+    std::vector<ScriptHistoryEntry> entries;
+    const uint256 script_hash{ScriptHash(script)};
+    HistoryKey key{script_hash, start};
+    std::unique_ptr<CDBIterator> it(m_db->NewIterator());
+    for (it->Seek(key); it->Valid() && it->GetKey(key) && key.script_hash == script_hash && key.pos.height <= max_height; it->Next()) {
+        if (entries.size() == max_entries) {
+            next = key.pos;
+            break;
+        }
+        ScriptHistoryEntry& entry{entries.emplace_back()};
+        entry.pos = key.pos;
+        if (entry.IsSpend()) {
+            SpendValue value;
+            if (!it->GetValue(value)) {
+                LogError("Cannot read script index entry at height %d", key.pos.height);
+                return util::Unexpected{strprintf("IO error reading the history of script %s.", HexStr(script))};
+            }
+            entry.txid = value.txid;
+            entry.amount = value.amount;
+            entry.prevout = value.prevout;
+        } else {
+            OutputValue value;
+            if (!it->GetValue(value)) {
+                LogError("Cannot read script index entry at height %d", key.pos.height);
+                return util::Unexpected{strprintf("IO error reading the history of script %s.", HexStr(script))};
+            }
+            entry.txid = value.txid;
+            entry.amount = value.amount;
+            std::pair<Txid, int> spender;
+            if (m_db->Read(SpentKey{COutPoint{entry.txid, entry.Index()}}, spender) && spender.second <= max_height) {
+                entry.spent_by = spender;
+            }
+        }
+    }
+    return entries;
+}
+
+BaseIndex::DB& ScriptIndex::GetDB() const { return *m_db; }
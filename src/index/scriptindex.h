@@ -0,0 +1,100 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SCRIPTINDEX_H
+#define BITCOIN_INDEX_SCRIPTINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <uint256.h>
+#include <util/expected.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static constexpr bool DEFAULT_SCRIPTINDEX{false};
+
+/** Where an entry is in the history of a script, in the order of the chain. */
+struct ScriptHistoryPosition {
+    int height{0};
+    //! Position of the transaction in its block
+    uint32_t tx_index{0};
+    //! Index of the output, or of the input with SPEND_FLAG set
+    uint32_t io{0};
+
+    static constexpr uint32_t SPEND_FLAG{uint32_t{1} << 31};
+
+    /** Opaque representation, for paging through a history from an RPC or REST client. */
+    std::string ToHex() const;
+    static std::optional<ScriptHistoryPosition> FromHex(std::string_view hex);
+};
+
+/** An output paying to a script, or an input spending such an output. */
+struct ScriptHistoryEntry {
+    ScriptHistoryPosition pos;
+    Txid txid;
+    CAmount amount{0};
+    //! For an input, the output it spends
+    COutPoint prevout;
+    //! For an output, the transaction that spent it and its height, if it was spent
+    std::optional<std::pair<Txid, int>> spent_by;
+
+    bool IsSpend() const { return pos.io & ScriptHistoryPosition::SPEND_FLAG; }
+    uint32_t Index() const { return pos.io & ~ScriptHistoryPosition::SPEND_FLAG; }
+};
+
+/**
+ * ScriptIndex records the history of every script in the chain: the outputs
+ * that pay to it and the inputs that spend them. The history of a script is
+ * stored in order under keys that start with the hash of the script, so a
+ * page of it is read with a single range query. Each spent output is also
+ * recorded under its outpoint, to tell the transaction that spent it.
+ */
+class ScriptIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return false; }
+    void WriteBlock(const interfaces::BlockInfo& block, bool erase);
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    explicit ScriptIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /**
+     * Read the history of a script in chain order. Entries of blocks that are
+     * not in the active chain, and spends in them, are left out.
+     *
+     * @param[in] script       The scriptPubKey to look up.
+     * @param[in] start        The position to start at, e.g. the next position returned for the previous page.
+     * @param[in] max_entries  The maximum number of entries to return.
+     * @param[out] next        Set to the position of the next entry, if there are more than max_entries.
+     *
+     * @return  The entries, or util::Unexpected{error} if the database could not be read.
+     */
+    util::Expected<std::vector<ScriptHistoryEntry>, std::string> FindHistory(const CScript& script, const ScriptHistoryPosition& start,
+                                                                             size_t max_entries, std::optional<ScriptHistoryPosition>& next) const;
+};
+
+/// The global script index. May be null.
+extern std::unique_ptr<ScriptIndex> g_scriptindex;
+
+#endif // BITCOIN_INDEX_SCRIPTINDEX_H
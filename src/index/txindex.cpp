@@ -12,6 +12,7 @@
 #include <interfaces/chain.h>
 #include <node/blockstorage.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <streams.h>
@@ -21,9 +22,11 @@
 #include <validation.h>
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
+#include <optional>
 #include <span>
 #include <string>
 #include <utility>
@@ -72,20 +75,61 @@ TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size,
 
 TxIndex::~TxIndex() = default;
 
-bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+/** Compute the disk positions of the transactions of a block. */
+static std::vector<std::pair<Txid, CDiskTxPos>> ComputeTxPositions(const interfaces::BlockInfo& block)
+{
+    std::vector<std::pair<Txid, CDiskTxPos>> vPos;
+    if (block.view) {
+        // Unlike nTxOffset, the offsets in the block view include the header.
+        const size_t header_size{::GetSerializeSize(block.view->GetHeader())};
+        const std::vector<Txid> txids{block.view->ComputeTxids()};
+        vPos.reserve(txids.size());
+        for (size_t i{0}; i < txids.size(); ++i) {
+            vPos.emplace_back(txids[i], CDiskTxPos({block.file_number, block.data_pos}, block.view->Tx(i).Offset() - header_size));
+        }
+    } else {
+        assert(block.data);
+        CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
+        vPos.reserve(block.data->vtx.size());
+        for (const auto& tx : block.data->vtx) {
+            vPos.emplace_back(tx->GetHash(), pos);
+            pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
+        }
+    }
+    return vPos;
+}
+
+bool TxIndex::CustomPrepare(const interfaces::BlockInfo& block)
 {
     // Exclude genesis block transaction because outputs are not spendable.
     if (block.height == 0) return true;
 
-    assert(block.data);
-    CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
-    std::vector<std::pair<Txid, CDiskTxPos>> vPos;
-    vPos.reserve(block.data->vtx.size());
-    for (const auto& tx : block.data->vtx) {
-        vPos.emplace_back(tx->GetHash(), pos);
-        pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
+    PreparedTxs prepared{block.hash, ComputeTxPositions(block)};
+    LOCK(m_prepared_txs_mutex);
+    m_prepared_txs.insert_or_assign(block.height, std::move(prepared));
+    return true;
+}
+
+void TxIndex::CustomDiscardPrepared()
+{
+    LOCK(m_prepared_txs_mutex);
+    m_prepared_txs.clear();
+}
+
+bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    if (block.height == 0) return true;
+
+    std::optional<std::vector<std::pair<Txid, CDiskTxPos>>> positions;
+    {
+        LOCK(m_prepared_txs_mutex);
+        auto node{m_prepared_txs.extract(block.height)};
+        if (node && node.mapped().block_hash == block.hash) positions = std::move(node.mapped().positions);
+        // Positions prepared for lower heights belong to blocks that were not
+        // appended because of a reorg.
+        m_prepared_txs.erase(m_prepared_txs.begin(), m_prepared_txs.lower_bound(block.height));
     }
-    m_db->WriteTxs(vPos);
+    m_db->WriteTxs(positions ? *positions : ComputeTxPositions(block));
     return true;
 }
 
@@ -6,12 +6,17 @@
 #define BITCOIN_INDEX_TXINDEX_H
 
 #include <index/base.h>
+#include <index/disktxpos.h>
 #include <primitives/transaction.h>
+#include <sync.h>
+#include <uint256.h>
 
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
-class uint256;
 namespace interfaces {
 class Chain;
 }
@@ -31,10 +36,27 @@ protected:
 private:
     const std::unique_ptr<DB> m_db;
 
+    /** Transaction positions of a block computed by CustomPrepare. */
+    struct PreparedTxs {
+        uint256 block_hash;
+        std::vector<std::pair<Txid, CDiskTxPos>> positions;
+    };
+    Mutex m_prepared_txs_mutex;
+    /** Transaction positions computed by CustomPrepare that have not been appended yet, by block height. */
+    std::map<int, PreparedTxs> m_prepared_txs GUARDED_BY(m_prepared_txs_mutex);
+
     bool AllowPrune() const override { return false; }
 
 protected:
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    // Transaction positions do not depend on other blocks, so they are
+    // computed in CustomPrepare and written in CustomAppend.
+    bool CustomPrepare(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_txs_mutex);
+
+    void CustomDiscardPrepared() override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_txs_mutex);
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_txs_mutex);
+
+    bool UsesBlockView() const override { return true; }
 
     BaseIndex::DB& GetDB() const override;
 
@@ -0,0 +1,174 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/utxoscriptindex.h>
+
+#include <coins.h>
+#include <common/args.h>
+#include <crypto/siphash.h>
+#include <dbwrapper.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <undo.h>
+#include <util/check.h>
+#include <util/fs.h>
+
+#include <ios>
+#include <span>
+#include <utility>
+
+/* The database holds a copy of the UTXO set. Every coin is stored under the key
+ * [DB_UTXO, siphash(scriptPubKey), outpoint], so the coins of a script are read
+ * with a range query on the first two parts, and the coins of other scripts with
+ * the same hash are told apart by their scriptPubKey.
+ * The block whose UTXO set the database holds is written under DB_UTXO_TIP in the
+ * same batch as the coins, so that a reader always sees them together.
+ */
+
+constexpr uint8_t DB_UTXO{'c'};
+constexpr uint8_t DB_UTXO_TIP{'T'};
+
+std::unique_ptr<UtxoScriptIndex> g_utxoscriptindex;
+
+namespace {
+struct DBKey {
+    uint64_t script_hash;
+    COutPoint outpoint;
+
+    SERIALIZE_METHODS(DBKey, obj)
+    {
+        uint8_t prefix{DB_UTXO};
+        READWRITE(prefix);
+        if (prefix != DB_UTXO) {
+            throw std::ios_base::failure("Invalid format for UTXO script index DB key");
+        }
+        READWRITE(obj.script_hash, obj.outpoint);
+    }
+};
+} // namespace
+
+static uint64_t ScriptHash(std::pair<uint64_t, uint64_t> siphash_key, const CScript& script)
+{
+    return CSipHasher(siphash_key.first, siphash_key.second).Write(std::span{script.data(), script.size()}).Finalize();
+}
+
+UtxoScriptIndex::UtxoScriptIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "utxoscriptindex"), m_db{std::make_unique<DB>(gArgs.GetDataDirNet() / "indexes" / "utxoscriptindex" / "db", n_cache_size, f_memory, f_wipe)}
+{
+    if (!m_db->Read("siphash_key", m_siphash_key)) {
+        FastRandomContext rng(false);
+        m_siphash_key = {rng.rand64(), rng.rand64()};
+        m_db->Write("siphash_key", m_siphash_key, /*fSync=*/ true);
+    }
+}
+
+interfaces::Chain::NotifyOptions UtxoScriptIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    // The undo data has the scripts of the spent coins, and the coins to restore on disconnect.
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+void UtxoScriptIndex::WriteBlock(const interfaces::BlockInfo& block, bool erase)
+{
+    CDBBatch batch(*m_db);
+    // The outputs of the genesis block are not part of the UTXO set.
+    if (block.height > 0) {
+        const auto& vtx{block.data->vtx};
+        for (size_t n = 0; n < vtx.size(); ++n) {
+            // Undo the transactions in reverse order, so that an output spent in the
+            // same block is restored by its spender before its creation is undone.
+            const size_t i{erase ? vtx.size() - 1 - n : n};
+            const CTransaction& tx{*vtx[i]};
+            for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+                const CTxOut& out{tx.vout[j]};
+                // Like the chainstate, leave out the outputs that can never be spent.
+                if (out.scriptPubKey.IsUnspendable()) continue;
+                const DBKey key{ScriptHash(m_siphash_key, out.scriptPubKey), COutPoint{tx.GetHash(), j}};
+                if (erase) {
+                    batch.Erase(key);
+                } else {
+                    batch.Write(key, Coin{out, block.height, tx.IsCoinBase()});
+                }
+            }
+
+            // The coinbase tx has no undo data since no former output is spent
+            if (tx.IsCoinBase()) continue;
+            const CTxUndo& tx_undo{Assert(block.undo_data)->vtxundo.at(i - 1)};
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin& coin{tx_undo.vprevout.at(j)};
+                const DBKey key{ScriptHash(m_siphash_key, coin.out.scriptPubKey), tx.vin[j].prevout};
+                if (erase) {
+                    batch.Write(key, coin);
+                } else {
+                    batch.Erase(key);
+                }
+            }
+        }
+    }
+
+    if (erase) {
+        batch.Write(DB_UTXO_TIP, std::pair{*Assert(block.prev_hash), block.height - 1});
+    } else {
+        batch.Write(DB_UTXO_TIP, std::pair{block.hash, block.height});
+    }
+    m_db->WriteBatch(batch);
+}
+
+bool UtxoScriptIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    WriteBlock(block, /*erase=*/false);
+    return true;
+}
+
+bool UtxoScriptIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    WriteBlock(block, /*erase=*/true);
+    return true;
+}
+
+util::Expected<UtxoScriptScan, std::string> UtxoScriptIndex::FindCoins(const std::set<CScript>& scripts) const
+{
+    UtxoScriptScan result;
+    // A LevelDB iterator reads a snapshot of the database taken when it is
+    // created, so all the lookups below see the UTXO set of the same block.
+    std::unique_ptr<CDBIterator> it(m_db->NewIterator());
+
+    std::pair<uint256, int> tip;
+    uint8_t tip_key;
+    it->Seek(DB_UTXO_TIP);
+    if (!it->Valid() || !it->GetKey(tip_key) || tip_key != DB_UTXO_TIP || !it->GetValue(tip)) {
+        return util::Unexpected{std::string{"The UTXO script index has not indexed any block yet."}};
+    }
+    result.block = {tip.first, tip.second};
+
+    for (const CScript& script : scripts) {
+        const uint64_t script_hash{ScriptHash(m_siphash_key, script)};
+        DBKey key;
+        // Seek to the first key that starts with [DB_UTXO, script_hash].
+        for (it->Seek(std::pair{DB_UTXO, script_hash}); it->Valid() && it->GetKey(key) && key.script_hash == script_hash; it->Next()) {
+            ++result.entries_read;
+            Coin coin;
+            if (!it->GetValue(coin)) {
+                LogError("Cannot read UTXO script index entry for %s", key.outpoint.ToString());
+                return util::Unexpected{std::string{"IO error reading the UTXO script index."}};
+            }
+            if (coin.out.scriptPubKey == script) {
+                result.coins.emplace(key.outpoint, std::move(coin));
+            }
+        }
+    }
+    return result;
+}
+
+BaseIndex::DB& UtxoScriptIndex::GetDB() const { return *m_db; }
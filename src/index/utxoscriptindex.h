@@ -0,0 +1,78 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_UTXOSCRIPTINDEX_H
+#define BITCOIN_INDEX_UTXOSCRIPTINDEX_H
+
+#include <coins.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <interfaces/types.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <util/expected.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+static constexpr bool DEFAULT_UTXOSCRIPTINDEX{false};
+
+/** The unspent outputs found for a set of scripts. */
+struct UtxoScriptScan {
+    //! The block whose UTXO set was searched
+    interfaces::BlockRef block;
+    //! Number of index entries read, including the ones of other scripts with the same short hash
+    int64_t entries_read{0};
+    std::map<COutPoint, Coin> coins;
+};
+
+/**
+ * UtxoScriptIndex keeps a copy of the UTXO set keyed by a short hash of the
+ * scriptPubKey of each coin, so that the unspent outputs of a set of scripts
+ * are found with one range query per script instead of a scan of the whole
+ * chainstate. It is updated as blocks are connected and disconnected.
+ */
+class UtxoScriptIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+    std::pair<uint64_t, uint64_t> m_siphash_key;
+
+    bool AllowPrune() const override { return true; }
+    void WriteBlock(const interfaces::BlockInfo& block, bool erase);
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    explicit UtxoScriptIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /**
+     * Find the unspent outputs paying to any of the given scripts. All lookups
+     * read the same snapshot of the database, so the result is the UTXO set
+     * of a single block even while the index is being updated.
+     *
+     * @param[in] scripts  The scriptPubKeys to look up.
+     *
+     * @return  The matching coins and the block they are unspent at, or
+     *          util::Unexpected{error} if the database could not be read.
+     */
+    util::Expected<UtxoScriptScan, std::string> FindCoins(const std::set<CScript>& scripts) const;
+};
+
+/// The global UTXO script index. May be null.
+extern std::unique_ptr<UtxoScriptIndex> g_utxoscriptindex;
+
+#endif // BITCOIN_INDEX_UTXOSCRIPTINDEX_H
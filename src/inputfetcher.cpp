@@ -0,0 +1,52 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <inputfetcher.h>
+
+#include <primitives/block.h>
+#include <util/hasher.h>
+
+#include <ranges>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+InputFetcher::InputFetcher(unsigned int batch_size, int worker_threads_num)
+    : m_queue{batch_size, worker_threads_num, "inputfetch"}
+{
+}
+
+void InputFetcher::FetchInputs(CoinsViewOverlay& cache, const CCoinsView& base, const CBlock& block)
+{
+    if (!HasThreads() || block.vtx.size() <= 1) return;
+
+    // Outputs created within the block are not in the base view yet.
+    std::unordered_set<Txid, SaltedTxidHasher> block_txids;
+    block_txids.reserve(block.vtx.size());
+    for (const auto& tx : block.vtx) block_txids.insert(tx->GetHash());
+
+    std::vector<COutPoint> outpoints;
+    for (const auto& tx : block.vtx | std::views::drop(1)) {
+        for (const auto& in : tx->vin) {
+            if (block_txids.contains(in.prevout.hash) || cache.HaveCoinInCache(in.prevout)) continue;
+            outpoints.push_back(in.prevout);
+        }
+    }
+    if (outpoints.empty()) return;
+
+    std::vector<std::optional<Coin>> coins(outpoints.size());
+    std::vector<FetchJob> jobs;
+    jobs.reserve(outpoints.size());
+    for (size_t i{0}; i < outpoints.size(); ++i) {
+        jobs.emplace_back(base, outpoints[i], coins[i]);
+    }
+
+    CCheckQueueControl<FetchJob> control{m_queue};
+    control.Add(std::move(jobs));
+    control.Complete();
+
+    for (size_t i{0}; i < outpoints.size(); ++i) {
+        if (coins[i]) cache.WarmCoin(outpoints[i], std::move(*coins[i]));
+    }
+}
@@ -0,0 +1,78 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INPUTFETCHER_H
+#define BITCOIN_INPUTFETCHER_H
+
+#include <attributes.h>
+#include <checkqueue.h>
+#include <coins.h>
+#include <primitives/transaction.h>
+
+#include <optional>
+
+class CBlock;
+
+/** Maximum number of threads that prefetch block inputs. Lookups are mostly waiting
+ *  on the database, and they never run at the same time as the script checks of
+ *  the same block, so a few threads are enough. */
+static constexpr int MAX_INPUT_FETCH_THREADS{4};
+
+/**
+ * Warms a CoinsViewOverlay with the coins spent by a block before the block
+ * is connected.
+ *
+ * Without prefetching, ConnectBlock() looks up every prevout serially, and each
+ * cache miss turns into a blocking database read. The InputFetcher instead
+ * collects all prevouts that are not created within the block itself and looks
+ * them up on a pool of worker threads using PeekCoin(), so the lower cache
+ * layers are not mutated. The results are then inserted into the overlay as
+ * clean entries, where the serial input loop finds them in memory.
+ *
+ * Lookups on the base view run concurrently without holding any lock. This is
+ * only safe because the caller holds cs_main and does not modify any layer of
+ * the coins view hierarchy until FetchInputs() returns.
+ */
+class InputFetcher
+{
+private:
+    /** Look up a single outpoint in the base view and store the result. */
+    class FetchJob
+    {
+    private:
+        const CCoinsView* m_base;
+        const COutPoint* m_outpoint;
+        std::optional<Coin>* m_result;
+
+    public:
+        FetchJob(const CCoinsView& base LIFETIMEBOUND, const COutPoint& outpoint LIFETIMEBOUND, std::optional<Coin>& result LIFETIMEBOUND)
+            : m_base{&base}, m_outpoint{&outpoint}, m_result{&result} {}
+
+        //! Never fails; a missing coin is reported to ConnectBlock() by the serial lookup.
+        std::optional<bool> operator()()
+        {
+            *m_result = m_base->PeekCoin(*m_outpoint);
+            return std::nullopt;
+        }
+    };
+
+    CCheckQueue<FetchJob> m_queue;
+
+public:
+    explicit InputFetcher(unsigned int batch_size, int worker_threads_num);
+
+    bool HasThreads() const { return m_queue.HasThreads(); }
+
+    /**
+     * Fetch the coins spent by block from base and add them to cache.
+     * Does nothing if no worker threads are configured.
+     *
+     * @param[in,out] cache  The (empty) overlay that will be passed to ConnectBlock().
+     * @param[in]     base   The view the overlay is layered on.
+     * @param[in]     block  The block about to be connected.
+     */
+    void FetchInputs(CoinsViewOverlay& cache, const CCoinsView& base, const CBlock& block);
+};
+
+#endif // BITCOIN_INPUTFETCHER_H
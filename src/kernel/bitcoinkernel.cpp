@@ -20,6 +20,7 @@
 #include <node/blockstorage.h>
 #include <node/chainstate.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <script/interpreter.h>
 #include <script/script.h>
@@ -43,6 +44,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <span>
 #include <stdexcept>
 #include <string>
@@ -475,6 +477,23 @@ struct ChainMan {
         : m_chainman(std::move(chainman)), m_context(std::move(context)) {}
 };
 
+struct CoinsCursor {
+    //! Keeps the coins database the cursor iterates over alive, declared
+    //! first so that it is released after the cursor
+    std::shared_ptr<const CCoinsViewSharded> m_coins_views;
+    std::unique_ptr<CCoinsViewCursor> m_cursor;
+    //! The block the coins database was at when the cursor was created
+    const CBlockIndex* m_tip;
+};
+
+//! A block view together with the serialized block it refers to
+struct OwnedBlockView {
+    const std::vector<std::byte> m_data;
+    const BlockView m_view;
+
+    explicit OwnedBlockView(std::vector<std::byte>&& data) : m_data{std::move(data)}, m_view{m_data} {}
+};
+
 } // namespace
 
 struct btck_Transaction : Handle<btck_Transaction, std::shared_ptr<const CTransaction>> {};
@@ -496,6 +515,8 @@ struct btck_TransactionOutPoint: Handle<btck_TransactionOutPoint, COutPoint> {};
 struct btck_Txid: Handle<btck_Txid, Txid> {};
 struct btck_PrecomputedTransactionData : Handle<btck_PrecomputedTransactionData, PrecomputedTransactionData> {};
 struct btck_BlockHeader: Handle<btck_BlockHeader, CBlockHeader> {};
+struct btck_CoinsCursor : Handle<btck_CoinsCursor, CoinsCursor> {};
+struct btck_BlockView : Handle<btck_BlockView, OwnedBlockView> {};
 
 btck_Transaction* btck_transaction_create(const void* raw_transaction, size_t raw_transaction_len)
 {
@@ -697,6 +718,11 @@ void btck_transaction_input_destroy(btck_TransactionInput* input)
     delete input;
 }
 
+btck_TransactionOutPoint* btck_transaction_out_point_create(const btck_Txid* txid, uint32_t index)
+{
+    return btck_TransactionOutPoint::create(btck_Txid::get(txid), index);
+}
+
 btck_TransactionOutPoint* btck_transaction_out_point_copy(const btck_TransactionOutPoint* out_point)
 {
     return btck_TransactionOutPoint::copy(out_point);
@@ -1050,6 +1076,106 @@ const btck_BlockTreeEntry* btck_chainstate_manager_get_best_entry(const btck_Cha
     return btck_BlockTreeEntry::ref(WITH_LOCK(chainman.GetMutex(), return chainman.m_best_header));
 }
 
+btck_Coin* btck_chainstate_manager_get_coin(const btck_ChainstateManager* chainman, const btck_TransactionOutPoint* out_point)
+{
+    btck_Coin* coin{nullptr};
+    if (btck_chainstate_manager_get_coins(chainman, &out_point, 1, &coin) != 0) return nullptr;
+    return coin;
+}
+
+int btck_chainstate_manager_get_coins(const btck_ChainstateManager* chainman, const btck_TransactionOutPoint* const* out_points, size_t out_points_len, btck_Coin** coins)
+{
+    try {
+        auto& chainman_ref{*btck_ChainstateManager::get(chainman).m_chainman};
+        std::vector<COutPoint> outpoints;
+        outpoints.reserve(out_points_len);
+        for (size_t i{0}; i < out_points_len; ++i) {
+            outpoints.push_back(btck_TransactionOutPoint::get(out_points[i]));
+        }
+
+        // Look the coins up without holding cs_main, if possible.
+        std::vector<std::optional<Coin>> found;
+        const auto shared_view{WITH_LOCK(chainman_ref.GetMutex(), return chainman_ref.ActiveChainstate().CoinsShared())};
+        if (!shared_view->GetCoins(outpoints, found)) {
+            LOCK(chainman_ref.GetMutex());
+            const CCoinsViewCache& coins_tip{chainman_ref.ActiveChainstate().CoinsTip()};
+            found.clear();
+            found.reserve(outpoints.size());
+            for (const COutPoint& outpoint : outpoints) {
+                found.push_back(coins_tip.PeekCoin(outpoint));
+            }
+        }
+
+        std::vector<std::unique_ptr<btck_Coin>> results;
+        results.reserve(found.size());
+        for (auto& coin : found) {
+            results.emplace_back(coin ? btck_Coin::create(std::move(*coin)) : nullptr);
+        }
+        for (size_t i{0}; i < results.size(); ++i) {
+            coins[i] = results[i].release();
+        }
+    } catch (const std::exception& e) {
+        LogError("Failed to look up coins: %s", e.what());
+        return -1;
+    }
+    return 0;
+}
+
+btck_CoinsCursor* btck_chainstate_manager_coins_cursor_create(const btck_ChainstateManager* chainman)
+{
+    try {
+        auto& chainman_ref{*btck_ChainstateManager::get(chainman).m_chainman};
+        LOCK(chainman_ref.GetMutex());
+        Chainstate& chainstate{chainman_ref.ActiveChainstate()};
+        // Flush the coins cache, so that the coins database, which leveldb
+        // iterates over a snapshot of, reflects the chain tip.
+        chainstate.ForceFlushStateToDisk(/*wipe_cache=*/false);
+        const CBlockIndex* tip{chainman_ref.m_blockman.LookupBlockIndex(chainstate.CoinsDB().GetBestBlock())};
+        if (!tip) {
+            LogError("Failed to find the best block of the coins database.");
+            return nullptr;
+        }
+        return btck_CoinsCursor::create(chainstate.CoinsShared(), chainstate.CoinsDB().Cursor(), tip);
+    } catch (const std::exception& e) {
+        LogError("Failed to create coins cursor: %s", e.what());
+        return nullptr;
+    }
+}
+
+const btck_BlockTreeEntry* btck_coins_cursor_get_block_tree_entry(const btck_CoinsCursor* coins_cursor)
+{
+    return btck_BlockTreeEntry::ref(btck_CoinsCursor::get(coins_cursor).m_tip);
+}
+
+int btck_coins_cursor_next(btck_CoinsCursor* coins_cursor, btck_TransactionOutPoint** out_points, btck_Coin** coins, size_t max_coins, size_t* coins_read)
+{
+    auto& cursor{*btck_CoinsCursor::get(coins_cursor).m_cursor};
+    *coins_read = 0;
+    try {
+        for (; *coins_read < max_coins && cursor.Valid(); cursor.Next()) {
+            COutPoint outpoint;
+            Coin coin;
+            if (!cursor.GetKey(outpoint) || !cursor.GetValue(coin)) {
+                LogError("Unable to read the UTXO set.");
+                return -1;
+            }
+            std::unique_ptr<btck_TransactionOutPoint> out_point{btck_TransactionOutPoint::create(outpoint)};
+            coins[*coins_read] = btck_Coin::create(std::move(coin));
+            out_points[*coins_read] = out_point.release();
+            ++*coins_read;
+        }
+    } catch (const std::exception& e) {
+        LogError("Failed to read the UTXO set: %s", e.what());
+        return -1;
+    }
+    return 0;
+}
+
+void btck_coins_cursor_destroy(btck_CoinsCursor* coins_cursor)
+{
+    delete coins_cursor;
+}
+
 void btck_chainstate_manager_destroy(btck_ChainstateManager* chainman)
 {
     {
@@ -1157,6 +1283,113 @@ btck_Block* btck_block_read(const btck_ChainstateManager* chainman, const btck_B
     return btck_Block::create(block);
 }
 
+btck_BlockView* btck_block_view_read(const btck_ChainstateManager* chainman, const btck_BlockTreeEntry* entry)
+{
+    const auto& blockman{btck_ChainstateManager::get(chainman).m_chainman->m_blockman};
+    const CBlockIndex& index{btck_BlockTreeEntry::get(entry)};
+    auto data{blockman.ReadRawBlock(WITH_LOCK(::cs_main, return index.GetBlockPos()))};
+    if (!data) {
+        LogError("Failed to read block.");
+        return nullptr;
+    }
+    try {
+        auto block_view{btck_BlockView::create(std::move(*data))};
+        if (btck_BlockView::get(block_view).m_view.GetHash() != index.GetBlockHash()) {
+            btck_block_view_destroy(block_view);
+            LogError("Block read from disk does not match the block tree entry.");
+            return nullptr;
+        }
+        return block_view;
+    } catch (const std::exception& e) {
+        LogError("Failed to parse block: %s", e.what());
+        return nullptr;
+    }
+}
+
+btck_BlockView* btck_block_view_create(const void* raw_block, size_t raw_block_length)
+{
+    if (raw_block == nullptr && raw_block_length != 0) {
+        return nullptr;
+    }
+    const auto begin{reinterpret_cast<const std::byte*>(raw_block)};
+    try {
+        return btck_BlockView::create(std::vector<std::byte>(begin, begin + raw_block_length));
+    } catch (...) {
+        LogDebug(BCLog::KERNEL, "Block decode failed.");
+        return nullptr;
+    }
+}
+
+size_t btck_block_view_count_transactions(const btck_BlockView* block_view)
+{
+    return btck_BlockView::get(block_view).m_view.TxCount();
+}
+
+btck_BlockHeader* btck_block_view_get_header(const btck_BlockView* block_view)
+{
+    return btck_BlockHeader::create(btck_BlockView::get(block_view).m_view.GetHeader());
+}
+
+btck_BlockHash* btck_block_view_get_hash(const btck_BlockView* block_view)
+{
+    return btck_BlockHash::create(btck_BlockView::get(block_view).m_view.GetHash());
+}
+
+static TxView GetTxView(const btck_BlockView* block_view, size_t transaction_index)
+{
+    const BlockView& view{btck_BlockView::get(block_view).m_view};
+    assert(transaction_index < view.TxCount());
+    return view.Tx(transaction_index);
+}
+
+btck_Txid* btck_block_view_get_txid_at(const btck_BlockView* block_view, size_t transaction_index)
+{
+    return btck_Txid::create(GetTxView(block_view, transaction_index).ComputeHash());
+}
+
+btck_Transaction* btck_block_view_get_transaction_at(const btck_BlockView* block_view, size_t transaction_index)
+{
+    return btck_Transaction::create(GetTxView(block_view, transaction_index).ToTransaction());
+}
+
+size_t btck_block_view_count_transaction_inputs(const btck_BlockView* block_view, size_t transaction_index)
+{
+    return GetTxView(block_view, transaction_index).InputCount();
+}
+
+btck_TransactionOutPoint* btck_block_view_get_transaction_input_out_point(const btck_BlockView* block_view, size_t transaction_index, size_t input_index)
+{
+    const TxView tx{GetTxView(block_view, transaction_index)};
+    assert(input_index < tx.InputCount());
+    return btck_TransactionOutPoint::create(tx.Input(input_index).prevout());
+}
+
+size_t btck_block_view_count_transaction_outputs(const btck_BlockView* block_view, size_t transaction_index)
+{
+    return GetTxView(block_view, transaction_index).OutputCount();
+}
+
+int64_t btck_block_view_get_transaction_output_amount(const btck_BlockView* block_view, size_t transaction_index, size_t output_index)
+{
+    const TxView tx{GetTxView(block_view, transaction_index)};
+    assert(output_index < tx.OutputCount());
+    return tx.Output(output_index).nValue();
+}
+
+const unsigned char* btck_block_view_get_transaction_output_script_pubkey(const btck_BlockView* block_view, size_t transaction_index, size_t output_index, size_t* script_pubkey_len)
+{
+    const TxView tx{GetTxView(block_view, transaction_index)};
+    assert(output_index < tx.OutputCount());
+    const auto script_pubkey{tx.Output(output_index).scriptPubKey()};
+    *script_pubkey_len = script_pubkey.size();
+    return UCharCast(script_pubkey.data());
+}
+
+void btck_block_view_destroy(btck_BlockView* block_view)
+{
+    delete block_view;
+}
+
 btck_BlockHeader* btck_block_tree_entry_get_block_header(const btck_BlockTreeEntry* entry)
 {
     return btck_BlockHeader::create(btck_BlockTreeEntry::get(entry).GetBlockHeader());
@@ -1298,6 +1531,33 @@ int btck_chainstate_manager_process_block(
     return result ? 0 : -1;
 }
 
+int btck_chainstate_manager_process_blocks(
+    btck_ChainstateManager* chainman,
+    const void* const* raw_blocks, const size_t* raw_block_lens,
+    size_t raw_blocks_len,
+    int* _new_blocks)
+{
+    try {
+        std::vector<std::span<const std::byte>> blocks;
+        blocks.reserve(raw_blocks_len);
+        for (size_t i{0}; i < raw_blocks_len; ++i) {
+            blocks.emplace_back(reinterpret_cast<const std::byte*>(raw_blocks[i]), raw_block_lens[i]);
+        }
+        auto& chainman_ref{*btck_ChainstateManager::get(chainman).m_chainman};
+        std::vector<bool> new_blocks;
+        const bool result{node::ProcessRawBlocks(chainman_ref, blocks, chainman_ref.m_options.worker_threads_num, new_blocks)};
+        if (_new_blocks) {
+            for (size_t i{0}; i < new_blocks.size(); ++i) {
+                _new_blocks[i] = new_blocks[i] ? 1 : 0;
+            }
+        }
+        return result ? 0 : -1;
+    } catch (const std::exception& e) {
+        LogError("Failed to process blocks: %s", e.what());
+        return -1;
+    }
+}
+
 int btck_chainstate_manager_process_block_header(
     btck_ChainstateManager* chainstate_manager,
     const btck_BlockHeader* header,
@@ -304,6 +304,26 @@ typedef struct btck_Txid btck_Txid;
  */
 typedef struct btck_BlockHeader btck_BlockHeader;
 
+/**
+ * Opaque data structure for iterating over the UTXO set.
+ *
+ * Created through @ref btck_chainstate_manager_coins_cursor_create. It reads
+ * from a snapshot of the coins database taken when it was created, so the
+ * coins it returns are not affected by blocks processed afterwards. It must
+ * be destroyed before the chainstate manager it was created from.
+ */
+typedef struct btck_CoinsCursor btck_CoinsCursor;
+
+/**
+ * Opaque data structure for holding a serialized block that is parsed in place.
+ *
+ * Unlike a @ref btck_Block, it does not deserialize every transaction into its
+ * own objects. Instead, the accessors read the fields of the transactions from
+ * the serialized block, which makes it cheaper to create for callers that only
+ * look at some of them, like the txids or the outputs.
+ */
+typedef struct btck_BlockView btck_BlockView;
+
 /** Current sync state passed to tip changed callbacks. */
 typedef uint8_t btck_SynchronizationState;
 #define btck_SynchronizationState_INIT_REINDEX ((btck_SynchronizationState)(0))
@@ -1163,6 +1183,31 @@ BITCOINKERNEL_API int BITCOINKERNEL_WARN_UNUSED_RESULT btck_chainstate_manager_p
     const btck_Block* block,
     int* new_block) BITCOINKERNEL_ARG_NONNULL(1, 2, 3);
 
+/**
+ * @brief Process and validate a batch of serialized blocks with the chainstate
+ * manager. The blocks are deserialized and checked in parallel on as many
+ * threads as configured with @ref btck_chainstate_manager_options_set_worker_threads_num,
+ * and then processed in the order given, as if each had been passed to
+ * @ref btck_chainstate_manager_process_block. This is faster than creating
+ * and processing the blocks one by one.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @param[in] raw_blocks         Array of serialized blocks. Non-null, unless raw_blocks_len is 0.
+ * @param[in] raw_block_lens     Array containing the lengths of each of the serialized blocks. Non-null,
+ *                               unless raw_blocks_len is 0.
+ * @param[in] raw_blocks_len     Length of the raw_blocks and raw_block_lens arrays. May be 0, in which
+ *                               case nothing is processed.
+ * @param[out] new_blocks        Nullable, array of length raw_blocks_len. Each entry is set to 1 if the
+ *                               corresponding block was not processed before, see
+ *                               @ref btck_chainstate_manager_process_block.
+ * @return                       0 if all blocks could be deserialized and their processing was successful.
+ */
+BITCOINKERNEL_API int BITCOINKERNEL_WARN_UNUSED_RESULT btck_chainstate_manager_process_blocks(
+    btck_ChainstateManager* chainstate_manager,
+    const void* const* raw_blocks, const size_t* raw_block_lens,
+    size_t raw_blocks_len,
+    int* new_blocks) BITCOINKERNEL_ARG_NONNULL(1);
+
 /**
  * @brief Returns the best known currently active chain. Its lifetime is
  * dependent on the chainstate manager. It can be thought of as a view on a
@@ -1192,6 +1237,50 @@ BITCOINKERNEL_API const btck_BlockTreeEntry* BITCOINKERNEL_WARN_UNUSED_RESULT bt
     const btck_ChainstateManager* chainstate_manager,
     const btck_BlockHash* block_hash) BITCOINKERNEL_ARG_NONNULL(1, 2);
 
+/**
+ * @brief Look up an unspent coin in the UTXO set of the active chainstate.
+ * Safe to call concurrently with block processing.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @param[in] out_point          Non-null, the out point of the coin.
+ * @return                       The coin, or null if the out point is spent, does not
+ *                               exist, or the lookup failed.
+ */
+BITCOINKERNEL_API btck_Coin* BITCOINKERNEL_WARN_UNUSED_RESULT btck_chainstate_manager_get_coin(
+    const btck_ChainstateManager* chainstate_manager,
+    const btck_TransactionOutPoint* out_point) BITCOINKERNEL_ARG_NONNULL(1, 2);
+
+/**
+ * @brief Look up a batch of unspent coins in the UTXO set of the active
+ * chainstate. All coins are looked up against the same chain tip. Safe to
+ * call concurrently with block processing.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @param[in] out_points         Non-null, array of out_points_len out points.
+ * @param[in] out_points_len     Number of out points to look up.
+ * @param[out] coins             Non-null, array of out_points_len entries. Each entry is
+ *                               set to the owned coin of the out point at the same
+ *                               position, or to null if that out point is spent or does
+ *                               not exist.
+ * @return                       0 if the lookup was successful, non-zero otherwise. The
+ *                               coins array is left untouched on error.
+ */
+BITCOINKERNEL_API int BITCOINKERNEL_WARN_UNUSED_RESULT btck_chainstate_manager_get_coins(
+    const btck_ChainstateManager* chainstate_manager,
+    const btck_TransactionOutPoint* const* out_points,
+    size_t out_points_len,
+    btck_Coin** coins) BITCOINKERNEL_ARG_NONNULL(1, 2, 4);
+
+/**
+ * @brief Create a cursor over the UTXO set of the active chainstate, as of its
+ * current tip. This flushes the coins cache to the coins database first.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @return                       The coins cursor, or null on error.
+ */
+BITCOINKERNEL_API btck_CoinsCursor* BITCOINKERNEL_WARN_UNUSED_RESULT btck_chainstate_manager_coins_cursor_create(
+    const btck_ChainstateManager* chainstate_manager) BITCOINKERNEL_ARG_NONNULL(1);
+
 /**
  * Destroy the chainstate manager.
  */
@@ -1199,6 +1288,50 @@ BITCOINKERNEL_API void btck_chainstate_manager_destroy(btck_ChainstateManager* c
 
 ///@}
 
+/** @name CoinsCursor
+ * Functions for iterating over the UTXO set.
+ */
+///@{
+
+/**
+ * @brief Get the block tree entry of the chain tip the UTXO set iterated over
+ * by the cursor corresponds to.
+ *
+ * @param[in] coins_cursor Non-null.
+ * @return                 The block tree entry.
+ */
+BITCOINKERNEL_API const btck_BlockTreeEntry* BITCOINKERNEL_WARN_UNUSED_RESULT btck_coins_cursor_get_block_tree_entry(
+    const btck_CoinsCursor* coins_cursor) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Read the next chunk of coins from the UTXO set, in the order of the
+ * coins database. A cursor must not be used by multiple threads at once.
+ *
+ * @param[in] coins_cursor Non-null.
+ * @param[out] out_points  Non-null, array of max_coins entries, set to the owned out
+ *                         points of the coins read.
+ * @param[out] coins       Non-null, array of max_coins entries, set to the owned coins
+ *                         read.
+ * @param[in] max_coins    Maximum number of coins to read.
+ * @param[out] coins_read  Non-null, set to the number of coins read. Fewer than
+ *                         max_coins are only read at the end of the UTXO set or on
+ *                         error.
+ * @return                 0 if reading was successful, non-zero otherwise.
+ */
+BITCOINKERNEL_API int BITCOINKERNEL_WARN_UNUSED_RESULT btck_coins_cursor_next(
+    btck_CoinsCursor* coins_cursor,
+    btck_TransactionOutPoint** out_points,
+    btck_Coin** coins,
+    size_t max_coins,
+    size_t* coins_read) BITCOINKERNEL_ARG_NONNULL(1, 2, 3, 5);
+
+/**
+ * Destroy the coins cursor.
+ */
+BITCOINKERNEL_API void btck_coins_cursor_destroy(btck_CoinsCursor* coins_cursor);
+
+///@}
+
 /** @name Block
  * Functions for working with blocks.
  */
@@ -1298,6 +1431,147 @@ BITCOINKERNEL_API void btck_block_destroy(btck_Block* block);
 
 ///@}
 
+/** @name BlockView
+ * Functions for working with block views.
+ */
+///@{
+
+/**
+ * @brief Reads the block the passed in block tree entry points to from disk
+ * into a block view.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @param[in] block_tree_entry   Non-null.
+ * @return                       The block view, or null on error.
+ */
+BITCOINKERNEL_API btck_BlockView* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_read(
+    const btck_ChainstateManager* chainstate_manager,
+    const btck_BlockTreeEntry* block_tree_entry) BITCOINKERNEL_ARG_NONNULL(1, 2);
+
+/**
+ * @brief Copy a serialized raw block into a new block view and parse it.
+ *
+ * @param[in] raw_block     Serialized block.
+ * @param[in] raw_block_len Length of the serialized block.
+ * @return                  The block view, or null if the block is malformed.
+ */
+BITCOINKERNEL_API btck_BlockView* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_create(
+    const void* raw_block, size_t raw_block_len);
+
+/**
+ * @brief Count the number of transactions contained in a block view.
+ *
+ * @param[in] block_view Non-null.
+ * @return               The number of transactions in the block.
+ */
+BITCOINKERNEL_API size_t BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_count_transactions(
+    const btck_BlockView* block_view) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Get the btck_BlockHeader of the block.
+ *
+ * @param[in] block_view Non-null.
+ * @return               btck_BlockHeader.
+ */
+BITCOINKERNEL_API btck_BlockHeader* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_header(
+    const btck_BlockView* block_view) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Calculate and return the hash of the block.
+ *
+ * @param[in] block_view Non-null.
+ * @return               The block hash.
+ */
+BITCOINKERNEL_API btck_BlockHash* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_hash(
+    const btck_BlockView* block_view) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Calculate the txid of the transaction at the provided index. The txid
+ * is hashed again on every call.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The txid.
+ */
+BITCOINKERNEL_API btck_Txid* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_txid_at(
+    const btck_BlockView* block_view, size_t transaction_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Deserialize the transaction at the provided index, for callers that
+ * need all of it.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The transaction.
+ */
+BITCOINKERNEL_API btck_Transaction* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_transaction_at(
+    const btck_BlockView* block_view, size_t transaction_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Count the number of inputs of the transaction at the provided index.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The number of inputs.
+ */
+BITCOINKERNEL_API size_t BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_count_transaction_inputs(
+    const btck_BlockView* block_view, size_t transaction_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Get the out point spent by an input of the transaction at the
+ * provided index.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @param[in] input_index       The index of the input.
+ * @return                      The out point.
+ */
+BITCOINKERNEL_API btck_TransactionOutPoint* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_transaction_input_out_point(
+    const btck_BlockView* block_view, size_t transaction_index, size_t input_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Count the number of outputs of the transaction at the provided index.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The number of outputs.
+ */
+BITCOINKERNEL_API size_t BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_count_transaction_outputs(
+    const btck_BlockView* block_view, size_t transaction_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Get the amount of an output of the transaction at the provided index.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @param[in] output_index      The index of the output.
+ * @return                      The amount in satoshis.
+ */
+BITCOINKERNEL_API int64_t BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_transaction_output_amount(
+    const btck_BlockView* block_view, size_t transaction_index, size_t output_index) BITCOINKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Get the script pubkey of an output of the transaction at the provided
+ * index. The returned bytes are not copied out of the block and depend on the
+ * lifetime of the block view.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @param[in] output_index      The index of the output.
+ * @param[out] script_pubkey_len Non-null, set to the length of the script pubkey.
+ * @return                      The script pubkey, not null-terminated.
+ */
+BITCOINKERNEL_API const unsigned char* BITCOINKERNEL_WARN_UNUSED_RESULT btck_block_view_get_transaction_output_script_pubkey(
+    const btck_BlockView* block_view, size_t transaction_index, size_t output_index,
+    size_t* script_pubkey_len) BITCOINKERNEL_ARG_NONNULL(1, 4);
+
+/**
+ * Destroy the block view.
+ */
+BITCOINKERNEL_API void btck_block_view_destroy(btck_BlockView* block_view);
+
+///@}
+
 /** @name BlockValidationState
  * Functions for working with block validation states.
  */
@@ -1515,6 +1789,16 @@ BITCOINKERNEL_API void btck_transaction_input_destroy(btck_TransactionInput* tra
  */
 ///@{
 
+/**
+ * @brief Create a transaction out point.
+ *
+ * @param[in] txid  Non-null, the txid of the transaction the out point refers to.
+ * @param[in] index The index of the output within that transaction.
+ * @return          The transaction out point.
+ */
+BITCOINKERNEL_API btck_TransactionOutPoint* BITCOINKERNEL_WARN_UNUSED_RESULT btck_transaction_out_point_create(
+    const btck_Txid* txid, uint32_t index) BITCOINKERNEL_ARG_NONNULL(1);
+
 /**
  * @brief Copy a transaction out point.
  *
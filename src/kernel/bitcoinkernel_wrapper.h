@@ -493,6 +493,8 @@ public:
 class Txid : public Handle<btck_Txid, btck_txid_copy, btck_txid_destroy>, public TxidApi<Txid>
 {
 public:
+    Txid(btck_Txid* txid) : Handle{txid} {}
+
     Txid(const TxidView& view)
         : Handle(view) {}
 };
@@ -530,6 +532,12 @@ public:
 class OutPoint : public Handle<btck_TransactionOutPoint, btck_transaction_out_point_copy, btck_transaction_out_point_destroy>, public OutPointApi<OutPoint>
 {
 public:
+    template <typename Derived>
+    OutPoint(const TxidApi<Derived>& txid, uint32_t index)
+        : Handle{btck_transaction_out_point_create(static_cast<const Derived&>(txid).get(), index)} {}
+
+    OutPoint(btck_TransactionOutPoint* out_point) : Handle{out_point} {}
+
     OutPoint(const OutPointView& view)
         : Handle(view) {}
 };
@@ -623,6 +631,8 @@ public:
     explicit Transaction(std::span<const std::byte> raw_transaction)
         : Handle{btck_transaction_create(raw_transaction.data(), raw_transaction.size())} {}
 
+    Transaction(btck_Transaction* transaction) : Handle{transaction} {}
+
     Transaction(const TransactionView& view)
         : Handle{view} {}
 };
@@ -805,6 +815,70 @@ public:
     }
 };
 
+class BlockView : UniqueHandle<btck_BlockView, btck_block_view_destroy>
+{
+public:
+    BlockView(const std::span<const std::byte> raw_block)
+        : UniqueHandle{btck_block_view_create(raw_block.data(), raw_block.size())}
+    {
+    }
+
+    BlockView(btck_BlockView* block_view) : UniqueHandle{block_view} {}
+
+    size_t CountTransactions() const
+    {
+        return btck_block_view_count_transactions(get());
+    }
+
+    BlockHash GetHash() const
+    {
+        return BlockHash{btck_block_view_get_hash(get())};
+    }
+
+    BlockHeader GetHeader() const
+    {
+        return BlockHeader{btck_block_view_get_header(get())};
+    }
+
+    Txid GetTxid(size_t tx_index) const
+    {
+        return Txid{btck_block_view_get_txid_at(get(), tx_index)};
+    }
+
+    Transaction GetTransaction(size_t tx_index) const
+    {
+        return Transaction{btck_block_view_get_transaction_at(get(), tx_index)};
+    }
+
+    size_t CountInputs(size_t tx_index) const
+    {
+        return btck_block_view_count_transaction_inputs(get(), tx_index);
+    }
+
+    OutPoint GetInputOutPoint(size_t tx_index, size_t input_index) const
+    {
+        return OutPoint{btck_block_view_get_transaction_input_out_point(get(), tx_index, input_index)};
+    }
+
+    size_t CountOutputs(size_t tx_index) const
+    {
+        return btck_block_view_count_transaction_outputs(get(), tx_index);
+    }
+
+    int64_t GetOutputAmount(size_t tx_index, size_t output_index) const
+    {
+        return btck_block_view_get_transaction_output_amount(get(), tx_index, output_index);
+    }
+
+    //! The script pubkey refers to the block view and must not outlive it.
+    std::span<const std::byte> GetOutputScriptPubkey(size_t tx_index, size_t output_index) const
+    {
+        size_t len{0};
+        const unsigned char* script_pubkey{btck_block_view_get_transaction_output_script_pubkey(get(), tx_index, output_index, &len)};
+        return std::as_bytes(std::span{script_pubkey, len});
+    }
+};
+
 inline void logging_disable()
 {
     btck_logging_disable();
@@ -1187,6 +1261,33 @@ public:
     MAKE_RANGE_METHOD(TxsSpentOutputs, BlockSpentOutputs, &BlockSpentOutputs::Count, &BlockSpentOutputs::GetTxSpentOutputs, *this)
 };
 
+class CoinsCursor : UniqueHandle<btck_CoinsCursor, btck_coins_cursor_destroy>
+{
+public:
+    CoinsCursor(btck_CoinsCursor* coins_cursor) : UniqueHandle{coins_cursor} {}
+
+    BlockTreeEntry GetBlockTreeEntry() const
+    {
+        return btck_coins_cursor_get_block_tree_entry(get());
+    }
+
+    //! Read up to max_coins coins. Returns fewer only at the end of the UTXO set.
+    std::vector<std::pair<OutPoint, Coin>> Next(size_t max_coins)
+    {
+        std::vector<btck_TransactionOutPoint*> c_out_points(max_coins);
+        std::vector<btck_Coin*> c_coins(max_coins);
+        size_t coins_read{0};
+        const int res{btck_coins_cursor_next(get(), c_out_points.data(), c_coins.data(), max_coins, &coins_read)};
+        std::vector<std::pair<OutPoint, Coin>> coins;
+        coins.reserve(coins_read);
+        for (size_t i{0}; i < coins_read; ++i) {
+            coins.emplace_back(c_out_points[i], c_coins[i]);
+        }
+        if (res != 0) throw std::runtime_error("Failed to read the UTXO set");
+        return coins;
+    }
+};
+
 class ChainMan : UniqueHandle<btck_ChainstateManager, btck_chainstate_manager_destroy>
 {
 public:
@@ -1217,6 +1318,25 @@ public:
         return res == 0;
     }
 
+    bool ProcessBlocks(std::span<const std::span<const std::byte>> raw_blocks, std::vector<bool>* new_blocks = nullptr)
+    {
+        std::vector<const void*> c_blocks;
+        std::vector<size_t> c_blocks_lens;
+        c_blocks.reserve(raw_blocks.size());
+        c_blocks_lens.reserve(raw_blocks.size());
+        for (const auto& raw_block : raw_blocks) {
+            c_blocks.push_back(raw_block.data());
+            c_blocks_lens.push_back(raw_block.size());
+        }
+
+        std::vector<int> _new_blocks(raw_blocks.size());
+        int res = btck_chainstate_manager_process_blocks(get(), c_blocks.data(), c_blocks_lens.data(), c_blocks.size(), _new_blocks.data());
+        if (new_blocks) {
+            new_blocks->assign(_new_blocks.begin(), _new_blocks.end());
+        }
+        return res == 0;
+    }
+
     bool ProcessBlockHeader(const BlockHeader& header, BlockValidationState& state)
     {
         return btck_chainstate_manager_process_block_header(get(), header.get(), state.get()) == 0;
@@ -1246,10 +1366,52 @@ public:
         return block;
     }
 
+    std::optional<BlockView> ReadBlockView(const BlockTreeEntry& entry) const
+    {
+        auto block_view{btck_block_view_read(get(), entry.get())};
+        if (!block_view) return std::nullopt;
+        return block_view;
+    }
+
     BlockSpentOutputs ReadBlockSpentOutputs(const BlockTreeEntry& entry) const
     {
         return btck_block_spent_outputs_read(get(), entry.get());
     }
+
+    std::optional<Coin> GetCoin(const OutPoint& out_point) const
+    {
+        auto coin{btck_chainstate_manager_get_coin(get(), out_point.get())};
+        if (!coin) return std::nullopt;
+        return coin;
+    }
+
+    std::vector<std::optional<Coin>> GetCoins(std::span<const OutPoint> out_points) const
+    {
+        std::vector<const btck_TransactionOutPoint*> c_out_points;
+        c_out_points.reserve(out_points.size());
+        for (const auto& out_point : out_points) {
+            c_out_points.push_back(out_point.get());
+        }
+        std::vector<btck_Coin*> c_coins(out_points.size());
+        if (btck_chainstate_manager_get_coins(get(), c_out_points.data(), c_out_points.size(), c_coins.data()) != 0) {
+            throw std::runtime_error("Failed to look up coins");
+        }
+        std::vector<std::optional<Coin>> coins;
+        coins.reserve(c_coins.size());
+        for (btck_Coin* coin : c_coins) {
+            if (coin) {
+                coins.emplace_back(coin);
+            } else {
+                coins.emplace_back(std::nullopt);
+            }
+        }
+        return coins;
+    }
+
+    CoinsCursor CreateCoinsCursor() const
+    {
+        return btck_chainstate_manager_coins_cursor_create(get());
+    }
 };
 
 } // namespace btck
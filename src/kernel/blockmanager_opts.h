@@ -16,6 +16,8 @@ class CChainParams;
 namespace kernel {
 
 static constexpr bool DEFAULT_XOR_BLOCKSDIR{true};
+static constexpr bool DEFAULT_MMAP_BLOCKSDIR{false};
+static constexpr bool DEFAULT_BLOCK_INDEX_SNAPSHOT{false};
 
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
@@ -24,11 +26,15 @@ static constexpr bool DEFAULT_XOR_BLOCKSDIR{true};
 struct BlockManagerOpts {
     const CChainParams& chainparams;
     bool use_xor{DEFAULT_XOR_BLOCKSDIR};
+    //! Read finalized block files through read-only memory mappings
+    bool use_mmap{DEFAULT_MMAP_BLOCKSDIR};
     uint64_t prune_target{0};
     bool fast_prune{false};
     const fs::path blocks_dir;
     Notifications& notifications;
     DBParams block_tree_db_params;
+    //! Load the block index from a snapshot file written on the last clean shutdown, and write one on shutdown
+    bool use_block_index_snapshot{DEFAULT_BLOCK_INDEX_SNAPSHOT};
 };
 
 } // namespace kernel
@@ -44,8 +44,14 @@ struct ChainstateManagerOpts {
     CoinsViewOptions coins_view{};
     Notifications& notifications;
     ValidationSignals* signals{nullptr};
-    //! Number of script check worker threads. Zero means no parallel verification.
+    //! Number of script check worker threads. Input prefetching and header checks use as many
+    //! threads of their own, up to MAX_INPUT_FETCH_THREADS and MAX_HEADER_CHECK_THREADS.
+    //! Zero means no parallel verification.
     int worker_threads_num{0};
+    //! Number of script check worker threads used for the historical chainstate of an
+    //! assumeutxo snapshot, when it is validated by the background validation thread.
+    //! If not set, it shares the worker threads of the current chainstate.
+    std::optional<int> background_worker_threads_num{};
     size_t script_execution_cache_bytes{DEFAULT_SCRIPT_EXECUTION_CACHE_BYTES};
     size_t signature_cache_bytes{DEFAULT_SIGNATURE_CACHE_BYTES};
 };
@@ -20,6 +20,7 @@
 #include <util/overflow.h>
 #include <validation.h>
 
+#include <cassert>
 #include <map>
 #include <memory>
 #include <span>
@@ -175,6 +176,39 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
     return stats;
 }
 
+SerializedCoinsHasher::SerializedCoinsHasher()
+{
+    m_pool.Start(/*num_workers=*/1);
+}
+
+SerializedCoinsHasher::~SerializedCoinsHasher()
+{
+    m_pool.Stop();
+}
+
+void SerializedCoinsHasher::Add(std::shared_ptr<const Batch> coins)
+{
+    while (m_pending.size() >= MAX_PENDING_BATCHES) {
+        m_pending.front().get();
+        m_pending.pop_front();
+    }
+    // With a single worker, batches are hashed in the order they are added.
+    auto task{m_pool.Submit([this, coins = std::move(coins)] {
+        for (const auto& [outpoint, coin] : *coins) {
+            ApplyCoinHash(m_hasher, outpoint, coin);
+        }
+    })};
+    assert(task); // The pool is only stopped by the destructor.
+    m_pending.push_back(std::move(*task));
+}
+
+uint256 SerializedCoinsHasher::Finalize()
+{
+    for (auto& pending : m_pending) pending.get();
+    m_pending.clear();
+    return m_hasher.GetHash();
+}
+
 static void FinalizeHash(HashWriter& ss, CCoinsStats& stats)
 {
     stats.hashSerialized = ss.GetHash();
@@ -6,16 +6,24 @@
 #define BITCOIN_KERNEL_COINSTATS_H
 
 #include <arith_uint256.h>
+#include <coins.h>
 #include <consensus/amount.h>
+#include <hash.h>
+#include <primitives/transaction.h>
 #include <uint256.h>
+#include <util/threadpool.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <future>
+#include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 class CCoinsView;
-class Coin;
-class COutPoint;
 class CScript;
 class MuHash3072;
 namespace node {
@@ -77,6 +85,35 @@ uint64_t GetBogoSize(const CScript& script_pub_key);
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
+/**
+ * Computes the HASH_SERIALIZED commitment of a UTXO set on a thread of its
+ * own, so that hashing overlaps with reading and writing the coins, e.g. while
+ * a UTXO snapshot is loaded or dumped. The coins must be added in ascending
+ * outpoint order, which is the order ComputeUTXOStats() hashes them in.
+ */
+class SerializedCoinsHasher
+{
+public:
+    using Batch = std::vector<std::pair<COutPoint, Coin>>;
+
+    SerializedCoinsHasher();
+    ~SerializedCoinsHasher();
+
+    //! Queue a batch of coins to be hashed after the ones added before it.
+    //! Blocks while too many batches are pending.
+    void Add(std::shared_ptr<const Batch> coins);
+    //! Wait until all queued batches are hashed and return the hash.
+    uint256 Finalize();
+
+private:
+    //! Number of batches that may be pending before Add() blocks
+    static constexpr size_t MAX_PENDING_BATCHES{4};
+
+    HashWriter m_hasher{};
+    ThreadPool m_pool{"coinshash"};
+    std::deque<std::future<void>> m_pending;
+};
+
 std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {});
 } // namespace kernel
 
@@ -1852,6 +1852,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock>&& sock,
                              });
     pnode->AddRef();
     m_msgproc->InitializeNode(*pnode, local_services);
+    RegisterNodeSocket(*pnode);
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -1955,6 +1956,7 @@ void CConnman::DisconnectNodes()
                 pnode->grantOutbound.Release();
 
                 // close socket and cleanup
+                UnregisterNodeSocket(*pnode);
                 pnode->CloseSocketDisconnect();
 
                 // update connection count by network
@@ -2067,21 +2069,11 @@ Sock::EventsPerSock CConnman::GenerateWaitSockets(std::span<CNode* const> nodes)
     }
 
     for (CNode* pnode : nodes) {
-        bool select_recv = !pnode->fPauseRecv;
-        bool select_send;
-        {
-            LOCK(pnode->cs_vSend);
-            // Sending is possible if either there are bytes to send right now, or if there will be
-            // once a potential message from vSendMsg is handed to the transport. GetBytesToSend
-            // determines both of these in a single call.
-            const auto& [to_send, more, _msg_type] = pnode->m_transport->GetBytesToSend(!pnode->vSendMsg.empty());
-            select_send = !to_send.empty() || more;
-        }
-        if (!select_recv && !select_send) continue;
+        const Sock::Event event{RequestedSocketEvents(*pnode)};
+        if (event == 0) continue;
 
         LOCK(pnode->m_sock_mutex);
         if (pnode->m_sock) {
-            Sock::Event event = (select_send ? Sock::SEND : 0) | (select_recv ? Sock::RECV : 0);
             events_per_sock.emplace(pnode->m_sock, Sock::Events{event});
         }
     }
@@ -2089,6 +2081,93 @@ Sock::EventsPerSock CConnman::GenerateWaitSockets(std::span<CNode* const> nodes)
     return events_per_sock;
 }
 
+Sock::Event CConnman::RequestedSocketEvents(CNode& node)
+{
+    bool select_recv = !node.fPauseRecv;
+    bool select_send;
+    {
+        LOCK(node.cs_vSend);
+        // Sending is possible if either there are bytes to send right now, or if there will be
+        // once a potential message from vSendMsg is handed to the transport. GetBytesToSend
+        // determines both of these in a single call.
+        const auto& [to_send, more, _msg_type] = node.m_transport->GetBytesToSend(!node.vSendMsg.empty());
+        select_send = !to_send.empty() || more;
+    }
+    return (select_send ? Sock::SEND : 0) | (select_recv ? Sock::RECV : 0);
+}
+
+void CConnman::RegisterNodeSocket(CNode& node)
+{
+    if (!m_sock_epoll) return;
+    {
+        LOCK(node.m_sock_mutex);
+        if (!node.m_sock || !m_sock_epoll->Add(node.m_sock, Sock::RECV)) return;
+        node.m_epoll_sock = node.m_sock;
+        WITH_LOCK(m_sock_epoll_mutex, m_sock_epoll_nodes.emplace(node.m_epoll_sock.get(), &node));
+    }
+    // The transport may have bytes to send already, e.g. the V2 handshake.
+    MarkSocketEventsDirty(node);
+}
+
+void CConnman::UnregisterNodeSocket(CNode& node)
+{
+    LOCK(node.m_sock_mutex);
+    if (node.m_epoll_sock) {
+        WITH_LOCK(m_sock_epoll_mutex, m_sock_epoll_nodes.erase(node.m_epoll_sock.get()));
+        m_sock_epoll->Remove(*node.m_epoll_sock);
+        node.m_epoll_sock.reset();
+    }
+}
+
+void CConnman::MarkSocketEventsDirty(CNode& node)
+{
+    if (!m_sock_epoll || node.m_socket_events_dirty.exchange(true)) return;
+    node.AddRef();
+    LOCK(m_sock_epoll_mutex);
+    m_sock_epoll_dirty.push_back(&node);
+}
+
+void CConnman::UpdateNodeSocketEvents()
+{
+    std::vector<CNode*> nodes;
+    WITH_LOCK(m_sock_epoll_mutex, nodes.swap(m_sock_epoll_dirty));
+
+    for (CNode* pnode : nodes) {
+        // Clear the flag before looking at the node, so that any change from now on
+        // queues it again.
+        pnode->m_socket_events_dirty = false;
+        const Sock::Event event{RequestedSocketEvents(*pnode)};
+
+        bool recheck{false};
+        {
+            LOCK(pnode->m_sock_mutex);
+            if (pnode->m_epoll_sock) {
+                // Only calls into the kernel if the requested events changed. Once the socket
+                // is closed, stop waiting for it until DisconnectNodes() unregisters the node.
+                m_sock_epoll->Modify(*pnode->m_epoll_sock, pnode->m_sock ? event : 0);
+                // The message handler unpauses receiving without telling us, so keep
+                // checking a paused node.
+                recheck = pnode->m_sock && pnode->fPauseRecv;
+            }
+        }
+        if (recheck) MarkSocketEventsDirty(*pnode);
+        pnode->Release();
+    }
+}
+
+std::vector<CNode*> CConnman::ReadyEpollNodes(const Sock::EventsPerSock& events_per_sock)
+{
+    std::vector<CNode*> nodes;
+    LOCK(m_sock_epoll_mutex);
+    for (const auto& [sock, events] : events_per_sock) {
+        const auto it{m_sock_epoll_nodes.find(sock.get())};
+        if (it == m_sock_epoll_nodes.end()) continue; // A listening socket.
+        it->second->AddRef();
+        nodes.push_back(it->second);
+    }
+    return nodes;
+}
+
 void CConnman::SocketHandler()
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
@@ -2104,13 +2183,35 @@ void CConnman::SocketHandler()
         // listening sockets in one call ("readiness" as in poll(2) or
         // select(2)). If none are ready, wait for a short while and return
         // empty sets.
-        events_per_sock = GenerateWaitSockets(snap.Nodes());
-        if (events_per_sock.empty() || !events_per_sock.begin()->first->WaitMany(timeout, events_per_sock)) {
+        bool waited;
+        if (m_sock_epoll) {
+            // The sockets are registered already, only pass on what changed.
+            UpdateNodeSocketEvents();
+            waited = m_sock_epoll->Wait(timeout, events_per_sock);
+        } else {
+            events_per_sock = GenerateWaitSockets(snap.Nodes());
+            waited = !events_per_sock.empty() && events_per_sock.begin()->first->WaitMany(timeout, events_per_sock);
+        }
+        if (!waited) {
             m_interrupt_net->sleep_for(timeout);
         }
 
-        // Service (send/receive) each of the already connected nodes.
-        SocketHandlerConnected(snap.Nodes(), events_per_sock);
+        // Service (send/receive) each of the already connected nodes. With epoll,
+        // only the ready ones are known and visited.
+        if (m_sock_epoll) {
+            const std::vector<CNode*> ready_nodes{ReadyEpollNodes(events_per_sock)};
+            SocketHandlerConnected(ready_nodes, events_per_sock);
+            for (CNode* pnode : ready_nodes) {
+                pnode->Release();
+            }
+        } else {
+            SocketHandlerConnected(snap.Nodes(), events_per_sock);
+        }
+
+        const auto now{GetTime<std::chrono::microseconds>()};
+        for (CNode* pnode : snap.Nodes()) {
+            if (InactivityCheck(*pnode, now)) pnode->fDisconnect = true;
+        }
     }
 
     // Accept new connections from listening sockets.
@@ -2122,8 +2223,6 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
-    auto now = GetTime<std::chrono::microseconds>();
-
     for (CNode* pnode : nodes) {
         if (m_interrupt_net->interrupted()) {
             return;
@@ -2147,6 +2246,9 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
                 errorSet = it->second.occurred & Sock::ERR;
             }
         }
+        // Sending, receiving or closing the socket below may change the events to
+        // wait for.
+        if (sendSet || recvSet || errorSet) MarkSocketEventsDirty(*pnode);
 
         if (sendSet) {
             // Send data
@@ -2214,8 +2316,6 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
                 }
             }
         }
-
-        if (InactivityCheck(*pnode, now)) pnode->fDisconnect = true;
     }
 }
 
@@ -3033,6 +3133,7 @@ bool CConnman::OpenNetworkConnection(const CAddress& addrConnect,
     pnode->grantOutbound = std::move(grant_outbound);
 
     m_msgproc->InitializeNode(*pnode, m_local_services);
+    RegisterNodeSocket(*pnode);
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -3336,7 +3437,13 @@ bool CConnman::BindListenPort(const CService& addrBind, bilingual_str& strError,
         return false;
     }
 
-    vhListenSocket.emplace_back(std::move(sock), permissions);
+    std::shared_ptr<Sock> listen_sock{std::move(sock)};
+    if (m_sock_epoll && !m_sock_epoll->Add(listen_sock, Sock::RECV)) {
+        strError = Untranslated(strprintf("Error registering the socket for %s with epoll", addrBind.ToStringAddrPort()));
+        LogError("%s\n", strError.original);
+        return false;
+    }
+    vhListenSocket.emplace_back(std::move(listen_sock), permissions);
     return true;
 }
 
@@ -3648,6 +3755,14 @@ void CConnman::StopNodes()
         }
     }
 
+    // Release the nodes queued to update their socket events.
+    std::vector<CNode*> dirty_nodes;
+    WITH_LOCK(m_sock_epoll_mutex, dirty_nodes.swap(m_sock_epoll_dirty); m_sock_epoll_nodes.clear());
+    for (CNode* pnode : dirty_nodes) {
+        pnode->m_socket_events_dirty = false;
+        pnode->Release();
+    }
+
     // Delete peer connections.
     std::vector<CNode*> nodes;
     WITH_LOCK(m_nodes_mutex, nodes.swap(m_nodes));
@@ -3662,6 +3777,7 @@ void CConnman::StopNodes()
     }
     m_nodes_disconnected.clear();
     WITH_LOCK(m_reconnections_mutex, m_reconnections.clear());
+    if (m_sock_epoll) m_sock_epoll->Clear();
     vhListenSocket.clear();
     semOutbound.reset();
     semAddnode.reset();
@@ -4112,6 +4228,7 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
             std::tie(nBytesSent, std::ignore) = SocketSendData(*pnode);
         }
     }
+    MarkSocketEventsDirty(*pnode);
     if (nBytesSent) RecordBytesSent(nBytesSent);
 }
 
@@ -45,6 +45,7 @@
 #include <queue>
 #include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -85,6 +86,8 @@ static const std::string DEFAULT_MAX_UPLOAD_TARGET{"0M"};
 static const bool DEFAULT_BLOCKSONLY = false;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
+/** Default for -useepoll. */
+static constexpr bool DEFAULT_USE_EPOLL{true};
 /** Default for -privatebroadcast. */
 static constexpr bool DEFAULT_PRIVATE_BROADCAST{false};
 /** Number of file descriptors required for message capture **/
@@ -695,6 +698,12 @@ public:
      */
     std::shared_ptr<Sock> m_sock GUARDED_BY(m_sock_mutex);
 
+    /**
+     * Socket registered with CConnman's SockEpoll, if any. Kept after
+     * `CloseSocketDisconnect()` until the node is unregistered.
+     */
+    std::shared_ptr<const Sock> m_epoll_sock GUARDED_BY(m_sock_mutex);
+
     /** Sum of GetMemoryUsage of all vSendMsg entries. */
     size_t m_send_memusage GUARDED_BY(cs_vSend){0};
     /** Total number of bytes sent on the wire to this peer. */
@@ -742,6 +751,8 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    /** Whether the node is queued in CConnman to update the events requested for its socket. */
+    std::atomic_bool m_socket_events_dirty{false};
 
     /** Network key used to prevent fingerprinting our node across networks.
      *  Influenced by the network and the bind address (+ bind port for inbounds) */
@@ -1099,6 +1110,7 @@ public:
         bool whitelist_forcerelay = DEFAULT_WHITELISTFORCERELAY;
         bool whitelist_relay = DEFAULT_WHITELISTRELAY;
         bool m_capture_messages = false;
+        bool m_use_epoll = false;
     };
 
     void Init(const Options& connOptions) EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex, !m_total_bytes_sent_mutex)
@@ -1137,6 +1149,12 @@ public:
         whitelist_forcerelay = connOptions.whitelist_forcerelay;
         whitelist_relay = connOptions.whitelist_relay;
         m_capture_messages = connOptions.m_capture_messages;
+        if (!connOptions.m_use_epoll) {
+            m_sock_epoll.reset();
+        } else if (!m_sock_epoll) {
+            m_sock_epoll = SockEpoll::Create();
+            if (!m_sock_epoll) LogInfo("epoll is not available, falling back to poll/select for socket events");
+        }
     }
 
     // test only
@@ -1263,7 +1281,7 @@ public:
 
     bool ForNode(NodeId id, std::function<bool(CNode* pnode)> func);
 
-    void PushMessage(CNode* pnode, CSerializedNetMsg&& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex);
+    void PushMessage(CNode* pnode, CSerializedNetMsg&& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !m_sock_epoll_mutex);
 
     using NodeFn = std::function<void(CNode*)>;
     void ForEachNode(const NodeFn& func)
@@ -1457,10 +1475,36 @@ private:
      */
     Sock::EventsPerSock GenerateWaitSockets(std::span<CNode* const> nodes);
 
+    /** Events to wait for on a node's socket, 0 if none. */
+    Sock::Event RequestedSocketEvents(CNode& node);
+
+    /** Register a new node's socket with m_sock_epoll, if enabled. Call before adding it to m_nodes. */
+    void RegisterNodeSocket(CNode& node) EXCLUSIVE_LOCKS_REQUIRED(!m_sock_epoll_mutex);
+
+    /** Unregister a node's socket from m_sock_epoll, if it is registered. */
+    void UnregisterNodeSocket(CNode& node) EXCLUSIVE_LOCKS_REQUIRED(!m_sock_epoll_mutex);
+
+    /**
+     * Queue a node to update the events requested for its socket in m_sock_epoll.
+     * Call after something they depend on changed: its send queue, its transport,
+     * fPauseRecv or its socket.
+     */
+    void MarkSocketEventsDirty(CNode& node) EXCLUSIVE_LOCKS_REQUIRED(!m_sock_epoll_mutex);
+
+    /** Update the events requested in m_sock_epoll for the sockets of the queued nodes. */
+    void UpdateNodeSocketEvents() EXCLUSIVE_LOCKS_REQUIRED(!m_sock_epoll_mutex);
+
+    /**
+     * Find the nodes whose sockets are ready, if m_sock_epoll is used.
+     * @param[in] events_per_sock Sockets that are ready for IO, as returned by m_sock_epoll.
+     * @return the nodes, with a reference held to each of them
+     */
+    std::vector<CNode*> ReadyEpollNodes(const Sock::EventsPerSock& events_per_sock) EXCLUSIVE_LOCKS_REQUIRED(!m_sock_epoll_mutex);
+
     /**
      * Check connected and listening sockets for IO readiness and process them accordingly.
      */
-    void SocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+    void SocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc, !m_sock_epoll_mutex);
 
     /**
      * Do the read/write for connected sockets that are ready for IO.
@@ -1469,7 +1513,7 @@ private:
      */
     void SocketHandlerConnected(const std::vector<CNode*>& nodes,
                                 const Sock::EventsPerSock& events_per_sock)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc, !m_sock_epoll_mutex);
 
     /**
      * Accept incoming connections, one from each read-ready listening socket.
@@ -1756,6 +1800,26 @@ private:
      */
     bool m_capture_messages{false};
 
+    /**
+     * Persistent socket registrations used by SocketHandler() instead of
+     * Sock::WaitMany(), if epoll is enabled and available. Sockets are added
+     * when they start listening or their node connects, and removed when the
+     * node is disconnected.
+     */
+    std::unique_ptr<SockEpoll> m_sock_epoll;
+
+    Mutex m_sock_epoll_mutex;
+
+    /** Nodes whose sockets are registered with m_sock_epoll, by their registered socket. */
+    std::unordered_map<const Sock*, CNode*> m_sock_epoll_nodes GUARDED_BY(m_sock_epoll_mutex);
+
+    /**
+     * Nodes whose socket events may have changed since they were last passed to
+     * m_sock_epoll, with a reference held to each of them. Only these are updated
+     * before waiting, instead of all nodes.
+     */
+    std::vector<CNode*> m_sock_epoll_dirty GUARDED_BY(m_sock_epoll_mutex);
+
     /**
      * Mutex protecting m_i2p_sam_sessions.
      */
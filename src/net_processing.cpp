@@ -58,6 +58,7 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/strencodings.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <validation.h>
@@ -396,6 +397,9 @@ struct Peer {
     Mutex m_getdata_requests_mutex;
     /** Work queue of items requested by this peer **/
     std::deque<CInv> m_getdata_requests GUARDED_BY(m_getdata_requests_mutex);
+    /** Block being read from disk and sent to this peer by a block serving thread, if any.
+     *  No further messages from the peer are processed until it has been sent. */
+    std::optional<std::future<void>> m_block_serve GUARDED_BY(m_getdata_requests_mutex);
 
     /** Time of the last getheaders message to this peer */
     NodeClock::time_point m_last_getheaders_timestamp GUARDED_BY(NetEventsInterface::g_msgproc_mutex){};
@@ -1022,8 +1026,23 @@ private:
      */
     bool BlockRequestAllowed(const CBlockIndex& block_index) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool AlreadyHaveBlock(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
-    void ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
-        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex);
+    /** Serve a block requested by the peer. If it is sent by a block serving thread, that thread
+     *  also sends the NOTFOUND for the transactions requested before it, and not_found is cleared. */
+    void ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv, std::vector<CInv>& not_found)
+        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, peer.m_getdata_requests_mutex, !m_most_recent_block_mutex);
+
+    /** Read a block from disk and send it to the peer in network format, which matches the
+     *  format on disk. Disconnects the peer and returns false if the block cannot be read.
+     *  Safe to call from a block serving thread. */
+    bool SendRawBlockFromDisk(CNode& pfrom, const CBlockIndex& index, const FlatFilePos& block_pos)
+        LOCKS_EXCLUDED(::cs_main);
+
+    /** Whether block_hash is the block the peer asked to continue from. If so, it is reset, and
+     *  SendContinuationInv() must be called after serving the block. */
+    bool TakeContinuationBlock(Peer& peer, const uint256& block_hash);
+
+    /** Trigger the peer's next getblocks request. Safe to call from a block serving thread. */
+    void SendContinuationInv(CNode& pfrom, const CBlockIndex& tip);
 
     /**
      * Validation logic for compact filters request handling.
@@ -1094,6 +1113,11 @@ private:
 
     /// The transactions to be broadcast privately.
     PrivateBroadcast m_tx_for_private_broadcast;
+
+    /** Threads that read historical blocks requested by peers from disk, so that slow disk
+     *  reads do not delay processing messages from other peers. Declared last so that its
+     *  workers are joined before any other member is destroyed. */
+    ThreadPool m_block_serve_pool{"blkserve"};
 };
 
 const CNodeState* PeerManagerImpl::State(NodeId pnode) const
@@ -1676,6 +1700,14 @@ void PeerManagerImpl::ReattemptPrivateBroadcast(CScheduler& scheduler)
 void PeerManagerImpl::FinalizeNode(const CNode& node)
 {
     NodeId nodeid = node.GetId();
+    if (PeerRef peer{GetPeerRef(nodeid)}) {
+        // A block serving thread holds a reference to the node while it sends to it,
+        // so CConnman only finalizes the node once it is done and this does not block.
+        // Only CConnman::StopNodes() at shutdown deletes nodes that are still
+        // referenced; wait for the job then, without holding any lock it may need.
+        auto serve{WITH_LOCK(peer->m_getdata_requests_mutex, return std::exchange(peer->m_block_serve, std::nullopt))};
+        if (serve) serve->wait();
+    }
     {
     LOCK(cs_main);
     {
@@ -2022,6 +2054,9 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
+    if (opts.block_serve_threads > 0) {
+        m_block_serve_pool.Start(opts.block_serve_threads);
+    }
 }
 
 void PeerManagerImpl::StartScheduledTasks(CScheduler& scheduler)
@@ -2325,7 +2360,7 @@ void PeerManagerImpl::RelayAddress(NodeId originator,
     }
 }
 
-void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
+void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv, std::vector<CInv>& not_found)
 {
     std::shared_ptr<const CBlock> a_recent_block;
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
@@ -2405,19 +2440,35 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         pblock = a_recent_block;
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
-        // as the network format matches the format on disk
-        if (const auto block_data{m_chainman.m_blockman.ReadRawBlock(block_pos)}) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, std::span{*block_data});
-        } else {
-            if (WITH_LOCK(m_chainman.GetMutex(), return m_chainman.m_blockman.IsBlockPruned(*pindex))) {
-                LogDebug(BCLog::NET, "Block was pruned before it could be read, %s\n", pfrom.DisconnectMsg(fLogIPs));
-            } else {
-                LogError("Cannot load block from disk, %s\n", pfrom.DisconnectMsg(fLogIPs));
+        // as the network format matches the format on disk. Do so on a block serving
+        // thread if possible; the peer's messages are not processed until it is done.
+        // Everything ProcessGetData() would send after the block is sent by that thread
+        // too, so that the responses stay in request order. The thread holds a reference
+        // to the node, so that it is not deleted before the job is done, and does not
+        // touch the Peer.
+        Assume(!peer.m_block_serve);
+        const bool continuation{TakeContinuationBlock(peer, inv.hash)};
+        pfrom.AddRef();
+        auto serve{m_block_serve_pool.Submit([this, &pfrom, pindex, block_pos, tip, continuation, not_found] {
+            // Don't read the block for a peer that has been disconnected meanwhile.
+            if (!pfrom.fDisconnect && SendRawBlockFromDisk(pfrom, *pindex, block_pos)) {
+                if (continuation) SendContinuationInv(pfrom, *tip);
+                if (!not_found.empty()) MakeAndPushMessage(pfrom, NetMsgType::NOTFOUND, not_found);
             }
-            pfrom.fDisconnect = true;
+            m_connman.WakeMessageHandler();
+            pfrom.Release();
+        })};
+        if (serve) {
+            peer.m_block_serve = std::move(*serve);
+            not_found.clear();
             return;
         }
-        // Don't set pblock as we've sent the block
+        pfrom.Release();
+        if (!SendRawBlockFromDisk(pfrom, *pindex, block_pos)) return;
+        // The continuation block has been taken already, so send the inv here rather
+        // than below.
+        if (continuation) SendContinuationInv(pfrom, *tip);
+        return;
     } else {
         // Send block from disk
         std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -2478,19 +2529,41 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         }
     }
 
-    {
-        LOCK(peer.m_block_inv_mutex);
-        // Trigger the peer node to send a getblocks request for the next batch of inventory
-        if (inv.hash == peer.m_continuation_block) {
-            // Send immediately. This must send even if redundant,
-            // and we want it right after the last block so they don't
-            // wait for other stuff first.
-            std::vector<CInv> vInv;
-            vInv.emplace_back(MSG_BLOCK, tip->GetBlockHash());
-            MakeAndPushMessage(pfrom, NetMsgType::INV, vInv);
-            peer.m_continuation_block.SetNull();
-        }
+    if (TakeContinuationBlock(peer, inv.hash)) SendContinuationInv(pfrom, *tip);
+}
+
+bool PeerManagerImpl::SendRawBlockFromDisk(CNode& pfrom, const CBlockIndex& index, const FlatFilePos& block_pos)
+{
+    if (const auto block_data{m_chainman.m_blockman.ReadRawBlock(block_pos)}) {
+        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, std::span{*block_data});
+        return true;
     }
+    if (WITH_LOCK(m_chainman.GetMutex(), return m_chainman.m_blockman.IsBlockPruned(index))) {
+        LogDebug(BCLog::NET, "Block was pruned before it could be read, %s\n", pfrom.DisconnectMsg(fLogIPs));
+    } else {
+        LogError("Cannot load block from disk, %s\n", pfrom.DisconnectMsg(fLogIPs));
+    }
+    pfrom.fDisconnect = true;
+    return false;
+}
+
+bool PeerManagerImpl::TakeContinuationBlock(Peer& peer, const uint256& block_hash)
+{
+    LOCK(peer.m_block_inv_mutex);
+    if (block_hash != peer.m_continuation_block) return false;
+    peer.m_continuation_block.SetNull();
+    return true;
+}
+
+void PeerManagerImpl::SendContinuationInv(CNode& pfrom, const CBlockIndex& tip)
+{
+    // Trigger the peer node to send a getblocks request for the next batch of inventory.
+    // Send immediately. This must send even if redundant,
+    // and we want it right after the last block so they don't
+    // wait for other stuff first.
+    std::vector<CInv> vInv;
+    vInv.emplace_back(MSG_BLOCK, tip.GetBlockHash());
+    MakeAndPushMessage(pfrom, NetMsgType::INV, vInv);
 }
 
 CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay, const GenTxid& gtxid)
@@ -2558,7 +2631,7 @@ void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic
     if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
         const CInv &inv = *it++;
         if (inv.IsGenBlkMsg()) {
-            ProcessGetBlockData(pfrom, peer, inv);
+            ProcessGetBlockData(pfrom, peer, inv, vNotFound);
         }
         // else: If the first item on the queue is an unknown type, we erase it
         // and continue processing the queue on the next call.
@@ -5222,9 +5295,16 @@ bool PeerManagerImpl::ProcessMessages(CNode& node, std::atomic<bool>& interruptM
 
     {
         LOCK(peer.m_getdata_requests_mutex);
+        // Wait until the block being served to this peer has been sent, to
+        // maintain the order of responses.
+        if (peer.m_block_serve) {
+            if (peer.m_block_serve->wait_for(0s) != std::future_status::ready) return false;
+            peer.m_block_serve.reset();
+        }
         if (!peer.m_getdata_requests.empty()) {
             ProcessGetData(node, peer, interruptMsgProc);
         }
+        if (peer.m_block_serve) return false;
     }
 
     const bool processed_orphan = ProcessOrphanTx(peer);
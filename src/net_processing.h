@@ -42,6 +42,10 @@ static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{false};
 /** Default number of non-mempool transactions to keep around for block reconstruction. Includes
     orphan, replaced, and rejected transactions. */
 static const uint32_t DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN{100};
+/** Default number of threads that read historical blocks requested by peers from disk. */
+static constexpr int DEFAULT_BLOCK_SERVE_THREADS{2};
+/** Maximum number of threads that read historical blocks requested by peers from disk. */
+static constexpr int MAX_BLOCK_SERVE_THREADS{16};
 static const bool DEFAULT_PEERBLOOMFILTERS = false;
 static const bool DEFAULT_PEERBLOCKFILTERS = false;
 /** Maximum number of outstanding CMPCTBLOCK requests for the same block. */
@@ -94,6 +98,9 @@ public:
         uint32_t max_headers_result{MAX_HEADERS_RESULTS};
         //! Whether private broadcast is used for sending transactions.
         bool private_broadcast{DEFAULT_PRIVATE_BROADCAST};
+        //! Number of threads that read blocks requested by peers from disk and send them.
+        //! Zero means blocks are served from the message handler thread.
+        int block_serve_threads{0};
     };
 
     static std::unique_ptr<PeerManager> make(CConnman& connman, AddrMan& addrman,
@@ -18,6 +18,8 @@ namespace node {
 util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Options& opts)
 {
     if (auto value{args.GetBoolArg("-blocksxor")}) opts.use_xor = *value;
+    if (auto value{args.GetBoolArg("-blocksmmap")}) opts.use_mmap = *value;
+    if (auto value{args.GetBoolArg("-blockindexsnapshot")}) opts.use_block_index_snapshot = *value;
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
     int64_t nPruneArg{args.GetIntArg("-prune", opts.prune_target)};
     if (nPruneArg < 0) {
@@ -35,7 +37,7 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
 
-    ReadDatabaseArgs(args, opts.block_tree_db_params.options);
+    if (auto result{ReadDatabaseArgs(args, opts.block_tree_db_params.options, "blockindex")}; !result) return result;
 
     return {};
 }
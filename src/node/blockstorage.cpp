@@ -30,23 +30,33 @@
 #include <util/check.h>
 #include <util/expected.h>
 #include <util/fs.h>
+#include <util/fs_helpers.h>
 #include <util/log.h>
+#include <util/mappedfile.h>
 #include <util/obfuscation.h>
 #include <util/overflow.h>
 #include <util/result.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <compare>
 #include <cstddef>
 #include <cstdio>
+#include <deque>
 #include <exception>
+#include <future>
+#include <ios>
+#include <limits>
 #include <map>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <span>
@@ -60,6 +70,7 @@ static constexpr uint8_t DB_BLOCK_INDEX{'b'};
 static constexpr uint8_t DB_FLAG{'F'};
 static constexpr uint8_t DB_REINDEX_FLAG{'R'};
 static constexpr uint8_t DB_LAST_BLOCK{'l'};
+static constexpr uint8_t DB_BLOCK_INDEX_SNAPSHOT{'S'};
 // Keys used in previous version that might still be found in the DB:
 // BlockTreeDB::DB_TXINDEX_BLOCK{'T'};
 // BlockTreeDB::DB_TXINDEX{'t'}
@@ -117,6 +128,22 @@ bool BlockTreeDB::ReadFlag(const std::string& name, bool& fValue)
     return true;
 }
 
+void BlockTreeDB::WriteBlockIndexSnapshotChecksum(const std::optional<uint256>& checksum)
+{
+    if (checksum) {
+        Write(DB_BLOCK_INDEX_SNAPSHOT, *checksum, /*fSync=*/true);
+    } else {
+        Erase(DB_BLOCK_INDEX_SNAPSHOT, /*fSync=*/true);
+    }
+}
+
+std::optional<uint256> BlockTreeDB::ReadBlockIndexSnapshotChecksum()
+{
+    uint256 checksum;
+    if (!Read(DB_BLOCK_INDEX_SNAPSHOT, checksum)) return std::nullopt;
+    return checksum;
+}
+
 bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
 {
     AssertLockHeld(::cs_main);
@@ -221,11 +248,11 @@ const CBlockIndex* BlockManager::LookupBlockIndex(const uint256& hash) const
     return it == m_block_index.end() ? nullptr : &it->second;
 }
 
-CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header)
+CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint256& hash, CBlockIndex*& best_header)
 {
     AssertLockHeld(cs_main);
 
-    auto [mi, inserted] = m_block_index.try_emplace(block.GetHash(), block);
+    auto [mi, inserted] = m_block_index.try_emplace(hash, block);
     if (!inserted) {
         return &mi->second;
     }
@@ -404,6 +431,210 @@ void BlockManager::UpdatePruneLock(const std::string& name, const PruneLockInfo&
     m_prune_locks[name] = lock_info;
 }
 
+namespace {
+/** Version of the block index snapshot file format */
+constexpr uint32_t BLOCK_INDEX_SNAPSHOT_VERSION{1};
+/** Position of the absent predecessor or skip entry of a block index snapshot entry */
+constexpr uint32_t BLOCK_INDEX_SNAPSHOT_NONE{std::numeric_limits<uint32_t>::max()};
+
+/**
+ * A CBlockIndex in the block index snapshot file. Entries are sorted by
+ * height, and refer to their predecessor and skip entries by position.
+ */
+struct BlockIndexSnapshotEntry {
+    uint256 hash;
+    uint32_t prev{BLOCK_INDEX_SNAPSHOT_NONE};
+    uint32_t skip{BLOCK_INDEX_SNAPSHOT_NONE};
+    int32_t height{0};
+    int32_t file{0};
+    uint32_t data_pos{0};
+    uint32_t undo_pos{0};
+    int32_t version{0};
+    uint256 merkle_root;
+    uint32_t time{0};
+    uint32_t bits{0};
+    uint32_t nonce{0};
+    uint32_t status{0};
+    uint32_t tx_count{0};
+    uint256 chain_work;
+
+    SERIALIZE_METHODS(BlockIndexSnapshotEntry, obj)
+    {
+        READWRITE(obj.hash, obj.prev, obj.skip, obj.height, obj.file, obj.data_pos, obj.undo_pos,
+                  obj.version, obj.merkle_root, obj.time, obj.bits, obj.nonce, obj.status, obj.tx_count,
+                  obj.chain_work);
+    }
+};
+
+/**
+ * Digest of the block file records, which every version updates in the same
+ * database write as the block index entries of the blocks it stores, connects
+ * or prunes. A snapshot is bound to it so that it is not used after a version
+ * that doesn't know about the snapshot wrote to the database.
+ */
+uint256 BlockFilesDigest(int max_blockfile_num, std::span<const CBlockFileInfo> infos)
+{
+    HashWriter hasher;
+    hasher << max_blockfile_num << uint64_t{infos.size()};
+    for (const CBlockFileInfo& info : infos) hasher << info;
+    return hasher.GetHash();
+}
+} // namespace
+
+fs::path BlockManager::GetBlockIndexSnapshotPath() const
+{
+    return m_opts.block_tree_db_params.path.parent_path() / "blockindex.dat";
+}
+
+bool BlockManager::WriteBlockIndexSnapshot()
+{
+    AssertLockHeld(::cs_main);
+    if (!m_opts.use_block_index_snapshot || m_opts.block_tree_db_params.memory_only || !m_block_index_loaded) return false;
+    if (!m_dirty_blockindex.empty() || !m_dirty_fileinfo.empty()) {
+        LogWarning("Not writing block index snapshot, as the block index has not been written to disk.");
+        return false;
+    }
+
+    const auto start{SteadyClock::now()};
+    std::vector<CBlockIndex*> sorted_by_height{GetAllBlockIndices()};
+    std::sort(sorted_by_height.begin(), sorted_by_height.end(), CBlockIndexHeightOnlyComparator());
+    std::unordered_map<const CBlockIndex*, uint32_t> positions;
+    positions.reserve(sorted_by_height.size());
+    for (uint32_t i{0}; i < sorted_by_height.size(); ++i) {
+        positions.emplace(sorted_by_height[i], i);
+    }
+    const auto position_of{[&](const CBlockIndex* pindex) {
+        return pindex ? positions.at(pindex) : BLOCK_INDEX_SNAPSHOT_NONE;
+    }};
+
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    const fs::path temp_path{path + ".new"};
+    AutoFile file{fsbridge::fopen(temp_path, "wb")};
+    if (file.IsNull()) {
+        LogError("Failed to open block index snapshot file %s for writing", fs::PathToString(temp_path));
+        return false;
+    }
+    uint256 checksum;
+    try {
+        HashedSourceWriter writer{file};
+        const int max_blockfile_num{WITH_LOCK(cs_LastBlockFile, return MaxBlockfileNum())};
+        writer << GetParams().MessageStart() << BLOCK_INDEX_SNAPSHOT_VERSION
+               << BlockFilesDigest(max_blockfile_num, m_blockfile_info) << uint64_t{sorted_by_height.size()};
+        for (const CBlockIndex* pindex : sorted_by_height) {
+            writer << BlockIndexSnapshotEntry{
+                .hash = pindex->GetBlockHash(),
+                .prev = position_of(pindex->pprev),
+                .skip = position_of(pindex->pskip),
+                .height = pindex->nHeight,
+                .file = pindex->nFile,
+                .data_pos = pindex->nDataPos,
+                .undo_pos = pindex->nUndoPos,
+                .version = pindex->nVersion,
+                .merkle_root = pindex->hashMerkleRoot,
+                .time = pindex->nTime,
+                .bits = pindex->nBits,
+                .nonce = pindex->nNonce,
+                .status = pindex->nStatus,
+                .tx_count = pindex->nTx,
+                .chain_work = ArithToUint256(pindex->nChainWork),
+            };
+        }
+        checksum = writer.GetHash();
+        file << checksum;
+        if (!file.Commit()) throw std::ios_base::failure("commit failed");
+        if (file.fclose() != 0) throw std::ios_base::failure(SysErrorString(errno));
+    } catch (const std::exception& e) {
+        (void)file.fclose();
+        LogError("Failed to write block index snapshot file %s: %s", fs::PathToString(temp_path), e.what());
+        return false;
+    }
+    if (!RenameOver(temp_path, path)) {
+        LogError("Failed to rename block index snapshot file %s", fs::PathToString(temp_path));
+        return false;
+    }
+    m_block_tree_db->WriteBlockIndexSnapshotChecksum(checksum);
+    LogInfo("Wrote block index snapshot with %d entries in %dms", sorted_by_height.size(), Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+    return true;
+}
+
+std::vector<CBlockIndex*> BlockManager::LoadBlockIndexSnapshot(const uint256& checksum)
+{
+    AssertLockHeld(::cs_main);
+    if (!m_block_index.empty()) return {};
+
+    const auto start{SteadyClock::now()};
+    const fs::path path{GetBlockIndexSnapshotPath()};
+    std::vector<BlockIndexSnapshotEntry> entries;
+    try {
+        // Read the whole file at once and only construct block index
+        // entries once all of it has been checked.
+        AutoFile file{fsbridge::fopen(path, "rb")};
+        if (file.IsNull()) throw std::ios_base::failure("cannot open file");
+        std::vector<std::byte> data(file.size());
+        file.read(data);
+        if (data.size() < uint256::size()) throw std::ios_base::failure("file too short");
+        const auto contents{std::span{data}.first(data.size() - uint256::size())};
+        uint256 file_checksum;
+        SpanReader{std::span{data}.last(uint256::size())} >> file_checksum;
+        HashWriter hasher;
+        hasher.write(contents);
+        if (file_checksum != checksum || hasher.GetHash() != checksum) throw std::ios_base::failure("checksum mismatch");
+
+        SpanReader reader{contents};
+        MessageStartChars message_start;
+        uint32_t version;
+        uint256 files_digest;
+        uint64_t count;
+        reader >> message_start >> version >> files_digest >> count;
+        if (message_start != GetParams().MessageStart()) throw std::ios_base::failure("network mismatch");
+        if (version != BLOCK_INDEX_SNAPSHOT_VERSION) throw std::ios_base::failure(strprintf("unknown version %d", version));
+        int max_blockfile_num;
+        const std::vector<CBlockFileInfo> infos{ReadBlockFileInfoDB(max_blockfile_num)};
+        if (files_digest != BlockFilesDigest(max_blockfile_num, infos)) {
+            throw std::ios_base::failure("block files changed since the snapshot was written");
+        }
+        if (count >= BLOCK_INDEX_SNAPSHOT_NONE) throw std::ios_base::failure("too many entries");
+        entries.resize(count);
+        for (uint32_t i{0}; i < count; ++i) {
+            if (m_interrupt) return {};
+            auto& entry{entries[i]};
+            reader >> entry;
+            const bool prev_ok{entry.prev == BLOCK_INDEX_SNAPSHOT_NONE ? entry.height == 0 :
+                                                                         entry.prev < i && entries[entry.prev].height == entry.height - 1};
+            const bool skip_ok{entry.skip == BLOCK_INDEX_SNAPSHOT_NONE || entry.skip < i};
+            if (!prev_ok || !skip_ok) throw std::ios_base::failure(strprintf("invalid entry %d", i));
+        }
+        if (!reader.empty()) throw std::ios_base::failure("trailing data");
+    } catch (const std::exception& e) {
+        LogWarning("Not using block index snapshot %s: %s", fs::PathToString(path), e.what());
+        return {};
+    }
+
+    m_block_index.reserve(entries.size());
+    std::vector<CBlockIndex*> sorted_by_height;
+    sorted_by_height.reserve(entries.size());
+    for (const auto& entry : entries) {
+        CBlockIndex* pindex{InsertBlockIndex(entry.hash)};
+        pindex->pprev = entry.prev == BLOCK_INDEX_SNAPSHOT_NONE ? nullptr : sorted_by_height[entry.prev];
+        pindex->pskip = entry.skip == BLOCK_INDEX_SNAPSHOT_NONE ? nullptr : sorted_by_height[entry.skip];
+        pindex->nHeight = entry.height;
+        pindex->nFile = entry.file;
+        pindex->nDataPos = entry.data_pos;
+        pindex->nUndoPos = entry.undo_pos;
+        pindex->nVersion = entry.version;
+        pindex->hashMerkleRoot = entry.merkle_root;
+        pindex->nTime = entry.time;
+        pindex->nBits = entry.bits;
+        pindex->nNonce = entry.nonce;
+        pindex->nStatus = entry.status;
+        pindex->nTx = entry.tx_count;
+        pindex->nChainWork = UintToArith256(entry.chain_work);
+        sorted_by_height.push_back(pindex);
+    }
+    LogInfo("Loaded %d block index entries from snapshot in %dms", sorted_by_height.size(), Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+    return sorted_by_height;
+}
+
 CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
 {
     AssertLockHeld(cs_main);
@@ -422,7 +653,18 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
 
 bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(
+    // A block index snapshot is only consistent with the database until the
+    // next write to it, so erase its checksum before anything is written.
+    std::vector<CBlockIndex*> vSortedByHeight;
+    if (const auto snapshot_checksum{m_block_tree_db->ReadBlockIndexSnapshotChecksum()}) {
+        m_block_tree_db->WriteBlockIndexSnapshotChecksum(std::nullopt);
+        if (m_opts.use_block_index_snapshot) vSortedByHeight = LoadBlockIndexSnapshot(*snapshot_checksum);
+    }
+    // Chain work and skip pointers are already set for entries loaded from
+    // the snapshot, which is sorted by height.
+    const bool from_snapshot{!vSortedByHeight.empty()};
+
+    if (!from_snapshot && !m_block_tree_db->LoadBlockIndexGuts(
             GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt)) {
         return false;
     }
@@ -452,9 +694,11 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
     Assert(m_snapshot_height.has_value() == snapshot_blockhash.has_value());
 
     // Calculate nChainWork
-    std::vector<CBlockIndex*> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
+    if (!from_snapshot) {
+        vSortedByHeight = GetAllBlockIndices();
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+                  CBlockIndexHeightOnlyComparator());
+    }
 
     CBlockIndex* previous_index{nullptr};
     for (CBlockIndex* pindex : vSortedByHeight) {
@@ -464,7 +708,7 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
             return false;
         }
         previous_index = pindex;
-        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
+        if (!from_snapshot) pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
 
         // We can link the chain of blocks for which we've received transactions at some point, or
@@ -499,7 +743,7 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
             m_dirty_blockindex.insert(pindex);
         }
 
-        if (pindex->pprev) {
+        if (pindex->pprev && !from_snapshot) {
             pindex->BuildSkip();
         }
     }
@@ -526,29 +770,36 @@ void BlockManager::WriteBlockIndexDB()
     m_block_tree_db->WriteBatchSync(vFiles, max_blockfile, vBlocks);
 }
 
-bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
+std::vector<CBlockFileInfo> BlockManager::ReadBlockFileInfoDB(int& max_blockfile_num) const
 {
-    if (!LoadBlockIndex(snapshot_blockhash)) {
-        return false;
-    }
-    int max_blockfile_num{0};
-
-    // Load block file info
+    max_blockfile_num = 0;
     m_block_tree_db->ReadLastBlockFile(max_blockfile_num);
-    m_blockfile_info.resize(max_blockfile_num + 1);
-    LogInfo("Loading block index db: last block file = %i", max_blockfile_num);
+    std::vector<CBlockFileInfo> infos(max_blockfile_num + 1);
     for (int nFile = 0; nFile <= max_blockfile_num; nFile++) {
-        m_block_tree_db->ReadBlockFileInfo(nFile, m_blockfile_info[nFile]);
+        m_block_tree_db->ReadBlockFileInfo(nFile, infos[nFile]);
     }
-    LogInfo("Loading block index db: last block file info: %s", m_blockfile_info[max_blockfile_num].ToString());
     for (int nFile = max_blockfile_num + 1; true; nFile++) {
         CBlockFileInfo info;
         if (m_block_tree_db->ReadBlockFileInfo(nFile, info)) {
-            m_blockfile_info.push_back(info);
+            infos.push_back(info);
         } else {
             break;
         }
     }
+    return infos;
+}
+
+bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
+{
+    if (!LoadBlockIndex(snapshot_blockhash)) {
+        return false;
+    }
+    int max_blockfile_num{0};
+
+    // Load block file info
+    m_blockfile_info = ReadBlockFileInfoDB(max_blockfile_num);
+    LogInfo("Loading block index db: last block file = %i", max_blockfile_num);
+    LogInfo("Loading block index db: last block file info: %s", m_blockfile_info[max_blockfile_num].ToString());
 
     // Check presence of blk files
     LogInfo("Checking all blk files are present...");
@@ -585,6 +836,7 @@ bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_block
     m_block_tree_db->ReadReindexing(fReindexing);
     if (fReindexing) m_blockfiles_indexed = false;
 
+    m_block_index_loaded = true;
     return true;
 }
 
@@ -805,6 +1057,7 @@ void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
 {
     std::error_code ec;
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
+        WITH_LOCK(m_mapped_block_files_mutex, m_mapped_block_files.erase(*it));
         FlatFilePos pos(*it, 0);
         const bool removed_blockfile{fs::remove(m_block_file_seq.FileName(pos), ec)};
         const bool removed_undofile{fs::remove(m_undo_file_seq.FileName(pos), ec)};
@@ -1080,6 +1333,48 @@ bool BlockManager::ReadBlock(CBlock& block, const CBlockIndex& index) const
     return ReadBlock(block, block_pos, index.GetBlockHash());
 }
 
+std::shared_ptr<const MappedFile> BlockManager::GetMappedBlockFile(int file_num) const
+{
+    {
+        // Only map files that are finalized, so they are neither truncated nor
+        // appended to anymore. Files are never written to again once a cursor
+        // has moved past them.
+        LOCK(cs_LastBlockFile);
+        if (file_num > MaxBlockfileNum()) return nullptr;
+        for (const auto& cursor : m_blockfile_cursors) {
+            if (cursor && cursor->file_num == file_num) return nullptr;
+        }
+    }
+
+    LOCK(m_mapped_block_files_mutex);
+    auto [it, inserted]{m_mapped_block_files.try_emplace(file_num)};
+    it->second.last_used = ++m_mapped_block_files_clock;
+    if (inserted) {
+        const fs::path path{m_block_file_seq.FileName({file_num, 0})};
+        it->second.file = MappedFile::Open(path);
+        if (!it->second.file) {
+            LogDebug(BCLog::BLOCKSTORAGE, "Could not map block file %s, reading it from disk instead\n", fs::PathToString(path));
+        }
+        if (m_mapped_block_files.size() > MAX_MAPPED_BLOCK_FILES) {
+            // Unmap the least recently used file, which is never the one just mapped
+            m_mapped_block_files.erase(std::ranges::min_element(m_mapped_block_files, {}, [](const auto& entry) { return entry.second.last_used; }));
+        }
+    }
+    return it->second.file;
+}
+
+void BlockManager::UnmapBlockFiles() const
+{
+    LOCK(m_mapped_block_files_mutex);
+    m_mapped_block_files.clear();
+}
+
+size_t BlockManager::MappedBlockFileCount() const
+{
+    LOCK(m_mapped_block_files_mutex);
+    return m_mapped_block_files.size();
+}
+
 BlockManager::ReadRawBlockResult BlockManager::ReadRawBlock(const FlatFilePos& pos, std::optional<std::pair<size_t, size_t>> block_part) const
 {
     if (pos.nPos < STORAGE_HEADER_BYTES) {
@@ -1089,17 +1384,36 @@ BlockManager::ReadRawBlockResult BlockManager::ReadRawBlock(const FlatFilePos& p
         LogError("Failed for %s while reading raw block storage header", pos.ToString());
         return util::Unexpected{ReadRawError::IO};
     }
-    AutoFile filein{OpenBlockFile({pos.nFile, pos.nPos - STORAGE_HEADER_BYTES}, /*fReadOnly=*/true)};
-    if (filein.IsNull()) {
+
+    const std::shared_ptr<const MappedFile> mapped{m_opts.use_mmap ? GetMappedBlockFile(pos.nFile) : nullptr};
+    AutoFile filein{mapped ? AutoFile{nullptr} : OpenBlockFile({pos.nFile, pos.nPos - STORAGE_HEADER_BYTES}, /*fReadOnly=*/true)};
+    if (!mapped && filein.IsNull()) {
         LogError("OpenBlockFile failed for %s while reading raw block", pos.ToString());
         return util::Unexpected{ReadRawError::IO};
     }
 
+    // Read and deobfuscate data.size() bytes at file_pos from the mapping, in
+    // one pass into the destination buffer.
+    const auto read_mapped{[&](std::span<std::byte> data, uint64_t file_pos) {
+        const auto file_data{mapped->data()};
+        if (file_pos > file_data.size() || data.size() > file_data.size() - file_pos) {
+            throw std::ios_base::failure("end of mapped block file");
+        }
+        std::copy_n(file_data.begin() + file_pos, data.size(), data.begin());
+        m_obfuscation(data, file_pos);
+    }};
+
     try {
         MessageStartChars blk_start;
         unsigned int blk_size;
 
-        filein >> blk_start >> blk_size;
+        if (mapped) {
+            std::array<std::byte, STORAGE_HEADER_BYTES> header;
+            read_mapped(header, pos.nPos - STORAGE_HEADER_BYTES);
+            SpanReader{header} >> blk_start >> blk_size;
+        } else {
+            filein >> blk_start >> blk_size;
+        }
 
         if (blk_start != GetParams().MessageStart()) {
             LogError("Block magic mismatch for %s: %s versus expected %s while reading raw block",
@@ -1113,17 +1427,23 @@ BlockManager::ReadRawBlockResult BlockManager::ReadRawBlock(const FlatFilePos& p
             return util::Unexpected{ReadRawError::IO};
         }
 
+        size_t offset{0};
         if (block_part) {
-            const auto [offset, size]{*block_part};
-            if (size == 0 || SaturatingAdd(offset, size) > blk_size) {
+            const auto [part_offset, size]{*block_part};
+            if (size == 0 || SaturatingAdd(part_offset, size) > blk_size) {
                 return util::Unexpected{ReadRawError::BadPartRange}; // Avoid logging - offset/size come from untrusted REST input
             }
-            filein.seek(offset, SEEK_CUR);
+            offset = part_offset;
             blk_size = size;
         }
 
         std::vector<std::byte> data(blk_size); // Zeroing of memory is intentional here
-        filein.read(data);
+        if (mapped) {
+            read_mapped(data, uint64_t{pos.nPos} + offset);
+        } else {
+            if (offset) filein.seek(offset, SEEK_CUR);
+            filein.read(data);
+        }
         return data;
     } catch (const std::exception& e) {
         LogError("Read from block file failed: %s for %s while reading raw block", e.what(), pos.ToString());
@@ -1231,6 +1551,8 @@ BlockManager::BlockManager(const util::SignalInterrupt& interrupt, Options opts)
 {
     m_block_tree_db = std::make_unique<BlockTreeDB>(m_opts.block_tree_db_params);
 
+    if (m_opts.use_mmap) LogInfo("Reading finalized block files through memory mappings");
+
     if (m_opts.block_tree_db_params.wipe_data) {
         m_block_tree_db->WriteReindexing(true);
         m_blockfiles_indexed = false;
@@ -1315,6 +1637,51 @@ void ImportBlocks(ChainstateManager& chainman, std::span<const fs::path> import_
     // End scope of ImportingNow
 }
 
+bool ProcessRawBlocks(ChainstateManager& chainman, std::span<const std::span<const std::byte>> raw_blocks, int num_workers, std::vector<bool>& new_blocks)
+{
+    const auto decode_block{[&chainman](std::span<const std::byte> raw_block) -> std::shared_ptr<const CBlock> {
+        auto block{std::make_shared<CBlock>()};
+        try {
+            SpanReader{raw_block} >> TX_WITH_WITNESS(*block);
+        } catch (const std::exception&) {
+            LogDebug(BCLog::VALIDATION, "Block decode failed.");
+            return nullptr;
+        }
+        // The block is not shared with any other thread yet, so its fChecked
+        // flag can be set here. If the checks passed, ProcessNewBlock() will
+        // not have to repeat them.
+        BlockValidationState state;
+        CheckBlock(*block, state, chainman.GetConsensus());
+        return block;
+    }};
+
+    ThreadPool pool{"blockimport"};
+    pool.Start(std::max(num_workers, 1));
+    const size_t max_pending{2 * static_cast<size_t>(std::max(num_workers, 1))};
+    std::deque<std::future<std::shared_ptr<const CBlock>>> pending;
+    size_t next_block{0};
+
+    bool result{true};
+    new_blocks.assign(raw_blocks.size(), false);
+    for (size_t i{0}; i < raw_blocks.size(); ++i) {
+        while (next_block < raw_blocks.size() && pending.size() < max_pending) {
+            auto task{pool.Submit([&decode_block, raw_block = raw_blocks[next_block]] { return decode_block(raw_block); })};
+            if (!task) throw std::runtime_error("Failed to submit block to the thread pool");
+            pending.push_back(std::move(*task));
+            ++next_block;
+        }
+        const auto block{pending.front().get()};
+        pending.pop_front();
+
+        bool new_block{false};
+        if (!block || !chainman.ProcessNewBlock(block, /*force_processing=*/true, /*min_pow_checked=*/true, &new_block)) {
+            result = false;
+        }
+        new_blocks[i] = new_block;
+    }
+    return result;
+}
+
 std::ostream& operator<<(std::ostream& os, const BlockfileType& type) {
     switch(type) {
         case BlockfileType::NORMAL: os << "normal"; break;
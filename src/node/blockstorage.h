@@ -45,6 +45,7 @@ class BlockValidationState;
 class CBlockUndo;
 class Chainstate;
 class ChainstateManager;
+class MappedFile;
 namespace Consensus {
 struct Params;
 }
@@ -106,6 +107,9 @@ public:
     void ReadReindexing(bool& fReindexing);
     void WriteFlag(const std::string& name, bool fValue);
     bool ReadFlag(const std::string& name, bool& fValue);
+    /** Mark the block index snapshot with the given checksum as consistent with the database, or erase the mark. */
+    void WriteBlockIndexSnapshotChecksum(const std::optional<uint256>& checksum);
+    std::optional<uint256> ReadBlockIndexSnapshotChecksum();
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 };
@@ -121,6 +125,8 @@ static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 /** The maximum size of a blk?????.dat file (since 0.8) */
 static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
+/** The maximum number of block files kept memory mapped at once, the least recently used one is unmapped first */
+static constexpr size_t MAX_MAPPED_BLOCK_FILES{32};
 
 /** Size of header written by WriteBlock before a serialized CBlock (8 bytes) */
 static constexpr uint32_t STORAGE_HEADER_BYTES{std::tuple_size_v<MessageStartChars> + sizeof(unsigned int)};
@@ -204,6 +210,25 @@ private:
     bool LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Whether LoadBlockIndexDB() completed, so that m_block_index reflects the database. */
+    bool m_block_index_loaded GUARDED_BY(cs_main){false};
+
+    /** Path of the block index snapshot file, next to the block tree database. */
+    fs::path GetBlockIndexSnapshotPath() const;
+
+    /**
+     * Load the block index from the snapshot file if its checksum matches,
+     * including each entry's chain work and skip pointer. Return the loaded
+     * entries sorted by height, or an empty vector if the snapshot could not
+     * be used, in which case m_block_index is left untouched.
+     */
+    std::vector<CBlockIndex*> LoadBlockIndexSnapshot(const uint256& checksum)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Read the block file records from the block tree database the way
+     *  LoadBlockIndexDB() does: up to the last block file, and any after it. */
+    std::vector<CBlockFileInfo> ReadBlockFileInfoDB(int& max_blockfile_num) const;
+
     /** Return false if block file or undo file flushing fails. */
     [[nodiscard]] bool FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo);
 
@@ -253,7 +278,7 @@ private:
         const Chainstate& chain,
         ChainstateManager& chainman);
 
-    RecursiveMutex cs_LastBlockFile;
+    mutable RecursiveMutex cs_LastBlockFile;
 
     //! Since assumedvalid chainstates may be syncing a range of the chain that is very
     //! far away from the normal/background validation process, we should segment blockfiles
@@ -303,6 +328,27 @@ private:
     const FlatFileSeq m_block_file_seq;
     const FlatFileSeq m_undo_file_seq;
 
+    struct MappedBlockFile {
+        //! Null if the file could not be mapped and is read through the file system instead
+        std::shared_ptr<const MappedFile> file;
+        //! Value of m_mapped_block_files_clock when the mapping was last used
+        uint64_t last_used;
+    };
+
+    mutable Mutex m_mapped_block_files_mutex;
+    /**
+     * Read-only mappings of finalized block files, used by ReadRawBlock() if
+     * Options::use_mmap is set. At most MAX_MAPPED_BLOCK_FILES are kept.
+     */
+    mutable std::map<int, MappedBlockFile> m_mapped_block_files GUARDED_BY(m_mapped_block_files_mutex);
+    mutable uint64_t m_mapped_block_files_clock GUARDED_BY(m_mapped_block_files_mutex){0};
+
+    /**
+     * Return a mapping of the block file file_num, or nullptr if it may still
+     * be written to or cannot be mapped.
+     */
+    std::shared_ptr<const MappedFile> GetMappedBlockFile(int file_num) const EXCLUSIVE_LOCKS_REQUIRED(!m_mapped_block_files_mutex);
+
 protected:
     std::vector<CBlockFileInfo> m_blockfile_info;
 
@@ -356,6 +402,16 @@ public:
     std::unique_ptr<BlockTreeDB> m_block_tree_db GUARDED_BY(::cs_main);
 
     void WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Write an image of the in-memory block index to the snapshot file, to be
+     * loaded by the next LoadBlockIndexDB() instead of iterating the block
+     * tree database. This is only done if Options::use_block_index_snapshot
+     * is set and the block index has been fully written to the database, and
+     * is meant to be called on shutdown: the snapshot is invalidated as soon
+     * as it is loaded.
+     */
+    bool WriteBlockIndexSnapshot() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     bool LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -366,7 +422,12 @@ public:
      */
     void ScanAndUnlinkAlreadyPrunedFiles() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    CBlockIndex* AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    CBlockIndex* AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+    {
+        return AddToBlockIndex(block, block.GetHash(), best_header);
+    }
+    //! Same as above, for a header whose hash has already been computed.
+    CBlockIndex* AddToBlockIndex(const CBlockHeader& block, const uint256& hash, CBlockIndex*& best_header) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     /** Create a new block index entry for a given block hash */
     CBlockIndex* InsertBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -466,6 +527,13 @@ public:
      */
     void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const;
 
+    /**
+     * Drop the mappings of all block files. Reads that are in progress keep
+     * the mapping they use until they are done.
+     */
+    void UnmapBlockFiles() const EXCLUSIVE_LOCKS_REQUIRED(!m_mapped_block_files_mutex);
+    size_t MappedBlockFileCount() const EXCLUSIVE_LOCKS_REQUIRED(!m_mapped_block_files_mutex);
+
     /** Functions for disk access for blocks */
     bool ReadBlock(CBlock& block, const FlatFilePos& pos, const std::optional<uint256>& expected_hash) const;
     bool ReadBlock(CBlock& block, const CBlockIndex& index) const;
@@ -478,6 +546,17 @@ public:
 
 // Calls ActivateBestChain() even if no blocks are imported.
 void ImportBlocks(ChainstateManager& chainman, std::span<const fs::path> import_paths);
+
+/**
+ * Process a batch of serialized blocks. The blocks are deserialized and run
+ * through CheckBlock() on num_workers threads, a few blocks ahead of the one
+ * being processed, and passed to ProcessNewBlock() in the order given.
+ *
+ * @param[out] new_blocks  For each block, whether it was not processed before.
+ * @returns whether all blocks could be deserialized and were processed
+ *          successfully, in the sense of ProcessNewBlock().
+ */
+bool ProcessRawBlocks(ChainstateManager& chainman, std::span<const std::span<const std::byte>> raw_blocks, int num_workers, std::vector<bool>& new_blocks);
 } // namespace node
 
 #endif // BITCOIN_NODE_BLOCKSTORAGE_H
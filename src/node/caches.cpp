@@ -6,8 +6,10 @@
 
 #include <common/args.h>
 #include <common/system.h>
+#include <index/scriptindex.h>
 #include <index/txindex.h>
 #include <index/txospenderindex.h>
+#include <index/utxoscriptindex.h>
 #include <kernel/caches.h>
 #include <logging.h>
 #include <node/interface_ui.h>
@@ -25,6 +27,10 @@ static constexpr size_t MAX_TX_INDEX_CACHE{1024_MiB};
 static constexpr size_t MAX_FILTER_INDEX_CACHE{1024_MiB};
 //! Max memory allocated to tx spenderindex DB specific cache in bytes.
 static constexpr size_t MAX_TXOSPENDER_INDEX_CACHE{1024_MiB};
+//! Max memory allocated to script index DB specific cache in bytes.
+static constexpr size_t MAX_SCRIPT_INDEX_CACHE{1024_MiB};
+//! Max memory allocated to UTXO script index DB specific cache in bytes.
+static constexpr size_t MAX_UTXO_SCRIPT_INDEX_CACHE{1024_MiB};
 //! Maximum dbcache size on 32-bit systems.
 static constexpr size_t MAX_32BIT_DBCACHE{1024_MiB};
 //! Larger default dbcache on 64-bit systems with enough RAM.
@@ -63,6 +69,10 @@ CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes)
     total_cache -= index_sizes.tx_index;
     index_sizes.txospender_index = std::min(total_cache / 8, args.GetBoolArg("-txospenderindex", DEFAULT_TXOSPENDERINDEX) ? MAX_TXOSPENDER_INDEX_CACHE : 0);
     total_cache -= index_sizes.txospender_index;
+    index_sizes.script_index = std::min(total_cache / 8, args.GetBoolArg("-scriptindex", DEFAULT_SCRIPTINDEX) ? MAX_SCRIPT_INDEX_CACHE : 0);
+    total_cache -= index_sizes.script_index;
+    index_sizes.utxo_script_index = std::min(total_cache / 8, args.GetBoolArg("-utxoscriptindex", DEFAULT_UTXOSCRIPTINDEX) ? MAX_UTXO_SCRIPT_INDEX_CACHE : 0);
+    total_cache -= index_sizes.utxo_script_index;
     if (n_indexes > 0) {
         size_t max_cache = std::min(total_cache / 8, MAX_FILTER_INDEX_CACHE);
         index_sizes.filter_index = max_cache / n_indexes;
@@ -47,7 +47,7 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
 
     if (auto value{args.GetIntArg("-maxtipage")}) opts.max_tip_age = std::chrono::seconds{*value};
 
-    ReadDatabaseArgs(args, opts.coins_db);
+    if (auto result{ReadDatabaseArgs(args, opts.coins_db, "chainstate")}; !result) return result;
     ReadCoinsViewArgs(args, opts.coins_view);
 
     int script_threads = args.GetIntArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
@@ -59,6 +59,15 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
     // Subtract 1 because the main thread counts towards the par threads.
     opts.worker_threads_num = script_threads - 1;
 
+    if (auto background_script_threads{args.GetIntArg("-parbackground")}) {
+        if (*background_script_threads <= 0) *background_script_threads += GetNumCores();
+        // Subtract 1 because the background validation thread counts towards them.
+        opts.background_worker_threads_num = std::max<int>(*background_script_threads - 1, 0);
+    } else if (const int free_cores{GetNumCores() - script_threads}; free_cores > 1) {
+        // Use the cores that -par leaves free, but no more threads than -par.
+        opts.background_worker_threads_num = std::min(free_cores, script_threads) - 1;
+    }
+
     if (auto max_size = args.GetIntArg("-maxsigcachesize")) {
         // 1. When supplied with a max_size of 0, both the signature cache and
         //    script execution cache create the minimum possible cache (2
@@ -6,13 +6,64 @@
 
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <tinyformat.h>
+#include <util/result.h>
+#include <util/strencodings.h>
+#include <util/translation.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
+/**
+ * Return the value of a tuning option for the database named db_name, if any.
+ * A "<db>:<n>" value for this database takes precedence over a "<n>" value
+ * for all of them; otherwise the last value given wins.
+ */
+static util::Result<std::optional<int64_t>> GetDatabaseIntArg(const ArgsManager& args, const std::string& arg, std::string_view db_name, int64_t min, int64_t max)
+{
+    std::optional<int64_t> all_dbs, this_db;
+    for (const std::string& value : args.GetArgs(arg)) {
+        const auto sep{value.rfind(':')};
+        const std::string_view name{sep == std::string::npos ? std::string_view{} : std::string_view{value}.substr(0, sep)};
+        const auto n{ToIntegral<int64_t>(sep == std::string::npos ? value : value.substr(sep + 1))};
+        if (!n || *n < min || *n > max || (sep != std::string::npos && name.empty())) {
+            return util::Error{Untranslated(strprintf("Invalid %s value (%s), must be [<db>:]<n> with <n> between %d and %d", arg, value, min, max))};
+        }
+        if (sep == std::string::npos) {
+            all_dbs = n;
+        } else if (name == db_name) {
+            this_db = n;
+        }
+    }
+    return this_db ? this_db : all_dbs;
+}
+
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_name)
 {
-    // Settings here apply to all databases (chainstate, blocks, and index
-    // databases), but it'd be easy to parse database-specific options by adding
-    // a database_type string or enum parameter to this function.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+
+    auto bloom_bits{GetDatabaseIntArg(args, "-dbbloombits", db_name, 0, 64)};
+    if (!bloom_bits) return util::Error{util::ErrorString(bloom_bits)};
+    if (*bloom_bits) options.bloom_bits = **bloom_bits;
+
+    auto block_size{GetDatabaseIntArg(args, "-dbblocksize", db_name, 1, 1024)};
+    if (!block_size) return util::Error{util::ErrorString(block_size)};
+    if (*block_size) options.block_size = size_t(**block_size) << 10;
+
+    auto write_buffer{GetDatabaseIntArg(args, "-dbwritebuffer", db_name, 1, 1024)};
+    if (!write_buffer) return util::Error{util::ErrorString(write_buffer)};
+    if (*write_buffer) options.write_buffer_size = size_t(**write_buffer) << 20;
+
+    auto max_file_size{GetDatabaseIntArg(args, "-dbmaxfilesize", db_name, 1, 1024)};
+    if (!max_file_size) return util::Error{util::ErrorString(max_file_size)};
+    if (*max_file_size) options.max_file_size = size_t(**max_file_size) << 20;
+
+    auto compaction_rate{GetDatabaseIntArg(args, "-dbcompactrate", db_name, 0, 1024)};
+    if (!compaction_rate) return util::Error{util::ErrorString(compaction_rate)};
+    if (*compaction_rate) options.compaction_rate = size_t(**compaction_rate) << 20;
+
+    return {};
 }
 } // namespace node
@@ -5,11 +5,24 @@
 #ifndef BITCOIN_NODE_DATABASE_ARGS_H
 #define BITCOIN_NODE_DATABASE_ARGS_H
 
+#include <util/result.h>
+
+#include <string_view>
+
 class ArgsManager;
 struct DBOptions;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options);
+/**
+ * Read the options of the database named db_name: "chainstate", "blockindex",
+ * or the name of the directory of an index under "indexes" (e.g. "txindex").
+ * Tuning options are given either as "<n>" for all databases or as
+ * "<db>:<n>" for a single one, which takes precedence.
+ *
+ * Fails if any tuning option, including those given for other databases,
+ * is invalid.
+ */
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_name);
 } // namespace node
 
 #endif // BITCOIN_NODE_DATABASE_ARGS_H
@@ -6,6 +6,7 @@
 #include <primitives/block.h>
 
 #include <hash.h>
+#include <primitives/block_view.h>
 #include <tinyformat.h>
 
 #include <memory>
@@ -17,6 +18,14 @@ uint256 CBlockHeader::GetHash() const
     return (HashWriter{} << *this).GetHash();
 }
 
+size_t CBlock::UnserializeFrom(std::span<const std::byte> data)
+{
+    const BlockView view{data};
+    *static_cast<CBlockHeader*>(this) = view.GetHeader();
+    vtx = view.ToTransactions();
+    return view.Serialized().size();
+}
+
 std::string CBlock::ToString() const
 {
     std::stringstream s;
@@ -11,7 +11,10 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <ios>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -92,9 +95,33 @@ public:
         *(static_cast<CBlockHeader*>(this)) = header;
     }
 
-    SERIALIZE_METHODS(CBlock, obj)
+    template <typename Stream>
+    void Serialize(Stream& s) const
     {
-        READWRITE(AsBase<CBlockHeader>(obj), obj.vtx);
+        s << AsBase<CBlockHeader>(*this) << vtx;
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        // If the serialized block is in memory already, hash the transactions
+        // from it rather than serializing them again.
+        if constexpr (requires { s.GetStream().data(); }) {
+            if (s.template GetParams<TransactionSerParams>().allow_witness) {
+                try {
+                    s.ignore(UnserializeFrom({s.GetStream().data(), s.size()}));
+                    return;
+                } catch (const std::ios_base::failure&) {
+                    // Malformed: read it from the stream below, so that it fails
+                    // with the same error as from any other stream.
+                }
+            }
+        }
+        // Read all transactions before converting them, so that their txids
+        // and wtxids can be computed together.
+        std::vector<CMutableTransaction> txs;
+        s >> AsBase<CBlockHeader>(*this) >> txs;
+        vtx = MakeTransactionRefs(std::move(txs));
     }
 
     void SetNull()
@@ -107,6 +134,11 @@ public:
     }
 
     std::string ToString() const;
+
+private:
+    /** Deserialize from a block serialized with witnesses at the start of data
+     *  (see BlockView), and return its size. */
+    size_t UnserializeFrom(std::span<const std::byte> data);
 };
 
 /** Describes a place in the block chain to another node such that if the
@@ -0,0 +1,339 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block_view.h>
+
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+#include <hash.h>
+#include <serialize.h>
+#include <streams.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <ios>
+#include <limits>
+#include <memory>
+
+namespace {
+/** The size of a serialized COutPoint. */
+constexpr size_t OUTPOINT_SIZE{32 + 4};
+/** The smallest possible serialized transaction: version, two empty vectors and nLockTime. */
+constexpr size_t MIN_TX_SIZE{4 + 1 + 1 + 4};
+
+/** Reads the parts of a serialized block that BlockView doesn't record, and tracks the position in it. */
+class BlockParser
+{
+private:
+    std::span<const std::byte> m_data;
+    SpanReader m_reader;
+
+public:
+    explicit BlockParser(std::span<const std::byte> data) : m_data{data}, m_reader{data} {}
+
+    uint32_t Pos() const { return m_data.size() - m_reader.size(); }
+    void Skip(size_t n) { m_reader.ignore(n); }
+    uint64_t CompactSize() { return ReadCompactSize(m_reader); }
+    uint8_t Byte() { return ser_readdata8(m_reader); }
+    void Header(CBlockHeader& header) { m_reader >> header; }
+
+    /** Skip a script or a witness stack item. */
+    void SkipBytes() { Skip(CompactSize()); }
+    void SkipWitnessStack()
+    {
+        for (uint64_t n{CompactSize()}; n > 0; --n) SkipBytes();
+    }
+};
+} // namespace
+
+COutPoint TxInView::prevout() const
+{
+    COutPoint ret;
+    SpanReader{m_data.first(OUTPOINT_SIZE)} >> ret;
+    return ret;
+}
+
+uint32_t TxInView::nSequence() const
+{
+    return ReadLE32(m_data.last(4).data());
+}
+
+std::vector<std::span<const std::byte>> TxInView::WitnessStack() const
+{
+    std::vector<std::span<const std::byte>> ret;
+    if (m_witness.empty()) return ret;
+    SpanReader reader{m_witness};
+    ret.resize(ReadCompactSize(reader));
+    for (auto& item : ret) {
+        const size_t size = ReadCompactSize(reader);
+        item = m_witness.subspan(m_witness.size() - reader.size(), size);
+        reader.ignore(size);
+    }
+    return ret;
+}
+
+CAmount TxOutView::nValue() const
+{
+    return static_cast<CAmount>(ReadLE64(m_data.data()));
+}
+
+uint32_t TxView::version() const
+{
+    return ReadLE32(Serialized().data());
+}
+
+uint32_t TxView::nLockTime() const
+{
+    return ReadLE32(Serialized().last(4).data());
+}
+
+bool TxView::HasWitness() const
+{
+    return m_block->m_txs[m_index].has_witness;
+}
+
+size_t TxView::InputCount() const
+{
+    const auto& txs{m_block->m_txs};
+    const uint32_t end{m_index + 1 < txs.size() ? txs[m_index + 1].first_input : uint32_t(m_block->m_inputs.size())};
+    return end - txs[m_index].first_input;
+}
+
+TxInView TxView::Input(size_t index) const
+{
+    const auto& pos{m_block->m_inputs.at(m_block->m_txs[m_index].first_input + index)};
+    const auto data{m_block->m_data};
+    return TxInView{data.subspan(pos.begin, pos.end - pos.begin),
+                    data.subspan(pos.script_begin, pos.end - 4 - pos.script_begin),
+                    data.subspan(pos.witness_begin, pos.witness_end - pos.witness_begin)};
+}
+
+size_t TxView::OutputCount() const
+{
+    const auto& txs{m_block->m_txs};
+    const uint32_t end{m_index + 1 < txs.size() ? txs[m_index + 1].first_output : uint32_t(m_block->m_outputs.size())};
+    return end - txs[m_index].first_output;
+}
+
+TxOutView TxView::Output(size_t index) const
+{
+    const auto& pos{m_block->m_outputs.at(m_block->m_txs[m_index].first_output + index)};
+    const auto data{m_block->m_data};
+    return TxOutView{data.subspan(pos.begin, pos.end - pos.begin),
+                     data.subspan(pos.script_begin, pos.end - pos.script_begin)};
+}
+
+std::span<const std::byte> TxView::Serialized() const
+{
+    const auto& pos{m_block->m_txs[m_index]};
+    return m_block->m_data.subspan(pos.begin, pos.end - pos.begin);
+}
+
+size_t TxView::Offset() const
+{
+    return m_block->m_txs[m_index].begin;
+}
+
+size_t TxView::StrippedSize() const
+{
+    const auto& pos{m_block->m_txs[m_index]};
+    if (!pos.has_witness) return pos.end - pos.begin;
+    return 4 + (pos.body_end - pos.body_begin) + 4;
+}
+
+Txid TxView::ComputeHash() const
+{
+    const auto& pos{m_block->m_txs[m_index]};
+    const auto tx{Serialized()};
+    if (!pos.has_witness) return Txid::FromUint256(Hash(tx));
+    // Leave out the witness flag and the witnesses.
+    uint256 hash;
+    CHash256().Write(UCharSpanCast(tx.first(4))).Write(UCharSpanCast(m_block->m_data.subspan(pos.body_begin, pos.body_end - pos.body_begin))).Write(UCharSpanCast(tx.last(4))).Finalize(hash);
+    return Txid::FromUint256(hash);
+}
+
+Wtxid TxView::ComputeWitnessHash() const
+{
+    return Wtxid::FromUint256(Hash(Serialized()));
+}
+
+CTransactionRef TxView::ToTransaction() const
+{
+    SpanReader reader{Serialized()};
+    return std::make_shared<const CTransaction>(deserialize, TX_WITH_WITNESS, reader);
+}
+
+BlockView::BlockView(std::span<const std::byte> data) : m_data{data}
+{
+    if (data.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::ios_base::failure("BlockView: block too large");
+    }
+    BlockParser parser{data};
+    parser.Header(m_header);
+    const uint64_t tx_count{parser.CompactSize()};
+    // Don't trust the count for allocating more than the block could hold.
+    m_txs.reserve(std::min<uint64_t>(tx_count, data.size() / MIN_TX_SIZE));
+    for (uint64_t n{tx_count}; n > 0; --n) {
+        TxPos& tx{m_txs.emplace_back()};
+        tx.begin = parser.Pos();
+        tx.first_input = m_inputs.size();
+        tx.first_output = m_outputs.size();
+        parser.Skip(4); // version
+
+        // Same as UnserializeTransaction(), which describes the format.
+        uint8_t flags{0};
+        tx.body_begin = parser.Pos();
+        uint64_t inputs{parser.CompactSize()};
+        bool has_outputs{true};
+        if (inputs == 0) {
+            flags = parser.Byte();
+            if (flags != 0) {
+                tx.body_begin = parser.Pos();
+                inputs = parser.CompactSize();
+            } else {
+                has_outputs = false;
+            }
+        }
+        for (uint64_t n{inputs}; n > 0; --n) {
+            InputPos& input{m_inputs.emplace_back()};
+            input.begin = parser.Pos();
+            parser.Skip(OUTPOINT_SIZE);
+            const uint64_t script_size{parser.CompactSize()};
+            input.script_begin = parser.Pos();
+            parser.Skip(script_size);
+            parser.Skip(4); // nSequence
+            input.end = parser.Pos();
+            input.witness_begin = input.witness_end = input.end;
+        }
+        if (has_outputs) {
+            for (uint64_t n{parser.CompactSize()}; n > 0; --n) {
+                OutputPos& output{m_outputs.emplace_back()};
+                output.begin = parser.Pos();
+                parser.Skip(8); // nValue
+                const uint64_t script_size{parser.CompactSize()};
+                output.script_begin = parser.Pos();
+                parser.Skip(script_size);
+                output.end = parser.Pos();
+            }
+        }
+        tx.body_end = parser.Pos();
+        tx.has_witness = false;
+        if (flags & 1) {
+            flags ^= 1;
+            for (uint64_t i{0}; i < inputs; ++i) {
+                InputPos& input{m_inputs[tx.first_input + i]};
+                input.witness_begin = parser.Pos();
+                // A stack with no items is serialized as a single zero byte.
+                parser.SkipWitnessStack();
+                input.witness_end = parser.Pos();
+                tx.has_witness |= input.witness_end - input.witness_begin > 1;
+            }
+            if (!tx.has_witness) {
+                throw std::ios_base::failure("Superfluous witness record");
+            }
+        }
+        if (flags) {
+            throw std::ios_base::failure("Unknown transaction optional data");
+        }
+        parser.Skip(4); // nLockTime
+        tx.end = parser.Pos();
+    }
+    // Leave out anything that follows the block.
+    m_data = data.first(parser.Pos());
+}
+
+size_t BlockView::StrippedSize() const
+{
+    size_t ret{m_data.size()};
+    for (size_t i{0}; i < m_txs.size(); ++i) {
+        ret -= (m_txs[i].end - m_txs[i].begin) - Tx(i).StrippedSize();
+    }
+    return ret;
+}
+
+void BlockView::ComputeHashes(std::vector<Txid>& txids, std::vector<Wtxid>* wtxids) const
+{
+    // Transactions without witness are hashed in place. Those with a witness
+    // are copied without it into a scratch buffer first for their txid, and
+    // hashed in place for their wtxid.
+    std::vector<std::byte> stripped;
+    size_t witness_count{0};
+    for (size_t i{0}; i < m_txs.size(); ++i) {
+        if (!m_txs[i].has_witness) continue;
+        stripped.resize(stripped.size() + Tx(i).StrippedSize());
+        ++witness_count;
+    }
+    const size_t count{m_txs.size() + (wtxids ? witness_count : 0)};
+    std::vector<const unsigned char*> inputs;
+    std::vector<size_t> lengths;
+    inputs.reserve(count);
+    lengths.reserve(count);
+    size_t offset{0};
+    for (const TxPos& pos : m_txs) {
+        if (!pos.has_witness) {
+            inputs.push_back(UCharCast(m_data.data() + pos.begin));
+            lengths.push_back(pos.end - pos.begin);
+            continue;
+        }
+        const size_t body_size{pos.body_end - pos.body_begin};
+        std::byte* out{stripped.data() + offset};
+        std::memcpy(out, m_data.data() + pos.begin, 4);
+        std::memcpy(out + 4, m_data.data() + pos.body_begin, body_size);
+        std::memcpy(out + 4 + body_size, m_data.data() + pos.end - 4, 4);
+        inputs.push_back(UCharCast(out));
+        lengths.push_back(4 + body_size + 4);
+        offset += lengths.back();
+    }
+    assert(offset == stripped.size());
+    if (wtxids) {
+        for (const TxPos& pos : m_txs) {
+            if (!pos.has_witness) continue;
+            inputs.push_back(UCharCast(m_data.data() + pos.begin));
+            lengths.push_back(pos.end - pos.begin);
+        }
+    }
+    assert(inputs.size() == count);
+
+    std::vector<unsigned char> hashes(count * uint256::size());
+    SHA256DMulti(hashes.data(), inputs.data(), lengths.data(), count);
+    const auto hash_at{[&](size_t i) { return uint256{std::span{hashes}.subspan(i * uint256::size(), uint256::size())}; }};
+    txids.clear();
+    txids.reserve(m_txs.size());
+    for (size_t i{0}; i < m_txs.size(); ++i) {
+        txids.push_back(Txid::FromUint256(hash_at(i)));
+    }
+    if (wtxids) {
+        wtxids->clear();
+        wtxids->reserve(m_txs.size());
+        size_t next_hash{m_txs.size()};
+        for (size_t i{0}; i < m_txs.size(); ++i) {
+            wtxids->push_back(Wtxid::FromUint256(m_txs[i].has_witness ? hash_at(next_hash++) : txids[i].ToUint256()));
+        }
+    }
+}
+
+std::vector<Txid> BlockView::ComputeTxids() const
+{
+    std::vector<Txid> ret;
+    ComputeHashes(ret, /*wtxids=*/nullptr);
+    return ret;
+}
+
+std::vector<CTransactionRef> BlockView::ToTransactions() const
+{
+    std::vector<CMutableTransaction> txs;
+    txs.reserve(m_txs.size());
+    for (size_t i{0}; i < m_txs.size(); ++i) {
+        SpanReader reader{Tx(i).Serialized()};
+        txs.emplace_back(deserialize, TX_WITH_WITNESS, reader);
+        // The hashes are taken from the buffer, so they are only those of the
+        // transaction if it was deserialized from exactly its bytes.
+        if (!reader.empty()) throw std::ios_base::failure("BlockView: transaction size mismatch");
+    }
+    std::vector<Txid> txids;
+    std::vector<Wtxid> wtxids;
+    ComputeHashes(txids, &wtxids);
+    return MakeTransactionRefs(std::move(txs), txids, wtxids);
+}
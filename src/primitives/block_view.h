@@ -0,0 +1,173 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_PRIMITIVES_BLOCK_VIEW_H
+#define BITCOIN_PRIMITIVES_BLOCK_VIEW_H
+
+#include <attributes.h>
+#include <consensus/amount.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <primitives/transaction_identifier.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class BlockView;
+
+/** An input of a transaction in a BlockView. */
+class TxInView
+{
+private:
+    friend class TxView;
+
+    //! The serialized prevout, scriptSig and nSequence.
+    std::span<const std::byte> m_data;
+    std::span<const std::byte> m_script_sig;
+    std::span<const std::byte> m_witness;
+
+    TxInView(std::span<const std::byte> data, std::span<const std::byte> script_sig, std::span<const std::byte> witness)
+        : m_data{data}, m_script_sig{script_sig}, m_witness{witness} {}
+
+public:
+    COutPoint prevout() const;
+    std::span<const std::byte> scriptSig() const { return m_script_sig; }
+    uint32_t nSequence() const;
+
+    /** The serialized witness stack, empty if the transaction has no witness. */
+    std::span<const std::byte> witness() const { return m_witness; }
+    /** The items of the witness stack. */
+    std::vector<std::span<const std::byte>> WitnessStack() const;
+};
+
+/** An output of a transaction in a BlockView. */
+class TxOutView
+{
+private:
+    friend class TxView;
+
+    std::span<const std::byte> m_data;
+    std::span<const std::byte> m_script_pub_key;
+
+    TxOutView(std::span<const std::byte> data, std::span<const std::byte> script_pub_key)
+        : m_data{data}, m_script_pub_key{script_pub_key} {}
+
+public:
+    CAmount nValue() const;
+    std::span<const std::byte> scriptPubKey() const { return m_script_pub_key; }
+};
+
+/** A transaction in a BlockView. Like the view itself, this refers to the
+ *  buffer that the view was parsed from. */
+class TxView
+{
+private:
+    friend class BlockView;
+
+    const BlockView* m_block;
+    size_t m_index;
+
+    TxView(const BlockView& block LIFETIMEBOUND, size_t index) : m_block{&block}, m_index{index} {}
+
+public:
+    uint32_t version() const;
+    uint32_t nLockTime() const;
+    bool HasWitness() const;
+
+    size_t InputCount() const;
+    TxInView Input(size_t index) const;
+    size_t OutputCount() const;
+    TxOutView Output(size_t index) const;
+
+    /** The serialization of the transaction including its witness. */
+    std::span<const std::byte> Serialized() const;
+    /** The offset of the transaction from the start of the block. */
+    size_t Offset() const;
+    /** The size of the transaction serialized without witness. */
+    size_t StrippedSize() const;
+
+    /** Hash the transaction. This is not cached: every call hashes it again. */
+    Txid ComputeHash() const;
+    Wtxid ComputeWitnessHash() const;
+
+    /** Deserialize the transaction, for code that needs a CTransaction after all. */
+    CTransactionRef ToTransaction() const;
+};
+
+/**
+ * A read-only view of a serialized block (including witnesses) that is parsed
+ * in place. Rather than building a CTransaction with its own vectors and
+ * scripts for every transaction, it records where the transactions, their
+ * inputs and their outputs are in the buffer, in three flat vectors.
+ *
+ * The buffer must outlive the view and every TxView, TxInView and TxOutView
+ * obtained from it.
+ */
+class BlockView
+{
+private:
+    friend class TxView;
+
+    struct TxPos {
+        uint32_t begin;
+        uint32_t end;
+        //! The serialized inputs and outputs, between the version (and witness flag) and the witnesses.
+        uint32_t body_begin;
+        uint32_t body_end;
+        uint32_t first_input;
+        uint32_t first_output;
+        bool has_witness;
+    };
+    struct InputPos {
+        uint32_t begin;
+        //! The scriptSig, after its length.
+        uint32_t script_begin;
+        uint32_t end;
+        uint32_t witness_begin;
+        uint32_t witness_end;
+    };
+    struct OutputPos {
+        uint32_t begin;
+        //! The scriptPubKey, after its length.
+        uint32_t script_begin;
+        uint32_t end;
+    };
+
+    std::span<const std::byte> m_data;
+    CBlockHeader m_header;
+    std::vector<TxPos> m_txs;
+    std::vector<InputPos> m_inputs;
+    std::vector<OutputPos> m_outputs;
+
+    /** Hash all transactions at once, also with witness if wtxids is set. */
+    void ComputeHashes(std::vector<Txid>& txids, std::vector<Wtxid>* wtxids) const;
+
+public:
+    /** Parse a serialized block. Throws std::ios_base::failure if it is
+     *  malformed, in the same cases as deserializing a CBlock does. Anything
+     *  that follows the block in data is not part of the view. */
+    explicit BlockView(std::span<const std::byte> data LIFETIMEBOUND);
+
+    const CBlockHeader& GetHeader() const LIFETIMEBOUND { return m_header; }
+    uint256 GetHash() const { return m_header.GetHash(); }
+
+    size_t TxCount() const { return m_txs.size(); }
+    TxView Tx(size_t index) const LIFETIMEBOUND { return TxView{*this, index}; }
+
+    /** The serialized block. */
+    std::span<const std::byte> Serialized() const { return m_data; }
+    /** The size of the block serialized without witnesses. */
+    size_t StrippedSize() const;
+
+    /** The txids of all transactions, hashed several at a time where the CPU supports it. */
+    std::vector<Txid> ComputeTxids() const;
+
+    /** Deserialize all transactions. Their txids and wtxids are hashed from the
+     *  buffer, rather than from a serialization of the deserialized transactions. */
+    std::vector<CTransactionRef> ToTransactions() const;
+};
+
+#endif // BITCOIN_PRIMITIVES_BLOCK_VIEW_H
@@ -7,16 +7,22 @@
 
 #include <consensus/amount.h>
 #include <crypto/hex_base.h>
+#include <crypto/sha256.h>
 #include <hash.h>
 #include <primitives/transaction_identifier.h>
 #include <script/script.h>
 #include <serialize.h>
+#include <streams.h>
 #include <tinyformat.h>
+#include <uint256.h>
 
 #include <algorithm>
 #include <cassert>
+#include <memory>
 #include <span>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 std::string COutPoint::ToString() const
 {
@@ -94,6 +100,55 @@ Wtxid CTransaction::ComputeWitnessHash() const
 
 CTransaction::CTransaction(const CMutableTransaction& tx) : vin(tx.vin), vout(tx.vout), version{tx.version}, nLockTime{tx.nLockTime}, m_has_witness{ComputeHasWitness()}, hash{ComputeHash()}, m_witness_hash{ComputeWitnessHash()} {}
 CTransaction::CTransaction(CMutableTransaction&& tx) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), version{tx.version}, nLockTime{tx.nLockTime}, m_has_witness{ComputeHasWitness()}, hash{ComputeHash()}, m_witness_hash{ComputeWitnessHash()} {}
+CTransaction::CTransaction(PrecomputedHashesKey, CMutableTransaction&& tx, const Txid& hash, const Wtxid& witness_hash) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), version{tx.version}, nLockTime{tx.nLockTime}, m_has_witness{ComputeHasWitness()}, hash{hash}, m_witness_hash{witness_hash} {}
+
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs)
+{
+    // Serialize every transaction without witness, and those that have one
+    // also with witness, into a single buffer, and hash them all at once.
+    std::vector<unsigned char> ser;
+    std::vector<size_t> offsets{0};
+    for (const CMutableTransaction& tx : txs) {
+        VectorWriter{ser, ser.size(), TX_NO_WITNESS(tx)};
+        offsets.push_back(ser.size());
+        if (tx.HasWitness()) {
+            VectorWriter{ser, ser.size(), TX_WITH_WITNESS(tx)};
+            offsets.push_back(ser.size());
+        }
+    }
+    const size_t count{offsets.size() - 1};
+    std::vector<const unsigned char*> inputs(count);
+    std::vector<size_t> lengths(count);
+    for (size_t i{0}; i < count; ++i) {
+        inputs[i] = ser.data() + offsets[i];
+        lengths[i] = offsets[i + 1] - offsets[i];
+    }
+    std::vector<unsigned char> hashes(count * uint256::size());
+    SHA256DMulti(hashes.data(), inputs.data(), lengths.data(), count);
+
+    std::vector<Txid> txids;
+    std::vector<Wtxid> wtxids;
+    txids.reserve(txs.size());
+    wtxids.reserve(txs.size());
+    size_t next_hash{0};
+    const auto hash_at{[&](size_t i) { return uint256{std::span{hashes}.subspan(i * uint256::size(), uint256::size())}; }};
+    for (const CMutableTransaction& tx : txs) {
+        const Txid& txid{txids.emplace_back(Txid::FromUint256(hash_at(next_hash++)))};
+        wtxids.push_back(tx.HasWitness() ? Wtxid::FromUint256(hash_at(next_hash++)) : Wtxid::FromUint256(txid.ToUint256()));
+    }
+    return MakeTransactionRefs(std::move(txs), txids, wtxids);
+}
+
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs, std::span<const Txid> txids, std::span<const Wtxid> wtxids)
+{
+    assert(txids.size() == txs.size() && wtxids.size() == txs.size());
+    std::vector<CTransactionRef> ret;
+    ret.reserve(txs.size());
+    for (size_t i{0}; i < txs.size(); ++i) {
+        ret.push_back(std::make_shared<const CTransaction>(CTransaction::PrecomputedHashesKey{}, std::move(txs[i]), txids[i], wtxids[i]));
+    }
+    return ret;
+}
 
 CAmount CTransaction::GetValueOut() const
 {
@@ -19,6 +19,7 @@
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <span>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -304,10 +305,20 @@ private:
 
     bool ComputeHasWitness() const;
 
+    //! Restricts the constructor taking precomputed hashes to MakeTransactionRefs().
+    class PrecomputedHashesKey
+    {
+        PrecomputedHashesKey() = default;
+        friend std::vector<std::shared_ptr<const CTransaction>> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs, std::span<const Txid> txids, std::span<const Wtxid> wtxids);
+    };
+    friend std::vector<std::shared_ptr<const CTransaction>> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs, std::span<const Txid> txids, std::span<const Wtxid> wtxids);
+
 public:
     /** Convert a CMutableTransaction into a CTransaction. */
     explicit CTransaction(const CMutableTransaction& tx);
     explicit CTransaction(CMutableTransaction&& tx);
+    /** Convert a CMutableTransaction whose txid and wtxid have already been computed. */
+    CTransaction(PrecomputedHashesKey, CMutableTransaction&& tx, const Txid& hash, const Wtxid& witness_hash);
 
     template <typename Stream>
     inline void Serialize(Stream& s) const {
@@ -403,4 +414,18 @@ struct CMutableTransaction
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
 
+/**
+ * Convert a batch of transactions, such as those of a block. Their txids and
+ * wtxids are computed together with SHA256DMulti(), which hashes several
+ * transactions at a time where the CPU supports it.
+ */
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs);
+
+/**
+ * Convert a batch of transactions whose txids and wtxids have already been
+ * computed, e.g. from their serialization in a BlockView. The hashes are not
+ * checked against the transactions.
+ */
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs, std::span<const Txid> txids, std::span<const Wtxid> wtxids);
+
 #endif // BITCOIN_PRIMITIVES_TRANSACTION_H
@@ -172,6 +172,7 @@ QT_TRANSLATE_NOOP("bitcoin-core", "Private broadcast of own transactions request
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune cannot be configured with a negative value."),
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune configured below the minimum of %d MiB.  Please use a higher number."),
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune mode is incompatible with -reindex-chainstate. Use full -reindex instead."),
+QT_TRANSLATE_NOOP("bitcoin-core", "Prune mode is incompatible with -scriptindex."),
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune mode is incompatible with -txindex."),
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune mode is incompatible with -txospenderindex."),
 QT_TRANSLATE_NOOP("bitcoin-core", "Prune: last wallet synchronisation goes beyond pruned data. You need to -reindex (download the whole blockchain again in case of a pruned node)"),
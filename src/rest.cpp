@@ -8,16 +8,20 @@
 #include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
+#include <coins.h>
 #include <core_io.h>
 #include <flatfile.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/scriptindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/json_writer.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
@@ -32,6 +36,7 @@
 #include <validation.h>
 
 #include <any>
+#include <optional>
 #include <vector>
 
 #include <univalue.h>
@@ -423,7 +428,7 @@ static bool rest_block(const std::any& context,
         pos = pblockindex->GetBlockPos();
     }
 
-    const auto block_data{chainman.m_blockman.ReadRawBlock(pos, block_part)};
+    auto block_data{chainman.m_blockman.ReadRawBlock(pos, block_part)};
     if (!block_data) {
         switch (block_data.error()) {
         case node::ReadRawError::IO: return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "I/O error reading " + hashStr);
@@ -437,7 +442,7 @@ static bool rest_block(const std::any& context,
     switch (rf) {
     case RESTResponseFormat::BINARY: {
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, *block_data);
+        req->WriteReply(HTTP_OK, std::move(*block_data));
         return true;
     }
 
@@ -450,10 +455,16 @@ static bool rest_block(const std::any& context,
 
     case RESTResponseFormat::JSON: {
         if (tx_verbosity) {
-            CBlock block{};
-            SpanReader{*block_data} >> TX_WITH_WITNESS(block);
-            UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, *tx_verbosity, chainman.GetConsensus().powLimit);
-            std::string strJSON = objBlock.write() + "\n";
+            std::string strJSON;
+            JSONWriter writer{strJSON};
+            if (*tx_verbosity == TxVerbosity::SHOW_TXID) {
+                blockToJSON(writer, BlockView{*block_data}, *tip, *pblockindex, chainman.GetConsensus().powLimit);
+            } else {
+                CBlock block{};
+                SpanReader{*block_data} >> TX_WITH_WITNESS(block);
+                blockToJSON(writer, chainman.m_blockman, block, *tip, *pblockindex, *tx_verbosity, chainman.GetConsensus().powLimit);
+            }
+            strJSON += '\n';
             req->WriteHeader("Content-Type", "application/json");
             req->WriteReply(HTTP_OK, strJSON);
             return true;
@@ -819,7 +830,13 @@ static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::s
             if (verbose && mempool_sequence) {
                 return RESTERR(req, HTTP_BAD_REQUEST, "Verbose results cannot contain mempool sequence values. (hint: set \"verbose=false\")");
             }
-            str_json = MempoolToJSON(*mempool, verbose, mempool_sequence).write() + "\n";
+            if (verbose) {
+                JSONWriter writer{str_json};
+                MempoolToJSON(writer, *mempool);
+                str_json += '\n';
+            } else {
+                str_json = MempoolToJSON(*mempool, verbose, mempool_sequence).write() + "\n";
+            }
         } else {
             str_json = MempoolInfoToJSON(*mempool).write() + "\n";
         }
@@ -893,6 +910,63 @@ static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string
     }
 }
 
+static bool rest_script_history(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, uri_part);
+
+    if (!g_scriptindex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Requires -scriptindex");
+    }
+    const auto script{ParseScriptOrAddress(param)};
+    if (!script) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address or script: " + param);
+    }
+
+    std::optional<std::string> raw_count, raw_cursor;
+    try {
+        raw_count = req->GetQueryParameter("count");
+        raw_cursor = req->GetQueryParameter("cursor");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto count{raw_count ? ToIntegral<int>(*raw_count) : DEFAULT_SCRIPT_HISTORY_COUNT};
+    if (!count || *count < 1 || *count > MAX_SCRIPT_HISTORY_COUNT) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("count must be between 1 and %d", MAX_SCRIPT_HISTORY_COUNT));
+    }
+    ScriptHistoryPosition start;
+    if (raw_cursor) {
+        const auto pos{ScriptHistoryPosition::FromHex(*raw_cursor)};
+        if (!pos) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor: " + *raw_cursor);
+        }
+        start = *pos;
+    }
+
+    if (!g_scriptindex->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "The script index is still being built");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        std::optional<ScriptHistoryPosition> next;
+        const auto history{g_scriptindex->FindHistory(*script, start, *count, next)};
+        if (!history) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, history.error());
+        }
+        std::string strJSON = ScriptHistoryToJSON(*history, next).write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static bool rest_getutxos(const std::any& context, HTTPRequest* req, const std::string& uri_part)
 {
     if (!CheckWarmup(req))
@@ -1019,8 +1093,20 @@ static bool rest_getutxos(const std::any& context, HTTPRequest* req, const std::
             CCoinsViewMemPool viewMempool(&viewChain, *mempool);
             process_utxos(viewMempool, mempool);
         } else {
-            LOCK(cs_main);
-            process_utxos(chainman.ActiveChainstate().CoinsTip(), nullptr);
+            // Look the coins up without holding cs_main, if possible.
+            const auto shared_view{WITH_LOCK(cs_main, return chainman.ActiveChainstate().CoinsShared())};
+            std::vector<std::optional<Coin>> coins;
+            if (const auto best_block{shared_view->GetCoins(vOutPoints, coins)}) {
+                for (auto& coin : coins) {
+                    hits.push_back(coin.has_value());
+                    if (coin) outs.emplace_back(std::move(*coin));
+                }
+                active_height = WITH_LOCK(cs_main, return Assert(chainman.m_blockman.LookupBlockIndex(*best_block))->nHeight);
+                active_hash = *best_block;
+            } else {
+                LOCK(cs_main);
+                process_utxos(chainman.ActiveChainstate().CoinsTip(), nullptr);
+            }
         }
 
         for (size_t i = 0; i < hits.size(); ++i) {
@@ -1151,6 +1237,7 @@ static const struct {
     {"/rest/mempool/", rest_mempool},
     {"/rest/headers/", rest_headers},
     {"/rest/getutxos", rest_getutxos},
+    {"/rest/scripthistory/", rest_script_history},
     {"/rest/deploymentinfo/", rest_deploymentinfo},
     {"/rest/deploymentinfo", rest_deploymentinfo},
     {"/rest/blockhashbyheight/", rest_blockhash_by_height},
@@ -12,7 +12,9 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <consensus/amount.h>
+#include <consensus/consensus.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <core_io.h>
@@ -22,7 +24,10 @@
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/scriptindex.h>
+#include <index/utxoscriptindex.h>
 #include <interfaces/mining.h>
+#include <key_io.h>
 #include <kernel/coinstats.h>
 #include <logging/timer.h>
 #include <net.h>
@@ -32,7 +37,9 @@
 #include <node/transaction.h>
 #include <node/utxo_snapshot.h>
 #include <node/warnings.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
+#include <rpc/json_writer.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -49,14 +56,21 @@
 #include <util/fs.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/threadpool.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <versionbits.h>
 
 #include <cstdint>
+#include <cstdio>
 
+#include <algorithm>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <mutex>
@@ -75,16 +89,20 @@ using node::NodeContext;
 using node::SnapshotMetadata;
 using util::MakeUnorderedList;
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
-PrepareUTXOSnapshot(
-    Chainstate& chainstate,
-    const std::function<void()>& interruption_point = {})
+/** Number of coins written to a UTXO snapshot before they are handed to the hashing thread. */
+static constexpr size_t DUMP_HASH_BATCH_COINS{100'000};
+/** Number of blocks whose filters a scanblocks worker reads and matches at once. */
+static constexpr int SCANBLOCKS_CHUNK_SIZE{1000};
+/** Maximum number of threads matching block filters for scanblocks. */
+static constexpr int MAX_SCANBLOCKS_WORKERS{8};
+
+std::pair<std::unique_ptr<CCoinsViewCursor>, const CBlockIndex*>
+PrepareUTXOSnapshot(Chainstate& chainstate)
     EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
 UniValue WriteUTXOSnapshot(
     Chainstate& chainstate,
     CCoinsViewCursor* pcursor,
-    CCoinsStats* maybe_stats,
     const CBlockIndex* tip,
     AutoFile&& afile,
     const fs::path& path,
@@ -199,24 +217,57 @@ UniValue coinbaseTxToJSON(const CTransaction& coinbase_tx)
     return coinbase_tx_obj;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+/** Serialize the metadata of the coinbase transaction in a block view */
+static UniValue coinbaseTxToJSON(const TxView& coinbase_tx)
+{
+    CHECK_NONFATAL(coinbase_tx.InputCount() > 0);
+    const TxInView vin_0{coinbase_tx.Input(0)};
+    UniValue coinbase_tx_obj(UniValue::VOBJ);
+    coinbase_tx_obj.pushKV("version", coinbase_tx.version());
+    coinbase_tx_obj.pushKV("locktime", coinbase_tx.nLockTime());
+    coinbase_tx_obj.pushKV("sequence", vin_0.nSequence());
+    coinbase_tx_obj.pushKV("coinbase", HexStr(vin_0.scriptSig()));
+    const auto witness_stack{vin_0.WitnessStack()};
+    if (!witness_stack.empty()) {
+        CHECK_NONFATAL(witness_stack.size() == 1);
+        coinbase_tx_obj.pushKV("witness", HexStr(witness_stack[0]));
+    }
+    return coinbase_tx_obj;
+}
+
+//! Block description to JSON, without the "tx" array
+static UniValue blockSummaryToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256& pow_limit, size_t stripped_size, size_t size, UniValue coinbase_tx)
 {
     UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
 
-    result.pushKV("strippedsize", ::GetSerializeSize(TX_NO_WITNESS(block)));
-    result.pushKV("size", ::GetSerializeSize(TX_WITH_WITNESS(block)));
-    result.pushKV("weight", ::GetBlockWeight(block));
+    result.pushKV("strippedsize", stripped_size);
+    result.pushKV("size", size);
+    // Same as GetBlockWeight()
+    result.pushKV("weight", stripped_size * (WITNESS_SCALE_FACTOR - 1) + size);
+    result.pushKV("coinbase_tx", std::move(coinbase_tx));
 
+    return result;
+}
+
+static UniValue blockSummaryToJSON(const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256& pow_limit)
+{
     CHECK_NONFATAL(!block.vtx.empty());
-    result.pushKV("coinbase_tx", coinbaseTxToJSON(*block.vtx[0]));
+    return blockSummaryToJSON(tip, blockindex, pow_limit, ::GetSerializeSize(TX_NO_WITNESS(block)), ::GetSerializeSize(TX_WITH_WITNESS(block)), coinbaseTxToJSON(*block.vtx[0]));
+}
 
-    UniValue txs(UniValue::VARR);
-    txs.reserve(block.vtx.size());
+static UniValue blockSummaryToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256& pow_limit)
+{
+    CHECK_NONFATAL(block.TxCount() > 0);
+    return blockSummaryToJSON(tip, blockindex, pow_limit, block.StrippedSize(), block.Serialized().size(), coinbaseTxToJSON(block.Tx(0)));
+}
 
+//! Convert every transaction of block to JSON in turn and pass it to fn
+static void blockTxsToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& blockindex, TxVerbosity verbosity, const std::function<void(UniValue&&)>& fn)
+{
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
+                fn(tx->GetHash().GetHex());
             }
             break;
 
@@ -234,16 +285,62 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
                 const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
+                fn(std::move(objTx));
             }
             break;
     }
+}
+
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    UniValue result = blockSummaryToJSON(block, tip, blockindex, pow_limit);
 
+    UniValue txs(UniValue::VARR);
+    txs.reserve(block.vtx.size());
+    blockTxsToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) { txs.push_back(std::move(tx)); });
     result.pushKV("tx", std::move(txs));
 
     return result;
 }
 
+void blockToJSON(JSONWriter& writer, BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    writer.BeginObject();
+    writer.Members(blockSummaryToJSON(block, tip, blockindex, pow_limit));
+    writer.Key("tx");
+    writer.BeginArray();
+    blockTxsToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) { writer.Value(tx); });
+    writer.EndArray();
+    writer.EndObject();
+}
+
+UniValue blockToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
+{
+    UniValue result = blockSummaryToJSON(block, tip, blockindex, pow_limit);
+
+    UniValue txs(UniValue::VARR);
+    txs.reserve(block.TxCount());
+    for (const Txid& txid : block.ComputeTxids()) {
+        txs.push_back(txid.GetHex());
+    }
+    result.pushKV("tx", std::move(txs));
+
+    return result;
+}
+
+void blockToJSON(JSONWriter& writer, const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
+{
+    writer.BeginObject();
+    writer.Members(blockSummaryToJSON(block, tip, blockindex, pow_limit));
+    writer.Key("tx");
+    writer.BeginArray();
+    for (const Txid& txid : block.ComputeTxids()) {
+        writer.Value(txid.GetHex());
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{
@@ -862,18 +959,33 @@ static RPCHelpMan getblock()
         return HexStr(block_data);
     }
 
+    if (verbosity == 1) {
+        // Only the txids are needed, so parse the block in place instead of
+        // deserializing every transaction.
+        const BlockView block{block_data};
+        if (request.m_result_buffer) {
+            JSONWriter writer{*request.m_result_buffer};
+            blockToJSON(writer, block, *tip, *pblockindex, chainman.GetConsensus().powLimit);
+            return UniValue::VNULL;
+        }
+        return blockToJSON(block, *tip, *pblockindex, chainman.GetConsensus().powLimit);
+    }
+
     CBlock block{};
     SpanReader{block_data} >> TX_WITH_WITNESS(block);
 
     TxVerbosity tx_verbosity;
-    if (verbosity == 1) {
-        tx_verbosity = TxVerbosity::SHOW_TXID;
-    } else if (verbosity == 2) {
+    if (verbosity == 2) {
         tx_verbosity = TxVerbosity::SHOW_DETAILS;
     } else {
         tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
     }
 
+    if (request.m_result_buffer) {
+        JSONWriter writer{*request.m_result_buffer};
+        blockToJSON(writer, chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
+        return UniValue::VNULL;
+    }
     return blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
 },
     };
@@ -1217,7 +1329,6 @@ static RPCHelpMan gettxout()
 {
     NodeContext& node = EnsureAnyNodeContext(request.context);
     ChainstateManager& chainman = EnsureChainman(node);
-    LOCK(cs_main);
 
     UniValue ret(UniValue::VOBJ);
 
@@ -1227,21 +1338,34 @@ static RPCHelpMan gettxout()
     if (!request.params[2].isNull())
         fMempool = request.params[2].get_bool();
 
+    std::optional<Coin> coin;
+    std::optional<uint256> best_block;
+    if (!fMempool) {
+        // Look the coin up without holding cs_main, if possible.
+        const auto shared_view{WITH_LOCK(cs_main, return chainman.ActiveChainstate().CoinsShared())};
+        std::vector<std::optional<Coin>> coins;
+        best_block = shared_view->GetCoins({&out, 1}, coins);
+        if (best_block) coin = std::move(coins.front());
+    }
+
+    LOCK(cs_main);
     Chainstate& active_chainstate = chainman.ActiveChainstate();
     CCoinsViewCache* coins_view = &active_chainstate.CoinsTip();
 
-    std::optional<Coin> coin;
-    if (fMempool) {
-        const CTxMemPool& mempool = EnsureMemPool(node);
-        LOCK(mempool.cs);
-        CCoinsViewMemPool view(coins_view, mempool);
-        if (!mempool.isSpent(out)) coin = view.GetCoin(out);
-    } else {
-        coin = coins_view->GetCoin(out);
+    if (!best_block) {
+        if (fMempool) {
+            const CTxMemPool& mempool = EnsureMemPool(node);
+            LOCK(mempool.cs);
+            CCoinsViewMemPool view(coins_view, mempool);
+            if (!mempool.isSpent(out)) coin = view.GetCoin(out);
+        } else {
+            coin = coins_view->GetCoin(out);
+        }
+        best_block = coins_view->GetBestBlock();
     }
     if (!coin) return UniValue::VNULL;
 
-    const CBlockIndex* pindex = active_chainstate.m_blockman.LookupBlockIndex(coins_view->GetBestBlock());
+    const CBlockIndex* pindex = active_chainstate.m_blockman.LookupBlockIndex(*best_block);
     ret.pushKV("bestblock", pindex->GetBlockHash().GetHex());
     if (coin->nHeight == MEMPOOL_HEIGHT) {
         ret.pushKV("confirmations", 0);
@@ -2313,7 +2437,8 @@ static RPCHelpMan scantxoutset()
         "or more path elements separated by \"/\", and optionally ending in \"/*\" (unhardened), or \"/*'\" or \"/*h\" (hardened) to specify all\n"
         "unhardened or hardened child keys.\n"
         "In the latter case, a range needs to be specified by below if different from 1000.\n"
-        "For more information on output descriptors, see the documentation in the doc/descriptors.md file.\n",
+        "For more information on output descriptors, see the documentation in the doc/descriptors.md file.\n"
+        "With -utxoscriptindex, the scripts are looked up in the index instead of scanning the whole UTXO set.\n",
         {
             scan_action_arg_desc,
             scan_objects_arg_desc,
@@ -2321,7 +2446,7 @@ static RPCHelpMan scantxoutset()
         {
             RPCResult{"when action=='start'; only returns after scan completes", RPCResult::Type::OBJ, "", "", {
                 {RPCResult::Type::BOOL, "success", "Whether the scan was completed"},
-                {RPCResult::Type::NUM, "txouts", "The number of unspent transaction outputs scanned"},
+                {RPCResult::Type::NUM, "txouts", "The number of unspent transaction outputs scanned (with -utxoscriptindex, only the ones looked up)"},
                 {RPCResult::Type::NUM, "height", "The block height at which the scan was done"},
                 {RPCResult::Type::STR_HEX, "bestblock", "The hash of the block at the tip of the chain"},
                 {RPCResult::Type::ARR, "unspents", "",
@@ -2405,18 +2530,38 @@ static RPCHelpMan scantxoutset()
         std::map<COutPoint, Coin> coins;
         g_should_abort_scan = false;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
-        const CBlockIndex* tip;
+        const CBlockIndex* tip{nullptr};
+        bool res;
         NodeContext& node = EnsureAnyNodeContext(request.context);
-        {
-            ChainstateManager& chainman = EnsureChainman(node);
+        ChainstateManager& chainman = EnsureChainman(node);
+        if (g_utxoscriptindex && g_utxoscriptindex->BlockUntilSyncedToCurrentChain()) {
+            // Look the scripts up in the index rather than reading the whole UTXO set
+            auto scan{g_utxoscriptindex->FindCoins(needles)};
+            if (!scan) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, scan.error());
+            }
+            // The index is only rewound once a block of another branch is connected, so
+            // e.g. after invalidateblock it can hold the UTXO set of a block that is no
+            // longer in the active chain. Only use it if it is the UTXO set of the tip.
             LOCK(cs_main);
-            Chainstate& active_chainstate = chainman.ActiveChainstate();
-            active_chainstate.ForceFlushStateToDisk(/*wipe_cache=*/false);
-            pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
-            tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
+            if (const CBlockIndex* block{chainman.m_blockman.LookupBlockIndex(scan->block.hash)}; block && block == chainman.ActiveTip()) {
+                tip = block;
+                count = scan->entries_read;
+                coins = std::move(scan->coins);
+                res = true;
+            }
+        }
+        if (!tip) {
+            std::unique_ptr<CCoinsViewCursor> pcursor;
+            {
+                LOCK(cs_main);
+                Chainstate& active_chainstate = chainman.ActiveChainstate();
+                active_chainstate.ForceFlushStateToDisk(/*wipe_cache=*/false);
+                pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
+                tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
+            }
+            res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
         result.pushKV("success", res);
         result.pushKV("txouts", count);
         result.pushKV("height", tip->nHeight);
@@ -2628,8 +2773,6 @@ static RPCHelpMan scanblocks()
             }
         }
         UniValue blocks(UniValue::VARR);
-        const int amount_per_chunk = 10000;
-        std::vector<BlockFilter> filters;
         int start_block_height = start_index->nHeight; // for progress reporting
         const int total_blocks_to_process = stop_block->nHeight - start_block_height;
 
@@ -2638,50 +2781,69 @@ static RPCHelpMan scanblocks()
         g_scanfilter_progress_height = start_block_height;
         bool completed = true;
 
-        const CBlockIndex* end_range = nullptr;
-        do {
+        // Match the filters of a chunk of the range, which are read from the
+        // filter files in one pass, and return the hashes of the matching blocks.
+        const auto scan_chunk{[&](int chunk_start, const CBlockIndex* chunk_end) {
+            std::vector<uint256> matches;
+            std::vector<BlockFilter> filters;
+            if (g_scanfilter_should_abort_scan || !index->LookupFilterRange(chunk_start, chunk_end, filters)) {
+                return matches;
+            }
+            for (size_t i = 0; i < filters.size(); ++i) {
+                const BlockFilter& filter{filters[i]};
+                // compare the elements-set with each filter
+                if (!filter.GetFilter().MatchAny(needle_set)) continue;
+                if (filter_false_positives) {
+                    // Double check the filter matches by scanning the block
+                    const CBlockIndex& blockindex{*CHECK_NONFATAL(chunk_end->GetAncestor(chunk_start + i))};
+                    if (!CheckBlockFilterMatches(chainman.m_blockman, blockindex, needle_set)) {
+                        continue;
+                    }
+                }
+                matches.push_back(filter.GetBlockHash());
+            }
+            return matches;
+        }};
+
+        // Chunks are matched on a thread pool and their results are collected
+        // in order, so the relevant blocks are still returned in chain order.
+        ThreadPool pool{"scanblocks"};
+        const int num_workers{std::clamp(GetNumCores(), 1, MAX_SCANBLOCKS_WORKERS)};
+        pool.Start(num_workers);
+        std::deque<std::pair<const CBlockIndex*, std::future<std::vector<uint256>>>> pending;
+        int next_height{start_block_height};
+        while (next_height <= stop_block->nHeight || !pending.empty()) {
             node.rpc_interruption_point(); // allow a clean shutdown
             if (g_scanfilter_should_abort_scan) {
                 completed = false;
                 break;
             }
 
-            // split the lookup range in chunks if we are deeper than 'amount_per_chunk' blocks from the stopping block
-            int start_block = !end_range ? start_index->nHeight : start_index->nHeight + 1; // to not include the previous round 'end_range' block
-            end_range = (start_block + amount_per_chunk < stop_block->nHeight) ?
-                    WITH_LOCK(::cs_main, return chainman.ActiveChain()[start_block + amount_per_chunk]) :
-                    stop_block;
-
-            if (index->LookupFilterRange(start_block, end_range, filters)) {
-                for (const BlockFilter& filter : filters) {
-                    // compare the elements-set with each filter
-                    if (filter.GetFilter().MatchAny(needle_set)) {
-                        if (filter_false_positives) {
-                            // Double check the filter matches by scanning the block
-                            const CBlockIndex& blockindex = *CHECK_NONFATAL(WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(filter.GetBlockHash())));
-
-                            if (!CheckBlockFilterMatches(chainman.m_blockman, blockindex, needle_set)) {
-                                continue;
-                            }
-                        }
-
-                        blocks.push_back(filter.GetBlockHash().GetHex());
-                    }
+            while (next_height <= stop_block->nHeight && pending.size() < 2 * static_cast<size_t>(num_workers)) {
+                const CBlockIndex* chunk_end{stop_block->GetAncestor(std::min(next_height + SCANBLOCKS_CHUNK_SIZE - 1, stop_block->nHeight))};
+                auto task{pool.Submit([&scan_chunk, chunk_start = next_height, chunk_end] { return scan_chunk(chunk_start, chunk_end); })};
+                if (!task) {
+                    throw JSONRPCError(RPC_MISC_ERROR, "Failed to start the filter scan");
                 }
+                pending.emplace_back(chunk_end, std::move(*task));
+                next_height = chunk_end->nHeight + 1;
             }
-            start_index = end_range;
+
+            for (const uint256& block_hash : pending.front().second.get()) {
+                blocks.push_back(block_hash.GetHex());
+            }
+            start_index = pending.front().first;
+            pending.pop_front();
 
             // update progress
-            int blocks_processed = end_range->nHeight - start_block_height;
+            int blocks_processed = start_index->nHeight - start_block_height;
             if (total_blocks_to_process > 0) { // avoid division by zero
                 g_scanfilter_progress = (int)(100.0 / total_blocks_to_process * blocks_processed);
             } else {
                 g_scanfilter_progress = 100;
             }
-            g_scanfilter_progress_height = end_range->nHeight;
-
-        // Finish if we reached the stop block
-        } while (start_index != stop_block);
+            g_scanfilter_progress_height = start_index->nHeight;
+        }
 
         ret.pushKV("from_height", start_block_height);
         ret.pushKV("to_height", start_index->nHeight); // start_index is always the last scanned block here
@@ -2840,9 +3002,28 @@ static RPCHelpMan getdescriptoractivity()
         blockman = CHECK_NONFATAL(&active_chainstate.m_blockman);
     }
 
+    // The blocks relevant to a scan are usually far apart on disk, so read
+    // them and their undo data ahead on a thread pool while the earlier ones
+    // are being searched.
+    ThreadPool pool{"descactivity"};
+    const int num_workers{std::clamp(GetNumCores(), 1, MAX_SCANBLOCKS_WORKERS)};
+    pool.Start(num_workers);
+    std::deque<std::future<std::pair<CBlock, CBlockUndo>>> pending;
+    auto next_blockindex{blockindexes_sorted.begin()};
+
     for (const CBlockIndex* blockindex : blockindexes_sorted) {
-        const CBlock block{GetBlockChecked(chainman.m_blockman, *blockindex)};
-        const CBlockUndo block_undo{GetUndoChecked(*blockman, *blockindex)};
+        while (next_blockindex != blockindexes_sorted.end() && pending.size() < 2 * static_cast<size_t>(num_workers)) {
+            auto task{pool.Submit([&chainman, blockman, pindex = *next_blockindex] {
+                return std::pair{GetBlockChecked(chainman.m_blockman, *pindex), GetUndoChecked(*blockman, *pindex)};
+            })};
+            if (!task) {
+                throw JSONRPCError(RPC_MISC_ERROR, "Failed to read the blocks");
+            }
+            pending.push_back(std::move(*task));
+            ++next_blockindex;
+        }
+        const auto [block, block_undo]{pending.front().get()};
+        pending.pop_front();
 
         for (size_t i = 0; i < block.vtx.size(); ++i) {
             const auto& tx = block.vtx.at(i);
@@ -2931,6 +3112,123 @@ static RPCHelpMan getdescriptoractivity()
     };
 }
 
+std::optional<CScript> ParseScriptOrAddress(std::string_view str)
+{
+    const CTxDestination dest{DecodeDestination(std::string{str})};
+    if (IsValidDestination(dest)) return GetScriptForDestination(dest);
+    if (const auto bytes{TryParseHex<unsigned char>(str)}) return CScript(bytes->begin(), bytes->end());
+    return std::nullopt;
+}
+
+UniValue ScriptHistoryToJSON(const std::vector<ScriptHistoryEntry>& entries, const std::optional<ScriptHistoryPosition>& next)
+{
+    UniValue history(UniValue::VARR);
+    for (const auto& entry : entries) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("txid", entry.txid.GetHex());
+        obj.pushKV("height", entry.pos.height);
+        obj.pushKV("type", entry.IsSpend() ? "spend" : "receive");
+        obj.pushKV("n", entry.Index());
+        obj.pushKV("amount", ValueFromAmount(entry.amount));
+        if (entry.IsSpend()) {
+            UniValue prevout(UniValue::VOBJ);
+            prevout.pushKV("txid", entry.prevout.hash.GetHex());
+            prevout.pushKV("vout", entry.prevout.n);
+            obj.pushKV("prevout", std::move(prevout));
+        } else if (entry.spent_by) {
+            UniValue spent(UniValue::VOBJ);
+            spent.pushKV("txid", entry.spent_by->first.GetHex());
+            spent.pushKV("height", entry.spent_by->second);
+            obj.pushKV("spent", std::move(spent));
+        }
+        history.push_back(std::move(obj));
+    }
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("history", std::move(history));
+    if (next) ret.pushKV("next", next->ToHex());
+    return ret;
+}
+
+static RPCHelpMan getscripthistory()
+{
+    return RPCHelpMan{
+        "getscripthistory",
+        "Return the history of an address or output script in the active chain: the outputs that paid to it\n"
+        "and the inputs that spent them, in the order of the chain.\n"
+        "Requires -scriptindex. Long histories are returned in pages; pass the \"next\" value of a page as\n"
+        "the cursor to get the following one.\n",
+        {
+            {"script", RPCArg::Type::STR, RPCArg::Optional::NO, "An address, or a hex-encoded output script"},
+            {"count", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_SCRIPT_HISTORY_COUNT}, strprintf("The maximum number of entries to return, at most %d", MAX_SCRIPT_HISTORY_COUNT)},
+            {"cursor", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The \"next\" value of the previous page"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::ARR, "history", "",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "txid", "The id of the transaction"},
+                        {RPCResult::Type::NUM, "height", "The height of the block the transaction is in"},
+                        {RPCResult::Type::STR, "type", "\"receive\" for an output paying to the script, \"spend\" for an input spending one"},
+                        {RPCResult::Type::NUM, "n", "The index of the output or of the input in the transaction"},
+                        {RPCResult::Type::STR_AMOUNT, "amount", "The amount in " + CURRENCY_UNIT},
+                        {RPCResult::Type::OBJ, "spent", /*optional=*/true, "For a spent output, the transaction that spent it",
+                        {
+                            {RPCResult::Type::STR_HEX, "txid", "The id of the spending transaction"},
+                            {RPCResult::Type::NUM, "height", "The height of the block the spending transaction is in"},
+                        }},
+                        {RPCResult::Type::OBJ, "prevout", /*optional=*/true, "For an input, the output it spends",
+                        {
+                            {RPCResult::Type::STR_HEX, "txid", "The id of the transaction of the output"},
+                            {RPCResult::Type::NUM, "vout", "The index of the output"},
+                        }},
+                    }},
+                }},
+                {RPCResult::Type::STR_HEX, "next", /*optional=*/true, "The cursor of the next page, if there are more entries"},
+            }},
+        RPCExamples{
+            HelpExampleCli("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\"") +
+            HelpExampleCli("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 100 \"00000f1a0000000280000000\"") +
+            HelpExampleRpc("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\", 100")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    if (!g_scriptindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -scriptindex");
+    }
+    const auto script{ParseScriptOrAddress(self.Arg<std::string_view>("script"))};
+    if (!script) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address or script");
+    }
+    const int count{self.Arg<int>("count")};
+    if (count < 1 || count > MAX_SCRIPT_HISTORY_COUNT) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("count must be between 1 and %d", MAX_SCRIPT_HISTORY_COUNT));
+    }
+    ScriptHistoryPosition start;
+    if (const auto cursor{self.MaybeArg<std::string_view>("cursor")}) {
+        const auto pos{ScriptHistoryPosition::FromHex(*cursor)};
+        if (!pos) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        start = *pos;
+    }
+
+    if (!g_scriptindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "The script index is still being built");
+    }
+
+    std::optional<ScriptHistoryPosition> next;
+    const auto history{g_scriptindex->FindHistory(*script, start, count, next)};
+    if (!history) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, history.error());
+    }
+    return ScriptHistoryToJSON(*history, next);
+},
+    };
+}
+
 static RPCHelpMan getblockfilter()
 {
     return RPCHelpMan{
@@ -3165,7 +3463,6 @@ static RPCHelpMan dumptxoutset()
 
     Chainstate* chainstate;
     std::unique_ptr<CCoinsViewCursor> cursor;
-    CCoinsStats stats;
     {
         // Lock the chainstate before calling PrepareUtxoSnapshot, to be able
         // to get a UTXO database cursor while the chain is pointing at the
@@ -3185,13 +3482,12 @@ static RPCHelpMan dumptxoutset()
             LogWarning("dumptxoutset failed to roll back to requested height, reverting to tip.\n");
             throw JSONRPCError(RPC_MISC_ERROR, "Could not roll back to requested height.");
         } else {
-            std::tie(cursor, stats, tip) = PrepareUTXOSnapshot(*chainstate, node.rpc_interruption_point);
+            std::tie(cursor, tip) = PrepareUTXOSnapshot(*chainstate);
         }
     }
 
     UniValue result = WriteUTXOSnapshot(*chainstate,
                                         cursor.get(),
-                                        &stats,
                                         tip,
                                         std::move(afile),
                                         path,
@@ -3205,24 +3501,21 @@ static RPCHelpMan dumptxoutset()
     };
 }
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
-PrepareUTXOSnapshot(
-    Chainstate& chainstate,
-    const std::function<void()>& interruption_point)
+std::pair<std::unique_ptr<CCoinsViewCursor>, const CBlockIndex*>
+PrepareUTXOSnapshot(Chainstate& chainstate)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor;
-    std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex* tip;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
-        // between (i) flushing coins cache to disk (coinsdb), (ii) getting stats
-        // based upon the coinsdb, and (iii) constructing a cursor to the
-        // coinsdb for use in WriteUTXOSnapshot.
+        // between (i) flushing coins cache to disk (coinsdb) and (ii)
+        // constructing a cursor to the coinsdb for use in WriteUTXOSnapshot.
         //
         // Cursors returned by leveldb iterate over snapshots, so the contents
         // of the pcursor will not be affected by simultaneous writes during
-        // use below this block.
+        // use below this block. This is what allows WriteUTXOSnapshot to
+        // count and hash the coins while writing them, without cs_main.
         //
         // See discussion here:
         //   https://github.com/bitcoin/bitcoin/pull/15606#discussion_r274479369
@@ -3231,22 +3524,16 @@ PrepareUTXOSnapshot(
 
         chainstate.ForceFlushStateToDisk(/*wipe_cache=*/false);
 
-        maybe_stats = GetUTXOStats(&chainstate.CoinsDB(), chainstate.m_blockman, CoinStatsHashType::HASH_SERIALIZED, interruption_point);
-        if (!maybe_stats) {
-            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
-        }
-
         pcursor = chainstate.CoinsDB().Cursor();
-        tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
+        tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(chainstate.CoinsDB().GetBestBlock()));
     }
 
-    return {std::move(pcursor), *CHECK_NONFATAL(maybe_stats), tip};
+    return {std::move(pcursor), tip};
 }
 
 UniValue WriteUTXOSnapshot(
     Chainstate& chainstate,
     CCoinsViewCursor* pcursor,
-    CCoinsStats* maybe_stats,
     const CBlockIndex* tip,
     AutoFile&& afile,
     const fs::path& path,
@@ -3257,7 +3544,9 @@ UniValue WriteUTXOSnapshot(
         tip->nHeight, tip->GetBlockHash().ToString(),
         fs::PathToString(path), fs::PathToString(temppath)));
 
-    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), maybe_stats->coins_count};
+    // The number of coins is only known once they have all been written, and
+    // is filled in afterwards.
+    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), /*coins_count=*/0};
 
     afile << metadata;
 
@@ -3268,6 +3557,11 @@ UniValue WriteUTXOSnapshot(
     size_t written_coins_count{0};
     std::vector<std::pair<uint32_t, Coin>> coins;
 
+    // The content hash is computed on a thread of its own, from the coins
+    // written to the file.
+    kernel::SerializedCoinsHasher hasher;
+    auto hash_batch{std::make_shared<kernel::SerializedCoinsHasher::Batch>()};
+
     // To reduce space the serialization format of the snapshot avoids
     // duplication of tx hashes. The code takes advantage of the guarantee by
     // leveldb that keys are lexicographically sorted.
@@ -3275,7 +3569,7 @@ UniValue WriteUTXOSnapshot(
     // (key.hash) and when we have them all (key.hash != last_hash) we write
     // them to file using the below lambda function.
     // See also https://github.com/bitcoin/bitcoin/issues/25675
-    auto write_coins_to_file = [&](AutoFile& afile, const Txid& last_hash, const std::vector<std::pair<uint32_t, Coin>>& coins, size_t& written_coins_count) {
+    auto write_coins_to_file = [&](AutoFile& afile, const Txid& last_hash, std::vector<std::pair<uint32_t, Coin>>& coins, size_t& written_coins_count) {
         afile << last_hash;
         WriteCompactSize(afile, coins.size());
         for (const auto& [n, coin] : coins) {
@@ -3283,6 +3577,16 @@ UniValue WriteUTXOSnapshot(
             afile << coin;
             ++written_coins_count;
         }
+        // The database orders the coins of a transaction by the encoding of
+        // their output index, the content hash by its value.
+        std::ranges::sort(coins, {}, [](const auto& entry) { return entry.first; });
+        for (auto& [n, coin] : coins) {
+            hash_batch->emplace_back(COutPoint{last_hash, n}, std::move(coin));
+        }
+        if (hash_batch->size() >= DUMP_HASH_BATCH_COINS) {
+            hasher.Add(std::move(hash_batch));
+            hash_batch = std::make_shared<kernel::SerializedCoinsHasher::Batch>();
+        }
     };
 
     pcursor->GetKey(key);
@@ -3290,22 +3594,29 @@ UniValue WriteUTXOSnapshot(
     while (pcursor->Valid()) {
         if (iter % 5000 == 0) interruption_point();
         ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            if (key.hash != last_hash) {
-                write_coins_to_file(afile, last_hash, coins, written_coins_count);
-                last_hash = key.hash;
-                coins.clear();
-            }
-            coins.emplace_back(key.n, coin);
+        if (!pcursor->GetKey(key) || !pcursor->GetValue(coin)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
         }
+        if (key.hash != last_hash) {
+            write_coins_to_file(afile, last_hash, coins, written_coins_count);
+            last_hash = key.hash;
+            coins.clear();
+        }
+        coins.emplace_back(key.n, coin);
         pcursor->Next();
     }
 
     if (!coins.empty()) {
         write_coins_to_file(afile, last_hash, coins, written_coins_count);
     }
+    if (!hash_batch->empty()) {
+        hasher.Add(std::move(hash_batch));
+    }
+    const uint256 txoutset_hash{hasher.Finalize()};
 
-    CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
+    metadata.m_coins_count = written_coins_count;
+    afile.seek(0, SEEK_SET);
+    afile << metadata;
 
     if (afile.fclose() != 0) {
         throw std::ios_base::failure(
@@ -3317,7 +3628,7 @@ UniValue WriteUTXOSnapshot(
     result.pushKV("base_hash", tip->GetBlockHash().ToString());
     result.pushKV("base_height", tip->nHeight);
     result.pushKV("path", path.utf8string());
-    result.pushKV("txoutset_hash", maybe_stats->hashSerialized.ToString());
+    result.pushKV("txoutset_hash", txoutset_hash.ToString());
     result.pushKV("nchaintx", tip->m_chain_tx_count);
     return result;
 }
@@ -3329,10 +3640,9 @@ UniValue CreateUTXOSnapshot(
     const fs::path& path,
     const fs::path& tmppath)
 {
-    auto [cursor, stats, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate, node.rpc_interruption_point))};
+    auto [cursor, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate))};
     return WriteUTXOSnapshot(chainstate,
                              cursor.get(),
-                             &stats,
                              tip,
                              std::move(afile),
                              path,
@@ -3428,6 +3738,9 @@ const std::vector<RPCResult> RPCHelpForChainstate{
     {RPCResult::Type::STR_HEX, "target", "The difficulty target"},
     {RPCResult::Type::NUM, "difficulty", "difficulty of the tip"},
     {RPCResult::Type::NUM, "verificationprogress", "progress towards the network tip"},
+    {RPCResult::Type::NUM, "snapshot_validation_progress", /*optional=*/true, "progress towards the base block of the snapshot this chainstate is validating, if any"},
+    {RPCResult::Type::NUM, "blocks_per_second", /*optional=*/true, "rate at which the most recent blocks were connected to this chainstate"},
+    {RPCResult::Type::NUM, "transactions_per_second", /*optional=*/true, "rate at which the transactions of the most recent blocks were connected to this chainstate"},
     {RPCResult::Type::STR_HEX, "snapshot_blockhash", /*optional=*/true, "the base block of the snapshot this chainstate is based on, if any"},
     {RPCResult::Type::NUM, "coins_db_cache_bytes", "size of the coinsdb cache"},
     {RPCResult::Type::NUM, "coins_tip_cache_bytes", "size of the coinstip cache"},
@@ -3472,6 +3785,13 @@ return RPCHelpMan{
         data.pushKV("target", GetTarget(*tip, chainman.GetConsensus().powLimit).GetHex());
         data.pushKV("difficulty", GetDifficulty(*tip));
         data.pushKV("verificationprogress", chainman.GuessVerificationProgress(tip));
+        if (const CBlockIndex* target{cs.TargetBlock()}; target && target->m_chain_tx_count) {
+            data.pushKV("snapshot_validation_progress", std::min(1.0, double(tip->m_chain_tx_count) / target->m_chain_tx_count));
+        }
+        if (const auto throughput{cs.GetConnectThroughput()}) {
+            data.pushKV("blocks_per_second", throughput->blocks_per_second);
+            data.pushKV("transactions_per_second", throughput->transactions_per_second);
+        }
         data.pushKV("coins_db_cache_bytes",  cs.m_coinsdb_cache_size_bytes);
         data.pushKV("coins_tip_cache_bytes", cs.m_coinstip_cache_size_bytes);
         if (cs.m_from_snapshot_blockhash) {
@@ -3493,6 +3813,83 @@ return RPCHelpMan{
     };
 }
 
+static RPCHelpMan compactchainstate()
+{
+    return RPCHelpMan{
+        "compactchainstate",
+        "Start or report on the background compaction of the chainstate database.\n"
+        "Background compaction is enabled with -dbcompactrate=chainstate:<n>. It compacts the database a key range at a time,\n"
+        "at the configured rate, when the database has not been written to for a few seconds and the node is not in initial block download.\n",
+        {
+            {"action", RPCArg::Type::STR, RPCArg::Default{"status"}, "The action to execute\n"
+                "\"start\" for starting a compaction pass over the whole database, if none is in progress\n"
+                "\"status\" for a report on the compaction and the levels of the database"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "", {
+                {RPCResult::Type::BOOL, "enabled", "whether background compaction is enabled"},
+                {RPCResult::Type::BOOL, "deferred", "whether compaction is held off because the node is in initial block download"},
+                {RPCResult::Type::BOOL, "running", "whether a compaction pass is in progress"},
+                {RPCResult::Type::NUM, "passes", "the number of compaction passes completed"},
+                {RPCResult::Type::NUM, "progress", /*optional=*/true, "the progress (in %) of the current pass, by estimated size, when running"},
+                {RPCResult::Type::NUM, "compaction_time", "the time spent compacting by all passes, in seconds"},
+                {RPCResult::Type::ARR, "levels", "the levels of the database that have tables or compaction activity",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "level", "the level"},
+                        {RPCResult::Type::NUM, "files", "the number of table files"},
+                        {RPCResult::Type::NUM, "size", "the size of the tables, in MiB"},
+                        {RPCResult::Type::NUM, "compaction_time", "the time spent on compactions into the level, in seconds"},
+                        {RPCResult::Type::NUM, "read", "the data read by compactions into the level, in MiB"},
+                        {RPCResult::Type::NUM, "written", "the data written by compactions into the level, in MiB"},
+                    }},
+                }},
+            }},
+        RPCExamples{
+            HelpExampleCli("compactchainstate", "start")
+            + HelpExampleCli("compactchainstate", "status")
+            + HelpExampleRpc("compactchainstate", "\"start\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const auto action{self.Arg<std::string_view>("action")};
+    if (action != "start" && action != "status") {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid action '%s'", action));
+    }
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    LOCK(cs_main);
+    CCoinsViewDB& coins_db{chainman.ActiveChainstate().CoinsDB()};
+    if (action == "start" && !coins_db.RequestCompaction()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Background compaction of the chainstate is disabled (use -dbcompactrate=chainstate:<n>)");
+    }
+
+    const DBCompactionProgress compaction{coins_db.GetCompactionProgress()};
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("enabled", compaction.enabled);
+    result.pushKV("deferred", compaction.deferred);
+    result.pushKV("running", compaction.running);
+    result.pushKV("passes", compaction.passes);
+    if (compaction.running) {
+        result.pushKV("progress", compaction.pass_bytes ? std::min(100.0, 100.0 * compaction.compacted_bytes / compaction.pass_bytes) : 0.0);
+    }
+    result.pushKV("compaction_time", Ticks<SecondsDouble>(compaction.compaction_time));
+    UniValue levels(UniValue::VARR);
+    for (const DBLevelStats& stats : coins_db.GetLevelStats()) {
+        UniValue level(UniValue::VOBJ);
+        level.pushKV("level", stats.level);
+        level.pushKV("files", stats.files);
+        level.pushKV("size", stats.size_mib);
+        level.pushKV("compaction_time", stats.compaction_secs);
+        level.pushKV("read", stats.read_mib);
+        level.pushKV("written", stats.written_mib);
+        levels.push_back(std::move(level));
+    }
+    result.pushKV("levels", std::move(levels));
+    return result;
+},
+    };
+}
 
 void RegisterBlockchainRPCCommands(CRPCTable& t)
 {
@@ -3517,10 +3914,12 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
         {"blockchain", &getdescriptoractivity},
+        {"blockchain", &getscripthistory},
         {"blockchain", &getblockfilter},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
+        {"blockchain", &compactchainstate},
         {"hidden", &invalidateblock},
         {"hidden", &reconsiderblock},
         {"blockchain", &waitfornewblock},
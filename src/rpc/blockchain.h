@@ -16,19 +16,27 @@
 #include <any>
 #include <cstdint>
 #include <optional>
+#include <string_view>
 #include <vector>
 
+class BlockView;
 class CBlock;
 class CBlockIndex;
 class CChain;
+class CScript;
 class Chainstate;
+class JSONWriter;
 class UniValue;
+struct ScriptHistoryEntry;
+struct ScriptHistoryPosition;
 namespace node {
 class BlockManager;
 struct NodeContext;
 } // namespace node
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+static constexpr int DEFAULT_SCRIPT_HISTORY_COUNT{100};
+static constexpr int MAX_SCRIPT_HISTORY_COUNT{10000};
 
 /**
  * Get the difficulty of the net wrt to the given block index.
@@ -41,6 +49,15 @@ double GetDifficulty(const CBlockIndex& blockindex);
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
+/** Block description to JSON, streamed into writer one transaction at a time */
+void blockToJSON(JSONWriter& writer, node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
+/** Block description with txids to JSON, from a block view */
+UniValue blockToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
+/** Block description with txids to JSON, from a block view, streamed into writer */
+void blockToJSON(JSONWriter& writer, const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
@@ -60,6 +77,12 @@ UniValue CreateUTXOSnapshot(
 
 //! Return height of highest block that has been pruned, or std::nullopt if no blocks have been pruned
 std::optional<int> GetPruneHeight(const node::BlockManager& blockman, const CChain& chain) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+/** Parse an address or a hex-encoded output script */
+std::optional<CScript> ParseScriptOrAddress(std::string_view str);
+
+/** Page of the history of a script to JSON */
+UniValue ScriptHistoryToJSON(const std::vector<ScriptHistoryEntry>& entries, const std::optional<ScriptHistoryPosition>& next);
+
 void CheckBlockDataAvailability(node::BlockManager& blockman, const CBlockIndex& blockindex, bool check_for_undo) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
 #endif // BITCOIN_RPC_BLOCKCHAIN_H
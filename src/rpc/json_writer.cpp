@@ -0,0 +1,73 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/json_writer.h>
+
+#include <univalue.h>
+#include <util/check.h>
+
+void JSONWriter::BeginValue()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (!m_empty.empty()) {
+        if (!m_empty.back()) m_out += ',';
+        m_empty.back() = false;
+    }
+}
+
+void JSONWriter::BeginObject()
+{
+    BeginValue();
+    m_out += '{';
+    m_empty.push_back(true);
+}
+
+void JSONWriter::EndObject()
+{
+    Assume(!m_empty.empty() && !m_after_key);
+    m_empty.pop_back();
+    m_out += '}';
+}
+
+void JSONWriter::BeginArray()
+{
+    BeginValue();
+    m_out += '[';
+    m_empty.push_back(true);
+}
+
+void JSONWriter::EndArray()
+{
+    Assume(!m_empty.empty() && !m_after_key);
+    m_empty.pop_back();
+    m_out += ']';
+}
+
+void JSONWriter::Key(std::string_view key)
+{
+    Assume(!m_empty.empty() && !m_after_key);
+    BeginValue();
+    UniValue{std::string{key}}.write(/*prettyIndent=*/0, /*indentLevel=*/0, m_out);
+    m_out += ':';
+    m_after_key = true;
+}
+
+void JSONWriter::Value(const UniValue& value)
+{
+    BeginValue();
+    value.write(/*prettyIndent=*/0, /*indentLevel=*/0, m_out);
+}
+
+void JSONWriter::Members(const UniValue& obj)
+{
+    const auto& keys{obj.getKeys()};
+    const auto& values{obj.getValues()};
+    for (size_t i{0}; i < keys.size(); ++i) {
+        Key(keys[i]);
+        Value(values[i]);
+    }
+}
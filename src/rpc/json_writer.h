@@ -0,0 +1,52 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSON_WRITER_H
+#define BITCOIN_RPC_JSON_WRITER_H
+
+#include <attributes.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Serializes JSON incrementally into a string, producing the same compact
+ * output as UniValue::write().
+ *
+ * Large results (e.g. blocks with full transaction details, or the verbose
+ * mempool) can be emitted piece by piece with this writer, so that only the
+ * UniValue of the element currently being written has to exist in memory,
+ * rather than the tree for the whole result.
+ */
+class JSONWriter
+{
+private:
+    std::string& m_out;
+    //! For every open object or array, whether it has no elements yet
+    std::vector<bool> m_empty;
+    //! Whether a key was just written and its value is expected next
+    bool m_after_key{false};
+
+    void BeginValue();
+
+public:
+    explicit JSONWriter(std::string& out LIFETIMEBOUND) : m_out{out} {}
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    //! Write the key of the next member of the current object.
+    void Key(std::string_view key);
+    //! Write a complete value.
+    void Value(const UniValue& value);
+    //! Write all members of the object obj as members of the current object.
+    void Members(const UniValue& obj);
+};
+
+#endif // BITCOIN_RPC_JSON_WRITER_H
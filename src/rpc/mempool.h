@@ -6,6 +6,7 @@
 #define BITCOIN_RPC_MEMPOOL_H
 
 class CTxMemPool;
+class JSONWriter;
 class UniValue;
 
 /** Mempool information to JSON */
@@ -14,4 +15,7 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 /** Mempool to JSON */
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool include_mempool_sequence = false);
 
+/** Verbose mempool to JSON, streamed into writer one entry at a time */
+void MempoolToJSON(JSONWriter& writer, const CTxMemPool& pool);
+
 #endif // BITCOIN_RPC_MEMPOOL_H
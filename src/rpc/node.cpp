@@ -9,8 +9,10 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/scriptindex.h>
 #include <index/txindex.h>
 #include <index/txospenderindex.h>
+#include <index/utxoscriptindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
 #include <interfaces/init.h>
@@ -402,6 +404,14 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_txospenderindex->GetSummary(), index_name));
     }
 
+    if (g_scriptindex) {
+        result.pushKVs(SummaryToJSON(g_scriptindex->GetSummary(), index_name));
+    }
+
+    if (g_utxoscriptindex) {
+        result.pushKVs(SummaryToJSON(g_utxoscriptindex->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
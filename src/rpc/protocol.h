@@ -16,7 +16,9 @@ enum HTTPStatusCode
     HTTP_FORBIDDEN             = 403,
     HTTP_NOT_FOUND             = 404,
     HTTP_BAD_METHOD            = 405,
+    HTTP_PAYLOAD_TOO_LARGE     = 413,
     HTTP_INTERNAL_SERVER_ERROR = 500,
+    HTTP_NOT_IMPLEMENTED       = 501,
     HTTP_SERVICE_UNAVAILABLE   = 503,
 };
 
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -67,6 +68,32 @@ UniValue JSONRPCReplyObj(UniValue result, UniValue error, std::optional<UniValue
     return reply;
 }
 
+std::pair<std::string, std::string> JSONRPCReplyEnvelope(const std::optional<UniValue>& id, JSONRPCVersion jsonrpc_version)
+{
+    std::string prefix{"{"};
+    if (jsonrpc_version == JSONRPCVersion::V2) prefix += "\"jsonrpc\":\"2.0\",";
+    prefix += "\"result\":";
+    std::string suffix;
+    if (jsonrpc_version == JSONRPCVersion::V1_LEGACY) suffix += ",\"error\":null";
+    if (id.has_value()) {
+        suffix += ",\"id\":";
+        suffix += id->write();
+    }
+    suffix += '}';
+    return {std::move(prefix), std::move(suffix)};
+}
+
+std::string JSONRPCReplyString(std::string_view result_json, const std::optional<UniValue>& id, JSONRPCVersion jsonrpc_version)
+{
+    const auto [prefix, suffix]{JSONRPCReplyEnvelope(id, jsonrpc_version)};
+    std::string reply;
+    reply.reserve(prefix.size() + result_json.size() + suffix.size());
+    reply += prefix;
+    reply += result_json;
+    reply += suffix;
+    return reply;
+}
+
 UniValue JSONRPCError(int code, const std::string& message)
 {
     UniValue error(UniValue::VOBJ);
@@ -9,6 +9,8 @@
 #include <any>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include <univalue.h>
 #include <util/fs.h>
@@ -22,6 +24,10 @@ enum class JSONRPCVersion {
 UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params, const UniValue& id);
 UniValue JSONRPCReplyObj(UniValue result, UniValue error, std::optional<UniValue> id, JSONRPCVersion jsonrpc_version);
 UniValue JSONRPCError(int code, const std::string& message);
+/** Serialized successful reply, same as JSONRPCReplyObj(...).write() for a result that is already serialized as result_json */
+std::string JSONRPCReplyString(std::string_view result_json, const std::optional<UniValue>& id, JSONRPCVersion jsonrpc_version);
+/** The parts of a serialized successful reply that go before and after its already serialized result */
+std::pair<std::string, std::string> JSONRPCReplyEnvelope(const std::optional<UniValue>& id, JSONRPCVersion jsonrpc_version);
 
 enum class GenerateAuthCookieResult : uint8_t {
     DISABLED, // -norpccookiefile
@@ -61,6 +67,13 @@ public:
     std::string peerAddr;
     std::any context;
     JSONRPCVersion m_json_version = JSONRPCVersion::V1_LEGACY;
+    /**
+     * Optional buffer for methods that can produce very large results. If set,
+     * such a method may write its result as JSON text into this buffer and
+     * return null instead of building the result as a UniValue. A non-empty
+     * buffer after successful execution holds the result.
+     */
+    std::string* m_result_buffer{nullptr};
 
     void parse(const UniValue& valRequest);
     [[nodiscard]] bool IsNotification() const { return !id.has_value() && m_json_version == JSONRPCVersion::V2; };
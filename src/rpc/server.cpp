@@ -350,8 +350,11 @@ UniValue JSONRPCExec(const JSONRPCRequest& jreq, bool catch_errors)
         try {
             result = tableRPC.execute(jreq);
         } catch (UniValue& e) {
+            // Discard any partially streamed result
+            if (jreq.m_result_buffer) jreq.m_result_buffer->clear();
             return JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
         } catch (const std::exception& e) {
+            if (jreq.m_result_buffer) jreq.m_result_buffer->clear();
             return JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_MISC_ERROR, e.what()), jreq.id, jreq.m_json_version);
         }
     } else {
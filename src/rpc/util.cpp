@@ -660,9 +660,15 @@ UniValue RPCHelpMan::HandleRequest(const JSONRPCRequest& request) const
     UniValue ret = m_fun(*this, request);
     m_req = nullptr;
     if (gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
+        // Check a streamed result like any other
+        UniValue streamed;
+        if (request.m_result_buffer && !request.m_result_buffer->empty()) {
+            CHECK_NONFATAL(ret.isNull() && streamed.read(*request.m_result_buffer));
+        }
+        const UniValue& result{streamed.isNull() ? ret : streamed};
         UniValue mismatch{UniValue::VARR};
         for (const auto& res : m_results.m_results) {
-            UniValue match{res.MatchesType(ret)};
+            UniValue match{res.MatchesType(result)};
             if (match.isTrue()) {
                 mismatch.setNull();
                 break;
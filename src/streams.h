@@ -98,6 +98,7 @@ public:
         return (*this);
     }
 
+    const std::byte* data() const { return m_data.data(); }
     size_t size() const { return m_data.size(); }
     bool empty() const { return m_data.empty(); }
 
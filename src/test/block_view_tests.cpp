@@ -0,0 +1,174 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block.h>
+#include <primitives/block_view.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <span.h>
+#include <streams.h>
+#include <test/util/common.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <ios>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(block_view_tests, BasicTestingSetup)
+
+static CScript RandomScript(FastRandomContext& rng, size_t max_size)
+{
+    const auto bytes{rng.randbytes(rng.randrange(max_size))};
+    return CScript(bytes.begin(), bytes.end());
+}
+
+static CMutableTransaction RandomTransaction(FastRandomContext& rng, bool coinbase, bool witness)
+{
+    CMutableTransaction tx;
+    tx.version = rng.rand32();
+    tx.nLockTime = rng.rand32();
+    tx.vin.resize(coinbase ? 1 : 1 + rng.randrange(4));
+    for (CTxIn& in : tx.vin) {
+        in.prevout = coinbase ? COutPoint{} : COutPoint{Txid::FromUint256(rng.rand256()), rng.rand32()};
+        in.scriptSig = RandomScript(rng, 120);
+        in.nSequence = rng.rand32();
+        // Leave some stacks of a witness transaction empty.
+        if (witness && (coinbase || rng.randbool())) {
+            in.scriptWitness.stack.resize(1 + rng.randrange(3));
+            for (auto& item : in.scriptWitness.stack) item = rng.randbytes(rng.randrange(80));
+        }
+    }
+    if (witness && !tx.HasWitness()) tx.vin[0].scriptWitness.stack.push_back({});
+    tx.vout.resize(1 + rng.randrange(4));
+    for (CTxOut& out : tx.vout) {
+        out.nValue = rng.randrange(MAX_MONEY);
+        out.scriptPubKey = RandomScript(rng, 40);
+    }
+    return tx;
+}
+
+static std::vector<std::byte> RandomBlock(FastRandomContext& rng, CBlock& block)
+{
+    block.nVersion = rng.rand32();
+    block.hashPrevBlock = rng.rand256();
+    block.hashMerkleRoot = rng.rand256();
+    block.nTime = rng.rand32();
+    block.nBits = rng.rand32();
+    block.nNonce = rng.rand32();
+    block.vtx.clear();
+    const size_t txs{1 + rng.randrange<size_t>(20)};
+    for (size_t i{0}; i < txs; ++i) {
+        block.vtx.push_back(MakeTransactionRef(RandomTransaction(rng, /*coinbase=*/i == 0, /*witness=*/rng.randbool())));
+    }
+    DataStream ss;
+    ss << TX_WITH_WITNESS(block);
+    return {ss.begin(), ss.end()};
+}
+
+BOOST_AUTO_TEST_CASE(block_view_matches_block)
+{
+    for (int i{0}; i < 50; ++i) {
+        CBlock block;
+        const std::vector<std::byte> data{RandomBlock(m_rng, block)};
+        const BlockView view{data};
+
+        BOOST_CHECK(view.GetHash() == block.GetHash());
+        BOOST_CHECK_EQUAL(view.StrippedSize(), ::GetSerializeSize(TX_NO_WITNESS(block)));
+        BOOST_REQUIRE_EQUAL(view.TxCount(), block.vtx.size());
+        const std::vector<Txid> txids{view.ComputeTxids()};
+        size_t offset{80 + GetSizeOfCompactSize(block.vtx.size())};
+        for (size_t j{0}; j < block.vtx.size(); ++j) {
+            const CTransaction& tx{*block.vtx[j]};
+            const TxView tx_view{view.Tx(j)};
+            BOOST_CHECK_EQUAL(tx_view.version(), tx.version);
+            BOOST_CHECK_EQUAL(tx_view.nLockTime(), tx.nLockTime);
+            BOOST_CHECK_EQUAL(tx_view.HasWitness(), tx.HasWitness());
+            BOOST_CHECK(tx_view.ComputeHash() == tx.GetHash());
+            BOOST_CHECK(txids[j] == tx.GetHash());
+            BOOST_CHECK(tx_view.ComputeWitnessHash() == tx.GetWitnessHash());
+            BOOST_CHECK_EQUAL(tx_view.Offset(), offset);
+            BOOST_CHECK_EQUAL(tx_view.Serialized().size(), ::GetSerializeSize(TX_WITH_WITNESS(tx)));
+            BOOST_CHECK_EQUAL(tx_view.StrippedSize(), ::GetSerializeSize(TX_NO_WITNESS(tx)));
+            BOOST_CHECK(tx_view.ToTransaction()->GetWitnessHash() == tx.GetWitnessHash());
+            offset += tx_view.Serialized().size();
+
+            BOOST_REQUIRE_EQUAL(tx_view.InputCount(), tx.vin.size());
+            for (size_t k{0}; k < tx.vin.size(); ++k) {
+                const TxInView in{tx_view.Input(k)};
+                BOOST_CHECK(in.prevout() == tx.vin[k].prevout);
+                BOOST_CHECK(std::ranges::equal(MakeUCharSpan(in.scriptSig()), tx.vin[k].scriptSig));
+                BOOST_CHECK_EQUAL(in.nSequence(), tx.vin[k].nSequence);
+                const auto stack{in.WitnessStack()};
+                BOOST_REQUIRE_EQUAL(stack.size(), tx.vin[k].scriptWitness.stack.size());
+                for (size_t l{0}; l < stack.size(); ++l) {
+                    BOOST_CHECK(std::ranges::equal(MakeUCharSpan(stack[l]), tx.vin[k].scriptWitness.stack[l]));
+                }
+            }
+            BOOST_REQUIRE_EQUAL(tx_view.OutputCount(), tx.vout.size());
+            for (size_t k{0}; k < tx.vout.size(); ++k) {
+                const TxOutView out{tx_view.Output(k)};
+                BOOST_CHECK_EQUAL(out.nValue(), tx.vout[k].nValue);
+                BOOST_CHECK(std::ranges::equal(MakeUCharSpan(out.scriptPubKey()), tx.vout[k].scriptPubKey));
+            }
+        }
+        BOOST_CHECK_EQUAL(offset, data.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_unserialize_in_place)
+{
+    for (int i{0}; i < 20; ++i) {
+        CBlock block;
+        const std::vector<std::byte> data{RandomBlock(m_rng, block)};
+
+        // The transactions are hashed from the serialized block, and whatever
+        // follows it is left in the stream.
+        DataStream ss{data};
+        ss << uint32_t{0};
+        CBlock from_data_stream;
+        ss >> TX_WITH_WITNESS(from_data_stream);
+        BOOST_CHECK_EQUAL(ss.size(), 4U);
+        CBlock from_span_reader;
+        SpanReader{data} >> TX_WITH_WITNESS(from_span_reader);
+
+        for (const CBlock* read : {&from_data_stream, &from_span_reader}) {
+            BOOST_CHECK(read->GetHash() == block.GetHash());
+            BOOST_REQUIRE_EQUAL(read->vtx.size(), block.vtx.size());
+            for (size_t j{0}; j < block.vtx.size(); ++j) {
+                BOOST_CHECK(read->vtx[j]->GetHash() == block.vtx[j]->GetHash());
+                BOOST_CHECK(read->vtx[j]->GetWitnessHash() == block.vtx[j]->GetWitnessHash());
+                BOOST_CHECK_EQUAL(read->vtx[j]->HasWitness(), block.vtx[j]->HasWitness());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_view_malformed)
+{
+    CBlock block;
+    std::vector<std::byte> data{RandomBlock(m_rng, block)};
+
+    // Every truncation of the block is rejected, like it is by CBlock.
+    for (size_t size{0}; size < data.size(); ++size) {
+        BOOST_CHECK_THROW(BlockView{std::span{data}.first(size)}, std::ios_base::failure);
+    }
+    // Deserializing a CBlock from memory fails with the error of the stream.
+    DataStream truncated{std::span{data}.first(data.size() - 1)};
+    BOOST_CHECK_EXCEPTION(truncated >> TX_WITH_WITNESS(block), std::ios_base::failure, HasReason{"DataStream::read(): end of data"});
+
+    // A witness flag without any witness.
+    CMutableTransaction tx{RandomTransaction(m_rng, /*coinbase=*/true, /*witness=*/false)};
+    block.vtx = {MakeTransactionRef(tx)};
+    DataStream ss;
+    ss << block.nVersion << block.hashPrevBlock << block.hashMerkleRoot << block.nTime << block.nBits << block.nNonce;
+    WriteCompactSize(ss, 1);
+    ss << tx.version << uint8_t{0} << uint8_t{1} << tx.vin << tx.vout << uint8_t{0} << tx.nLockTime;
+    BOOST_CHECK_EXCEPTION(BlockView{MakeByteSpan(ss)}, std::ios_base::failure, HasReason{"Superfluous witness record"});
+    BOOST_CHECK_EXCEPTION(SpanReader{MakeByteSpan(ss)} >> TX_WITH_WITNESS(block), std::ios_base::failure, HasReason{"Superfluous witness record"});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
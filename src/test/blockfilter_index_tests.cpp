@@ -5,6 +5,7 @@
 #include <addresstype.h>
 #include <blockfilter.h>
 #include <chainparams.h>
+#include <common/args.h>
 #include <consensus/merkle.h>
 #include <consensus/validation.h>
 #include <index/blockfilterindex.h>
@@ -270,6 +271,26 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     filter_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_sync_threads, BuildChainTestingSetup)
+{
+    // Build the index with blocks read and prepared on the sync thread, and
+    // ahead of it on a pool of threads. Both must produce the same filters.
+    for (const int sync_threads : {0, MAX_INDEX_SYNC_THREADS}) {
+        BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, /*f_memory=*/true, /*f_wipe=*/true);
+        BOOST_REQUIRE(filter_index.Init());
+        filter_index.Sync(sync_threads);
+        BOOST_CHECK(filter_index.GetSummary().synced);
+
+        LOCK(cs_main);
+        uint256 last_header;
+        for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+             block_index != nullptr;
+             block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+            BOOST_CHECK(CheckFilterLookups(filter_index, block_index, last_header, m_node.chainman->m_blockman));
+        }
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
@@ -384,4 +405,55 @@ BOOST_FIXTURE_TEST_CASE(index_reorg_crash, BuildChainTestingSetup)
     index.Stop();
 }
 
+class IndexPrepareInterrupt : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+    const int m_interrupt_height;
+    std::promise<void> m_appended_before;
+    std::shared_future<void> m_appended_before_future{m_appended_before.get_future()};
+
+public:
+    explicit IndexPrepareInterrupt(std::unique_ptr<interfaces::Chain> chain, int interrupt_height)
+        : BaseIndex(std::move(chain), "test index"), m_interrupt_height(interrupt_height)
+    {
+        const fs::path path = gArgs.GetDataDirNet() / "index";
+        fs::create_directories(path);
+        m_db = std::make_unique<BaseIndex::DB>(path / "db", /*n_cache_size=*/0, /*f_memory=*/true, /*f_wipe=*/false);
+    }
+
+    bool AllowPrune() const override { return false; }
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block) override
+    {
+        if (block.height != m_interrupt_height) return true;
+        // Give the sync thread time to start waiting for this block after
+        // appending the one before it, then fail it as if it was skipped
+        // because of the interrupt.
+        m_appended_before_future.wait();
+        std::this_thread::sleep_for(100ms);
+        Interrupt();
+        return false;
+    }
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override
+    {
+        if (block.height == m_interrupt_height - 1) m_appended_before.set_value();
+        return true;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(index_interrupt_pipelined_sync, BuildChainTestingSetup)
+{
+    // A block that fails to be prepared because the sync is being interrupted
+    // must not leave a consumed future behind for the interrupt to wait on.
+    const int interrupt_height{50};
+    IndexPrepareInterrupt index(interfaces::MakeChain(m_node), interrupt_height);
+    BOOST_REQUIRE(index.Init());
+    index.Sync(MAX_INDEX_SYNC_THREADS);
+    BOOST_CHECK(!index.GetSummary().synced);
+    BOOST_CHECK_EQUAL(index.GetSummary().best_block_height, interrupt_height - 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
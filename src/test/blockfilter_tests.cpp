@@ -8,10 +8,12 @@
 #include <blockfilter.h>
 #include <core_io.h>
 #include <primitives/block.h>
+#include <random.h>
 #include <serialize.h>
 #include <streams.h>
 #include <undo.h>
 #include <univalue.h>
+#include <util/golombrice.h>
 #include <util/strencodings.h>
 
 #include <boost/test/unit_test.hpp>
@@ -41,6 +43,42 @@ BOOST_AUTO_TEST_CASE(gcsfilter_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(golombrice_reader)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    for (const uint8_t P : {0, 1, 19, 40}) {
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 1000; ++i) {
+            // Mostly small quotients, with some long runs of 1's.
+            const uint64_t q{i % 97 == 0 ? rng.randrange<uint64_t>(200) : rng.randrange<uint64_t>(4)};
+            values.push_back((q << P) + (P == 0 ? 0 : rng.randbits(P)));
+        }
+
+        std::vector<unsigned char> encoded;
+        {
+            VectorWriter stream{encoded, 0};
+            BitStreamWriter bitwriter{stream};
+            for (const uint64_t value : values) GolombRiceEncode(bitwriter, P, value);
+            bitwriter.Flush();
+        }
+
+        GolombRiceReader reader{encoded};
+        SpanReader stream{encoded};
+        BitStreamReader bitreader{stream};
+        for (const uint64_t value : values) {
+            BOOST_CHECK_EQUAL(reader.Decode(P), value);
+            BOOST_CHECK_EQUAL(GolombRiceDecode(bitreader, P), value);
+        }
+
+        // Reading past the end of the data fails.
+        GolombRiceReader truncated{std::span{encoded}.first(encoded.size() / 2)};
+        const auto decode_all{[&] {
+            for (size_t i = 0; i < values.size(); ++i) truncated.Decode(P);
+        }};
+        BOOST_CHECK_THROW(decode_all(), std::ios_base::failure);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(gcsfilter_default_constructor)
 {
     GCSFilter filter;
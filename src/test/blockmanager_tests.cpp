@@ -2,17 +2,26 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <clientversion.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
+#include <pow.h>
 #include <script/solver.h>
 #include <primitives/block.h>
+#include <streams.h>
 #include <util/chaintype.h>
+#include <util/fs.h>
 #include <validation.h>
 
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 #include <test/util/common.h>
 #include <test/util/logging.h>
@@ -23,6 +32,7 @@ using node::STORAGE_HEADER_BYTES;
 using node::BlockManager;
 using node::KernelNotifications;
 using node::MAX_BLOCKFILE_SIZE;
+using node::MAX_MAPPED_BLOCK_FILES;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and cleanup
 BOOST_FIXTURE_TEST_SUITE(blockmanager_tests, BasicTestingSetup)
@@ -300,4 +310,198 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_read_mapped_block_file)
+{
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .use_mmap = true,
+        .fast_prune = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = m_args.GetDataDirNet() / "blocks" / "index",
+            .cache_bytes = 0,
+        },
+    };
+    BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+
+    // Blocks of about 30kB, so that the third one goes into a new 64kB fast_prune block file
+    std::vector<CBlock> blocks(3);
+    std::vector<FlatFilePos> positions;
+    for (size_t i{0}; i < blocks.size(); ++i) {
+        CMutableTransaction tx;
+        tx.vout.emplace_back(i, CScript() << std::vector<unsigned char>(30'000));
+        blocks[i].vtx.push_back(MakeTransactionRef(std::move(tx)));
+        positions.push_back(blockman.WriteBlock(blocks[i], /*nHeight=*/i + 1));
+    }
+    BOOST_CHECK_EQUAL(positions[0].nFile, 0);
+    BOOST_CHECK_EQUAL(positions[2].nFile, 1);
+
+    // Blocks in the finalized file are read from the mapping, the block in the
+    // file that is still being written to from disk. Both give the same result.
+    for (size_t i{0}; i < blocks.size(); ++i) {
+        DataStream expected;
+        expected << TX_WITH_WITNESS(blocks[i]);
+        const auto block_data{blockman.ReadRawBlock(positions[i])};
+        BOOST_REQUIRE(block_data);
+        BOOST_CHECK(std::ranges::equal(*block_data, expected));
+
+        const auto part{blockman.ReadRawBlock(positions[i], std::pair{size_t{80}, size_t{100}})};
+        BOOST_REQUIRE(part);
+        BOOST_CHECK(std::ranges::equal(*part, std::span{expected}.subspan(80, 100)));
+        BOOST_CHECK_EQUAL(blockman.ReadRawBlock(positions[i], std::pair{size_t{1}, expected.size()}).error(), node::ReadRawError::BadPartRange);
+    }
+
+    // A position past the end of a mapped file fails cleanly
+    {
+        ASSERT_DEBUG_LOG("end of mapped block file");
+        BOOST_CHECK_EQUAL(blockman.ReadRawBlock({0, 1'000'000}).error(), node::ReadRawError::IO);
+    }
+
+    // Fill more block files than are kept mapped, and read a block from each
+    // finalized one. Only the most recently used ones stay mapped.
+    while (positions.back().nFile <= int(MAX_MAPPED_BLOCK_FILES) + 1) {
+        positions.push_back(blockman.WriteBlock(blocks[positions.size() % blocks.size()], /*nHeight=*/positions.size() + 1));
+    }
+    for (size_t i{0}; i < positions.size(); ++i) {
+        if (positions[i].nFile == positions.back().nFile) continue;
+        DataStream expected;
+        expected << TX_WITH_WITNESS(blocks[i % blocks.size()]);
+        const auto block_data{blockman.ReadRawBlock(positions[i])};
+        BOOST_REQUIRE(block_data);
+        BOOST_CHECK(std::ranges::equal(*block_data, expected));
+        BOOST_CHECK_LE(blockman.MappedBlockFileCount(), MAX_MAPPED_BLOCK_FILES);
+    }
+    BOOST_CHECK_EQUAL(blockman.MappedBlockFileCount(), MAX_MAPPED_BLOCK_FILES);
+
+    // Files that were unmapped are mapped again when they are read
+    blockman.UnmapBlockFiles();
+    BOOST_CHECK_EQUAL(blockman.MappedBlockFileCount(), 0U);
+    BOOST_CHECK(blockman.ReadRawBlock(positions[0]));
+    BOOST_CHECK_EQUAL(blockman.MappedBlockFileCount(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_block_index_snapshot)
+{
+    const auto params{CreateChainParams(ArgsManager{}, ChainType::REGTEST)};
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    const BlockManager::Options blockman_opts{
+        .chainparams = *params,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = m_args.GetDataDirNet() / "blocks" / "index",
+            .cache_bytes = 0,
+        },
+        .use_block_index_snapshot = true,
+    };
+    const auto mine_header{[&](const CBlockIndex& prev, uint32_t time_offset = 1) {
+        CBlockHeader header{prev.GetBlockHeader()};
+        header.hashPrevBlock = prev.GetBlockHash();
+        header.nTime = prev.nTime + time_offset;
+        while (!CheckProofOfWork(header.GetHash(), header.nBits, params->GetConsensus())) ++header.nNonce;
+        return header;
+    }};
+    const auto hash_of{[](const CBlockIndex* pindex) { return pindex ? pindex->GetBlockHash() : uint256{}; }};
+
+    // Height, chain work, hashes of the predecessor and skip blocks, and status by block hash
+    std::map<uint256, std::tuple<int, arith_uint256, uint256, uint256, uint32_t>> expected;
+    const auto check_block_index{[&](const BlockManager& blockman) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        BOOST_CHECK_EQUAL(blockman.m_block_index.size(), expected.size());
+        for (const auto& [hash, block_index] : blockman.m_block_index) {
+            BOOST_CHECK(expected.at(hash) == std::make_tuple(block_index.nHeight, block_index.nChainWork, hash_of(block_index.pprev),
+                                                             hash_of(block_index.pskip), block_index.nStatus));
+        }
+    }};
+
+    // Build a block index with a fork and write it to the database and the snapshot.
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        CBlockIndex* best_header{nullptr};
+        CBlockIndex* tip{blockman.AddToBlockIndex(params->GenesisBlock(), best_header)};
+        for (int i{0}; i < 50; ++i) tip = blockman.AddToBlockIndex(mine_header(*tip), best_header);
+        CBlockIndex* fork{blockman.AddToBlockIndex(mine_header(*Assert(tip->GetAncestor(40)), /*time_offset=*/2), best_header)};
+        fork = blockman.AddToBlockIndex(mine_header(*fork), best_header);
+        fork->nStatus |= BLOCK_FAILED_VALID;
+        blockman.WriteBlockIndexDB();
+        BOOST_CHECK(blockman.WriteBlockIndexSnapshot());
+        for (const auto& [hash, block_index] : blockman.m_block_index) {
+            expected.emplace(hash, std::make_tuple(block_index.nHeight, block_index.nChainWork, hash_of(block_index.pprev),
+                                                   hash_of(block_index.pskip), block_index.nStatus));
+        }
+    }
+    // The next load uses the snapshot, and invalidates it.
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        {
+            ASSERT_DEBUG_LOG("Loaded 53 block index entries from snapshot");
+            BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        }
+        check_block_index(blockman);
+        BOOST_CHECK(!blockman.m_block_tree_db->ReadBlockIndexSnapshotChecksum());
+    }
+    // Without a valid snapshot, the block index is loaded from the database.
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        check_block_index(blockman);
+        BOOST_CHECK(blockman.WriteBlockIndexSnapshot());
+    }
+    // A snapshot that does not match its checksum is not used.
+    {
+        const fs::path path{m_args.GetDataDirNet() / "blocks" / "blockindex.dat"};
+        std::vector<std::byte> data(fs::file_size(path));
+        AutoFile{fsbridge::fopen(path, "rb")}.read(data);
+        data[100] ^= std::byte{1};
+        AutoFile file{fsbridge::fopen(path, "wb")};
+        file.write(data);
+        BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+    }
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        {
+            ASSERT_DEBUG_LOG("checksum mismatch");
+            BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        }
+        check_block_index(blockman);
+        BOOST_CHECK(blockman.WriteBlockIndexSnapshot());
+    }
+    // A version that doesn't know about the snapshot leaves its checksum in
+    // the database. Once it has changed a block file record, in the same
+    // write as block index entries, the snapshot is not used.
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        const auto checksum{blockman.m_block_tree_db->ReadBlockIndexSnapshotChecksum()};
+        BOOST_REQUIRE(checksum);
+        BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        CBlockIndex* tip{nullptr};
+        for (auto& [_, block_index] : blockman.m_block_index) {
+            if (!tip || block_index.nHeight > tip->nHeight) tip = &block_index;
+        }
+        BOOST_REQUIRE(tip);
+        tip->nStatus |= BLOCK_FAILED_VALID;
+        std::get<4>(expected.at(tip->GetBlockHash())) = tip->nStatus;
+        CBlockFileInfo info;
+        info.AddBlock(tip->nHeight, tip->nTime);
+        blockman.m_block_tree_db->WriteBatchSync({{0, &info}}, /*nLastFile=*/0, {tip});
+        blockman.m_block_tree_db->WriteBlockIndexSnapshotChecksum(checksum);
+    }
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        {
+            ASSERT_DEBUG_LOG("block files changed since the snapshot was written");
+            BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        }
+        check_block_index(blockman);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <streams.h>
+#include <sync.h>
 #include <test/util/common.h>
 #include <test/util/poolresourcetester.h>
 #include <test/util/random.h>
@@ -15,8 +16,11 @@
 #include <undo.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <string>
+#include <thread>
 #include <variant>
 #include <vector>
 
@@ -1193,4 +1197,341 @@ BOOST_AUTO_TEST_CASE(ccoins_peekcoin)
     BOOST_CHECK(!main_cache.HaveCoinInCache(outpoint));
 }
 
+
+BOOST_AUTO_TEST_CASE(ccoins_trim)
+{
+    CCoinsViewTest base{m_rng};
+    CCoinsViewCacheTest cache{&base};
+
+    // Add coins in a number of blocks, so that they were accessed at different times.
+    constexpr size_t BLOCKS{10}, COINS_PER_BLOCK{2000};
+    std::vector<std::vector<COutPoint>> blocks(BLOCKS);
+    for (auto& block : blocks) {
+        for (size_t i{0}; i < COINS_PER_BLOCK; ++i) {
+            block.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+            cache.AddCoin(block.back(), Coin{CTxOut{1, CScript{} << OP_TRUE}, 1, false}, /*possible_overwrite=*/false);
+        }
+        cache.SetBestBlock(m_rng.rand256());
+    }
+
+    // Coins can only be evicted once they are written to the base view.
+    BOOST_CHECK(!cache.Trim(0));
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), BLOCKS * COINS_PER_BLOCK);
+    cache.Sync();
+
+    // Looking up coins of the oldest block makes them recent again.
+    const std::vector<COutPoint> touched(blocks[0].begin(), blocks[0].begin() + 100);
+    for (const auto& outpoint : touched) BOOST_CHECK(cache.HaveCoin(outpoint));
+    // Peeking at them does not.
+    for (const auto& outpoint : blocks[1]) BOOST_CHECK(cache.PeekCoin(outpoint));
+
+    const size_t usage_before{cache.DynamicMemoryUsage()};
+    size_t evicted{0};
+    bool evicted_recent{false};
+    // Evicted coins are passed on from the most recently accessed block to the oldest.
+    std::map<COutPoint, size_t> block_of;
+    for (size_t i{0}; i < BLOCKS; ++i) {
+        for (const auto& outpoint : blocks[i]) block_of.emplace(outpoint, i);
+    }
+    size_t last_block{BLOCKS};
+    bool evicted_in_order{true};
+    BOOST_CHECK(cache.Trim(usage_before / 2, [&](const COutPoint& outpoint, const Coin& coin) {
+        BOOST_CHECK(!coin.IsSpent());
+        evicted_recent |= std::ranges::find(touched, outpoint) != touched.end();
+        const size_t block{block_of.at(outpoint)};
+        evicted_in_order &= block <= last_block;
+        last_block = block;
+        ++evicted;
+        return true;
+    }));
+    cache.SelfTest();
+    BOOST_CHECK(!evicted_recent);
+    BOOST_CHECK(evicted_in_order);
+    BOOST_CHECK_EQUAL(cache.GetCacheSize() + evicted, BLOCKS * COINS_PER_BLOCK);
+    BOOST_CHECK_LT(cache.DynamicMemoryUsage(), usage_before);
+    BOOST_CHECK(std::ranges::all_of(touched, [&](const auto& outpoint) { return cache.HaveCoinInCache(outpoint); }));
+    BOOST_CHECK(std::ranges::all_of(blocks.back(), [&](const auto& outpoint) { return cache.HaveCoinInCache(outpoint); }));
+    BOOST_CHECK(std::ranges::none_of(blocks[1], [&](const auto& outpoint) { return cache.HaveCoinInCache(outpoint); }));
+    // Evicted coins are still in the base view.
+    BOOST_CHECK(cache.HaveCoin(blocks[1][0]));
+
+    // The callback can stop being called early.
+    const size_t size_before{cache.GetCacheSize()};
+    evicted = 0;
+    cache.Sync();
+    BOOST_CHECK(cache.Trim(0, [&](const COutPoint&, const Coin&) { return ++evicted < 10; }));
+    BOOST_CHECK_EQUAL(evicted, 10U);
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK_GT(size_before, 0U);
+    cache.SelfTest();
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_compressed_cache)
+{
+    CCoinsViewTest base{m_rng};
+    CCoinsViewCompressedCache compressed{&base};
+    CCoinsViewCacheTest tip{&compressed};
+
+    std::vector<COutPoint> outpoints;
+    std::vector<Coin> coins;
+    for (int i{0}; i < 3; ++i) {
+        outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), i);
+        // Include a script that does not compress to a known template.
+        coins.emplace_back(CTxOut{m_rng.randrange(MAX_MONEY), CScript{} << std::vector<unsigned char>(100 * i, 1)}, 100 + i, i == 0);
+        tip.AddCoin(outpoints.back(), Coin{coins.back()}, /*possible_overwrite=*/false);
+    }
+    tip.Flush();
+
+    // Nothing is kept until the cache has memory.
+    BOOST_CHECK(!compressed.Insert(outpoints[0], coins[0]));
+    compressed.SetMaxUsage(1 << 20);
+    for (int i{0}; i < 3; ++i) BOOST_CHECK(compressed.Insert(outpoints[i], coins[i]));
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), 3U);
+    BOOST_CHECK_GT(compressed.DynamicMemoryUsage(), 0U);
+    for (int i{0}; i < 3; ++i) {
+        BOOST_CHECK(compressed.GetCoin(outpoints[i]).value() == coins[i]);
+        BOOST_CHECK(compressed.PeekCoin(outpoints[i]).value() == coins[i]);
+        BOOST_CHECK(compressed.HaveCoin(outpoints[i]));
+    }
+
+    // Changes written through the cache drop the coins they touch.
+    BOOST_CHECK(tip.SpendCoin(outpoints[1]));
+    tip.Sync();
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), 2U);
+    BOOST_CHECK(!compressed.GetCoin(outpoints[1]));
+    BOOST_CHECK(!base.GetCoin(outpoints[1]));
+
+    // Aging drops the coins that were not looked up since.
+    compressed.Age();
+    BOOST_CHECK(compressed.PeekCoin(outpoints[0]));
+    compressed.Age();
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), 1U);
+    compressed.Age();
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), 0U);
+    // The coins are still found in the base view.
+    BOOST_CHECK(compressed.GetCoin(outpoints[2]).value() == coins[2]);
+
+    // Coins are only inserted until the newer generation takes half the memory.
+    compressed.SetMaxUsage(1 << 16);
+    size_t inserted{0};
+    while (compressed.Insert(COutPoint{Txid::FromUint256(m_rng.rand256()), 0}, coins[0])) ++inserted;
+    BOOST_CHECK_GT(inserted, 0U);
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), inserted);
+    BOOST_CHECK_LE(compressed.DynamicMemoryUsage(), 1U << 16);
+
+    // Shrinking the cache empties it.
+    compressed.SetMaxUsage(1);
+    BOOST_CHECK_EQUAL(compressed.GetCacheSize(), 0U);
+    BOOST_CHECK(!compressed.Insert(outpoints[0], coins[0]));
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_sharded)
+{
+    CCoinsViewTest base{m_rng};
+    CCoinsViewSharded shared{&base, /*max_cached_coins=*/CCoinsViewSharded::SHARD_COUNT};
+    CoinsViewPublishingCache tip{shared};
+    std::vector<std::optional<Coin>> coins;
+
+    const COutPoint outpoint1{Txid::FromUint256(m_rng.rand256()), 0};
+    const COutPoint outpoint2{Txid::FromUint256(m_rng.rand256()), 1};
+    const Coin coin1{CTxOut{1, CScript{} << OP_1}, 1, false};
+    const Coin coin2{CTxOut{2, CScript{} << OP_2}, 2, false};
+    const std::vector<COutPoint> outpoints{outpoint1, outpoint2};
+
+    // Changes are not published and lookups are unavailable until activated.
+    tip.AddCoin(outpoint1, Coin{coin1}, /*possible_overwrite=*/false);
+    const uint256 block1{m_rng.rand256()};
+    {
+        CCoinsViewCache child{&tip};
+        child.SetBestBlock(block1);
+        child.Flush();
+    }
+    BOOST_CHECK(!shared.IsActive());
+    BOOST_CHECK(!shared.GetCoins(outpoints, coins));
+
+    shared.RequestActivation();
+    BOOST_CHECK(!shared.IsActive());
+    tip.Flush();
+    BOOST_CHECK(shared.IsActive());
+    BOOST_CHECK_EQUAL(*shared.GetCoins(outpoints, coins), block1);
+    BOOST_REQUIRE_EQUAL(coins.size(), 2U);
+    BOOST_CHECK(coins[0] && *coins[0] == coin1);
+    BOOST_CHECK(!coins[1]);
+
+    // Changes written into the tip are visible before the tip is flushed, even
+    // though both coins were cached from the base view.
+    const uint256 block2{m_rng.rand256()};
+    {
+        CCoinsViewCache child{&tip};
+        child.SpendCoin(outpoint1);
+        child.AddCoin(outpoint2, Coin{coin2}, /*possible_overwrite=*/false);
+        child.SetBestBlock(block2);
+        child.Flush();
+    }
+    BOOST_CHECK(base.GetCoin(outpoint1));
+    BOOST_CHECK_EQUAL(*shared.GetCoins(outpoints, coins), block2);
+    BOOST_CHECK(!coins[0]);
+    BOOST_CHECK(coins[1] && *coins[1] == coin2);
+    // Lookups through the view (used by the tip on cache misses) see the same state.
+    BOOST_CHECK(!shared.HaveCoin(outpoint1));
+    BOOST_CHECK(shared.PeekCoin(outpoint2).value() == coin2);
+
+    // Flushing the tip does not change the published state.
+    tip.Flush();
+    BOOST_CHECK(!base.GetCoin(outpoint1));
+    BOOST_CHECK_EQUAL(*shared.GetCoins(outpoints, coins), block2);
+    BOOST_CHECK(!coins[0]);
+    BOOST_CHECK(coins[1] && *coins[1] == coin2);
+
+    // Changes made to the tip directly become visible when it is flushed.
+    tip.SpendCoin(outpoint2);
+    tip.Flush();
+    BOOST_CHECK_EQUAL(*shared.GetCoins(outpoints, coins), block2);
+    BOOST_CHECK(!coins[0] && !coins[1]);
+
+    // Overflowing the cache evicts previously cached coins.
+    std::vector<COutPoint> missing;
+    for (size_t i{0}; i < 4 * CCoinsViewSharded::SHARD_COUNT; ++i) {
+        missing.emplace_back(Txid::FromUint256(m_rng.rand256()), 0);
+    }
+    BOOST_CHECK(shared.GetCoins(missing, coins));
+    BOOST_CHECK_EQUAL(coins.size(), missing.size());
+    BOOST_CHECK(std::ranges::none_of(coins, [](const auto& coin) { return coin.has_value(); }));
+
+    shared.Deactivate();
+    BOOST_CHECK(!shared.IsActive());
+    BOOST_CHECK(!shared.GetCoins(outpoints, coins));
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_sharded_concurrent_readers)
+{
+    // Every block spends the only coin of a chain of coins and creates the next
+    // one. Readers looking up the whole chain concurrently must always find
+    // exactly the coin created by the block that was returned as best block.
+    constexpr int NUM_BLOCKS{200};
+    CCoinsViewTest base{m_rng};
+    CCoinsViewSharded shared{&base};
+    CoinsViewPublishingCache tip{shared};
+
+    std::vector<COutPoint> outpoints;
+    std::vector<uint256> blocks;
+    for (int i{0}; i <= NUM_BLOCKS; ++i) {
+        outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), 0);
+        blocks.push_back(m_rng.rand256());
+    }
+    tip.AddCoin(outpoints[0], Coin{CTxOut{1, CScript{}}, 1, false}, /*possible_overwrite=*/false);
+    tip.SetBestBlock(blocks[0]);
+    shared.RequestActivation();
+    tip.Flush();
+
+    std::atomic_bool done{false};
+    std::atomic_bool consistent{true};
+    std::vector<std::thread> readers;
+    for (int t{0}; t < 3; ++t) {
+        readers.emplace_back([&] {
+            std::vector<std::optional<Coin>> coins;
+            while (!done) {
+                const uint256 best_block{*Assert(shared.GetCoins(outpoints, coins))};
+                const auto height{std::ranges::find(blocks, best_block) - blocks.begin()};
+                for (int i{0}; i <= NUM_BLOCKS; ++i) {
+                    if (coins[i].has_value() != (i == height)) consistent = false;
+                }
+            }
+        });
+    }
+    for (int i{1}; i <= NUM_BLOCKS; ++i) {
+        CCoinsViewCache child{&tip};
+        child.SpendCoin(outpoints[i - 1]);
+        child.AddCoin(outpoints[i], Coin{CTxOut{1, CScript{}}, i + 1, false}, /*possible_overwrite=*/false);
+        child.SetBestBlock(blocks[i]);
+        child.Flush();
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    BOOST_CHECK(consistent);
+}
+
+//! CCoinsViewTest that can be read while it is written, like CCoinsViewDB.
+class CCoinsViewLockedTest : public CCoinsViewTest
+{
+    mutable Mutex m_mutex;
+
+public:
+    using CCoinsViewTest::CCoinsViewTest;
+
+    std::optional<Coin> GetCoin(const COutPoint& outpoint) const override
+    {
+        LOCK(m_mutex);
+        return CCoinsViewTest::GetCoin(outpoint);
+    }
+
+    void BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override
+    {
+        LOCK(m_mutex);
+        CCoinsViewTest::BatchWrite(cursor, hashBlock);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(ccoins_sharded_concurrent_flush)
+{
+    // Like ccoins_sharded_concurrent_readers, but the tip is also written to the
+    // base view, with both Flush() and Sync(), while the readers run. Readers must
+    // never see an older state than the tip that was published before their
+    // lookup started, neither from published entries nor from the base view.
+    constexpr int NUM_BLOCKS{300};
+    CCoinsViewLockedTest base{m_rng};
+    CCoinsViewSharded shared{&base, /*max_cached_coins=*/4 * CCoinsViewSharded::SHARD_COUNT};
+    CoinsViewPublishingCache tip{shared};
+
+    std::vector<COutPoint> outpoints;
+    std::vector<uint256> blocks;
+    for (int i{0}; i <= NUM_BLOCKS; ++i) {
+        outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), 0);
+        blocks.push_back(m_rng.rand256());
+    }
+    tip.AddCoin(outpoints[0], Coin{CTxOut{1, CScript{}}, 1, false}, /*possible_overwrite=*/false);
+    tip.SetBestBlock(blocks[0]);
+    shared.RequestActivation();
+    tip.Flush();
+
+    std::atomic<int> published{0};
+    std::atomic_bool done{false};
+    std::atomic_bool consistent{true};
+    std::atomic_bool monotonic{true};
+    std::vector<std::thread> readers;
+    for (int t{0}; t < 3; ++t) {
+        readers.emplace_back([&] {
+            std::vector<std::optional<Coin>> coins;
+            while (!done) {
+                const int min_height{published};
+                const uint256 best_block{*Assert(shared.GetCoins(outpoints, coins))};
+                const int height(std::ranges::find(blocks, best_block) - blocks.begin());
+                if (height < min_height || height > NUM_BLOCKS) monotonic = false;
+                for (int i{0}; i <= NUM_BLOCKS; ++i) {
+                    if (coins[i].has_value() != (i == height)) consistent = false;
+                }
+            }
+        });
+    }
+    for (int i{1}; i <= NUM_BLOCKS; ++i) {
+        {
+            CCoinsViewCache child{&tip};
+            child.SpendCoin(outpoints[i - 1]);
+            child.AddCoin(outpoints[i], Coin{CTxOut{1, CScript{}}, i + 1, false}, /*possible_overwrite=*/false);
+            child.SetBestBlock(blocks[i]);
+            child.Flush();
+        }
+        published = i;
+        if (i % 7 == 0) {
+            tip.Flush();
+        } else if (i % 3 == 0) {
+            tip.Sync();
+        }
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    BOOST_CHECK(monotonic);
+    BOOST_CHECK(consistent);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
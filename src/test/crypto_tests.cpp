@@ -1082,9 +1082,42 @@ BOOST_AUTO_TEST_CASE(sha256d64)
         for (int j = 0; j < i; ++j) {
             CHash256().Write({in + 64 * j, 64}).Finalize({out1 + 32 * j, 32});
         }
-        SHA256D64(out2, in, i);
-        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+        for (const auto use_implementation : {sha256_implementation::STANDARD, sha256_implementation::USE_SSE4_AND_AVX2, sha256_implementation::USE_SSE4_AND_AVX512, sha256_implementation::USE_ALL}) {
+            SHA256AutoDetect(use_implementation);
+            SHA256D64(out2, in, i);
+            BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+        }
+    }
+    SHA256AutoDetect();
+}
+
+BOOST_AUTO_TEST_CASE(sha256dmulti)
+{
+    using namespace sha256_implementation;
+    for (const auto use_implementation : {STANDARD, USE_SSE4, USE_SSE4_AND_AVX2, USE_SSE4_AND_SHANI, USE_SSE4_AND_AVX512}) {
+        BOOST_TEST_MESSAGE(SHA256AutoDetect(use_implementation));
+        for (size_t count = 0; count <= 20; ++count) {
+            // Cover the lengths around block boundaries, where padding spills into an extra block.
+            std::vector<std::vector<unsigned char>> msgs(count);
+            for (auto& msg : msgs) {
+                const size_t len{m_rng.randbool() ? 48 + m_rng.randrange<size_t>(24) : m_rng.randrange<size_t>(300)};
+                msg = m_rng.randbytes(len);
+            }
+            std::vector<const unsigned char*> inputs;
+            std::vector<size_t> lengths;
+            for (const auto& msg : msgs) {
+                inputs.push_back(msg.data());
+                lengths.push_back(msg.size());
+            }
+            std::vector<unsigned char> out1(32 * count), out2(32 * count);
+            for (size_t i = 0; i < count; ++i) {
+                CHash256().Write(msgs[i]).Finalize({out1.data() + 32 * i, 32});
+            }
+            SHA256DMulti(out2.data(), inputs.data(), lengths.data(), count);
+            BOOST_CHECK(out1 == out2);
+        }
     }
+    SHA256AutoDetect();
 }
 
 void CryptoTest::TestSHA3_256(const std::string& input, const std::string& output)
@@ -2,18 +2,27 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <dbwrapper.h>
+#include <node/database_args.h>
 #include <test/util/common.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <util/string.h>
+#include <util/time.h>
 
+#include <chrono>
+#include <iterator>
 #include <memory>
 #include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
+using namespace std::chrono_literals;
 using util::ToString;
 
 BOOST_FIXTURE_TEST_SUITE(dbwrapper_tests, BasicTestingSetup)
@@ -226,6 +235,110 @@ BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_tuning_options)
+{
+    // Small blocks, write buffers and files without bloom filters hold the same data.
+    const DBOptions options{.bloom_bits = 0, .block_size = 256, .write_buffer_size = 64 << 10, .max_file_size = 64 << 10};
+    CDBWrapper dbw({.path = m_args.GetDataDirBase() / "dbwrapper_tuning", .cache_bytes = 1 << 20, .memory_only = true, .options = options});
+
+    std::vector<uint256> values(10'000);
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        values[i] = m_rng.rand256();
+        dbw.Write(std::pair{uint8_t{'k'}, i}, values[i]);
+    }
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        uint256 res;
+        BOOST_REQUIRE(dbw.Read(std::pair{uint8_t{'k'}, i}, res));
+        BOOST_CHECK_EQUAL(res, values[i]);
+    }
+    BOOST_CHECK(!dbw.Exists(std::pair{uint8_t{'k'}, uint32_t(values.size())}));
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_read_database_args)
+{
+    const auto parse{[](std::vector<const char*> argv) {
+        auto args{std::make_unique<ArgsManager>()};
+        for (const char* arg : {"-dbbloombits=[<db>:]<n>", "-dbblocksize=[<db>:]<n>", "-dbwritebuffer=[<db>:]<n>", "-dbmaxfilesize=[<db>:]<n>"}) {
+            args->AddArg(arg, "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+        }
+        argv.insert(argv.begin(), "ignored");
+        std::string error;
+        BOOST_REQUIRE_MESSAGE(args->ParseParameters(argv.size(), argv.data(), error), error);
+        return args;
+    }};
+
+    // A value for one database takes precedence over a value for all of them, whatever their order.
+    const auto args{parse({"-dbbloombits=16", "-dbbloombits=chainstate:0", "-dbbloombits=20", "-dbmaxfilesize=txindex:64", "-dbwritebuffer=8"})};
+    DBOptions chainstate;
+    BOOST_REQUIRE(node::ReadDatabaseArgs(*args, chainstate, "chainstate"));
+    BOOST_CHECK_EQUAL(chainstate.bloom_bits, 0);
+    BOOST_CHECK_EQUAL(chainstate.block_size, DBWRAPPER_BLOCK_SIZE);
+    BOOST_CHECK_EQUAL(chainstate.write_buffer_size.value(), size_t{8} << 20);
+    BOOST_CHECK_EQUAL(chainstate.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    DBOptions txindex;
+    BOOST_REQUIRE(node::ReadDatabaseArgs(*args, txindex, "txindex"));
+    BOOST_CHECK_EQUAL(txindex.bloom_bits, 20);
+    BOOST_CHECK_EQUAL(txindex.max_file_size, size_t{64} << 20);
+
+    // Without tuning options, the defaults are kept.
+    DBOptions defaults;
+    BOOST_REQUIRE(node::ReadDatabaseArgs(*parse({}), defaults, "chainstate"));
+    BOOST_CHECK_EQUAL(defaults.bloom_bits, DBWRAPPER_BLOOM_BITS);
+    BOOST_CHECK(!defaults.write_buffer_size);
+
+    // An invalid value fails for every database, not only the one it names.
+    for (const char* arg : {"-dbblocksize=txindex:0", "-dbbloombits=65", "-dbwritebuffer=chainstate:x", "-dbmaxfilesize=:8"}) {
+        DBOptions options;
+        BOOST_CHECK(!node::ReadDatabaseArgs(*parse({arg}), options, "chainstate"));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_background_compaction)
+{
+    const fs::path path{m_args.GetDataDirBase() / "dbwrapper_compaction"};
+    // A small write buffer leaves the data in several level 0 tables.
+    DBOptions options{.write_buffer_size = 64 << 10};
+    constexpr uint32_t ENTRIES{20'000};
+    {
+        CDBWrapper dbw({.path = path, .cache_bytes = 1 << 20, .options = options});
+        BOOST_CHECK(!dbw.RequestCompaction());
+        BOOST_CHECK(!dbw.GetCompactionProgress().enabled);
+        for (uint32_t i = 0; i < ENTRIES; ++i) {
+            dbw.Write(std::pair{uint8_t{'k'}, i}, m_rng.rand256());
+        }
+    }
+
+    // The database was not written to since it was opened, so it can be compacted
+    // right away, but not while compaction is deferred.
+    options.compaction_rate = 1 << 30;
+    CDBWrapper dbw({.path = path, .cache_bytes = 1 << 20, .options = options});
+    dbw.SetCompactionDeferred(true);
+    BOOST_CHECK(dbw.RequestCompaction());
+    auto progress{dbw.GetCompactionProgress()};
+    BOOST_CHECK(progress.enabled);
+    BOOST_CHECK(progress.deferred);
+    BOOST_CHECK_EQUAL(progress.passes, 0);
+
+    dbw.SetCompactionDeferred(false);
+    while ((progress = dbw.GetCompactionProgress()).passes == 0) {
+        UninterruptibleSleep(10ms);
+    }
+    BOOST_CHECK(!progress.running);
+    BOOST_CHECK_GT(progress.pass_bytes, 0U);
+    BOOST_CHECK_GT(progress.compacted_bytes, 0U);
+
+    // No table is left in level 0, and the data is unchanged.
+    const auto levels{dbw.GetLevelStats()};
+    BOOST_CHECK(!levels.empty());
+    for (const DBLevelStats& level : levels) {
+        if (level.level == 0) BOOST_CHECK_EQUAL(level.files, 0);
+    }
+    std::unique_ptr<CDBIterator> it{dbw.NewIterator()};
+    uint32_t count{0};
+    for (it->Seek(uint8_t{'k'}); it->Valid(); it->Next()) ++count;
+    BOOST_CHECK_EQUAL(count, ENTRIES);
+}
+
 // Test that we do not obfuscation if there is existing data.
 BOOST_AUTO_TEST_CASE(existing_data_no_obfuscate)
 {
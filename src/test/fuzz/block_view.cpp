@@ -0,0 +1,135 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block.h>
+#include <primitives/block_view.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <streams.h>
+#include <test/fuzz/fuzz.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <ios>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace {
+bool SpanEqual(std::span<const std::byte> a, std::span<const std::byte> b)
+{
+    return std::ranges::equal(a, b);
+}
+
+bool SpanEqual(std::span<const std::byte> a, std::span<const unsigned char> b)
+{
+    return SpanEqual(a, std::as_bytes(b));
+}
+
+template <typename T>
+std::vector<std::byte> SerializeWithWitness(const T& obj)
+{
+    DataStream ss;
+    ss << TX_WITH_WITNESS(obj);
+    return {ss.begin(), ss.end()};
+}
+} // namespace
+
+//! Compare BlockView against reading the header and transactions with the
+//! regular deserialization code, one transaction at a time, which does not
+//! go through BlockView.
+FUZZ_TARGET(block_view)
+{
+    CBlockHeader header;
+    std::vector<CMutableTransaction> txs;
+    size_t size{0};
+    bool valid{true};
+    try {
+        SpanReader reader{buffer};
+        reader >> header >> TX_WITH_WITNESS(txs);
+        size = buffer.size() - reader.size();
+    } catch (const std::ios_base::failure&) {
+        valid = false;
+    }
+
+    std::optional<BlockView> view;
+    try {
+        view.emplace(std::as_bytes(buffer));
+    } catch (const std::ios_base::failure&) {
+    }
+    // A CBlock read from memory is parsed with a BlockView first.
+    CBlock block;
+    bool block_valid{true};
+    SpanReader block_reader{buffer};
+    try {
+        block_reader >> TX_WITH_WITNESS(block);
+    } catch (const std::ios_base::failure&) {
+        block_valid = false;
+    }
+    assert(view.has_value() == valid);
+    assert(block_valid == valid);
+    if (!valid) return;
+
+    assert(view->Serialized().size() == size);
+    assert(block_reader.size() == buffer.size() - size);
+    assert(view->GetHash() == header.GetHash());
+    assert(block.GetHash() == header.GetHash());
+    assert(view->TxCount() == txs.size());
+    assert(block.vtx.size() == txs.size());
+
+    const std::vector<Txid> txids{view->ComputeTxids()};
+    const std::vector<CTransactionRef> view_txs{view->ToTransactions()};
+    assert(txids.size() == txs.size() && view_txs.size() == txs.size());
+    size_t offset{size};
+    for (size_t i{txs.size()}; i-- > 0;) {
+        const CTransaction tx{txs[i]};
+        const TxView tx_view{view->Tx(i)};
+
+        // Transaction boundaries and the round trip of the serialization.
+        const std::vector<std::byte> ser{SerializeWithWitness(tx)};
+        assert(SpanEqual(tx_view.Serialized(), ser));
+        assert(tx_view.Offset() + ser.size() == offset);
+        offset = tx_view.Offset();
+        assert(tx_view.StrippedSize() == GetSerializeSize(TX_NO_WITNESS(tx)));
+
+        // Hashes, both computed by the view and taken from it.
+        assert(tx_view.ComputeHash() == tx.GetHash());
+        assert(tx_view.ComputeWitnessHash() == tx.GetWitnessHash());
+        assert(txids[i] == tx.GetHash());
+        for (const CTransactionRef& other : {view_txs[i], block.vtx[i]}) {
+            assert(other->GetHash() == tx.GetHash());
+            assert(other->GetWitnessHash() == tx.GetWitnessHash());
+            assert(SerializeWithWitness(*other) == ser);
+        }
+
+        // Fields.
+        assert(tx_view.version() == tx.version);
+        assert(tx_view.nLockTime() == tx.nLockTime);
+        assert(tx_view.HasWitness() == tx.HasWitness());
+        assert(tx_view.InputCount() == tx.vin.size());
+        for (size_t j{0}; j < tx.vin.size(); ++j) {
+            const TxInView in{tx_view.Input(j)};
+            assert(in.prevout() == tx.vin[j].prevout);
+            assert(SpanEqual(in.scriptSig(), tx.vin[j].scriptSig));
+            assert(in.nSequence() == tx.vin[j].nSequence);
+            const auto stack{in.WitnessStack()};
+            assert(stack.size() == tx.vin[j].scriptWitness.stack.size());
+            for (size_t k{0}; k < stack.size(); ++k) {
+                assert(SpanEqual(stack[k], tx.vin[j].scriptWitness.stack[k]));
+            }
+        }
+        assert(tx_view.OutputCount() == tx.vout.size());
+        for (size_t j{0}; j < tx.vout.size(); ++j) {
+            const TxOutView out{tx_view.Output(j)};
+            assert(out.nValue() == tx.vout[j].nValue);
+            assert(SpanEqual(out.scriptPubKey(), tx.vout[j].scriptPubKey));
+        }
+    }
+    assert(offset == 80 + GetSizeOfCompactSize(txs.size()));
+
+    // The whole block, with and without witnesses.
+    assert(SpanEqual(view->Serialized(), SerializeWithWitness(block)));
+    assert(view->StrippedSize() == GetSerializeSize(TX_NO_WITNESS(block)));
+}
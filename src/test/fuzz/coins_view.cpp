@@ -122,6 +122,10 @@ void TestCoinsView(FuzzedDataProvider& fuzzed_data_provider, CCoinsViewCache& co
             [&] {
                 coins_view_cache.Sync();
             },
+            [&] {
+                coins_view_cache.Sync();
+                assert(coins_view_cache.Trim(fuzzed_data_provider.ConsumeIntegralInRange<size_t>(0, coins_view_cache.DynamicMemoryUsage())));
+            },
             [&] {
                 uint256 best_block{ConsumeUInt256(fuzzed_data_provider)};
                 // Set best block hash to non-null to satisfy the assertion in CCoinsViewDB::BatchWrite().
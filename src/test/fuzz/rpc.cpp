@@ -95,6 +95,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "clearbanned",
     "combinepsbt",
     "combinerawtransaction",
+    "compactchainstate",
     "converttopsbt",
     "createmultisig",
     "createpsbt",
@@ -153,6 +154,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getrawmempool",
     "getrawtransaction",
     "getrpcinfo",
+    "getscripthistory",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
@@ -0,0 +1,46 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <headerchecker.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <test/util/setup_common.h>
+#include <util/chaintype.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(headerchecker_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(check_headers)
+{
+    const auto chain_params{CreateChainParams(*m_node.args, ChainType::REGTEST)};
+    const auto& consensus{chain_params->GetConsensus()};
+
+    // Every third header claims more work than it has.
+    std::vector<CBlockHeader> headers;
+    CBlockHeader header{chain_params->GenesisBlock()};
+    for (int i{0}; i < 100; ++i) {
+        header.hashPrevBlock = header.GetHash();
+        header.nBits = i % 3 == 0 ? 0x1d00ffff : chain_params->GenesisBlock().nBits;
+        header.nNonce = 0;
+        while (i % 3 != 0 && !CheckProofOfWork(header.GetHash(), header.nBits, consensus)) ++header.nNonce;
+        headers.push_back(header);
+    }
+
+    for (const int worker_threads : {0, 3}) {
+        HeaderChecker checker{/*batch_size=*/8, worker_threads};
+        const auto checked{checker.CheckHeaders(headers, consensus)};
+        BOOST_REQUIRE_EQUAL(checked.size(), headers.size());
+        for (size_t i{0}; i < headers.size(); ++i) {
+            BOOST_CHECK(checked[i].hash == headers[i].GetHash());
+            BOOST_CHECK_EQUAL(checked[i].pow_valid, i % 3 != 0);
+        }
+        BOOST_CHECK(checker.CheckHeaders({}, consensus).empty());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
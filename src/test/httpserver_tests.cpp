@@ -2,12 +2,87 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <httpserver.h>
+#include <netbase.h>
+#include <rpc/protocol.h>
+#include <serialize.h>
 #include <test/util/common.h>
 #include <test/util/setup_common.h>
+#include <util/signalinterrupt.h>
+#include <util/sock.h>
+#include <util/threadinterrupt.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+using http_bitcoin::HTTPRequestMessage;
+using http_bitcoin::ParseRequest;
+using http_bitcoin::ParseResult;
+
+namespace {
+ParseResult Parse(std::string_view data, HTTPRequestMessage& msg, size_t& consumed, size_t max_headers_size = 8192, size_t max_body_size = MAX_SIZE)
+{
+    return ParseRequest(std::as_bytes(std::span{data}), msg, consumed, max_headers_size, max_body_size);
+}
+
+/** Read n responses with a Content-Length header from sock. */
+std::vector<std::string> ReadResponses(const Sock& sock, size_t n)
+{
+    std::vector<std::string> responses;
+    std::string buffer;
+    while (responses.size() < n) {
+        const size_t header_end{buffer.find("\r\n\r\n")};
+        if (header_end != std::string::npos) {
+            const size_t length_pos{buffer.find("Content-Length: ")};
+            BOOST_REQUIRE(length_pos < header_end);
+            const size_t length{std::stoul(buffer.substr(length_pos + 16))};
+            if (buffer.size() >= header_end + 4 + length) {
+                responses.push_back(buffer.substr(0, header_end + 4 + length));
+                buffer.erase(0, header_end + 4 + length);
+                continue;
+            }
+        }
+        Sock::Event occurred;
+        BOOST_REQUIRE(sock.Wait(10s, Sock::RECV, &occurred) && occurred);
+        char buf[4096];
+        const ssize_t received{sock.Recv(buf, sizeof(buf), 0)};
+        BOOST_REQUIRE(received > 0);
+        buffer.append(buf, received);
+    }
+    BOOST_CHECK(buffer.empty());
+    return responses;
+}
+
+/** Connect to the IPv4 address the HTTP server listens on. */
+std::unique_ptr<Sock> ConnectToHTTPServer()
+{
+    std::optional<CService> server_addr;
+    for (const auto& addr : GetHTTPBindAddresses()) {
+        if (addr.IsIPv4()) server_addr = addr;
+    }
+    BOOST_REQUIRE(server_addr);
+    struct sockaddr_storage sockaddr;
+    socklen_t len = sizeof(sockaddr);
+    BOOST_REQUIRE(server_addr->GetSockAddr(reinterpret_cast<struct sockaddr*>(&sockaddr), &len));
+    auto sock{CreateSock(AF_INET, SOCK_STREAM, IPPROTO_TCP)};
+    BOOST_REQUIRE(sock);
+    if (sock->Connect(reinterpret_cast<struct sockaddr*>(&sockaddr), len) != 0) {
+        Sock::Event occurred;
+        BOOST_REQUIRE(sock->Wait(10s, Sock::SEND, &occurred) && occurred == Sock::SEND);
+    }
+    return sock;
+}
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(httpserver_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(test_query_parameters)
@@ -40,4 +115,152 @@ BOOST_AUTO_TEST_CASE(test_query_parameters)
     uri = "/rest/endpoint/someresource.json&p1=v1&p2=v2%";
     BOOST_CHECK_EXCEPTION(GetQueryParameterFromUri(uri.c_str(), "p1"), std::runtime_error, HasReason("URI parsing failed, it likely contained RFC 3986 invalid characters"));
 }
+BOOST_AUTO_TEST_CASE(parse_request)
+{
+    HTTPRequestMessage msg;
+    size_t consumed{0};
+
+    const std::string get{"GET /rest/chaininfo.json HTTP/1.1\r\nHost: localhost\r\nX-Custom:  value \r\n\r\n"};
+    BOOST_CHECK(Parse(get, msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(consumed, get.size());
+    BOOST_CHECK_EQUAL(msg.method, "GET");
+    BOOST_CHECK_EQUAL(msg.target, "/rest/chaininfo.json");
+    BOOST_CHECK_EQUAL(msg.version_minor, 1);
+    BOOST_CHECK_EQUAL(msg.FindHeader("x-custom").value(), "value");
+    BOOST_CHECK(!msg.FindHeader("Content-Length"));
+    BOOST_CHECK(msg.body.empty());
+    BOOST_CHECK(msg.KeepAlive());
+
+    // Every prefix of a request is incomplete
+    for (size_t i{0}; i < get.size(); ++i) {
+        BOOST_CHECK(Parse(get.substr(0, i), msg, consumed) == ParseResult::INCOMPLETE);
+    }
+
+    // Pipelined requests are parsed one at a time, with bare LF line endings accepted
+    const std::string post{"POST / HTTP/1.0\nContent-Length: 4\nConnection: keep-alive\n\nbody"};
+    const std::string pipelined{post + get};
+    BOOST_CHECK(Parse(pipelined, msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(consumed, post.size());
+    BOOST_CHECK_EQUAL(msg.method, "POST");
+    BOOST_CHECK_EQUAL(msg.version_minor, 0);
+    BOOST_CHECK_EQUAL(msg.body, "body");
+    BOOST_CHECK(msg.KeepAlive());
+    BOOST_CHECK(Parse(std::string_view{pipelined}.substr(consumed), msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(msg.method, "GET");
+
+    BOOST_CHECK(Parse("GET / HTTP/1.0\r\n\r\n", msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK(!msg.KeepAlive());
+    BOOST_CHECK(Parse("GET / HTTP/1.1\r\nConnection: Close\r\n\r\n", msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK(!msg.KeepAlive());
+
+    // Chunked transfer coding
+    const std::string chunked{"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n4;ext=1\r\nabcd\r\nA\r\n0123456789\r\n0\r\nTrailer: x\r\n\r\n"};
+    for (size_t i{0}; i < chunked.size(); ++i) {
+        BOOST_CHECK(Parse(chunked.substr(0, i), msg, consumed) == ParseResult::INCOMPLETE);
+    }
+    BOOST_CHECK(Parse(chunked, msg, consumed) == ParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(consumed, chunked.size());
+    BOOST_CHECK_EQUAL(msg.body, "abcd0123456789");
+
+    // A request received in parts is parsed from where parsing stopped, and
+    // chunks that were parsed already are not parsed again.
+    http_bitcoin::ParseState state;
+    const size_t first_chunk_end{chunked.find("A\r\n")};
+    for (size_t i{0}; i < chunked.size(); ++i) {
+        BOOST_CHECK(ParseRequest(std::as_bytes(std::span{chunked}.first(i)), msg, consumed, 8192, MAX_SIZE, state) == ParseResult::INCOMPLETE);
+        if (i >= first_chunk_end) BOOST_CHECK_GE(state.pos, first_chunk_end);
+    }
+    BOOST_CHECK(ParseRequest(std::as_bytes(std::span{chunked}), msg, consumed, 8192, MAX_SIZE, state) == ParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(consumed, chunked.size());
+    BOOST_CHECK_EQUAL(msg.body, "abcd0123456789");
+    BOOST_CHECK(!state.head);
+    BOOST_CHECK_EQUAL(state.pos, 0U);
+
+    // Malformed requests
+    BOOST_CHECK(Parse("GET /\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("GET / HTTP/2.0\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("GET / HTTP/1.1\r\nNoColon\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("GET / HTTP/1.1\r\nBad Name: x\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("GET / HTTP/1.1\r\nA: x\r\n folded\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 1\r\n\r\n", msg, consumed) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", msg, consumed) == ParseResult::UNSUPPORTED);
+
+    // Size limits
+    const std::string long_uri{"GET /" + std::string(100, 'x') + " HTTP/1.1\r\n\r\n"};
+    BOOST_CHECK(Parse(long_uri, msg, consumed, /*max_headers_size=*/long_uri.size()) == ParseResult::COMPLETE);
+    BOOST_CHECK(Parse(long_uri, msg, consumed, /*max_headers_size=*/50) == ParseResult::INVALID);
+    BOOST_CHECK(Parse(long_uri.substr(0, 60), msg, consumed, /*max_headers_size=*/50) == ParseResult::INVALID);
+    BOOST_CHECK(Parse("POST / HTTP/1.1\r\nContent-Length: 11\r\n\r\n", msg, consumed, 8192, /*max_body_size=*/10) == ParseResult::TOO_LARGE);
+    BOOST_CHECK(Parse(chunked, msg, consumed, 8192, /*max_body_size=*/10) == ParseResult::TOO_LARGE);
+    // An incomplete chunk line is bounded like the headers.
+    const std::string chunked_head{"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"};
+    BOOST_CHECK(Parse(chunked_head + std::string(40, '1'), msg, consumed, /*max_headers_size=*/50) == ParseResult::INCOMPLETE);
+    BOOST_CHECK(Parse(chunked_head + std::string(60, '1'), msg, consumed, /*max_headers_size=*/50) == ParseResult::INVALID);
+}
+
+BOOST_AUTO_TEST_CASE(format_response_header)
+{
+    const auto to_string{[](const std::vector<std::byte>& bytes) { return std::string{reinterpret_cast<const char*>(bytes.data()), bytes.size()}; }};
+    BOOST_CHECK_EQUAL(to_string(http_bitcoin::FormatResponseHeader(1, HTTP_OK, {{"Content-Type", "application/json"}}, 42, /*keep_alive=*/true)),
+                      "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 42\r\n\r\n");
+    BOOST_CHECK_EQUAL(to_string(http_bitcoin::FormatResponseHeader(1, HTTP_NOT_FOUND, {{"Connection", "close"}}, 0, /*keep_alive=*/false)),
+                      "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    BOOST_CHECK_EQUAL(to_string(http_bitcoin::FormatResponseHeader(0, HTTP_OK, {}, 1, /*keep_alive=*/true)),
+                      "HTTP/1.0 200 OK\r\nContent-Length: 1\r\nConnection: keep-alive\r\n\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(native_server_pipelining)
+{
+    gArgs.ForceSetArg("-rpcserverbackend", "native");
+    gArgs.ForceSetArg("-rpcport", "0");
+    util::SignalInterrupt interrupt;
+    BOOST_REQUIRE(InitHTTPServer(interrupt));
+    RegisterHTTPHandler("/echo/", false, [](HTTPRequest* req, const std::string& path) {
+        const std::string body{req->ReadBody()};
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, path + ":" + body);
+        return true;
+    });
+    StartHTTPServer();
+
+    auto sock{ConnectToHTTPServer()};
+
+    // Replies to pipelined requests arrive in request order
+    const std::string requests{
+        "POST /echo/a HTTP/1.1\r\nContent-Length: 3\r\n\r\none"
+        "GET /missing HTTP/1.1\r\n\r\n"
+        "POST /echo/b HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\ntwo\r\n0\r\n\r\n"
+        "GET /echo/c HTTP/1.1\r\nConnection: close\r\n\r\n"};
+    CThreadInterrupt sock_interrupt;
+    sock->SendComplete(std::span{requests}, 10s, sock_interrupt);
+    const auto responses{ReadResponses(*sock, 4)};
+    BOOST_CHECK_EQUAL(responses[0], "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\na:one");
+    BOOST_CHECK(responses[1].starts_with("HTTP/1.1 404 Not Found\r\n"));
+    BOOST_CHECK(responses[2].ends_with("\r\n\r\nb:two"));
+    BOOST_CHECK_EQUAL(responses[3], "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\nConnection: close\r\n\r\nc:");
+
+    // The server closes the connection after the reply to the last request
+    Sock::Event occurred;
+    BOOST_REQUIRE(sock->Wait(10s, Sock::RECV, &occurred) && occurred);
+    char buf[1];
+    BOOST_CHECK_EQUAL(sock->Recv(buf, sizeof(buf), 0), 0);
+
+    // Only requests with credentials may have large bodies
+    const std::string large_body(100'000, 'x');
+    sock = ConnectToHTTPServer();
+    const std::string authenticated{"POST /echo/d HTTP/1.1\r\nAuthorization: Basic dGVzdDp0ZXN0\r\nContent-Length: 100000\r\n\r\n" + large_body};
+    sock->SendComplete(std::span{authenticated}, 10s, sock_interrupt);
+    BOOST_CHECK(ReadResponses(*sock, 1)[0].ends_with("\r\n\r\nd:" + large_body));
+    sock = ConnectToHTTPServer();
+    const std::string unauthenticated{"POST /echo/e HTTP/1.1\r\nContent-Length: 100000\r\n\r\n"};
+    sock->SendComplete(std::span{unauthenticated}, 10s, sock_interrupt);
+    BOOST_CHECK(ReadResponses(*sock, 1)[0].starts_with("HTTP/1.1 413 Payload Too Large\r\n"));
+
+    InterruptHTTPServer();
+    StopHTTPServer();
+    UnregisterHTTPHandler("/echo/", false);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coins.h>
+#include <inputfetcher.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <primitives/transaction_identifier.h>
+#include <txdb.h>
+#include <uint256.h>
+#include <util/byte_units.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ranges>
+
+BOOST_AUTO_TEST_SUITE(inputfetcher_tests)
+
+namespace {
+
+constexpr auto NUM_TXS{100};
+
+//! Every transaction spends one external prevout and, except for the first
+//! one, an output of the preceding transaction in the block.
+CBlock CreateBlock() noexcept
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.emplace_back();
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    for (const auto i : std::views::iota(1, NUM_TXS)) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(Txid::FromUint256(uint256(i)), 0);
+        if (i > 1) tx.vin.emplace_back(block.vtx.back()->GetHash(), 0);
+        tx.vout.emplace_back(1, CScript{});
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+
+    return block;
+}
+
+void PopulateView(const CBlock& block, CCoinsView& view)
+{
+    CCoinsViewCache cache{&view};
+    cache.SetBestBlock(uint256::ONE);
+
+    for (const auto& tx : block.vtx | std::views::drop(1)) {
+        Coin coin{};
+        coin.out.nValue = 1;
+        cache.EmplaceCoinInternalDANGER(COutPoint{tx->vin[0].prevout}, std::move(coin));
+    }
+
+    cache.Flush();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fetch_external_inputs)
+{
+    const auto block{CreateBlock()};
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1_MiB, .memory_only = true}, {}};
+    PopulateView(block, db);
+    CCoinsViewCache main_cache{&db};
+    CoinsViewOverlay view{&main_cache};
+
+    InputFetcher fetcher{/*batch_size=*/4, /*worker_threads_num=*/2};
+    fetcher.FetchInputs(view, main_cache, block);
+
+    for (const auto& tx : block.vtx | std::views::drop(1)) {
+        BOOST_CHECK(view.HaveCoinInCache(tx->vin[0].prevout));
+        BOOST_CHECK(!main_cache.HaveCoinInCache(tx->vin[0].prevout));
+        // Outputs created within the block are never looked up
+        for (const auto& in : tx->vin | std::views::drop(1)) {
+            BOOST_CHECK(!view.HaveCoinInCache(in.prevout));
+        }
+    }
+    BOOST_CHECK_EQUAL(view.GetCacheSize(), NUM_TXS - 1);
+    BOOST_CHECK_EQUAL(view.GetDirtyCount(), 0U);
+    BOOST_CHECK_EQUAL(main_cache.GetCacheSize(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_prefers_cached_coins)
+{
+    const auto block{CreateBlock()};
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1_MiB, .memory_only = true}, {}};
+    PopulateView(block, db);
+    CCoinsViewCache main_cache{&db};
+    CoinsViewOverlay view{&main_cache};
+
+    // A coin that is already present in the overlay is not replaced
+    const auto& outpoint{block.vtx[1]->vin[0].prevout};
+    BOOST_CHECK(view.SpendCoin(outpoint));
+
+    InputFetcher fetcher{/*batch_size=*/4, /*worker_threads_num=*/2};
+    fetcher.FetchInputs(view, main_cache, block);
+
+    BOOST_CHECK(!view.HaveCoin(outpoint));
+    BOOST_CHECK(view.HaveCoinInCache(block.vtx[2]->vin[0].prevout));
+}
+
+BOOST_AUTO_TEST_CASE(fetch_missing_inputs)
+{
+    const auto block{CreateBlock()};
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1_MiB, .memory_only = true}, {}};
+    CCoinsViewCache main_cache{&db};
+    CoinsViewOverlay view{&main_cache};
+
+    InputFetcher fetcher{/*batch_size=*/4, /*worker_threads_num=*/2};
+    fetcher.FetchInputs(view, main_cache, block);
+
+    BOOST_CHECK_EQUAL(view.GetCacheSize(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_without_threads)
+{
+    const auto block{CreateBlock()};
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1_MiB, .memory_only = true}, {}};
+    PopulateView(block, db);
+    CCoinsViewCache main_cache{&db};
+    CoinsViewOverlay view{&main_cache};
+
+    InputFetcher fetcher{/*batch_size=*/4, /*worker_threads_num=*/0};
+    BOOST_CHECK(!fetcher.HasThreads());
+    fetcher.FetchInputs(view, main_cache, block);
+
+    BOOST_CHECK_EQUAL(view.GetCacheSize(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,7 @@
 
 #include <test/kernel/block_data.h>
 
+#include <algorithm>
 #include <charconv>
 #include <cstdint>
 #include <cstdlib>
@@ -705,6 +706,36 @@ BOOST_AUTO_TEST_CASE(btck_block)
     BOOST_CHECK_THROW(Block{empty_data}, std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(btck_block_view)
+{
+    const auto raw_block{hex_string_to_byte_vec(REGTEST_BLOCK_DATA[205])};
+    Block block{raw_block};
+    BlockView block_view{raw_block};
+    BOOST_CHECK(block_view.GetHash() == block.GetHash());
+    BOOST_CHECK(block_view.GetHeader().Hash() == block.GetHeader().Hash());
+    BOOST_REQUIRE_EQUAL(block_view.CountTransactions(), block.CountTransactions());
+    for (size_t i{0}; i < block.CountTransactions(); ++i) {
+        const TransactionView tx{block.GetTransaction(i)};
+        BOOST_CHECK(block_view.GetTxid(i) == Txid{tx.Txid()});
+        check_equal(block_view.GetTransaction(i).ToBytes(), tx.ToBytes());
+        BOOST_REQUIRE_EQUAL(block_view.CountInputs(i), tx.CountInputs());
+        for (size_t j{0}; j < tx.CountInputs(); ++j) {
+            const OutPoint out_point{block_view.GetInputOutPoint(i, j)};
+            BOOST_CHECK(out_point.Txid() == tx.GetInput(j).OutPoint().Txid());
+            BOOST_CHECK_EQUAL(out_point.index(), tx.GetInput(j).OutPoint().index());
+        }
+        BOOST_REQUIRE_EQUAL(block_view.CountOutputs(i), tx.CountOutputs());
+        for (size_t j{0}; j < tx.CountOutputs(); ++j) {
+            BOOST_CHECK_EQUAL(block_view.GetOutputAmount(i, j), tx.GetOutput(j).Amount());
+            check_equal(block_view.GetOutputScriptPubkey(i, j), tx.GetOutput(j).GetScriptPubkey().ToBytes());
+        }
+    }
+    auto invalid_data = hex_string_to_byte_vec("012300");
+    BOOST_CHECK_THROW(BlockView{invalid_data}, std::runtime_error);
+    auto empty_data = hex_string_to_byte_vec("");
+    BOOST_CHECK_THROW(BlockView{empty_data}, std::runtime_error);
+}
+
 Context create_context(std::shared_ptr<TestKernelNotifications> notifications, ChainType chain_type, std::shared_ptr<TestValidationInterface> validation_interface = nullptr)
 {
     ContextOptions options{};
@@ -999,6 +1030,40 @@ BOOST_AUTO_TEST_CASE(btck_chainman_in_memory_tests)
     BOOST_CHECK(context.interrupt());
 }
 
+BOOST_AUTO_TEST_CASE(btck_chainman_process_blocks_tests)
+{
+    auto test_directory{TestDirectory{"process_blocks_test_bitcoin_kernel"}};
+    auto notifications{std::make_shared<TestKernelNotifications>()};
+    auto context{create_context(notifications, ChainType::REGTEST)};
+    auto chainman{create_chainman(
+        test_directory, /*reindex=*/false, /*wipe_chainstate=*/false,
+        /*block_tree_db_in_memory=*/true, /*chainstate_db_in_memory=*/true, context)};
+
+    std::vector<std::vector<std::byte>> raw_blocks;
+    for (auto& raw_block : REGTEST_BLOCK_DATA) {
+        raw_blocks.push_back(hex_string_to_byte_vec(raw_block));
+    }
+    const std::vector<std::span<const std::byte>> blocks(raw_blocks.begin(), raw_blocks.end());
+
+    std::vector<bool> new_blocks;
+    BOOST_CHECK(chainman->ProcessBlocks(blocks, &new_blocks));
+    BOOST_CHECK_EQUAL(new_blocks.size(), blocks.size());
+    BOOST_CHECK(std::ranges::all_of(new_blocks, [](bool new_block) { return new_block; }));
+    BOOST_CHECK_EQUAL(chainman->GetChain().Height(), int(blocks.size()));
+
+    // Processing the blocks again only finds duplicates
+    BOOST_CHECK(chainman->ProcessBlocks(blocks, &new_blocks));
+    BOOST_CHECK(std::ranges::none_of(new_blocks, [](bool new_block) { return new_block; }));
+
+    // A block that cannot be deserialized fails the batch, but not the other blocks in it
+    const std::vector<std::byte> garbage(10, std::byte{0xff});
+    const std::vector<std::span<const std::byte>> bad_blocks{blocks.front(), garbage};
+    BOOST_CHECK(!chainman->ProcessBlocks(bad_blocks, &new_blocks));
+    BOOST_CHECK_EQUAL(new_blocks.size(), 2U);
+    BOOST_CHECK(!new_blocks[0] && !new_blocks[1]);
+    BOOST_CHECK_EQUAL(chainman->GetChain().Height(), int(blocks.size()));
+}
+
 BOOST_AUTO_TEST_CASE(btck_chainman_regtest_tests)
 {
     auto test_directory{TestDirectory{"regtest_test_bitcoin_kernel"}};
@@ -1062,6 +1127,10 @@ BOOST_AUTO_TEST_CASE(btck_chainman_regtest_tests)
     auto read_block_2 = chainman->ReadBlock(tip_2).value();
     check_equal(read_block_2.ToBytes(), hex_string_to_byte_vec(REGTEST_BLOCK_DATA[REGTEST_BLOCK_DATA.size() - 2]));
 
+    auto read_block_view = chainman->ReadBlockView(tip).value();
+    BOOST_CHECK(read_block_view.GetHash() == read_block.GetHash());
+    BOOST_CHECK_EQUAL(read_block_view.CountTransactions(), read_block.CountTransactions());
+
     Txid txid = read_block.Transactions()[0].Txid();
     Txid txid_2 = read_block_2.Transactions()[0].Txid();
     BOOST_CHECK(txid != txid_2);
@@ -1171,6 +1240,46 @@ BOOST_AUTO_TEST_CASE(btck_chainman_regtest_tests)
     }
     BOOST_CHECK_EQUAL(count, chain.CountEntries());
 
+    // Look up coins created and spent by the tip block
+    const TransactionView tip_coinbase{read_block.Transactions()[0]};
+    const OutPoint unspent{tip_coinbase.Txid(), 0};
+    const OutPoint spent{read_block.Transactions()[1].GetInput(0).OutPoint()};
+    const OutPoint nonexistent{tip_coinbase.Txid(), 1000};
+    std::optional<Coin> unspent_coin{chainman->GetCoin(unspent)};
+    BOOST_REQUIRE(unspent_coin);
+    BOOST_CHECK(unspent_coin->IsCoinbase());
+    BOOST_CHECK_EQUAL(unspent_coin->GetConfirmationHeight(), tip.GetHeight());
+    check_equal(unspent_coin->GetOutput().GetScriptPubkey().ToBytes(), tip_coinbase.GetOutput(0).GetScriptPubkey().ToBytes());
+    BOOST_CHECK(!chainman->GetCoin(spent));
+    BOOST_CHECK(!chainman->GetCoin(nonexistent));
+
+    const std::vector<OutPoint> out_points{spent, unspent, nonexistent};
+    auto coins{chainman->GetCoins(out_points)};
+    BOOST_REQUIRE_EQUAL(coins.size(), 3);
+    BOOST_CHECK(!coins[0]);
+    BOOST_REQUIRE(coins[1]);
+    BOOST_CHECK_EQUAL(coins[1]->GetOutput().Amount(), unspent_coin->GetOutput().Amount());
+    BOOST_CHECK(!coins[2]);
+
+    // Iterate over the UTXO set in chunks
+    CoinsCursor cursor{chainman->CreateCoinsCursor()};
+    BOOST_CHECK(cursor.GetBlockTreeEntry() == tip);
+    size_t utxo_count{0};
+    bool found_unspent{false};
+    for (auto chunk{cursor.Next(7)}; !chunk.empty(); chunk = cursor.Next(7)) {
+        BOOST_CHECK_LE(chunk.size(), 7);
+        for (const auto& [out_point, coin] : chunk) {
+            BOOST_CHECK(!(out_point.Txid() == spent.Txid() && out_point.index() == spent.index()));
+            if (out_point.Txid() == unspent.Txid() && out_point.index() == unspent.index()) {
+                BOOST_CHECK_EQUAL(coin.GetConfirmationHeight(), tip.GetHeight());
+                found_unspent = true;
+            }
+            ++utxo_count;
+        }
+    }
+    BOOST_CHECK(found_unspent);
+    BOOST_CHECK_GT(utxo_count, 7);
+    BOOST_CHECK(cursor.Next(7).empty());
 
     std::filesystem::remove_all(test_directory.m_directory / "blocks" / "blk00000.dat");
     BOOST_CHECK(!chainman->ReadBlock(tip_2).has_value());
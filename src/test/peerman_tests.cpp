@@ -3,12 +3,23 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
 #include <chainparams.h>
-#include <node/miner.h>
+#include <logging.h>
+#include <net.h>
 #include <net_processing.h>
+#include <netmessagemaker.h>
+#include <node/miner.h>
 #include <pow.h>
+#include <protocol.h>
+#include <test/util/net.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(peerman_tests, RegTestingSetup)
@@ -75,4 +86,76 @@ BOOST_AUTO_TEST_CASE(connections_desirable_service_flags)
     BOOST_CHECK(peerman->GetDesirableServiceFlags(peer_flags) == ServiceFlags(NODE_NETWORK | NODE_WITNESS));
 }
 
+// A peer disconnected while a block serving thread sends a block to it is only
+// finalized and deleted once that thread is done with it.
+BOOST_FIXTURE_TEST_CASE(block_serving_disconnect, TestChain100Setup)
+{
+    auto& connman{static_cast<ConnmanTestMsg&>(*m_node.connman)};
+    auto& peerman{*m_node.peerman};
+
+    const NodeId id{0};
+    CNode* node{new CNode{id,
+                          /*sock=*/nullptr,
+                          CAddress{CService{CNetAddr{in_addr{htonl(0x0a000001)}}, 8333}, NODE_NONE},
+                          /*nKeyedNetGroupIn=*/0,
+                          /*nLocalHostNonceIn=*/0,
+                          CAddress{},
+                          /*addrNameIn=*/"",
+                          ConnectionType::OUTBOUND_FULL_RELAY,
+                          /*inbound_onion=*/false,
+                          /*network_key=*/0}};
+    // The reference CConnman holds to each of its nodes.
+    node->AddRef();
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        connman.Handshake(
+            /*node=*/*node,
+            /*successfully_connected=*/true,
+            /*remote_services=*/ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+            /*local_services=*/ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+            /*version=*/PROTOCOL_VERSION,
+            /*relay_txs=*/true);
+    }
+    connman.AddTestNode(*node);
+    connman.FlushSendBuffer(*node);
+    node->fPauseSend = false;
+
+    // Request an old block, which is read from disk on a block serving thread.
+    const uint256 block_hash{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain()[1]->GetBlockHash())};
+    BOOST_REQUIRE(connman.ReceiveMsgFrom(*node, NetMsg::Make(NetMsgType::GETDATA, std::vector<CInv>{CInv{MSG_WITNESS_BLOCK, block_hash}})));
+
+    std::promise<void> sending_block;
+    bool sending_block_set{false};
+    const auto log_callback{LogInstance().PushBackCallback([&](const std::string& s) {
+        if (!sending_block_set && s.find("sending block (") != std::string::npos) {
+            sending_block_set = true;
+            sending_block.set_value();
+        }
+    })};
+
+    CNodeStateStats stats;
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        // Keep the block serving thread from sending the block until the node is disconnected.
+        LOCK(node->cs_vSend);
+        std::atomic<bool> interrupt{false};
+        BOOST_CHECK(!peerman.ProcessMessages(*node, interrupt));
+        BOOST_REQUIRE(sending_block.get_future().wait_for(std::chrono::seconds{10}) == std::future_status::ready);
+
+        node->fDisconnect = true;
+        connman.DisconnectNodesPublic();
+        BOOST_CHECK(connman.TestNodes().empty());
+        BOOST_CHECK(peerman.GetNodeStateStats(id, stats));
+    }
+
+    // The block serving thread releases the node once it has sent the block.
+    while (node->GetRefCount() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    connman.DisconnectNodesPublic();
+    BOOST_CHECK(!peerman.GetNodeStateStats(id, stats));
+
+    LogInstance().DeleteCallback(log_callback);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 #include <node/context.h>
 #include <rpc/blockchain.h>
 #include <rpc/client.h>
+#include <rpc/json_writer.h>
+#include <rpc/request.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <test/util/common.h>
@@ -643,4 +645,63 @@ BOOST_AUTO_TEST_CASE(rpc_arg_helper)
     CheckRpc(params, UniValue{JSON(R"([5, "hello", 4, "test", true, 1.23, "world"])")}, check_positional);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_json_writer)
+{
+    const UniValue value{JSON(R"({"a":[1,"x\"y",{},[]],"b":{"c":null,"d":[1.5]},"e\n":true})")};
+    std::string str;
+    JSONWriter writer{str};
+    writer.BeginObject();
+    writer.Key("a");
+    writer.BeginArray();
+    for (const UniValue& v : value["a"].getValues()) writer.Value(v);
+    writer.EndArray();
+    writer.Key("b");
+    writer.BeginObject();
+    writer.Members(value["b"]);
+    writer.EndObject();
+    writer.Key("e\n");
+    writer.Value(value["e\n"]);
+    writer.EndObject();
+    BOOST_CHECK_EQUAL(str, value.write());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_streamed_result)
+{
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+    const std::string tip_hash{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash().GetHex())};
+    const std::vector<std::pair<std::string, std::vector<std::string>>> calls{
+        {"getblock", {tip_hash, "1"}},
+        {"getblock", {tip_hash, "2"}},
+        {"getblock", {tip_hash, "3"}},
+        {"getrawmempool", {"true"}},
+    };
+    for (const auto& [method, args] : calls) {
+        JSONRPCRequest request;
+        request.context = &m_node;
+        request.strMethod = method;
+        request.params = RPCConvertValues(method, args);
+        const UniValue expected{tableRPC.execute(request)};
+
+        std::string result_json;
+        request.m_result_buffer = &result_json;
+        BOOST_CHECK(tableRPC.execute(request).isNull());
+        BOOST_CHECK_EQUAL(result_json, expected.write());
+
+        for (const auto version : {JSONRPCVersion::V1_LEGACY, JSONRPCVersion::V2}) {
+            BOOST_CHECK_EQUAL(JSONRPCReplyString(result_json, UniValue{1}, version),
+                              JSONRPCReplyObj(expected, NullUniValue, UniValue{1}, version).write());
+        }
+    }
+
+    // Methods that don't support streaming ignore the buffer
+    JSONRPCRequest request;
+    request.context = &m_node;
+    request.strMethod = "getblockcount";
+    request.params = UniValue{UniValue::VARR};
+    std::string result_json;
+    request.m_result_buffer = &result_json;
+    BOOST_CHECK_EQUAL(tableRPC.execute(request).getInt<int>(), 0);
+    BOOST_CHECK(result_json.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/scriptindex.h>
+#include <key.h>
+#include <script/script.h>
+#include <test/util/common.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(scriptindex_tests)
+
+BOOST_AUTO_TEST_CASE(scriptindex_position_hex)
+{
+    const ScriptHistoryPosition pos{.height = 840000, .tx_index = 3, .io = 1 | ScriptHistoryPosition::SPEND_FLAG};
+    BOOST_CHECK_EQUAL(pos.ToHex(), "000cd14000000003" "80000001");
+    const auto parsed{ScriptHistoryPosition::FromHex(pos.ToHex())};
+    BOOST_REQUIRE(parsed);
+    BOOST_CHECK_EQUAL(parsed->height, pos.height);
+    BOOST_CHECK_EQUAL(parsed->tx_index, pos.tx_index);
+    BOOST_CHECK_EQUAL(parsed->io, pos.io);
+
+    BOOST_CHECK(!ScriptHistoryPosition::FromHex(""));
+    BOOST_CHECK(!ScriptHistoryPosition::FromHex("000cd1400000000380000001ff"));
+    BOOST_CHECK(!ScriptHistoryPosition::FromHex("000cd1400000000380000g01"));
+    BOOST_CHECK(!ScriptHistoryPosition::FromHex("800cd1400000000380000001")); // negative height
+}
+
+BOOST_FIXTURE_TEST_CASE(scriptindex_initial_sync, TestChain100Setup)
+{
+    // Mine blocks for coinbase maturity, so we can spend some coinbase outputs in the test.
+    const CScript& coinbase_script = m_coinbase_txns[0]->vout[0].scriptPubKey;
+    for (int i = 0; i < 10; i++) CreateAndProcessBlock({}, coinbase_script);
+
+    // Spend the first output of two coinbase transactions to another script.
+    CKey key{GenerateRandomKey()};
+    const CScript dest_script{CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG};
+    std::vector<CMutableTransaction> spenders(2);
+    for (size_t i = 0; i < spenders.size(); i++) {
+        const auto& coinbase_tx{m_coinbase_txns[i]};
+        spenders[i].version = 1;
+        spenders[i].vin.resize(1);
+        spenders[i].vin[0].prevout = COutPoint(coinbase_tx->GetHash(), 0);
+        spenders[i].vout.resize(1);
+        spenders[i].vout[0].nValue = coinbase_tx->GetValueOut() - 1000;
+        spenders[i].vout[0].scriptPubKey = dest_script;
+
+        std::vector<unsigned char> vchSig;
+        const uint256 hash = SignatureHash(coinbase_script, spenders[i], 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_REQUIRE(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spenders[i].vin[0].scriptSig << vchSig;
+    }
+    const uint256 tip_hash = CreateAndProcessBlock(spenders, coinbase_script).GetHash();
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    const int tip_height{WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight())};
+
+    ScriptIndex scriptindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(scriptindex.Init());
+    std::optional<ScriptHistoryPosition> next;
+    BOOST_CHECK(scriptindex.FindHistory(dest_script, {}, 100, next).value().empty());
+
+    scriptindex.Sync();
+    BOOST_CHECK_EQUAL(scriptindex.GetSummary().best_block_hash, tip_hash);
+
+    // The new script received both outputs, which are unspent.
+    const auto dest_history{scriptindex.FindHistory(dest_script, {}, 100, next).value()};
+    BOOST_CHECK(!next);
+    BOOST_REQUIRE_EQUAL(dest_history.size(), spenders.size());
+    for (size_t i = 0; i < spenders.size(); i++) {
+        const auto& entry{dest_history[i]};
+        BOOST_CHECK(!entry.IsSpend());
+        BOOST_CHECK_EQUAL(entry.pos.height, tip_height);
+        BOOST_CHECK_EQUAL(entry.pos.tx_index, i + 1);
+        BOOST_CHECK_EQUAL(entry.Index(), 0U);
+        BOOST_CHECK_EQUAL(entry.txid, spenders[i].GetHash());
+        BOOST_CHECK_EQUAL(entry.amount, spenders[i].vout[0].nValue);
+        BOOST_CHECK(!entry.spent_by);
+    }
+
+    // The coinbase script received every coinbase output, and spent two of them in the last block.
+    const auto history{scriptindex.FindHistory(coinbase_script, {}, 1000, next).value()};
+    BOOST_CHECK(!next);
+    BOOST_REQUIRE_EQUAL(history.size(), size_t(tip_height) + spenders.size());
+    for (size_t i = 0; i < spenders.size(); i++) {
+        const auto& output{history[i]};
+        BOOST_CHECK_EQUAL(output.txid, m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(output.amount, m_coinbase_txns[i]->vout[0].nValue);
+        BOOST_REQUIRE(output.spent_by);
+        BOOST_CHECK_EQUAL(output.spent_by->first, spenders[i].GetHash());
+        BOOST_CHECK_EQUAL(output.spent_by->second, tip_height);
+    }
+    BOOST_CHECK(!history[spenders.size()].spent_by);
+    // In a block, the coinbase output comes first, then the inputs of the other transactions.
+    BOOST_CHECK(!history[tip_height - 1].IsSpend());
+    BOOST_CHECK_EQUAL(history[tip_height - 1].pos.height, tip_height);
+    for (size_t i = 0; i < spenders.size(); i++) {
+        const auto& spend{history[tip_height + i]};
+        BOOST_CHECK(spend.IsSpend());
+        BOOST_CHECK_EQUAL(spend.pos.height, tip_height);
+        BOOST_CHECK_EQUAL(spend.Index(), 0U);
+        BOOST_CHECK_EQUAL(spend.txid, spenders[i].GetHash());
+        BOOST_CHECK_EQUAL(spend.prevout.hash, m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(spend.amount, m_coinbase_txns[i]->vout[0].nValue);
+    }
+
+    // Paging through the history returns the same entries.
+    std::vector<ScriptHistoryEntry> paged;
+    ScriptHistoryPosition start;
+    for (;;) {
+        const auto page{scriptindex.FindHistory(coinbase_script, start, 7, next).value()};
+        BOOST_REQUIRE(page.size() == 7 || !next);
+        paged.insert(paged.end(), page.begin(), page.end());
+        if (!next) break;
+        start = *next;
+    }
+    BOOST_REQUIRE_EQUAL(paged.size(), history.size());
+    for (size_t i = 0; i < paged.size(); i++) {
+        BOOST_CHECK_EQUAL(paged[i].txid, history[i].txid);
+        BOOST_CHECK_EQUAL(paged[i].pos.io, history[i].pos.io);
+    }
+
+    // Shutdown sequence (c.f. Shutdown() in init.cpp)
+    scriptindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
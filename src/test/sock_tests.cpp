@@ -170,6 +170,69 @@ BOOST_AUTO_TEST_CASE(recv_until_terminator_limit)
     receiver.join();
 }
 
+#ifdef USE_EPOLL
+
+BOOST_AUTO_TEST_CASE(epoll_wait)
+{
+    int s[2];
+    CreateSocketPair(s);
+
+    const auto sock0{std::make_shared<const Sock>(s[0])};
+    const auto sock1{std::make_shared<const Sock>(s[1])};
+
+    auto epoll{SockEpoll::Create()};
+    BOOST_REQUIRE(epoll);
+
+    // Nothing to wait for.
+    Sock::EventsPerSock ready;
+    BOOST_CHECK(!epoll->Wait(0ms, ready));
+
+    // Idle socket times out.
+    BOOST_REQUIRE(epoll->Add(sock0, Sock::RECV));
+    BOOST_CHECK(!epoll->Add(sock0, Sock::RECV));
+    BOOST_REQUIRE(epoll->Wait(0ms, ready));
+    BOOST_CHECK(ready.empty());
+    BOOST_CHECK_EQUAL(epoll->RegisteredCount(), 1U);
+    BOOST_CHECK_EQUAL(sock0.use_count(), 2); // sock0 and the registration
+
+    // Readiness is reported, and reported again while the data is not consumed.
+    // Idle sockets are not reported.
+    BOOST_REQUIRE(epoll->Add(sock1, Sock::RECV));
+    BOOST_REQUIRE_EQUAL(sock1->Send("a", 1, 0), 1);
+    for (int i{0}; i < 2; ++i) {
+        BOOST_REQUIRE(epoll->Wait(1min, ready));
+        BOOST_REQUIRE_EQUAL(ready.size(), 1U);
+        BOOST_CHECK_EQUAL(ready.at(sock0).requested, Sock::RECV);
+        BOOST_CHECK_EQUAL(ready.at(sock0).occurred, Sock::RECV);
+    }
+
+    // Changing the requested events takes effect.
+    BOOST_REQUIRE(epoll->Modify(*sock0, Sock::SEND));
+    BOOST_REQUIRE(epoll->Wait(1min, ready));
+    BOOST_REQUIRE_EQUAL(ready.size(), 1U);
+    BOOST_CHECK_EQUAL(ready.at(sock0).occurred, Sock::SEND);
+
+    // Sockets without requested events are not reported.
+    BOOST_REQUIRE(epoll->Modify(*sock0, 0));
+    BOOST_REQUIRE(epoll->Wait(0ms, ready));
+    BOOST_CHECK(ready.empty());
+
+    // Removed sockets are no longer reported and are released.
+    BOOST_REQUIRE(epoll->Modify(*sock0, Sock::RECV));
+    epoll->Remove(*sock0);
+    BOOST_CHECK(!epoll->Modify(*sock0, Sock::RECV));
+    BOOST_REQUIRE(epoll->Wait(0ms, ready));
+    BOOST_CHECK(ready.empty());
+    BOOST_CHECK_EQUAL(epoll->RegisteredCount(), 1U);
+    BOOST_CHECK_EQUAL(sock0.use_count(), 1);
+
+    epoll->Clear();
+    BOOST_CHECK_EQUAL(epoll->RegisteredCount(), 0U);
+    BOOST_CHECK_EQUAL(sock1.use_count(), 1);
+}
+
+#endif /* USE_EPOLL */
+
 #endif /* WIN32 */
 
 BOOST_AUTO_TEST_SUITE_END()
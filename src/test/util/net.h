@@ -93,6 +93,11 @@ struct ConnmanTestMsg : public CConnman {
         SocketHandler();
     }
 
+    void DisconnectNodesPublic() EXCLUSIVE_LOCKS_REQUIRED(!m_reconnections_mutex, !m_nodes_mutex)
+    {
+        DisconnectNodes();
+    }
+
     void Handshake(CNode& node,
                    bool successfully_connected,
                    ServiceFlags remote_services,
@@ -0,0 +1,102 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/validation.h>
+#include <index/utxoscriptindex.h>
+#include <key.h>
+#include <script/script.h>
+#include <test/util/common.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(utxoscriptindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(utxoscriptindex_initial_sync, TestChain100Setup)
+{
+    // Mine blocks for coinbase maturity, so we can spend some coinbase outputs in the test.
+    const CScript& coinbase_script = m_coinbase_txns[0]->vout[0].scriptPubKey;
+    for (int i = 0; i < 10; i++) CreateAndProcessBlock({}, coinbase_script);
+
+    // Spend a coinbase output to another script, and spend that output again in the same block.
+    CKey key{GenerateRandomKey()};
+    const CScript dest_script{CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG};
+    std::vector<CMutableTransaction> spenders(2);
+    const CScript* prev_script{&coinbase_script};
+    for (size_t i = 0; i < spenders.size(); i++) {
+        spenders[i].version = 1;
+        spenders[i].vin.resize(1);
+        spenders[i].vin[0].prevout = i == 0 ? COutPoint(m_coinbase_txns[0]->GetHash(), 0) : COutPoint(spenders[i - 1].GetHash(), 0);
+        spenders[i].vout.resize(1);
+        spenders[i].vout[0].nValue = m_coinbase_txns[0]->GetValueOut() - 1000 * (i + 1);
+        spenders[i].vout[0].scriptPubKey = dest_script;
+
+        std::vector<unsigned char> vchSig;
+        const uint256 hash = SignatureHash(*prev_script, spenders[i], 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_REQUIRE((i == 0 ? coinbaseKey : key).Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spenders[i].vin[0].scriptSig << vchSig;
+        prev_script = &dest_script;
+    }
+    const uint256 tip_hash = CreateAndProcessBlock(spenders, coinbase_script).GetHash();
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    const int tip_height{WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight())};
+
+    UtxoScriptIndex utxoscriptindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(utxoscriptindex.Init());
+    BOOST_CHECK(!utxoscriptindex.FindCoins({dest_script}));
+
+    utxoscriptindex.Sync();
+    BOOST_CHECK_EQUAL(utxoscriptindex.GetSummary().best_block_hash, tip_hash);
+
+    // Only the output of the second spender is unspent.
+    const auto dest_scan{utxoscriptindex.FindCoins({dest_script}).value()};
+    BOOST_CHECK_EQUAL(dest_scan.block.hash, tip_hash);
+    BOOST_CHECK_EQUAL(dest_scan.block.height, tip_height);
+    BOOST_REQUIRE_EQUAL(dest_scan.coins.size(), 1U);
+    const auto& [dest_outpoint, dest_coin] = *dest_scan.coins.begin();
+    BOOST_CHECK(dest_outpoint == COutPoint(spenders[1].GetHash(), 0));
+    BOOST_CHECK_EQUAL(dest_coin.out.nValue, spenders[1].vout[0].nValue);
+    BOOST_CHECK_EQUAL(int(dest_coin.nHeight), tip_height);
+    BOOST_CHECK(!dest_coin.IsCoinBase());
+
+    // Every block pays its coinbase to the coinbase script. All of these outputs but the spent one
+    // are found with the output of the second spender, and they all match the chainstate.
+    const auto scan{utxoscriptindex.FindCoins({coinbase_script, dest_script}).value()};
+    BOOST_CHECK_EQUAL(scan.coins.size(), size_t(tip_height));
+    BOOST_CHECK(!scan.coins.contains(COutPoint(m_coinbase_txns[0]->GetHash(), 0)));
+    BOOST_CHECK(scan.coins.contains(COutPoint(m_coinbase_txns[1]->GetHash(), 0)));
+    {
+        LOCK(::cs_main);
+        const CCoinsViewCache& coins_tip{m_node.chainman->ActiveChainstate().CoinsTip()};
+        for (const auto& [outpoint, coin] : scan.coins) {
+            const Coin& chain_coin{coins_tip.AccessCoin(outpoint)};
+            BOOST_CHECK(chain_coin.out == coin.out);
+            BOOST_CHECK_EQUAL(int(chain_coin.nHeight), int(coin.nHeight));
+            BOOST_CHECK_EQUAL(chain_coin.IsCoinBase(), coin.IsCoinBase());
+        }
+    }
+
+    // Replace the last block with one without the spenders: their inputs are unspent again.
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveTip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    const uint256 fork_hash = CreateAndProcessBlock({}, CScript() << OP_TRUE).GetHash();
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    BOOST_CHECK_EQUAL(utxoscriptindex.GetSummary().best_block_hash, fork_hash);
+
+    const auto fork_scan{utxoscriptindex.FindCoins({coinbase_script, dest_script}).value()};
+    BOOST_CHECK_EQUAL(fork_scan.block.hash, fork_hash);
+    BOOST_CHECK_EQUAL(fork_scan.coins.size(), size_t(tip_height) - 1);
+    BOOST_CHECK(fork_scan.coins.contains(COutPoint(m_coinbase_txns[0]->GetHash(), 0)));
+    BOOST_CHECK(utxoscriptindex.FindCoins({dest_script}).value().coins.empty());
+
+    // Shutdown sequence (c.f. Shutdown() in init.cpp)
+    utxoscriptindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
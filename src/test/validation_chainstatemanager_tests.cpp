@@ -4,6 +4,7 @@
 //
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <kernel/coinstats.h>
 #include <kernel/disconnected_transactions.h>
 #include <node/chainstatemanager_args.h>
 #include <node/kernel_notifications.h>
@@ -25,6 +26,7 @@
 
 #include <tinyformat.h>
 
+#include <memory>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -456,6 +458,33 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot, SnapshotTestSetup)
     this->SetupSnapshot();
 }
 
+//! Check that the coins hashed in batches on a separate thread, as done while
+//! loading and dumping snapshots, result in the snapshot content hash.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_snapshot_hash_batches, TestChain100Setup)
+{
+    Chainstate& chainstate{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChainstate())};
+    WITH_LOCK(::cs_main, chainstate.ForceFlushStateToDisk());
+    CCoinsViewDB& coins_db{WITH_LOCK(::cs_main, return chainstate.CoinsDB())};
+    const auto stats{*Assert(kernel::ComputeUTXOStats(kernel::CoinStatsHashType::HASH_SERIALIZED, &coins_db, m_node.chainman->m_blockman))};
+
+    for (const size_t batch_size : {1, 7, 1000}) {
+        kernel::SerializedCoinsHasher hasher;
+        auto batch{std::make_shared<kernel::SerializedCoinsHasher::Batch>()};
+        for (auto cursor{coins_db.Cursor()}; cursor->Valid(); cursor->Next()) {
+            COutPoint outpoint;
+            Coin coin;
+            BOOST_REQUIRE(cursor->GetKey(outpoint) && cursor->GetValue(coin));
+            batch->emplace_back(outpoint, std::move(coin));
+            if (batch->size() == batch_size) {
+                hasher.Add(std::move(batch));
+                batch = std::make_shared<kernel::SerializedCoinsHasher::Batch>();
+            }
+        }
+        hasher.Add(std::move(batch));
+        BOOST_CHECK_EQUAL(hasher.Finalize(), stats.hashSerialized);
+    }
+}
+
 //! Test LoadBlockIndex behavior when multiple chainstates are in use.
 //!
 //! - First, verify that setBlockIndexCandidates is as expected when using a single,
@@ -781,6 +810,48 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_snapshot_completion, SnapshotTestSetup
     }
 }
 
+//! Test validating the historical chainstate in the background validation thread.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_background_validation, SnapshotTestSetup)
+{
+    this->SetupSnapshot();
+
+    ChainstateManager& chainman{*Assert(m_node.chainman)};
+    Chainstate& current_cs{WITH_LOCK(::cs_main, return chainman.CurrentChainstate())};
+    Chainstate& historical_cs{*Assert(WITH_LOCK(::cs_main, return chainman.HistoricalChainstate()))};
+
+    chainman.StartBackgroundValidation();
+    BOOST_CHECK(chainman.IsBackgroundValidationRunning());
+
+    // While the current chainstate is in IBD, the historical chainstate gets a
+    // cache budget of its own.
+    const size_t max_cache{10000};
+    chainman.m_total_coinsdb_cache = max_cache;
+    chainman.m_total_coinstip_cache = max_cache;
+    static_cast<TestChainstateManager&>(chainman).ResetIbd();
+    WITH_LOCK(::cs_main, chainman.MaybeRebalanceCaches());
+    BOOST_CHECK_CLOSE(double(historical_cs.m_coinstip_cache_size_bytes), max_cache * BACKGROUND_VALIDATION_CACHE_SHARE, 1);
+    BOOST_CHECK_CLOSE(double(historical_cs.m_coinsdb_cache_size_bytes), max_cache * BACKGROUND_VALIDATION_CACHE_SHARE, 1);
+    BOOST_CHECK_CLOSE(double(current_cs.m_coinstip_cache_size_bytes), max_cache * (1 - BACKGROUND_VALIDATION_CACHE_SHARE), 1);
+    BOOST_CHECK_CLOSE(double(current_cs.m_coinsdb_cache_size_bytes), max_cache * (1 - BACKGROUND_VALIDATION_CACHE_SHARE), 1);
+
+    // New blocks are still connected to the current chainstate, while the
+    // historical chainstate is left to the thread.
+    const int height{WITH_LOCK(::cs_main, return current_cs.m_chain.Height())};
+    mineBlocks(2);
+    BOOST_CHECK_EQUAL(WITH_LOCK(::cs_main, return current_cs.m_chain.Height()), height + 2);
+    BOOST_CHECK(chainman.ActivateBestChains());
+    BOOST_CHECK(WITH_LOCK(::cs_main, return current_cs.GetConnectThroughput()).has_value());
+
+    chainman.StopBackgroundValidation();
+    BOOST_CHECK(!chainman.IsBackgroundValidationRunning());
+
+    // Without the thread, the historical chainstate only gets a small share.
+    static_cast<TestChainstateManager&>(chainman).ResetIbd();
+    WITH_LOCK(::cs_main, chainman.MaybeRebalanceCaches());
+    BOOST_CHECK_CLOSE(double(historical_cs.m_coinstip_cache_size_bytes), max_cache * 0.05, 1);
+    BOOST_CHECK_CLOSE(double(current_cs.m_coinstip_cache_size_bytes), max_cache * 0.95, 1);
+}
+
 BOOST_FIXTURE_TEST_CASE(chainstatemanager_snapshot_completion_hash_mismatch, SnapshotTestSetup)
 {
     auto chainstates = this->SetupSnapshot();
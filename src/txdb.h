@@ -17,6 +17,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 class COutPoint;
@@ -47,12 +49,23 @@ public:
     void BatchWrite(CoinsViewCacheCursor& cursor, const uint256& hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
 
+    //! Write coins straight to the database, bypassing any cache and leaving
+    //! the best block untouched. Only meant for bulk loading a database that
+    //! is not in use yet, such as the one of a UTXO snapshot being loaded.
+    void BulkWrite(std::span<const std::pair<COutPoint, Coin>> coins);
+
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
     size_t EstimateSize() const override;
 
     //! Dynamically alter the underlying leveldb cache size.
     void ResizeCache(size_t new_cache_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    //! Background compaction and level statistics of the database, see CDBWrapper.
+    bool RequestCompaction() { return m_db->RequestCompaction(); }
+    void SetCompactionDeferred(bool deferred) { m_db->SetCompactionDeferred(deferred); }
+    DBCompactionProgress GetCompactionProgress() const { return m_db->GetCompactionProgress(); }
+    std::vector<DBLevelStats> GetLevelStats() const { return m_db->GetLevelStats(); }
 };
 
 #endif // BITCOIN_TXDB_H
@@ -98,6 +98,8 @@ public:
 
     std::string write(unsigned int prettyIndent = 0,
                       unsigned int indentLevel = 0) const;
+    /** Like write(), but append the output to s */
+    void write(unsigned int prettyIndent, unsigned int indentLevel, std::string& s) const;
 
     bool read(std::string_view raw);
 
@@ -5,11 +5,17 @@
 #ifndef BITCOIN_UTIL_GOLOMBRICE_H
 #define BITCOIN_UTIL_GOLOMBRICE_H
 
+#include <crypto/common.h>
 #include <util/fastrange.h>
 
 #include <streams.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <ios>
+#include <span>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -42,4 +48,85 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Decoder for a stream of Golomb-Rice coded values in memory. It returns the
+ * same values as GolombRiceDecode() on a BitStreamReader, but loads the stream
+ * 64 bits at a time and reads a unary-coded quotient with a single count of
+ * leading ones instead of one bit at a time.
+ */
+class GolombRiceReader
+{
+private:
+    std::span<const unsigned char> m_data;
+    /// Position in m_data of the first byte not loaded into m_buffer yet.
+    size_t m_pos{0};
+    /// The next bits of the stream, starting at the most significant bit.
+    uint64_t m_buffer{0};
+    /// Number of bits at the top of m_buffer that have not been consumed.
+    int m_bits{0};
+
+    void Refill()
+    {
+        if (m_bits > 56) return;
+        if (m_data.size() - m_pos >= 8) {
+            // Load whole bytes until the buffer has at least 56 bits. The bits
+            // below them are the start of the next byte, which is loaded again
+            // by the next refill to the same position.
+            m_buffer |= ReadBE64(m_data.data() + m_pos) >> m_bits;
+            const int n_bytes{(63 - m_bits) >> 3};
+            m_pos += n_bytes;
+            m_bits += n_bytes * 8;
+        } else {
+            while (m_bits <= 56 && m_pos < m_data.size()) {
+                m_buffer |= uint64_t{m_data[m_pos++]} << (56 - m_bits);
+                m_bits += 8;
+            }
+        }
+        if (m_bits == 0) {
+            throw std::ios_base::failure("GolombRiceReader: end of data");
+        }
+    }
+
+    void Consume(int nbits)
+    {
+        m_buffer = nbits == 64 ? 0 : m_buffer << nbits;
+        m_bits -= nbits;
+    }
+
+public:
+    explicit GolombRiceReader(std::span<const unsigned char> data) : m_data{data} {}
+
+    /** Read the specified number of bits, like BitStreamReader::Read(). */
+    uint64_t Read(int nbits)
+    {
+        uint64_t data{0};
+        while (nbits > 0) {
+            Refill();
+            const int bits{std::min(nbits, m_bits)};
+            data = bits == 64 ? m_buffer : (data << bits) | (m_buffer >> (64 - bits));
+            Consume(bits);
+            nbits -= bits;
+        }
+        return data;
+    }
+
+    uint64_t Decode(uint8_t P)
+    {
+        // Read unary-encoded quotient: q 1's followed by one 0.
+        uint64_t q{0};
+        for (;;) {
+            Refill();
+            const int ones{std::countl_one(m_buffer)};
+            if (ones < m_bits) {
+                q += ones;
+                Consume(ones + 1);
+                break;
+            }
+            q += m_bits;
+            Consume(m_bits);
+        }
+        return (q << P) + Read(P);
+    }
+};
+
 #endif // BITCOIN_UTIL_GOLOMBRICE_H
@@ -0,0 +1,39 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_MAPPEDFILE_H
+#define BITCOIN_UTIL_MAPPEDFILE_H
+
+#include <util/fs.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * The file must not be truncated while it is mapped, as accessing pages past
+ * its end is fatal. Appending to it is harmless, but the mapping does not
+ * grow.
+ */
+class MappedFile
+{
+private:
+    std::span<const std::byte> m_data;
+
+    explicit MappedFile(std::span<const std::byte> data) : m_data{data} {}
+
+public:
+    /** Map the file at path. Returns nullptr if it cannot be mapped, which is always the case on Windows. */
+    static std::unique_ptr<MappedFile> Open(const fs::path& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> data() const { return m_data; }
+};
+
+#endif // BITCOIN_UTIL_MAPPEDFILE_H
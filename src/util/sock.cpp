@@ -8,11 +8,13 @@
 #include <compat/compat.h>
 #include <span.h>
 #include <tinyformat.h>
+#include <util/check.h>
 #include <util/log.h>
 #include <util/syserror.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <array>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -21,6 +23,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 static inline bool IOErrorIsPermanent(int err)
 {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK && err != WSAEINPROGRESS;
@@ -244,6 +250,138 @@ bool Sock::WaitMany(std::chrono::milliseconds timeout, EventsPerSock& events_per
 #endif /* USE_POLL */
 }
 
+std::unique_ptr<SockEpoll> SockEpoll::Create()
+{
+#ifdef USE_EPOLL
+    const int epoll_fd{epoll_create1(EPOLL_CLOEXEC)};
+    if (epoll_fd == -1) {
+        LogWarning("Failed to create epoll instance: %s", SysErrorString(errno));
+        return nullptr;
+    }
+    return std::unique_ptr<SockEpoll>{new SockEpoll{epoll_fd}};
+#else
+    return nullptr;
+#endif /* USE_EPOLL */
+}
+
+SockEpoll::~SockEpoll()
+{
+#ifdef USE_EPOLL
+    close(m_epoll_fd);
+#endif /* USE_EPOLL */
+}
+
+#ifdef USE_EPOLL
+static uint32_t ToEpollEvents(Sock::Event requested)
+{
+    uint32_t events{0};
+    if (requested & Sock::RECV) events |= EPOLLIN;
+    if (requested & Sock::SEND) events |= EPOLLOUT;
+    return events;
+}
+#endif /* USE_EPOLL */
+
+bool SockEpoll::Add(std::shared_ptr<const Sock> sock, Sock::Event requested)
+{
+#ifdef USE_EPOLL
+    const SOCKET fd{sock->m_socket};
+    LOCK(m_mutex);
+    const auto [it, inserted]{m_registered.try_emplace(fd, Registration{std::move(sock), requested})};
+    if (!inserted) return false;
+    epoll_event ev{};
+    ev.events = ToEpollEvents(requested);
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        m_registered.erase(it);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif /* USE_EPOLL */
+}
+
+bool SockEpoll::Modify(const Sock& sock, Sock::Event requested)
+{
+#ifdef USE_EPOLL
+    LOCK(m_mutex);
+    const auto it{m_registered.find(sock.m_socket)};
+    // The stored shared_ptr keeps the file descriptor open while it is
+    // registered, so it cannot have been reused by a different socket.
+    if (it == m_registered.end() || it->second.sock.get() != &sock) return false;
+    if (it->second.requested == requested) return true;
+    epoll_event ev{};
+    ev.events = ToEpollEvents(requested);
+    ev.data.fd = sock.m_socket;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, sock.m_socket, &ev) == -1) return false;
+    it->second.requested = requested;
+    return true;
+#else
+    return false;
+#endif /* USE_EPOLL */
+}
+
+void SockEpoll::Remove(const Sock& sock)
+{
+#ifdef USE_EPOLL
+    LOCK(m_mutex);
+    const auto it{m_registered.find(sock.m_socket)};
+    if (it == m_registered.end() || it->second.sock.get() != &sock) return;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+    m_registered.erase(it);
+#endif /* USE_EPOLL */
+}
+
+void SockEpoll::Clear()
+{
+    LOCK(m_mutex);
+#ifdef USE_EPOLL
+    for (const auto& [fd, registration] : m_registered) {
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+#endif /* USE_EPOLL */
+    m_registered.clear();
+}
+
+size_t SockEpoll::RegisteredCount() const
+{
+    LOCK(m_mutex);
+    return m_registered.size();
+}
+
+bool SockEpoll::Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& ready)
+{
+    ready.clear();
+#ifdef USE_EPOLL
+    if (RegisteredCount() == 0) return false;
+
+    // Sockets that do not fit are reported by the next call, as registrations are level-triggered.
+    std::array<epoll_event, 1024> events;
+    const int num_ready{epoll_wait(m_epoll_fd, events.data(), events.size(), count_milliseconds(timeout))};
+    if (num_ready == -1) {
+        return false;
+    }
+
+    LOCK(m_mutex);
+    for (const auto& ev : std::span{events}.first(num_ready)) {
+        // The socket may have been removed or changed by another thread meanwhile.
+        const auto it{m_registered.find(ev.data.fd)};
+        if (it == m_registered.end() || it->second.requested == 0) continue;
+        Sock::Event occurred{0};
+        if (ev.events & EPOLLIN) occurred |= Sock::RECV;
+        if (ev.events & EPOLLOUT) occurred |= Sock::SEND;
+        if (ev.events & (EPOLLERR | EPOLLHUP)) occurred |= Sock::ERR;
+        occurred &= it->second.requested | Sock::ERR;
+        if (occurred == 0) continue;
+        ready.emplace(it->second.sock, Sock::Events{it->second.requested}).first->second.occurred = occurred;
+    }
+
+    return true;
+#else
+    return false;
+#endif /* USE_EPOLL */
+}
+
 void Sock::SendComplete(std::span<const unsigned char> data,
                         std::chrono::milliseconds timeout,
                         CThreadInterrupt& interrupt) const
@@ -6,10 +6,12 @@
 #define BITCOIN_UTIL_SOCK_H
 
 #include <compat/compat.h>
+#include <sync.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <span>
 #include <string>
@@ -276,12 +278,89 @@ protected:
     SOCKET m_socket;
 
 private:
+    friend class SockEpoll;
+
     /**
      * Close `m_socket` if it is not `INVALID_SOCKET`.
      */
     void Close();
 };
 
+/**
+ * Wait for readiness on many sockets like `Sock::WaitMany()`, but keep the sockets
+ * registered with the kernel across calls using epoll(7).
+ *
+ * `Sock::WaitMany()` passes every socket to poll(2) on every call, which costs
+ * O(sockets) in the kernel even if almost all of them are idle. Here, sockets are
+ * added when they are opened and removed when they are closed, the requested events
+ * are only sent to the kernel when they change, and `Wait()` only reports the ready
+ * sockets.
+ *
+ * Registrations are level-triggered, so a socket that was not fully drained is
+ * reported again by the next call, matching the semantics of `Sock::WaitMany()`.
+ * Sockets are kept alive (via the stored `shared_ptr`) until they are removed.
+ */
+class SockEpoll
+{
+public:
+    /**
+     * Create an epoll instance.
+     * @return nullptr if epoll is not supported on this platform or cannot be created.
+     */
+    static std::unique_ptr<SockEpoll> Create();
+
+    SockEpoll(const SockEpoll&) = delete;
+    SockEpoll& operator=(const SockEpoll&) = delete;
+
+    ~SockEpoll();
+
+    /**
+     * Register a socket for the requested events.
+     * @return false if it is already registered or cannot be registered
+     */
+    [[nodiscard]] bool Add(std::shared_ptr<const Sock> sock, Sock::Event requested) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Change the events requested for a registered socket. Only calls into the kernel
+     * if they differ from the previous ones. A socket with no requested events is not
+     * reported, not even for errors.
+     * @return false if it is not registered or cannot be changed
+     */
+    bool Modify(const Sock& sock, Sock::Event requested) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Unregister a socket, releasing the reference held to it. */
+    void Remove(const Sock& sock) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Unregister all sockets, releasing the references held to them. */
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Wait for the requested events on the registered sockets. Sockets may be added,
+     * changed and removed by other threads meanwhile.
+     * @param[in] timeout Wait this long for at least one of the requested events to occur.
+     * @param[out] ready Set to the sockets on which events occurred, with `requested` and
+     * `occurred` filled in. Sockets on which nothing occurred are not included.
+     * @return true on success (or timeout, if `ready` is empty), false if no sockets
+     * are registered or on error
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& ready) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of sockets currently registered with the kernel. */
+    size_t RegisteredCount() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    explicit SockEpoll(int epoll_fd) : m_epoll_fd{epoll_fd} {}
+
+    struct Registration {
+        std::shared_ptr<const Sock> sock;
+        Sock::Event requested;
+    };
+
+    const int m_epoll_fd;
+    mutable Mutex m_mutex;
+    std::unordered_map<SOCKET, Registration> m_registered GUARDED_BY(m_mutex);
+};
+
 /** Return readable error string for a network error code */
 std::string NetworkErrorString(int err);
 
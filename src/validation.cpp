@@ -59,6 +59,8 @@
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/thread.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -68,11 +70,14 @@
 #include <cassert>
 #include <chrono>
 #include <deque>
+#include <future>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -111,6 +116,12 @@ const std::vector<std::string> CHECKLEVEL_DOC {
  *  noticeably interfere with the pruning mechanism.
  * */
 static constexpr int PRUNE_LOCK_BUFFER{10};
+/** Number of most recently connected blocks over which validation throughput is measured. */
+static constexpr size_t CONNECT_THROUGHPUT_WINDOW{100};
+/** Number of coins deserialized from a UTXO snapshot before they are handed to the hashing and database threads. */
+static constexpr size_t SNAPSHOT_LOAD_BATCH_COINS{120'000};
+/** Maximum number of batches of snapshot coins waiting to be written to the database. */
+static constexpr size_t SNAPSHOT_LOAD_PENDING_BATCHES{4};
 
 TRACEPOINT_SEMAPHORE(validation, block_connected);
 TRACEPOINT_SEMAPHORE(utxocache, flush);
@@ -1848,12 +1859,14 @@ CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 
 CoinsViews::CoinsViews(DBParams db_params, CoinsViewOptions options)
     : m_dbview{std::move(db_params), std::move(options)},
-      m_catcherview(&m_dbview) {}
+      m_catcherview(&m_dbview),
+      m_compressedview(&m_catcherview),
+      m_sharedview(&m_compressedview) {}
 
 void CoinsViews::InitCache()
 {
     AssertLockHeld(::cs_main);
-    m_cacheview = std::make_unique<CCoinsViewCache>(&m_catcherview);
+    m_cacheview = std::make_unique<CoinsViewPublishingCache>(m_sharedview);
     m_connect_block_view = std::make_unique<CoinsViewOverlay>(&*m_cacheview);
 }
 
@@ -1912,7 +1925,7 @@ void Chainstate::InitCoinsDB(
     bool in_memory,
     bool should_wipe)
 {
-    m_coins_views = std::make_unique<CoinsViews>(
+    m_coins_views = std::make_shared<CoinsViews>(
         DBParams{
             .path = StoragePath(),
             .cache_bytes = cache_size_bytes,
@@ -1931,6 +1944,22 @@ void Chainstate::InitCoinsCache(size_t cache_size_bytes)
     assert(m_coins_views != nullptr);
     m_coinstip_cache_size_bytes = cache_size_bytes;
     m_coins_views->InitCache();
+    m_coins_views->m_compressedview.SetMaxUsage(cache_size_bytes * COINS_COMPRESSED_CACHE_PERCENT / 100);
+}
+
+std::optional<Chainstate::ConnectThroughput> Chainstate::GetConnectThroughput() const
+{
+    AssertLockHeld(::cs_main);
+    if (m_recent_connects.size() < 2) return std::nullopt;
+    const double elapsed{Ticks<SecondsDouble>(m_recent_connects.back().first - m_recent_connects.front().first)};
+    if (elapsed <= 0) return std::nullopt;
+    // The first block only marks the start of the measured period.
+    const uint64_t num_txs{std::accumulate(std::next(m_recent_connects.begin()), m_recent_connects.end(), uint64_t{0},
+                                           [](uint64_t sum, const auto& connect) { return sum + connect.second; })};
+    return ConnectThroughput{
+        .blocks_per_second = (m_recent_connects.size() - 1) / elapsed,
+        .transactions_per_second = num_txs / elapsed,
+    };
 }
 
 // Lock-free: depends on `m_cached_is_ibd`, which is latched by `UpdateIBDStatus()`.
@@ -2012,7 +2041,7 @@ std::optional<std::pair<ScriptError, std::string>> CScriptCheck::operator()() {
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
     ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
-    if (VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, m_flags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *m_signature_cache, *txdata), &error)) {
+    if (VerifyScript(scriptSig, m_tx_out->scriptPubKey, witness, m_flags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out->nValue, cacheStore, *m_signature_cache, *txdata), &error)) {
         return std::nullopt;
     } else {
         auto debug_str = strprintf("input %i of %s (wtxid %s), spending %s:%i", nIn, ptxTo->GetHash().ToString(), ptxTo->GetWitnessHash().ToString(), ptxTo->vin[nIn].prevout.hash.ToString(), ptxTo->vin[nIn].prevout.n);
@@ -2509,9 +2538,13 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // doesn't invalidate pointers into the vector, and keep txsdata in scope
     // for as long as `control`.
     std::optional<CCheckQueueControl<CScriptCheck>> control;
-    if (auto& queue = m_chainman.GetCheckQueue(); queue.HasThreads() && fScriptChecks) control.emplace(queue);
+    if (auto& queue = m_chainman.GetCheckQueue(*this); queue.HasThreads() && fScriptChecks) control.emplace(queue);
 
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
+    // The checks of each transaction are moved into control, so the same
+    // vector is reused for all of them instead of allocating one per
+    // transaction.
+    std::vector<CScriptCheck> vChecks;
 
     std::vector<int> prevheights;
     CAmount nFees = 0;
@@ -2576,7 +2609,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             // If CheckInputScripts is called with a pointer to a checks vector, the resulting checks are appended to it. In that case
             // they need to be added to control which runs them asynchronously. Otherwise, CheckInputScripts runs the checks before returning.
             if (control) {
-                std::vector<CScriptCheck> vChecks;
+                vChecks.clear();
                 tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks);
                 if (tx_ok) control->Add(std::move(vChecks));
             } else {
@@ -2683,7 +2716,7 @@ CoinsCacheSizeState Chainstate::GetCoinsCacheSizeState(
 {
     AssertLockHeld(::cs_main);
     const int64_t nMempoolUsage = m_mempool ? m_mempool->DynamicMemoryUsage() : 0;
-    int64_t cacheSize = CoinsTip().DynamicMemoryUsage();
+    int64_t cacheSize = CoinsTip().DynamicMemoryUsage() + m_coins_views->m_compressedview.DynamicMemoryUsage();
     int64_t nTotalSpace =
         max_coins_cache_size_bytes + std::max<int64_t>(int64_t(max_mempool_size_bytes) - nMempoolUsage, 0);
 
@@ -2703,6 +2736,8 @@ bool Chainstate::FlushStateToDisk(
 {
     LOCK(cs_main);
     assert(this->CanFlushToDisk());
+    // Hold off the background compaction of the chainstate while it is written in bursts.
+    CoinsDB().SetCompactionDeferred(m_chainman.IsInitialBlockDownload());
     std::set<int> setFilesToPrune;
     bool full_flush_completed = false;
 
@@ -2763,9 +2798,11 @@ bool Chainstate::FlushStateToDisk(
         bool fCacheCritical = mode == FlushStateMode::IF_NEEDED && cache_state >= CoinsCacheSizeState::CRITICAL;
         // It's been a while since we wrote the block index and chain state to disk. Do this frequently, so we don't need to redownload or reindex after a crash.
         bool fPeriodicWrite = mode == FlushStateMode::PERIODIC && nNow >= m_next_write;
-        const auto empty_cache{(mode == FlushStateMode::FORCE_FLUSH) || fCacheLarge || fCacheCritical};
+        const auto empty_cache{mode == FlushStateMode::FORCE_FLUSH};
+        // When the cache is written because of its size, only the coins that were accessed least recently are evicted.
+        const auto trim_cache{fCacheLarge || fCacheCritical};
         // Combine all conditions that result in a write to disk.
-        bool should_write = (mode == FlushStateMode::FORCE_SYNC) || empty_cache || fPeriodicWrite || fFlushForPrune;
+        bool should_write = (mode == FlushStateMode::FORCE_SYNC) || empty_cache || trim_cache || fPeriodicWrite || fFlushForPrune;
         // Write blocks, block index and best chain related state to disk.
         if (should_write) {
             LogDebug(BCLog::COINDB, "Writing chainstate to disk: flush mode=%s, prune=%d, large=%d, critical=%d, periodic=%d",
@@ -2784,6 +2821,9 @@ bool Chainstate::FlushStateToDisk(
                 if (!m_blockman.FlushChainstateBlockFile(m_chain.Height())) {
                     LogWarning("%s: Failed to flush block file.\n", __func__);
                 }
+                // Block files are mapped again when they are next read, so
+                // that mappings do not outlive the files they map indefinitely.
+                m_blockman.UnmapBlockFiles();
             }
 
             // Then update all block file information (which may refer to block and undo files).
@@ -2808,8 +2848,12 @@ bool Chainstate::FlushStateToDisk(
                 if (!CheckDiskSpace(m_chainman.m_options.datadir, 48 * 2 * 2 * CoinsTip().GetDirtyCount())) {
                     return FatalError(m_chainman.GetNotifications(), state, _("Disk space is too low!"));
                 }
+                // Once out of IBD, publish the chainstate for lookups without cs_main,
+                // starting with this flush.
+                if (!m_chainman.IsInitialBlockDownload()) m_coins_views->m_sharedview.RequestActivation();
                 // Flush the chainstate (which may refer to block index entries).
                 empty_cache ? CoinsTip().Flush() : CoinsTip().Sync();
+                if (trim_cache) TrimCoinsCache();
                 full_flush_completed = true;
                 TRACEPOINT(utxocache, flush,
                     int64_t{Ticks<std::chrono::microseconds>(NodeClock::now() - nNow)},
@@ -2835,6 +2879,23 @@ bool Chainstate::FlushStateToDisk(
     return true;
 }
 
+void Chainstate::TrimCoinsCache()
+{
+    AssertLockHeld(::cs_main);
+    LOG_TIME_MILLIS_WITH_CATEGORY("trim coins cache", BCLog::BENCH);
+    // The most recently accessed of the evicted coins replace the older half of
+    // the compressed cache.
+    auto& compressed{m_coins_views->m_compressedview};
+    compressed.Age();
+    const bool trimmed{CoinsTip().Trim(m_coinstip_cache_size_bytes * COINS_CACHE_RETAIN_PERCENT / 100,
+                                       [&](const COutPoint& outpoint, const Coin& coin) { return compressed.Insert(outpoint, coin); })};
+    // The cache has just been synced, so it has no modified coins.
+    if (!Assume(trimmed)) return;
+    LogDebug(BCLog::COINDB, "Trimmed coins cache to %d coins (%.1f MiB), %d coins (%.1f MiB) compressed",
+             CoinsTip().GetCacheSize(), CoinsTip().DynamicMemoryUsage() * (1.0 / 1024 / 1024),
+             compressed.GetCacheSize(), compressed.DynamicMemoryUsage() * (1.0 / 1024 / 1024));
+}
+
 void Chainstate::ForceFlushStateToDisk(bool wipe_cache)
 {
     BlockValidationState state;
@@ -3063,8 +3124,12 @@ bool Chainstate::ConnectTip(
     LogDebug(BCLog::BENCH, "  - Load block from disk: %.2fms\n",
              Ticks<MillisecondsDouble>(time_2 - time_1));
     {
-        CCoinsViewCache& view{*m_coins_views->m_connect_block_view};
+        CoinsViewOverlay& view{*m_coins_views->m_connect_block_view};
         const auto reset_guard{view.CreateResetGuard()};
+        m_chainman.GetInputFetcher().FetchInputs(view, CoinsTip(), *block_to_connect);
+        const auto time_fetch{SteadyClock::now()};
+        LogDebug(BCLog::BENCH, "  - Fetch inputs: %.2fms\n",
+                 Ticks<MillisecondsDouble>(time_fetch - time_2));
         bool rv = ConnectBlock(*block_to_connect, state, pindexNew, view);
         if (m_chainman.m_options.signals) {
             m_chainman.m_options.signals->BlockChecked(block_to_connect, state);
@@ -3111,6 +3176,8 @@ bool Chainstate::ConnectTip(
     UpdateTip(pindexNew);
 
     const auto time_6{SteadyClock::now()};
+    m_recent_connects.emplace_back(time_6, pindexNew->nTx);
+    if (m_recent_connects.size() > CONNECT_THROUGHPUT_WINDOW) m_recent_connects.pop_front();
     m_chainman.time_post_connect += time_6 - time_5;
     m_chainman.time_total += time_6 - time_1;
     LogDebug(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n",
@@ -4215,12 +4282,12 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
     return true;
 }
 
-bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
+bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, const CheckedHeader& checked, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
 {
     AssertLockHeld(cs_main);
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    const uint256& hash{checked.hash};
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -4236,7 +4303,9 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, GetConsensus())) {
+        // Same as CheckBlockHeader(), with the proof of work checked in advance
+        if (!checked.pow_valid) {
+            state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "high-hash", "proof of work failed");
             LogDebug(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -4262,7 +4331,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
         LogDebug(BCLog::VALIDATION, "%s: not adding new block header %s, missing anti-dos proof-of-work validation\n", __func__, hash.ToString());
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK, "too-little-chainwork");
     }
-    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, hash, m_best_header)};
 
     if (ppindex)
         *ppindex = pindex;
@@ -4274,11 +4343,13 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
 bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex)
 {
     AssertLockNotHeld(cs_main);
+    // Hash the headers and check their proof of work before taking cs_main.
+    const std::vector<CheckedHeader> checked{m_header_checker.CheckHeaders(headers, GetConsensus())};
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i{0}; i < headers.size(); ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            bool accepted{AcceptBlockHeader(header, state, &pindex, min_pow_checked)};
+            bool accepted{AcceptBlockHeader(headers[i], checked[i], state, &pindex, min_pow_checked)};
             CheckBlockIndex();
 
             if (!accepted) {
@@ -4337,7 +4408,7 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
     CBlockIndex *pindexDummy = nullptr;
     CBlockIndex *&pindex = ppindex ? *ppindex : pindexDummy;
 
-    bool accepted_header{AcceptBlockHeader(block, state, &pindex, min_pow_checked)};
+    bool accepted_header{AcceptBlockHeader(block, CheckHeader(block, GetConsensus()), state, &pindex, min_pow_checked)};
     CheckBlockIndex();
 
     if (!accepted_header)
@@ -4467,12 +4538,13 @@ bool ChainstateManager::ProcessNewBlock(const std::shared_ptr<const CBlock>& blo
         return false;
     }
 
+    // Leave the historical chainstate to the background validation thread, if it is running.
     Chainstate* bg_chain{WITH_LOCK(cs_main, return HistoricalChainstate())};
     BlockValidationState bg_state;
-    if (bg_chain && !bg_chain->ActivateBestChain(bg_state, block)) {
+    if (bg_chain && !RequestBackgroundValidation() && !bg_chain->ActivateBestChain(bg_state, block)) {
         LogError("%s: [background] ActivateBestChain failed (%s)\n", __func__, bg_state.ToString());
         return false;
-     }
+    }
 
     return true;
 }
@@ -5499,7 +5571,10 @@ bool Chainstate::ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size)
     size_t old_coinstip_size = m_coinstip_cache_size_bytes;
     m_coinstip_cache_size_bytes = coinstip_size;
     m_coinsdb_cache_size_bytes = coinsdb_size;
+    // Reopening the database must not race with lookups through the shared view.
+    CoinsShared()->Deactivate();
     CoinsDB().ResizeCache(coinsdb_size);
+    m_coins_views->m_compressedview.SetMaxUsage(coinstip_size * COINS_COMPRESSED_CACHE_PERCENT / 100);
 
     LogInfo("[%s] resized coinsdb cache to %.1f MiB",
         this->ToString(), coinsdb_size * (1.0 / 1024 / 1024));
@@ -5746,11 +5821,10 @@ util::Result<CBlockIndex*> ChainstateManager::ActivateSnapshot(
     return snapshot_start_block;
 }
 
-static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache, bool snapshot_loaded)
+static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache)
 {
     LOG_TIME_MILLIS_WITH_CATEGORY_MSG_ONCE(
-        strprintf("%s (%.2f MB)",
-                  snapshot_loaded ? "saving snapshot chainstate" : "flushing coins cache",
+        strprintf("saving snapshot chainstate (%.2f MB)",
                   coins_cache.DynamicMemoryUsage() / (1000 * 1000)),
         BCLog::LogFlags::ALL);
 
@@ -5813,6 +5887,38 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     LogInfo("[snapshot] loading %d coins from snapshot %s", coins_left, base_blockhash.ToString());
     int64_t coins_processed{0};
 
+    // Coins are deserialized and checked on this thread, in batches which are
+    // hashed and written to the database on threads of their own. The writes
+    // bypass the coins cache, as nothing else uses this database until the
+    // snapshot chainstate is activated.
+    CCoinsViewDB& coins_db{*WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB())};
+    std::deque<std::future<void>> pending_writes;
+    ThreadPool writer{"snapwrite"};
+    writer.Start(/*num_workers=*/1);
+
+    // Snapshots written by dumptxoutset list the coins in database order, so
+    // that their content hash can be computed while they are loaded. If a
+    // snapshot is in any other order, the hash is computed from the database
+    // once the coins are written, as its content may then differ from the
+    // sequence of coins in the snapshot.
+    std::optional<kernel::SerializedCoinsHasher> hasher{std::in_place};
+    std::optional<COutPoint> last_outpoint;
+
+    auto batch{std::make_shared<kernel::SerializedCoinsHasher::Batch>()};
+    const auto submit_batch{[&] {
+        if (hasher) hasher->Add(batch);
+        while (pending_writes.size() >= SNAPSHOT_LOAD_PENDING_BATCHES) {
+            pending_writes.front().get();
+            pending_writes.pop_front();
+        }
+        auto task{writer.Submit([&coins_db, batch] { coins_db.BulkWrite(*batch); })};
+        assert(task); // The pool is only stopped when it goes out of scope.
+        pending_writes.push_back(std::move(*task));
+        batch = std::make_shared<kernel::SerializedCoinsHasher::Batch>();
+        batch->reserve(SNAPSHOT_LOAD_BATCH_COINS);
+    }};
+    batch->reserve(SNAPSHOT_LOAD_BATCH_COINS);
+
     while (coins_left > 0) {
         try {
             Txid txid;
@@ -5824,6 +5930,7 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
                 return util::Error{Untranslated("Mismatch in coins count in snapshot metadata and actual snapshot data")};
             }
 
+            const size_t txid_begin{batch->size()};
             for (size_t i = 0; i < coins_per_txid; i++) {
                 COutPoint outpoint;
                 Coin coin;
@@ -5840,53 +5947,46 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
                     return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
                               coins_count - coins_left))};
                 }
-                coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
+                batch->emplace_back(std::move(outpoint), std::move(coin));
 
                 --coins_left;
                 ++coins_processed;
 
                 if (coins_processed % 1000000 == 0) {
-                    LogInfo("[snapshot] %d coins loaded (%.2f%%, %.2f MB)",
+                    LogInfo("[snapshot] %d coins loaded (%.2f%%)",
                         coins_processed,
-                        static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                        coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+                        static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count));
                 }
 
-                // Batch write and flush (if we need to) every so often.
-                //
-                // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-                // means <5MB of memory imprecision.
-                if (coins_processed % 120000 == 0) {
-                    if (m_interrupt) {
-                        return util::Error{Untranslated("Aborting after an interrupt was requested")};
-                    }
-
-                    const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                        return snapshot_chainstate.GetCoinsCacheSizeState());
-
-                    if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                        // This is a hack - we don't know what the actual best block is, but that
-                        // doesn't matter for the purposes of flushing the cache here. We'll set this
-                        // to its correct value (`base_blockhash`) below after the coins are loaded.
-                        coins_cache.SetBestBlock(GetRandHash());
+                if (coins_processed % 120000 == 0 && m_interrupt) {
+                    return util::Error{Untranslated("Aborting after an interrupt was requested")};
+                }
+            }
 
-                        // No need to acquire cs_main since this chainstate isn't being used yet.
-                        FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
-                    }
+            // The database orders the coins of a transaction by the encoding
+            // of their output index, ComputeUTXOStats() by its value.
+            std::span txid_coins{batch->begin() + txid_begin, batch->end()};
+            std::ranges::stable_sort(txid_coins, {}, [](const auto& entry) { return entry.first.n; });
+            if (hasher && !txid_coins.empty()) {
+                bool ordered{!last_outpoint || *last_outpoint < txid_coins.front().first};
+                for (size_t i{1}; ordered && i < txid_coins.size(); ++i) {
+                    ordered = txid_coins[i - 1].first.n < txid_coins[i].first.n;
                 }
+                if (!ordered) {
+                    LogInfo("[snapshot] coins are not in database order, the content hash will be computed after loading");
+                    hasher.reset();
+                }
+                last_outpoint = txid_coins.back().first;
             }
+
+            if (batch->size() >= SNAPSHOT_LOAD_BATCH_COINS) submit_batch();
         } catch (const std::ios_base::failure&) {
             return util::Error{Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
                       coins_processed))};
         }
     }
-
-    // Important that we set this. This and the coins_cache accesses above are
-    // sort of a layer violation, but either we reach into the innards of
-    // CCoinsViewCache here or we have to invert some of the Chainstate to
-    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
-    // method.
-    coins_cache.SetBestBlock(base_blockhash);
+    if (!batch->empty()) submit_batch();
+    for (auto& pending_write : pending_writes) pending_write.get();
 
     bool out_of_coins{false};
     try {
@@ -5901,36 +6001,43 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
             coins_count))};
     }
 
-    LogInfo("[snapshot] loaded %d (%.2f MB) coins from snapshot %s",
-        coins_count,
-        coins_cache.DynamicMemoryUsage() / (1000 * 1000),
-        base_blockhash.ToString());
+    LogInfo("[snapshot] loaded %d coins from snapshot %s", coins_count, base_blockhash.ToString());
+
+    // Important that we set this. This and the coins_cache access below are
+    // sort of a layer violation, but either we reach into the innards of
+    // CCoinsViewCache here or we have to invert some of the Chainstate to
+    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
+    // method. As the coins have been written to the database already, the
+    // flush only records the best block.
+    coins_cache.SetBestBlock(base_blockhash);
 
     // No need to acquire cs_main since this chainstate isn't being used yet.
-    FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
+    FlushSnapshotToDisk(coins_cache);
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
-    std::optional<CCoinsStats> maybe_stats;
+    uint256 content_hash;
+    if (hasher) {
+        content_hash = hasher->Finalize();
+    } else {
+        std::optional<CCoinsStats> maybe_stats;
 
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
-    } catch (StopHashingException const&) {
-        return util::Error{Untranslated("Aborting after an interrupt was requested")};
-    }
-    if (!maybe_stats.has_value()) {
-        return util::Error{Untranslated("Failed to generate coins stats")};
+        try {
+            maybe_stats = ComputeUTXOStats(
+                CoinStatsHashType::HASH_SERIALIZED, &coins_db, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
+        } catch (StopHashingException const&) {
+            return util::Error{Untranslated("Aborting after an interrupt was requested")};
+        }
+        if (!maybe_stats.has_value()) {
+            return util::Error{Untranslated("Failed to generate coins stats")};
+        }
+        content_hash = maybe_stats->hashSerialized;
     }
 
     // Assert that the deserialized chainstate contents match the expected assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
+    if (AssumeutxoHash{content_hash} != au_data.hash_serialized) {
         return util::Error{Untranslated(strprintf("Bad snapshot content hash: expected %s, got %s",
-            au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString()))};
+            au_data.hash_serialized.ToString(), content_hash.ToString()))};
     }
 
     snapshot_chainstate.m_chain.SetTip(*snapshot_start_block);
@@ -6117,18 +6224,26 @@ void ChainstateManager::MaybeRebalanceCaches()
         current_cs.ResizeCoinsCaches(m_total_coinstip_cache, m_total_coinsdb_cache);
     } else {
         // If both chainstates exist, determine who needs more cache based on IBD status.
-        //
-        // Note: shrink caches first so that we don't inadvertently overwhelm available memory.
-        if (IsInitialBlockDownload()) {
+        // While the current chainstate is in IBD, the historical chainstate gets
+        // a budget of its own if it is validated in its own thread,
+        // and only a small share otherwise.
+        const double historical_share{!IsInitialBlockDownload() ? 0.95 :
+                                      IsBackgroundValidationRunning() ? BACKGROUND_VALIDATION_CACHE_SHARE : 0.05};
+        const auto resize_historical{[&] {
             historical_cs->ResizeCoinsCaches(
-                m_total_coinstip_cache * 0.05, m_total_coinsdb_cache * 0.05);
+                m_total_coinstip_cache * historical_share, m_total_coinsdb_cache * historical_share);
+        }};
+        const auto resize_current{[&] {
             current_cs.ResizeCoinsCaches(
-                m_total_coinstip_cache * 0.95, m_total_coinsdb_cache * 0.95);
+                m_total_coinstip_cache * (1 - historical_share), m_total_coinsdb_cache * (1 - historical_share));
+        }};
+        // Note: shrink caches first so that we don't inadvertently overwhelm available memory.
+        if (historical_share < 0.5) {
+            resize_historical();
+            resize_current();
         } else {
-            current_cs.ResizeCoinsCaches(
-                m_total_coinstip_cache * 0.05, m_total_coinsdb_cache * 0.05);
-            historical_cs->ResizeCoinsCaches(
-                m_total_coinstip_cache * 0.95, m_total_coinsdb_cache * 0.95);
+            resize_current();
+            resize_historical();
         }
     }
 }
@@ -6153,6 +6268,8 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
     : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)},
+      m_input_fetcher{/*batch_size=*/16, std::clamp(options.worker_threads_num, 0, MAX_INPUT_FETCH_THREADS)},
+      m_header_checker{/*batch_size=*/64, std::clamp(options.worker_threads_num, 0, MAX_HEADER_CHECK_THREADS)},
       m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
       m_blockman{interrupt, std::move(blockman_options)},
@@ -6162,6 +6279,7 @@ ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Opt
 
 ChainstateManager::~ChainstateManager()
 {
+    StopBackgroundValidation();
     LOCK(::cs_main);
 
     m_versionbitscache.Clear();
@@ -6398,6 +6516,77 @@ std::optional<std::pair<const CBlockIndex*, const CBlockIndex*>> ChainstateManag
     return std::make_pair(chainstate->m_chain.Tip(), chainstate->TargetBlock());
 }
 
+void ChainstateManager::StartBackgroundValidation()
+{
+    LOCK(m_background_validation_mutex);
+    if (m_background_validation_running) return;
+    m_background_validation_running = true;
+    // Catch up with blocks that were received before the thread was started.
+    m_background_validation_requested = true;
+    m_background_validation_thread = std::thread(&util::TraceThread, "bgvalid", [this] { BackgroundValidationThread(); });
+}
+
+void ChainstateManager::StopBackgroundValidation()
+{
+    {
+        LOCK(m_background_validation_mutex);
+        if (!m_background_validation_running) return;
+        m_background_validation_running = false;
+    }
+    m_background_validation_cv.notify_all();
+    m_background_validation_thread.join();
+}
+
+bool ChainstateManager::RequestBackgroundValidation()
+{
+    {
+        LOCK(m_background_validation_mutex);
+        if (!m_background_validation_running) return false;
+        m_background_validation_requested = true;
+    }
+    m_background_validation_cv.notify_one();
+    return true;
+}
+
+void ChainstateManager::BackgroundValidationThread()
+{
+    while (true) {
+        {
+            WAIT_LOCK(m_background_validation_mutex, lock);
+            m_background_validation_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_background_validation_mutex) {
+                return m_background_validation_requested || !m_background_validation_running;
+            });
+            if (!m_background_validation_running) return;
+            m_background_validation_requested = false;
+        }
+
+        Chainstate* historical_cs;
+        {
+            LOCK(::cs_main);
+            historical_cs = HistoricalChainstate();
+            if (historical_cs && !m_historical_script_check_queue && m_options.background_worker_threads_num) {
+                const int worker_threads_num{std::clamp(*m_options.background_worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)};
+                m_historical_script_check_queue = std::make_unique<CCheckQueue<CScriptCheck>>(/*batch_size=*/128, worker_threads_num);
+                LogInfo("[background] starting %d script verification worker threads for the historical chainstate", worker_threads_num);
+            }
+        }
+        if (!historical_cs) continue;
+
+        BlockValidationState state;
+        if (!historical_cs->ActivateBestChain(state, nullptr)) {
+            LogError("[background] ActivateBestChain failed (%s)", state.ToString());
+        }
+
+        // Stop the worker threads once the snapshot has been validated, or
+        // found to be invalid, rather than leaving them idle.
+        LOCK(::cs_main);
+        if (m_historical_script_check_queue && !HistoricalChainstate()) {
+            m_historical_script_check_queue.reset();
+            LogInfo("[background] stopped the script verification worker threads of the historical chainstate");
+        }
+    }
+}
+
 util::Result<void> ChainstateManager::ActivateBestChains()
 {
     // We can't hold cs_main during ActivateBestChain even though we're accessing
@@ -6410,6 +6599,8 @@ util::Result<void> ChainstateManager::ActivateBestChains()
         chainstates.reserve(m_chainstates.size());
         for (const auto& chainstate : m_chainstates) {
             if (chainstate && chainstate->m_assumeutxo != Assumeutxo::INVALID && !chainstate->m_target_utxohash) {
+                // Leave the historical chainstate to the background validation thread, if it is running.
+                if (chainstate.get() == HistoricalChainstate() && RequestBackgroundValidation()) continue;
                 chainstates.push_back(chainstate.get());
             }
         }
@@ -14,6 +14,8 @@
 #include <consensus/amount.h>
 #include <cuckoocache.h>
 #include <deploymentstatus.h>
+#include <headerchecker.h>
+#include <inputfetcher.h>
 #include <kernel/chain.h>
 #include <kernel/chainparams.h>
 #include <kernel/chainstatemanager_opts.h>
@@ -40,13 +42,16 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <span>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -88,6 +93,9 @@ static const uint64_t MIN_DISK_SPACE_FOR_BLOCK_FILES = 550 * 1024 * 1024;
 
 /** Maximum number of dedicated script-checking threads allowed */
 static constexpr int MAX_SCRIPTCHECK_THREADS{15};
+/** Share of the coins caches given to the historical chainstate while the current
+ *  chainstate is in IBD, if the historical chainstate is validated in its own thread. */
+static constexpr double BACKGROUND_VALIDATION_CACHE_SHARE{0.3};
 
 /** Current sync state passed to tip changed callbacks. */
 enum class SynchronizationState {
@@ -333,12 +341,13 @@ bool CheckSequenceLocksAtTip(CBlockIndex* tip,
 
 /**
  * Closure representing one script verification
- * Note that this stores references to the spending transaction
+ * Note that this stores references to the spending transaction and the spent output
  */
 class CScriptCheck
 {
 private:
-    CTxOut m_tx_out;
+    //! The spent output, owned by txdata
+    const CTxOut* m_tx_out;
     const CTransaction *ptxTo;
     unsigned int nIn;
     script_verify_flags m_flags;
@@ -347,8 +356,8 @@ private:
     SignatureCache* m_signature_cache;
 
 public:
-    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, SignatureCache& signature_cache, unsigned int nInIn, script_verify_flags flags, bool cacheIn, PrecomputedTransactionData* txdataIn) :
-        m_tx_out(outIn), ptxTo(&txToIn), nIn(nInIn), m_flags(flags), cacheStore(cacheIn), txdata(txdataIn), m_signature_cache(&signature_cache) { }
+    CScriptCheck(const CTxOut& outIn LIFETIMEBOUND, const CTransaction& txToIn, SignatureCache& signature_cache, unsigned int nInIn, script_verify_flags flags, bool cacheIn, PrecomputedTransactionData* txdataIn) :
+        m_tx_out(&outIn), ptxTo(&txToIn), nIn(nInIn), m_flags(flags), cacheStore(cacheIn), txdata(txdataIn), m_signature_cache(&signature_cache) { }
 
     CScriptCheck(const CScriptCheck&) = delete;
     CScriptCheck& operator=(const CScriptCheck&) = delete;
@@ -486,6 +495,14 @@ public:
     //! This view wraps access to the leveldb instance and handles read errors gracefully.
     CCoinsViewErrorCatcher m_catcherview GUARDED_BY(cs_main);
 
+    //! This view keeps the coins evicted from m_cacheview by a flush in compressed form, up to a
+    //! share of the dbcache setting. It is thread-safe.
+    CCoinsViewCompressedCache m_compressedview;
+
+    //! This view publishes the state of m_cacheview for lookups that do not hold cs_main. It is
+    //! thread-safe, but only activated once the node is out of initial block download.
+    CCoinsViewSharded m_sharedview;
+
     //! This is the top layer of the cache hierarchy - it keeps as many coins in memory as
     //! can fit per the dbcache setting.
     std::unique_ptr<CCoinsViewCache> m_cacheview GUARDED_BY(cs_main);
@@ -523,6 +540,13 @@ constexpr int64_t LargeCoinsCacheThreshold(int64_t total_space) noexcept
                     total_space - MAX_BLOCK_COINSDB_USAGE_BYTES);
 }
 
+/** After a flush due to the size of the coins cache, the least recently
+ *  accessed coins are evicted until the cache takes at most this share of its
+ *  budget, rather than emptying it. */
+static constexpr int COINS_CACHE_RETAIN_PERCENT{50};
+/** Share of the coins cache budget that the compressed second level of the cache may take. */
+static constexpr int COINS_COMPRESSED_CACHE_PERCENT{10};
+
 //! Chainstate assumeutxo validity.
 enum class Assumeutxo {
     //! Every block in the chain has been validated.
@@ -562,7 +586,9 @@ protected:
     CTxMemPool* m_mempool;
 
     //! Manages the UTXO set, which is a reflection of the contents of `m_chain`.
-    std::unique_ptr<CoinsViews> m_coins_views;
+    //! Shared with the handles returned by CoinsShared(), so that the views
+    //! outlive a reset while lookups without cs_main are still using them.
+    std::shared_ptr<CoinsViews> m_coins_views;
 
     //! Cached result of LookupBlockIndex(*m_from_snapshot_blockhash)
     mutable const CBlockIndex* m_cached_snapshot_base GUARDED_BY(::cs_main){nullptr};
@@ -572,6 +598,10 @@ protected:
 
     std::optional<const char*> m_last_script_check_reason_logged GUARDED_BY(::cs_main){};
 
+    //! Times at which the most recent blocks were connected, and their
+    //! transaction counts, used to report validation throughput.
+    std::deque<std::pair<SteadyClock::time_point, unsigned int>> m_recent_connects GUARDED_BY(::cs_main);
+
 public:
     //! Reference to a BlockManager instance which itself is shared across all
     //! Chainstate instances.
@@ -612,6 +642,15 @@ public:
     //! is verified).
     void InitCoinsCache(size_t cache_size_bytes) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    struct ConnectThroughput {
+        double blocks_per_second;
+        double transactions_per_second;
+    };
+
+    //! @returns the rate at which the most recent blocks were connected, if
+    //!          enough blocks were connected to measure it.
+    std::optional<ConnectThroughput> GetConnectThroughput() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     //! @returns whether or not the CoinsViews object has been fully initialized and we can
     //!          safely flush this object to disk.
     bool CanFlushToDisk() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
@@ -697,6 +736,16 @@ public:
         return Assert(m_coins_views)->m_dbview;
     }
 
+    //! @returns An owning handle to the thread-safe view of the UTXO set at the tip,
+    //!     which remains usable after releasing cs_main. It keeps all coins views of
+    //!     the chainstate alive, even if they are reset in the meantime.
+    std::shared_ptr<CCoinsViewSharded> CoinsShared() EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+    {
+        AssertLockHeld(::cs_main);
+        Assert(m_coins_views);
+        return {m_coins_views, &m_coins_views->m_sharedview};
+    }
+
     //! @returns A pointer to the mempool.
     CTxMemPool* GetMempool()
     {
@@ -888,6 +937,10 @@ protected:
     void UpdateTip(const CBlockIndex* pindexNew)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /** Evict the least recently accessed coins from the synced coins cache
+     *  into its compressed second level, down to COINS_CACHE_RETAIN_PERCENT. */
+    void TrimCoinsCache() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     NodeClock::time_point m_next_write{NodeClock::time_point::max()};
 
     /**
@@ -958,14 +1011,18 @@ private:
         const node::SnapshotMetadata& metadata);
 
     /**
-     * If a block header hasn't already been seen, call CheckBlockHeader on it, ensure
+     * If a block header hasn't already been seen, check its proof of work, ensure
      * that it doesn't descend from an invalid block, and then add it to m_block_index.
      * Caller must set min_pow_checked=true in order to add a new header to the
      * block index (permanent memory storage), indicating that the header is
      * known to be part of a sufficiently high-work chain (anti-dos check).
+     *
+     * @param[in] checked  The hash of the header and the result of its proof of
+     *                     work check, as computed by CheckHeader().
      */
     bool AcceptBlockHeader(
         const CBlockHeader& block,
+        const CheckedHeader& checked,
         BlockValidationState& state,
         CBlockIndex** ppindex,
         bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -977,6 +1034,35 @@ private:
     //! A queue for script verifications that have to be performed by worker threads.
     CCheckQueue<CScriptCheck> m_script_check_queue;
 
+    //! A separate queue for the script verifications of the historical chainstate,
+    //! so that its validation has its own worker threads. Created by the
+    //! background validation thread when it first validates a historical chainstate,
+    //! if Options::background_worker_threads_num is set, and destroyed once there
+    //! is no historical chainstate anymore.
+    std::unique_ptr<CCheckQueue<CScriptCheck>> m_historical_script_check_queue GUARDED_BY(::cs_main);
+
+    //! Thread that connects blocks to the historical chainstate, started by
+    //! StartBackgroundValidation().
+    std::thread m_background_validation_thread;
+    std::atomic_bool m_background_validation_running{false};
+    Mutex m_background_validation_mutex;
+    std::condition_variable m_background_validation_cv;
+    bool m_background_validation_requested GUARDED_BY(m_background_validation_mutex){false};
+
+    void BackgroundValidationThread() EXCLUSIVE_LOCKS_REQUIRED(!m_background_validation_mutex);
+
+    //! Wake up the background validation thread.
+    //! @returns false if it is not running, in which case the caller has to
+    //!          connect blocks to the historical chainstate itself.
+    bool RequestBackgroundValidation() EXCLUSIVE_LOCKS_REQUIRED(!m_background_validation_mutex);
+
+    //! Worker threads that prefetch the inputs of a block before it is connected.
+    InputFetcher m_input_fetcher;
+
+    //! Worker threads that hash headers and check their proof of work before
+    //! they are accepted.
+    HeaderChecker m_header_checker;
+
     //! Timers and counters used for benchmarking validation in both background
     //! and active chainstates.
     SteadyClock::duration GUARDED_BY(::cs_main) time_check{};
@@ -1351,7 +1437,8 @@ public:
     //! Get range of historical blocks to download.
     std::optional<std::pair<const CBlockIndex*, const CBlockIndex*>> GetHistoricalBlockRange() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    //! Call ActivateBestChain() on every chainstate.
+    //! Call ActivateBestChain() on every chainstate. If the background
+    //! validation thread is running, the historical chainstate is left to it.
     util::Result<void> ActivateBestChains() LOCKS_EXCLUDED(::cs_main);
 
     //! If, due to invalidation / reconsideration of blocks, the previous
@@ -1365,6 +1452,30 @@ public:
 
     CCheckQueue<CScriptCheck>& GetCheckQueue() { return m_script_check_queue; }
 
+    //! @returns the queue for the script verifications of the given chainstate.
+    CCheckQueue<CScriptCheck>& GetCheckQueue(const Chainstate& chainstate) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+    {
+        if (m_historical_script_check_queue && &chainstate == HistoricalChainstate()) return *m_historical_script_check_queue;
+        return m_script_check_queue;
+    }
+
+    /**
+     * Start a thread that connects blocks to the historical chainstate, if there
+     * is one, so that background validation of an assumeutxo snapshot does not
+     * slow down the threads that process blocks of the current chainstate.
+     * Without it, the historical chainstate is advanced by ProcessNewBlock().
+     *
+     * The historical chainstate verifies scripts on a check queue of its own,
+     * with -parbackground worker threads, if there are cores for it. ConnectBlock()
+     * still holds cs_main, so blocks of the two chainstates are connected one
+     * after the other rather than in parallel.
+     */
+    void StartBackgroundValidation() EXCLUSIVE_LOCKS_REQUIRED(!m_background_validation_mutex);
+    void StopBackgroundValidation() EXCLUSIVE_LOCKS_REQUIRED(!m_background_validation_mutex);
+    bool IsBackgroundValidationRunning() const { return m_background_validation_running; }
+
+    InputFetcher& GetInputFetcher() { return m_input_fetcher; }
+
     ~ChainstateManager();
 
     //! List of chainstates. Note: in general, it is not safe to delete
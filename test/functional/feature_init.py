@@ -23,6 +23,8 @@ ALL_INDEX_ARGS = [
     '-blockfilterindex=1',
     '-coinstatsindex=1',
     '-txospenderindex=1',
+    '-scriptindex=1',
+    '-utxoscriptindex=1',
 ]
 
 class InitTest(BitcoinTestFramework):
@@ -81,6 +83,8 @@ class InitTest(BitcoinTestFramework):
             b'block filter index thread start',
             b'coinstatsindex thread start',
             b'txospenderindex thread start',
+            b'scriptindex thread start',
+            b'utxoscriptindex thread start',
             b'msghand thread start',
             b'net thread start',
             b'addcon thread start',
@@ -145,6 +149,16 @@ class InitTest(BitcoinTestFramework):
                 'error_message': 'LevelDB error: Corruption: CURRENT points to a non-existent file',
                 'startup_args': ['-txospenderindex=1'],
             },
+            {
+                'filepath_glob': 'indexes/scriptindex/db/MANIFEST*',
+                'error_message': 'LevelDB error: Corruption: CURRENT points to a non-existent file',
+                'startup_args': ['-scriptindex=1'],
+            },
+            {
+                'filepath_glob': 'indexes/utxoscriptindex/db/MANIFEST*',
+                'error_message': 'LevelDB error: Corruption: CURRENT points to a non-existent file',
+                'startup_args': ['-utxoscriptindex=1'],
+            },
             # Removing these files does not result in a startup error:
             # 'indexes/blockfilter/basic/*.dat', 'indexes/blockfilter/basic/db/*.*', 'indexes/coinstatsindex/db/*.*',
             # 'indexes/txindex/*.log', 'indexes/txindex/CURRENT', 'indexes/txindex/LOCK'
@@ -191,6 +205,16 @@ class InitTest(BitcoinTestFramework):
                 'error_message': 'LevelDB error: Corruption',
                 'startup_args': ['-txospenderindex=1'],
             },
+            {
+                'filepath_glob': 'indexes/scriptindex/db/*',
+                'error_message': 'LevelDB error: Corruption',
+                'startup_args': ['-scriptindex=1'],
+            },
+            {
+                'filepath_glob': 'indexes/utxoscriptindex/db/*',
+                'error_message': 'LevelDB error: Corruption',
+                'startup_args': ['-utxoscriptindex=1'],
+            },
             # Perturbing these files does not result in a startup error:
             # 'indexes/blockfilter/basic/*.dat', 'indexes/txindex/MANIFEST*', 'indexes/txindex/LOCK'
         ]
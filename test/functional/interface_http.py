@@ -12,9 +12,15 @@ import time
 import urllib.parse
 
 class HTTPBasicsTest (BitcoinTestFramework):
+    def add_options(self, parser):
+        parser.add_argument("--rpcserverbackend", default="libevent", choices=["libevent", "native"],
+                            help="HTTP server implementation used by the nodes (default: %(default)s)")
+
     def set_test_params(self):
         self.num_nodes = 3
         self.supports_cli = False
+        self.backend_args = [f"-rpcserverbackend={self.options.rpcserverbackend}"]
+        self.extra_args = [self.backend_args] * self.num_nodes
 
     def setup_network(self):
         self.setup_nodes()
@@ -188,7 +194,7 @@ class HTTPBasicsTest (BitcoinTestFramework):
         # called for the remainder of this test.
         self.nodes[2].reuse_http_connections = False
 
-        self.restart_node(2, extra_args=["-rpcservertimeout=2"])
+        self.restart_node(2, extra_args=self.backend_args + ["-rpcservertimeout=2"])
         # This is the amount of time the server will wait for a client to
         # send a complete request. Test it by sending an incomplete but
         # so-far otherwise well-formed HTTP request, and never finishing it.
@@ -89,10 +89,16 @@ def test_work_queue_getblock(node, got_exceeded_error):
 
 
 class RPCInterfaceTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        parser.add_argument("--rpcserverbackend", default="libevent", choices=["libevent", "native"],
+                            help="HTTP server implementation used by the nodes (default: %(default)s)")
+
     def set_test_params(self):
         self.num_nodes = 1
         self.setup_clean_chain = True
         self.supports_cli = False
+        self.backend_args = [f"-rpcserverbackend={self.options.rpcserverbackend}"]
+        self.extra_args = [self.backend_args]
 
     def test_getrpcinfo(self):
         self.log.info("Testing getrpcinfo...")
@@ -228,7 +234,7 @@ class RPCInterfaceTest(BitcoinTestFramework):
 
     def test_work_queue_exceeded(self):
         self.log.info("Testing work queue exceeded...")
-        self.restart_node(0, ['-rpcworkqueue=1', '-rpcthreads=1'])
+        self.restart_node(0, self.backend_args + ['-rpcworkqueue=1', '-rpcthreads=1'])
         got_exceeded_error = []
         threads = []
         for _ in range(3):
@@ -7,10 +7,17 @@ from collections import defaultdict
 
 from test_framework.messages import (
     CInv,
+    MSG_BLOCK,
+    MSG_TX,
+    MSG_WITNESS_FLAG,
     msg_getdata,
 )
-from test_framework.p2p import P2PInterface
+from test_framework.p2p import (
+    P2PInterface,
+    p2p_lock,
+)
 from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
 
 
 class P2PStoreBlock(P2PInterface):
@@ -22,9 +29,24 @@ class P2PStoreBlock(P2PInterface):
         self.blocks[message.block.hash_int] += 1
 
 
+class P2PStoreResponses(P2PInterface):
+    """Records the block and notfound responses in the order they are received."""
+    def __init__(self):
+        super().__init__()
+        self.responses = []
+
+    def on_block(self, message):
+        self.responses.append(("block", message.block.hash_int))
+
+    def on_notfound(self, message):
+        self.responses.append(("notfound", [inv.hash for inv in message.vec]))
+
+
 class GetdataTest(BitcoinTestFramework):
     def set_test_params(self):
-        self.num_nodes = 1
+        self.num_nodes = 2
+        # Serve blocks read from disk on the message handler thread on the second node
+        self.extra_args = [[], ["-blockservethreads=0"]]
 
     def run_test(self):
         p2p_block_store = self.nodes[0].add_p2p_connection(P2PStoreBlock())
@@ -43,6 +65,57 @@ class GetdataTest(BitcoinTestFramework):
         p2p_block_store.send_and_ping(good_getdata)
         p2p_block_store.wait_until(lambda: p2p_block_store.blocks[best_block] == 1)
 
+        self.test_response_order()
+        self.test_disconnect_while_serving()
+
+    def test_response_order(self):
+        self.log.info("test that responses to a GETDATA with blocks, transactions and unknown items are sent in request order")
+        node = self.nodes[0]
+        blocks = [int(node.getblockhash(height), 16) for height in (10, 11)]
+        missing_txs = [0x1234, 0x5678, 0x9abc]
+        getdata = msg_getdata([
+            CInv(t=MSG_TX, h=missing_txs[0]),
+            CInv(t=MSG_BLOCK | MSG_WITNESS_FLAG, h=blocks[0]),
+            CInv(t=MSG_TX, h=missing_txs[1]),
+            CInv(t=MSG_BLOCK | MSG_WITNESS_FLAG, h=blocks[1]),
+            CInv(t=MSG_TX, h=missing_txs[2]),
+        ])
+        # A NOTFOUND for the transactions requested before a block follows that block
+        expected = [
+            ("block", blocks[0]),
+            ("notfound", [missing_txs[0]]),
+            ("block", blocks[1]),
+            ("notfound", [missing_txs[1]]),
+            ("notfound", [missing_txs[2]]),
+        ]
+        # Blocks are read from disk on a block serving thread on the first node, and on
+        # the message handler thread on the second, which must not change the order.
+        for node in self.nodes:
+            peer = node.add_p2p_connection(P2PStoreResponses())
+            peer.send_and_ping(getdata)
+            with p2p_lock:
+                assert_equal(peer.responses, expected)
+            peer.peer_disconnect()
+            peer.wait_for_disconnect()
+
+    def test_disconnect_while_serving(self):
+        self.log.info("test that a peer disconnecting while blocks are being served to it is handled")
+        node = self.nodes[0]
+        getdata = msg_getdata([CInv(t=MSG_BLOCK | MSG_WITNESS_FLAG, h=int(node.getblockhash(height), 16)) for height in range(1, 200)])
+        num_peers = len(node.getpeerinfo())
+        for _ in range(5):
+            peer = node.add_p2p_connection(P2PInterface())
+            peer.send_without_ping(getdata)
+            peer.peer_disconnect()
+            peer.wait_for_disconnect()
+        self.wait_until(lambda: len(node.getpeerinfo()) == num_peers)
+
+        # The node keeps serving blocks to other peers
+        best_block = int(node.getbestblockhash(), 16)
+        peer = node.add_p2p_connection(P2PStoreBlock())
+        peer.send_and_ping(msg_getdata([CInv(t=MSG_BLOCK | MSG_WITNESS_FLAG, h=int(node.getblockhash(1), 16)), CInv(t=MSG_BLOCK | MSG_WITNESS_FLAG, h=best_block)]))
+        peer.wait_until(lambda: peer.blocks[best_block] == 1)
+
 
 if __name__ == '__main__':
     GetdataTest(__file__).main()
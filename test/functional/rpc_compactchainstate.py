@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the background compaction of the chainstate and the compactchainstate RPC."""
+
+import time
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+
+
+class CompactChainstateTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [["-dbcompactrate=chainstate:100"], []]
+
+    def run_test(self):
+        node, node_disabled = self.nodes
+
+        self.log.info("Test that background compaction is disabled by default")
+        status = node_disabled.compactchainstate()
+        assert_equal(status["enabled"], False)
+        assert_equal(status["passes"], 0)
+        assert_raises_rpc_error(-1, "Background compaction of the chainstate is disabled", node_disabled.compactchainstate, "start")
+        assert_raises_rpc_error(-8, "Invalid action 'abort'", node.compactchainstate, "abort")
+
+        self.log.info("Test that compaction is deferred during initial block download")
+        self.generate(node, 200)
+        # Restart with the tip far in the past, so that the node is in IBD, and
+        # flush the chainstate so that compaction is deferred.
+        self.restart_node(0, extra_args=self.extra_args[0] + [f"-mocktime={int(time.time()) + 365 * 24 * 60 * 60}"])
+        node.gettxoutsetinfo()
+        status = node.compactchainstate("start")
+        assert_equal(status["enabled"], True)
+        assert_equal(status["deferred"], True)
+        self.wait_until(lambda: node.compactchainstate()["running"])
+        assert_equal(node.compactchainstate()["passes"], 0)
+
+        self.log.info("Test a compaction pass")
+        self.restart_node(0)
+        node.compactchainstate("start")
+        self.wait_until(lambda: node.compactchainstate()["passes"] == 1)
+        status = node.compactchainstate()
+        assert_equal(status["deferred"], False)
+        assert_equal(status["running"], False)
+        assert "progress" not in status
+        # The tables of level 0 were all compacted into the next levels.
+        levels = status["levels"]
+        assert all(level["files"] == 0 for level in levels if level["level"] == 0)
+        assert any(level["files"] > 0 for level in levels if level["level"] > 0)
+
+
+if __name__ == '__main__':
+    CompactChainstateTest(__file__).main()
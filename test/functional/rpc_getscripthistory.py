@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the getscripthistory RPC and the /rest/scripthistory endpoint."""
+
+import http.client
+import json
+import urllib.parse
+
+from test_framework.messages import COIN
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import (
+    MiniWallet,
+    getnewdestination,
+)
+
+
+class GetScriptHistoryTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [["-scriptindex", "-rest"]]
+
+    def rest_request(self, uri, status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest/scripthistory/' + uri)
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        body = resp.read().decode('utf-8')
+        return json.loads(body) if status == 200 else body
+
+    def all_pages(self, script, count):
+        history = []
+        result = self.nodes[0].getscripthistory(script, count)
+        history += result["history"]
+        while "next" in result:
+            assert_equal(len(result["history"]), count)
+            result = self.nodes[0].getscripthistory(script, count, result["next"])
+            history += result["history"]
+        return history
+
+    def run_test(self):
+        node = self.nodes[0]
+        wallet = MiniWallet(node)
+        self.wait_until(lambda: node.getindexinfo()["scriptindex"]["synced"])
+
+        self.log.info("Test the history of a new address")
+        _, spk, address = getnewdestination()
+        assert_equal(node.getscripthistory(address), {"history": []})
+        sends = [wallet.send_to(from_node=node, scriptPubKey=spk, amount=(i + 1) * COIN) for i in range(3)]
+        self.generate(node, 1)
+        height = node.getblockcount()
+
+        history = node.getscripthistory(address)["history"]
+        assert_equal(len(history), 3)
+        # The order of the transactions in the block is up to the block template.
+        sends_by_txid = {send["txid"]: send for send in sends}
+        for entry in history:
+            send = sends_by_txid.pop(entry["txid"])
+            assert_equal(entry["height"], height)
+            assert_equal(entry["type"], "receive")
+            assert_equal(entry["n"], send["sent_vout"])
+            assert "spent" not in entry
+        assert_equal(sorted(entry["amount"] for entry in history), [1, 2, 3])
+        assert_equal(node.getscripthistory(spk.hex()), node.getscripthistory(address))
+
+        self.log.info("Test that spent outputs are linked to the inputs that spent them")
+        history = self.all_pages(wallet.get_address(), 10000)
+        receives = {(e["txid"], e["n"]): e for e in history if e["type"] == "receive"}
+        spends = [e for e in history if e["type"] == "spend"]
+        assert_equal(len(spends), len(sends))
+        for spend in spends:
+            assert spend["txid"] in [send["txid"] for send in sends]
+            received = receives[(spend["prevout"]["txid"], spend["prevout"]["vout"])]
+            assert_equal(received["spent"], {"txid": spend["txid"], "height": spend["height"]})
+            assert_equal(received["amount"], spend["amount"])
+        assert_equal([(e["height"]) for e in history], sorted(e["height"] for e in history))
+
+        self.log.info("Test paging through a history")
+        for count in [1, 7, 100]:
+            assert_equal(self.all_pages(wallet.get_address(), count), history)
+        assert_raises_rpc_error(-8, "count must be between 1 and 10000", node.getscripthistory, address, 0)
+        assert_raises_rpc_error(-8, "count must be between 1 and 10000", node.getscripthistory, address, 10001)
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getscripthistory, address, 1, "00")
+        assert_raises_rpc_error(-5, "Invalid address or script", node.getscripthistory, "notanaddress")
+
+        self.log.info("Test the REST endpoint")
+        assert_equal(self.rest_request(f"{address}.json"), node.getscripthistory(address))
+        page = self.rest_request(f"{address}.json?count=2")
+        assert_equal(page, node.getscripthistory(address, 2))
+        assert_equal(self.rest_request(f"{address}.json?count=2&cursor={page['next']}"), node.getscripthistory(address, 2, page["next"]))
+        assert_equal(self.rest_request(f"{spk.hex()}.json"), node.getscripthistory(address))
+        self.rest_request(f"{address}.json?count=0", status=400)
+        self.rest_request(f"{address}.json?cursor=zz", status=400)
+        self.rest_request("notanaddress.json", status=400)
+        self.rest_request(f"{address}.bin", status=404)
+
+        self.log.info("Test that a reorg removes the entries of disconnected blocks")
+        tip = node.getbestblockhash()
+        node.invalidateblock(tip)
+        assert_equal(node.getscripthistory(address), {"history": []})
+        assert_equal(self.rest_request(f"{address}.json"), {"history": []})
+        remaining = self.all_pages(wallet.get_address(), 10000)
+        assert_equal([(e["txid"], e["n"]) for e in remaining], [(e["txid"], e["n"]) for e in history if e["height"] < height])
+        spent_in_tip = {(s["prevout"]["txid"], s["prevout"]["vout"]) for s in spends}
+        assert all("spent" not in e for e in remaining if (e["txid"], e["n"]) in spent_in_tip)
+        # The index is rewound when the first block of the other branch is connected.
+        fork = self.generateblock(node, output=getnewdestination()[2], transactions=[])["hash"]
+        assert_equal(node.getscripthistory(address), {"history": []})
+        assert_equal(self.all_pages(wallet.get_address(), 10000), remaining)
+        node.invalidateblock(fork)
+        node.reconsiderblock(tip)
+        assert_equal(len(node.getscripthistory(address)["history"]), 3)
+        assert_equal(self.all_pages(wallet.get_address(), 10000), history)
+
+        self.log.info("Test that the RPC requires the index")
+        self.restart_node(0, extra_args=[])
+        assert_raises_rpc_error(-1, "Requires -scriptindex", node.getscripthistory, address)
+
+
+if __name__ == '__main__':
+    GetScriptHistoryTest(__file__).main()
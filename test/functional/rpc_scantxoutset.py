@@ -138,6 +138,48 @@ class ScantxoutsetTest(BitcoinTestFramework):
         # Check that invalid command give error
         assert_raises_rpc_error(-8, "Invalid action 'invalid_command'", self.nodes[0].scantxoutset, "invalid_command")
 
+        self.log.info("Test that scans with -utxoscriptindex find the same unspent outputs.")
+        scanobjects = [
+            [self.wallet.get_descriptor()],
+            ["combo(" + pubk1.hex() + ")", "combo(" + pubk2.hex() + ")", "combo(" + pubk3.hex() + ")"],
+            [{"desc": "combo(tprv8ZgxMBicQKsPd7Uf69XL1XwhmjHopUGep8GuEiJDZmbQz6o58LninorQAfcKZWARbtRtfnLcJ5MQ2AtHcQJCCRUcMRvmDUjyEmNUWwx8UbK/1/1/*)", "range": 1500}],
+            ["addr(" + getnewdestination()[2] + ")"],
+        ]
+        expected = [self.nodes[0].scantxoutset("start", objects) for objects in scanobjects]
+        self.restart_node(0, extra_args=["-utxoscriptindex"])
+        self.wait_until(lambda: self.nodes[0].getindexinfo("utxoscriptindex")["utxoscriptindex"]["synced"])
+        for objects, scan in zip(scanobjects, expected):
+            indexed_scan = self.nodes[0].scantxoutset("start", objects)
+            assert_equal(indexed_scan["txouts"], len(indexed_scan["unspents"]))
+            del indexed_scan["txouts"], scan["txouts"]
+            assert_equal(indexed_scan, scan)
+
+        self.log.info("Test that the index follows new blocks.")
+        tx = self.wallet.send_self_transfer(from_node=self.nodes[0])["tx"]
+        self.generate(self.nodes[0], 1)
+        scan = self.nodes[0].scantxoutset("start", [self.wallet.get_descriptor()])
+        assert_equal(scan["height"], self.nodes[0].getblockcount())
+        outpoints = [(u["txid"], u["vout"]) for u in scan["unspents"]]
+        assert (tx.txid_hex, 0) in outpoints
+        assert (f"{tx.vin[0].prevout.hash:064x}", tx.vin[0].prevout.n) not in outpoints
+
+        self.log.info("Test that the index is not used while its best block is not the tip.")
+        tip = self.nodes[0].getbestblockhash()
+        self.nodes[0].invalidateblock(tip)
+        scan = self.nodes[0].scantxoutset("start", [self.wallet.get_descriptor()])
+        assert_equal(scan["bestblock"], self.nodes[0].getbestblockhash())
+        assert_equal(scan["height"], self.nodes[0].getblockcount())
+        # The whole UTXO set was scanned.
+        assert scan["txouts"] > len(scan["unspents"])
+        outpoints = [(u["txid"], u["vout"]) for u in scan["unspents"]]
+        assert (tx.txid_hex, 0) not in outpoints
+        assert (f"{tx.vin[0].prevout.hash:064x}", tx.vin[0].prevout.n) in outpoints
+        self.nodes[0].reconsiderblock(tip)
+        scan = self.nodes[0].scantxoutset("start", [self.wallet.get_descriptor()])
+        assert_equal(scan["bestblock"], tip)
+        assert_equal(scan["txouts"], len(scan["unspents"]))
+        assert (tx.txid_hex, 0) in [(u["txid"], u["vout"]) for u in scan["unspents"]]
+
 
 if __name__ == "__main__":
     ScantxoutsetTest(__file__).main()
@@ -201,7 +201,9 @@ BASE_SCRIPTS = [
     'wallet_reindex.py',
     'wallet_reorgsrestore.py',
     'interface_http.py',
+    'interface_http.py --rpcserverbackend=native',
     'interface_rpc.py',
+    'interface_rpc.py --rpcserverbackend=native',
     'interface_usdt_coinselection.py',
     'interface_usdt_mempool.py',
     'interface_usdt_net.py',
@@ -374,6 +376,8 @@ BASE_SCRIPTS = [
     'feature_settings.py',
     'rpc_getdescriptorinfo.py',
     'rpc_gettxspendingprevout.py',
+    'rpc_getscripthistory.py',
+    'rpc_compactchainstate.py',
     'rpc_help.py',
     'feature_framework_testshell.py',
     'tool_rpcauth.py',